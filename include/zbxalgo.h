@@ -770,4 +770,28 @@ int	zbx_list_iterator_isset(const zbx_list_iterator_t *iterator);
 void	zbx_list_iterator_update(zbx_list_iterator_t *iterator);
 void	*zbx_list_iterator_remove_next(zbx_list_iterator_t *iterator);
 
+/* log-linear histogram (HDR histogram style) with value precision of 1/ZBX_HDR_HISTOGRAM_SUB_NUM */
+#define ZBX_HDR_HISTOGRAM_SUB_BITS	4
+#define ZBX_HDR_HISTOGRAM_SUB_NUM	(1 << ZBX_HDR_HISTOGRAM_SUB_BITS)
+/* values starting with 2^ZBX_HDR_HISTOGRAM_VALUE_BITS are counted in the last bucket */
+#define ZBX_HDR_HISTOGRAM_VALUE_BITS	32
+#define ZBX_HDR_HISTOGRAM_BUCKETS_NUM	\
+		((ZBX_HDR_HISTOGRAM_VALUE_BITS - ZBX_HDR_HISTOGRAM_SUB_BITS + 1) * ZBX_HDR_HISTOGRAM_SUB_NUM)
+
+/* histogram does not contain pointers and can be stored in shared memory */
+typedef struct
+{
+	zbx_uint64_t	buckets[ZBX_HDR_HISTOGRAM_BUCKETS_NUM];
+	zbx_uint64_t	count;
+	zbx_uint64_t	sum;
+	zbx_uint64_t	max;
+}
+zbx_hdr_histogram_t;
+
+void		zbx_hdr_histogram_clear(zbx_hdr_histogram_t *hist);
+void		zbx_hdr_histogram_add(zbx_hdr_histogram_t *hist, zbx_uint64_t value, zbx_uint64_t count);
+void		zbx_hdr_histogram_merge(zbx_hdr_histogram_t *dst, const zbx_hdr_histogram_t *src);
+zbx_uint64_t	zbx_hdr_histogram_percentile(const zbx_hdr_histogram_t *hist, double percentile);
+double		zbx_hdr_histogram_avg(const zbx_hdr_histogram_t *hist);
+
 #endif /* ZABBIX_ZBXALGO_H */
@@ -25,6 +25,7 @@
 #include "zbxtagfilter.h"
 #include "zbxautoreg.h"
 #include "zbxpgservice.h"
+#include "zbxpreprocbase.h"
 #include "zbxalgo.h"
 
 #define	ZBX_NO_POLLER			255
@@ -816,6 +817,8 @@ void	zbx_connector_filter_free(zbx_connector_filter_t connector_filter);
 
 int	zbx_dc_config_get_active_items_count_by_hostid(zbx_uint64_t hostid);
 void	zbx_dc_config_get_active_items_by_hostid(zbx_dc_item_t *items, zbx_uint64_t hostid, int *errcodes, size_t num);
+void	zbx_dc_config_get_items_preproc_steps(const zbx_dc_item_t *items, const int *errcodes,
+		zbx_vector_pp_step_ptr_t *steps, size_t num);
 void	zbx_dc_config_get_preprocessable_items(zbx_hashset_t *items, zbx_dc_um_shared_handle_t **um_handle,
 		zbx_uint64_t *revision);
 void	zbx_dc_config_get_functions_by_functionids(zbx_dc_function_t *functions,
@@ -832,6 +835,8 @@ typedef struct zbx_hc_data
 	unsigned char		value_type;
 	unsigned char		flags;
 	unsigned char		state;
+	double			ingest;		/* time value was passed for processing */
+	double			cached;		/* time value was added to history cache */
 
 	struct zbx_hc_data	*next;
 }
@@ -1289,6 +1294,7 @@ int	zbx_dc_drule_revisions_get(zbx_uint64_t *rev_last, zbx_vector_uint64_pair_t
 int	zbx_dc_httptest_next(time_t now, zbx_uint64_t *httptestid, time_t *nextcheck);
 void	zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay);
 
+zbx_uint64_t	zbx_dc_get_config_revision(void);
 void	zbx_dc_get_upstream_revision(zbx_uint64_t *config_revision, zbx_uint64_t *hostmap_revision);
 void	zbx_dc_set_upstream_revision(zbx_uint64_t config_revision, zbx_uint64_t hostmap_revision);
 
@@ -1365,6 +1371,18 @@ int	zbx_vps_monitor_capped(void);
 void	zbx_vps_monitor_get_stats(zbx_vps_monitor_stats_t *stats);
 const char	*zbx_vps_monitor_status(void);
 
+/* housekeeper statistics */
+typedef struct
+{
+	zbx_uint64_t	deleted;	/* events and problems deleted since server start */
+	double		rps;		/* deletion rate of the last batch, rows per second */
+	int		batch_size;	/* current deletion batch size */
+}
+zbx_hk_stats_t;
+
+void	zbx_dc_update_hk_stats(int deleted, double sec, int batch_size);
+void	zbx_dc_get_hk_stats(zbx_hk_stats_t *stats);
+
 typedef struct
 {
 	const char	*agent;
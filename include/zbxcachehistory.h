@@ -35,6 +35,17 @@
 #define ZBX_SYNC_DONE		0
 #define	ZBX_SYNC_MORE		1
 
+/* value processing stages with latency tracking */
+#define ZBX_HC_LATENCY_PREPROCESSING	0	/* from collection until added to history cache */
+#define ZBX_HC_LATENCY_CACHE		1	/* waiting in history cache for history syncer */
+#define ZBX_HC_LATENCY_DBFLUSH		2	/* writing history, trends and item updates to database */
+#define ZBX_HC_LATENCY_TRIGGERS		3	/* trigger recalculation and event processing */
+#define ZBX_HC_LATENCY_TOTAL		4	/* from collection until history synchronization is done */
+#define ZBX_HC_LATENCY_STAGES_NUM	5
+
+/* the value latency statistics are reported for the last full period */
+#define ZBX_HC_LATENCY_PERIOD		SEC_PER_MIN
+
 typedef struct
 {
 	zbx_uint64_t	history_counter;	/* the total number of processed values */
@@ -108,6 +119,7 @@ typedef struct
 	int		logeventid;
 	zbx_uint64_t	lastlogsize;
 	char		*source;
+	double		ingest;		/* time value was passed for processing, 0 if unknown */
 }
 zbx_pp_value_opt_t;
 
@@ -140,6 +152,7 @@ void	zbx_dc_flush_history(void);
 void	zbx_hc_pop_items(zbx_vector_hc_item_ptr_t *history_items);
 void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t *history_items);
 void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items);
+void	zbx_hc_latency_mark(int stage);
 int	zbx_hc_queue_get_size(void);
 int	zbx_hc_get_history_compression_age(void);
 
@@ -158,6 +171,9 @@ void	zbx_dc_update_interfaces_availability(void);
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
+void	zbx_hc_get_latency(zbx_hdr_histogram_t *latency);
+const char	*zbx_hc_latency_stage_string(int stage);
+int	zbx_hc_latency_stage_by_name(const char *name);
 int	zbx_db_trigger_queue_locked(void);
 void	zbx_db_trigger_queue_unlock(void);
 zbx_uint64_t	zbx_hc_proxyqueue_peek(void);
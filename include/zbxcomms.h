@@ -17,6 +17,7 @@
 
 #include "zbxalgo.h"
 #include "zbxtime.h"
+#include "zbxcompress.h"
 
 #define ZBX_IPV4_MAX_CIDR_PREFIX	32	/* max number of bits in IPv4 CIDR prefix */
 #define ZBX_IPV6_MAX_CIDR_PREFIX	128	/* max number of bits in IPv6 CIDR prefix */
@@ -127,6 +128,7 @@ typedef struct
 					/*'TLSCipherAll' */
 	char		*cipher_cmd13;	/* not used in agent, server, proxy, config file parameter '--tls-cipher13' */
 	char		*cipher_cmd;	/* not used in agent, server, proxy, config file parameter 'tls-cipher' */
+	int		kernel_offload;	/* used only in server and proxy, config file parameter 'TLSKernelOffload' */
 } zbx_config_tls_t;
 
 zbx_config_tls_t	*zbx_config_tls_new(void);
@@ -168,6 +170,7 @@ typedef struct
 	unsigned char	psk_buf[HOST_TLS_PSK_LEN / 2];
 #elif defined(HAVE_OPENSSL)
 	SSL				*ctx;
+	char				*session_key;	/* key of resumable session in client session cache */
 #if defined(HAVE_OPENSSL_WITH_PSK)
 	char	psk_buf[HOST_TLS_PSK_LEN / 2];
 	int	psk_len;
@@ -202,6 +205,8 @@ typedef struct
 	int				protocol;
 	int				timeout;
 	zbx_timespec_t			deadline;
+	/* stream uncompressing large message while it is being received */
+	zbx_uncompress_stream_t		*uncompress_stream;
 }
 zbx_socket_t;
 
@@ -216,6 +221,7 @@ typedef struct
 	unsigned char	expect;
 	int		protocol_version;
 	size_t		allocated;
+	double		uncompress_time;
 }
 zbx_tcp_recv_context_t;
 
@@ -283,6 +289,31 @@ int	zbx_tcp_send_context(zbx_socket_t *s, zbx_tcp_send_context_t *context, short
 
 void	zbx_tcp_close(zbx_socket_t *s);
 
+#define ZBX_COMPRESS_STATS_SENT		0
+#define ZBX_COMPRESS_STATS_RECEIVED	1
+#define ZBX_COMPRESS_STATS_COUNT	2
+
+/* compression statistics of Zabbix protocol messages */
+typedef struct
+{
+	zbx_uint64_t	messages;
+	zbx_uint64_t	bytes;			/* uncompressed size */
+	zbx_uint64_t	bytes_compressed;
+	double		time;			/* time spent compressing or uncompressing */
+}
+zbx_compress_stats_t;
+
+typedef void	(*zbx_compress_stats_update_f)(int direction, size_t bytes, size_t bytes_compressed, double time);
+
+void	zbx_tcp_init_compress_stats(zbx_compress_stats_update_f update_cb);
+
+#define ZBX_TLS_STATS_HANDSHAKES_FULL		0
+#define ZBX_TLS_STATS_HANDSHAKES_RESUMED	1
+#define ZBX_TLS_STATS_KTLS			2	/* connections with encryption offloaded to kernel */
+#define ZBX_TLS_STATS_COUNT			3
+
+typedef void	(*zbx_tls_stats_update_f)(int counter);
+
 #ifdef HAVE_IPV6
 int	get_address_family(const char *addr, int *family, char *error, int max_error_len);
 #endif
@@ -426,6 +457,9 @@ void	zbx_tls_validate_config(zbx_config_tls_t *config_tls, int config_active_for
 		int config_passive_forks, zbx_get_program_type_f zbx_get_program_type_cb);
 void	zbx_tls_library_deinit(zbx_tls_status_t status);
 void	zbx_tls_init_parent(zbx_get_program_type_f zbx_get_program_type_cb_arg);
+void	zbx_tls_init_ticket_keys(void);
+void	zbx_tls_check_kernel_offload(const zbx_config_tls_t *config_tls);
+void	zbx_tls_init_stats(zbx_tls_stats_update_f update_cb);
 
 typedef size_t	(*zbx_find_psk_in_cache_f)(const unsigned char *, unsigned char *, unsigned int *);
 
@@ -21,4 +21,11 @@ int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out);
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out);
 const char	*zbx_compress_strerror(void);
 
+typedef struct zbx_uncompress_stream	zbx_uncompress_stream_t;
+
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out);
+int	zbx_uncompress_stream_update(zbx_uncompress_stream_t *stream, const char *in, size_t size_in);
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out);
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream);
+
 #endif
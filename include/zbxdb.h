@@ -54,6 +54,7 @@ typedef struct
 	char	*config_db_tls_cipher;
 	char	*config_db_tls_cipher_13;
 	int	config_dbport;
+	int	config_db_prepared_statements;
 }
 zbx_config_dbhigh_t;
 
@@ -138,6 +139,11 @@ void	zbx_postgresql_escape_bin(const char *src, char **dst, size_t size);
 #endif
 
 int		zbx_db_vexecute(const char *fmt, va_list args);
+#if defined(HAVE_POSTGRESQL)
+int		zbx_db_prepared_statements_enabled(void);
+int		zbx_db_execute_prepared_basic(const char *sql, int params_num, const char * const *params);
+#endif
+void		zbx_db_pipeline_enable(void);
 zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args);
 zbx_db_result_t	zbx_db_select_n_basic(const char *query, int n);
 
@@ -501,6 +501,9 @@ int	zbx_db_check_oracle_colum_type(const char *table_name, const char *column_na
 #endif
 int		zbx_db_execute(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 int		zbx_db_execute_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
+#if defined(HAVE_POSTGRESQL)
+int		zbx_db_execute_prepared(const char *sql, int params_num, const char * const *params);
+#endif
 zbx_db_result_t	zbx_db_select_once(const char *fmt, ...)__zbx_attr_format_printf(1, 2);
 zbx_db_result_t	zbx_db_select(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 zbx_db_result_t	zbx_db_select_n(const char *query, int n);
@@ -715,6 +718,16 @@ void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
 zbx_uint64_t	zbx_db_insert_get_lastid(zbx_db_insert_t *self);
 
+#if defined(HAVE_POSTGRESQL)
+/* array literals for statements with array parameters */
+void		zbx_db_array_add_str(char **array, size_t *array_alloc, size_t *array_offset, const char *value);
+void		zbx_db_array_add_uint64(char **array, size_t *array_alloc, size_t *array_offset, zbx_uint64_t value);
+void		zbx_db_array_add_int(char **array, size_t *array_alloc, size_t *array_offset, int value);
+void		zbx_db_array_add_dbl(char **array, size_t *array_alloc, size_t *array_offset, double value);
+void		zbx_db_array_add_null(char **array, size_t *array_alloc, size_t *array_offset);
+void		zbx_db_array_close(char **array, size_t *array_alloc, size_t *array_offset);
+#endif
+
 int	zbx_db_get_database_type(void);
 
 typedef struct
@@ -793,6 +806,9 @@ zbx_proxy_diff_t;
 
 int	zbx_db_lock_maintenanceids(zbx_vector_uint64_t *maintenanceids);
 
+#if defined(HAVE_POSTGRESQL)
+int	zbx_db_save_item_changes_prepared(const zbx_vector_item_diff_ptr_t *item_diff, zbx_uint64_t mask);
+#endif
 void	zbx_db_save_item_changes(char **sql, size_t *sql_alloc, size_t *sql_offset,
 		const zbx_vector_item_diff_ptr_t *item_diff, zbx_uint64_t mask);
 
@@ -81,6 +81,9 @@ int	zbx_check_protocol_version(zbx_dc_proxy_t *proxy, int version);
 
 int	zbx_db_copy_template_elements(zbx_uint64_t hostid, zbx_vector_uint64_t *lnk_templateids,
 		zbx_host_template_link_type link_type, int audit_context_mode, char **error);
+int	zbx_db_copy_template_elements_hosts(const zbx_vector_uint64_t *hostids,
+		const zbx_vector_uint64_t *lnk_templateids, zbx_host_template_link_type link_type,
+		int audit_context_mode, zbx_vector_str_t *errors);
 int	zbx_db_delete_template_elements(zbx_uint64_t hostid, const char *hostname, zbx_vector_uint64_t *del_templateids,
 		int audit_context_mode, char **error);
 
@@ -43,6 +43,16 @@ zbx_eventdata_t;
 
 ZBX_VECTOR_DECL(eventdata, zbx_eventdata_t)
 
+/* problem event, used to cache open problems for recovery attempts */
+typedef struct
+{
+	zbx_uint64_t		eventid;
+	zbx_uint64_t		triggerid;
+
+	zbx_vector_tags_ptr_t	tags;
+}
+zbx_event_problem_t;
+
 void	zbx_eventdata_free(zbx_eventdata_t *eventdata);
 int	zbx_eventdata_compare(const zbx_eventdata_t *d1, const zbx_eventdata_t *d2);
 void	zbx_eventdata_to_str(const zbx_vector_eventdata_t *eventdata, char **replace_to);
@@ -70,4 +80,14 @@ void	zbx_event_db_get_history(const zbx_db_event *event, char **replace_to,
 
 int	zbx_problem_get_actions(const zbx_db_acknowledge *ack, int actions, const char *tz, char **out);
 
+int	zbx_problem_cache_init(zbx_uint64_t cache_size, char **error);
+void	zbx_problem_cache_destroy(void);
+zbx_uint64_t	zbx_problem_cache_get(const zbx_vector_uint64_t *triggerids, zbx_vector_ptr_t *problems,
+		zbx_vector_uint64_t *triggerids_miss);
+void	zbx_problem_cache_set(const zbx_vector_uint64_t *triggerids, const zbx_vector_ptr_t *problems,
+		zbx_uint64_t revision);
+void	zbx_problem_cache_update(const zbx_vector_db_event_t *problem_events, const zbx_vector_uint64_t *r_eventids);
+void	zbx_problem_cache_invalidate_triggers(const zbx_vector_uint64_t *triggerids);
+void	zbx_problem_cache_invalidate_events(const zbx_vector_uint64_t *eventids);
+
 #endif
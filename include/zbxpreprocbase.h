@@ -103,4 +103,35 @@ zbx_pp_item_t;
 
 void	zbx_pp_item_clear(zbx_pp_item_t *item);
 
+int	zbx_item_preproc_convert_value(zbx_variant_t *value, unsigned char type, char **errmsg);
+int	zbx_item_preproc_convert_value_to_numeric(zbx_variant_t *value_num, const zbx_variant_t *value,
+		unsigned char value_type, char **errmsg);
+int	zbx_item_preproc_multiplier_variant(unsigned char value_type, zbx_variant_t *value, const char *params,
+		char **errmsg);
+int	zbx_item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg);
+int	zbx_item_preproc_throttle_value(zbx_variant_t *value, const zbx_timespec_t *ts,
+		zbx_variant_t *history_value, zbx_timespec_t *history_ts);
+int	zbx_item_preproc_throttle_timed_value(zbx_variant_t *value, const zbx_timespec_t *ts, const char *params,
+		zbx_variant_t *history_value, zbx_timespec_t *history_ts, char **errmsg);
+
+/* preprocessing steps pushed down to agent to discard values that would be throttled by server */
+typedef struct
+{
+	unsigned char			value_type;
+	zbx_vector_pp_step_ptr_t	steps;
+
+	/* throttling history */
+	zbx_variant_t			history_value;
+	zbx_timespec_t			history_ts;
+}
+zbx_pp_pushdown_t;
+
+void	zbx_pp_pushdown_select(zbx_vector_pp_step_ptr_t *steps);
+zbx_pp_pushdown_t	*zbx_pp_pushdown_create(unsigned char value_type, zbx_vector_pp_step_ptr_t *steps);
+void	zbx_pp_pushdown_free(zbx_pp_pushdown_t *pushdown);
+int	zbx_pp_pushdown_compare(const zbx_pp_pushdown_t *pushdown, unsigned char value_type,
+		const zbx_vector_pp_step_ptr_t *steps);
+void	zbx_pp_pushdown_reset(zbx_pp_pushdown_t *pushdown);
+int	zbx_pp_pushdown_execute(zbx_pp_pushdown_t *pushdown, const char *value, const zbx_timespec_t *ts);
+
 #endif
@@ -15,16 +15,43 @@
 #ifndef ZABBIX_PROF_H
 #define ZABBIX_PROF_H
 
+#include "zbxtypes.h"
+
 #define ZBX_PROF_UNKNOWN	0x00
 #define ZBX_PROF_PROCESSING	0x01
 #define ZBX_PROF_RWLOCK		0x02
 #define ZBX_PROF_MUTEX		0x04
-#define ZBX_PROF_ALL		0xff
+#define ZBX_PROF_ALL		(ZBX_PROF_PROCESSING | ZBX_PROF_RWLOCK | ZBX_PROF_MUTEX)
+
+/* sampling arms a CPU time timer, so it is not part of ZBX_PROF_ALL and is enabled and disabled separately */
+#define ZBX_PROF_SAMPLING	0x08
+
+/* CPU time interval between samples in sampling mode, in microseconds */
+#define ZBX_PROF_SAMPLING_INTERVAL	10000
+
+/* name used for samples taken outside of profiled functions */
+#define ZBX_PROF_OTHER		"other"
 
 typedef int zbx_prof_scope_t;
 
+typedef struct
+{
+	const char		*func_name;
+	zbx_prof_scope_t	scope;
+	zbx_uint64_t		samples;
+	zbx_uint64_t		locked;
+	double			sec_wait;
+}
+zbx_prof_stat_t;
+
+/* callback function to store sampled profiling statistics of the calling process */
+typedef void (*zbx_prof_flush_func_t)(const char *info, const zbx_prof_stat_t *stats, int stats_num);
+
+void	zbx_prof_init(zbx_prof_flush_func_t flush_cb);
+const char	*zbx_prof_scope_string(zbx_prof_scope_t scope);
+
 void	zbx_prof_enable(zbx_prof_scope_t scope);
-void	zbx_prof_disable(void);
+void	zbx_prof_disable(zbx_prof_scope_t scope);
 void	zbx_prof_start(const char *func_name, zbx_prof_scope_t scope);
 void	zbx_prof_end_wait(void);
 void	zbx_prof_end(void);
@@ -25,6 +25,8 @@
 #ifndef _WINDOWS
 #include "zbxthreads.h"
 #include "zbxstats.h"
+#include "zbxprof.h"
+#include "zbxcomms.h"
 
 ZBX_THREAD_ENTRY(zbx_selfmon_thread, args);
 
@@ -34,6 +36,12 @@ void	zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char sta
 void	zbx_get_selfmon_stats(unsigned char proc_type, unsigned char aggr_func, int proc_num, unsigned char state,
 		double *value);
 int	zbx_get_all_process_stats(zbx_process_info_t *stats);
+void	zbx_selfmon_prof_flush(const char *info, const zbx_prof_stat_t *stats, int stats_num);
+void	zbx_selfmon_get_prof_stats(unsigned char proc_type, zbx_prof_stat_t **stats, int *stats_num);
+void	zbx_selfmon_compress_update(int direction, size_t bytes, size_t bytes_compressed, double time);
+void	zbx_selfmon_get_compress_stats(int direction, zbx_compress_stats_t *stats);
+void	zbx_selfmon_tls_update(int counter);
+void	zbx_selfmon_get_tls_stats(zbx_uint64_t *stats);
 void	zbx_sleep_loop(const zbx_thread_info_t *info, int sleeptime);
 #endif
 
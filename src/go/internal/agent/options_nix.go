@@ -37,6 +37,7 @@ type AgentOptions struct {
 	EnablePersistentBuffer   int      `conf:"optional,range=0:1,default=0"`
 	PersistentBufferPeriod   int      `conf:"optional,range=60:31536000,default=3600"`
 	PersistentBufferFile     string   `conf:"optional"`
+	PersistentBufferType     string   `conf:"optional,default=sqlite"`
 	ListenIP                 string   `conf:"optional"`
 	ListenPort               int      `conf:"optional,range=1024:32767,default=10050"`
 	StatusPort               int      `conf:"optional,range=1024:32767"`
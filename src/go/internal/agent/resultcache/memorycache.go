@@ -22,7 +22,6 @@ import (
 
 	"golang.zabbix.com/agent2/internal/agent"
 	"golang.zabbix.com/agent2/internal/monitor"
-	"golang.zabbix.com/agent2/pkg/itemutil"
 	"golang.zabbix.com/agent2/pkg/version"
 	"golang.zabbix.com/sdk/log"
 	"golang.zabbix.com/sdk/plugin"
@@ -182,38 +181,7 @@ func (c *MemoryCache) insertResult(result *AgentData) {
 
 func (c *MemoryCache) write(r *plugin.Result) {
 	c.lastDataID++
-	var value *string
-	var state *int
-	if r.Error == nil {
-		value = r.Value
-	} else {
-		errmsg := r.Error.Error()
-		value = &errmsg
-		tmp := itemutil.StateNotSupported
-		state = &tmp
-	}
-
-	var clock, ns int
-	if !r.Ts.IsZero() {
-		clock = int(r.Ts.Unix())
-		ns = r.Ts.Nanosecond()
-	}
-
-	data := &AgentData{
-		Id:             c.lastDataID,
-		Itemid:         r.Itemid,
-		LastLogsize:    r.LastLogsize,
-		Mtime:          r.Mtime,
-		Clock:          clock,
-		Ns:             ns,
-		Value:          value,
-		State:          state,
-		EventSource:    r.EventSource,
-		EventID:        r.EventID,
-		EventSeverity:  r.EventSeverity,
-		EventTimestamp: r.EventTimestamp,
-		persistent:     r.Persistent,
-	}
+	data := newAgentData(c.lastDataID, r)
 
 	if c.totalValueNum >= c.maxBufferSize {
 		c.insertResult(data)
@@ -223,28 +191,11 @@ func (c *MemoryCache) write(r *plugin.Result) {
 }
 
 func (c *MemoryCache) writeCommand(cr *CommandResult) {
-	var value *string
-	var err *string
-
 	log.Debugf("cache command(%d) result:%s error:%s", cr.ID, cr.Result, cr.Error)
 
 	c.lastCommandID++
 
-	if cr.Result != "" {
-		value = &cr.Result
-	}
-
-	if cr.Error != nil {
-		err_msg := cr.Error.Error()
-		err = &err_msg
-	}
-
-	cmd := &AgentCommands{
-		Id:    cr.ID,
-		Value: value,
-		Error: err}
-
-	c.addCommandResult(cmd)
+	c.addCommandResult(newAgentCommands(cr))
 }
 
 func (c *MemoryCache) run() {
@@ -42,6 +42,7 @@ import (
 	"time"
 
 	"golang.zabbix.com/agent2/internal/agent"
+	"golang.zabbix.com/agent2/pkg/itemutil"
 	"golang.zabbix.com/sdk/log"
 	"golang.zabbix.com/sdk/plugin"
 )
@@ -173,6 +174,62 @@ func (c *cacheData) isUploadEnabled() bool {
 	return c.historyUpload
 }
 
+// newAgentData converts plugin result to the cached data with the specified id
+func newAgentData(id uint64, r *plugin.Result) *AgentData {
+	var value *string
+	var state *int
+	if r.Error == nil {
+		value = r.Value
+	} else {
+		errmsg := r.Error.Error()
+		value = &errmsg
+		tmp := itemutil.StateNotSupported
+		state = &tmp
+	}
+
+	var clock, ns int
+	if !r.Ts.IsZero() {
+		clock = int(r.Ts.Unix())
+		ns = r.Ts.Nanosecond()
+	}
+
+	return &AgentData{
+		Id:             id,
+		Itemid:         r.Itemid,
+		LastLogsize:    r.LastLogsize,
+		Mtime:          r.Mtime,
+		Clock:          clock,
+		Ns:             ns,
+		Value:          value,
+		State:          state,
+		EventSource:    r.EventSource,
+		EventID:        r.EventID,
+		EventSeverity:  r.EventSeverity,
+		EventTimestamp: r.EventTimestamp,
+		persistent:     r.Persistent,
+	}
+}
+
+// newAgentCommands converts remote command result to the cached command result
+func newAgentCommands(cr *CommandResult) *AgentCommands {
+	var value *string
+	var err *string
+
+	if cr.Result != "" {
+		value = &cr.Result
+	}
+
+	if cr.Error != nil {
+		errMsg := cr.Error.Error()
+		err = &errMsg
+	}
+
+	return &AgentCommands{
+		Id:    cr.ID,
+		Value: value,
+		Error: err}
+}
+
 func tableName(prefix string, index int) string {
 	return fmt.Sprintf("%s_%d", prefix, index)
 }
@@ -205,6 +262,14 @@ func New(options *agent.AgentOptions, clientid uint64, output Uploader) ResultCa
 		}
 		c.init(options)
 
+		return c
+	} else if options.PersistentBufferType == PersistentBufferSegment {
+		c := &SegmentCache{
+			cacheData:     data,
+			historyUpload: true,
+		}
+		c.init(options)
+
 		return c
 	} else {
 		c := &DiskCache{
@@ -408,6 +473,14 @@ func Prepare(options *agent.AgentOptions, addresses [][]string, hostnames []stri
 		return
 	}
 
+	switch options.PersistentBufferType {
+	case PersistentBufferSQLite:
+	case PersistentBufferSegment:
+		return prepareSegmentCache(options, addresses, hostnames)
+	default:
+		return fmt.Errorf("invalid \"PersistentBufferType\" parameter value \"%s\"", options.PersistentBufferType)
+	}
+
 	if err = prepareDiskCache(options, addresses, hostnames); err != nil {
 		if err = os.Remove(options.PersistentBufferFile); err != nil {
 			return
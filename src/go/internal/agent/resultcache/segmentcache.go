@@ -0,0 +1,509 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+package resultcache
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"reflect"
+	"strconv"
+	"sync/atomic"
+	"time"
+
+	"golang.zabbix.com/agent2/internal/agent"
+	"golang.zabbix.com/agent2/internal/monitor"
+	"golang.zabbix.com/agent2/pkg/version"
+	"golang.zabbix.com/sdk/log"
+	"golang.zabbix.com/sdk/plugin"
+)
+
+const (
+	PersistentBufferSQLite  = "sqlite"
+	PersistentBufferSegment = "segment"
+
+	// number of records written before segment logs are synced to disk
+	SegmentSyncRecords = 1000
+	// maximum time records can stay written but not synced to disk
+	SegmentSyncInterval = time.Second
+
+	segmentRegistryFile = "registry.json"
+)
+
+// SegmentCache is persistent result cache keeping results in append-only segment logs
+// (see segmentlog.go) inside PersistentBufferFile directory. Compared to DiskCache it avoids
+// per value SQL transactions - values are appended to buffered segment files which are synced
+// to disk in batches and removed as a whole when uploaded.
+type SegmentCache struct {
+	*cacheData
+	storagePeriod int64
+	data          *segmentLog
+	log           *segmentLog
+	command       *segmentLog
+	persistFlag   uint32
+	historyUpload bool
+}
+
+type segmentRegistryEntry struct {
+	ID       int    `json:"id"`
+	Address  string `json:"address"`
+	Hostname string `json:"hostname"`
+}
+
+func readSegmentRegistry(dir string) (entries []segmentRegistryEntry, err error) {
+	var data []byte
+
+	if data, err = os.ReadFile(filepath.Join(dir, segmentRegistryFile)); err != nil {
+		if os.IsNotExist(err) {
+			return nil, nil
+		}
+
+		return
+	}
+
+	if err = json.Unmarshal(data, &entries); err != nil {
+		return nil, fmt.Errorf("cannot parse %s: %w", segmentRegistryFile, err)
+	}
+
+	return
+}
+
+func segmentCacheDir(dir string, address string, hostname string) (string, error) {
+	entries, err := readSegmentRegistry(dir)
+	if err != nil {
+		return "", err
+	}
+
+	for _, e := range entries {
+		if e.Address == address && e.Hostname == hostname {
+			return filepath.Join(dir, strconv.Itoa(e.ID)), nil
+		}
+	}
+
+	return "", fmt.Errorf("address %s hostname %s is not registered in persistent buffer", address, hostname)
+}
+
+// prepareSegmentCache registers active server and hostname combinations in the persistent buffer
+// directory, removing data of combinations that are not configured anymore.
+func prepareSegmentCache(options *agent.AgentOptions, addresses [][]string, hostnames []string) (err error) {
+	dir := options.PersistentBufferFile
+
+	if err = os.MkdirAll(dir, 0700); err != nil {
+		return fmt.Errorf("Cannot create directory %s : %s.", dir, err)
+	}
+
+	var registered []segmentRegistryEntry
+	reset := false
+	if registered, err = readSegmentRegistry(dir); err != nil {
+		log.Warningf("%s, resetting persistent buffer", err)
+		reset = true
+	}
+
+	var entries []segmentRegistryEntry
+	var lastID int
+
+	for _, e := range registered {
+		if e.ID > lastID {
+			lastID = e.ID
+		}
+	}
+
+	for _, addr := range addresses {
+	hostCheck:
+		for _, host := range hostnames {
+			for _, e := range registered {
+				if e.Address == addr[0] && e.Hostname == host {
+					entries = append(entries, e)
+					continue hostCheck
+				}
+			}
+
+			lastID++
+			entries = append(entries, segmentRegistryEntry{ID: lastID, Address: addr[0], Hostname: host})
+		}
+	}
+
+	var dirEntries []os.DirEntry
+	if dirEntries, err = os.ReadDir(dir); err != nil {
+		return
+	}
+
+	active := make(map[string]bool)
+	for _, e := range entries {
+		active[strconv.Itoa(e.ID)] = true
+	}
+
+	for _, d := range dirEntries {
+		if _, convErr := strconv.Atoi(d.Name()); convErr != nil || !d.IsDir() || (!reset && active[d.Name()]) {
+			continue
+		}
+
+		if err = os.RemoveAll(filepath.Join(dir, d.Name())); err != nil {
+			return
+		}
+	}
+
+	for _, e := range entries {
+		path := filepath.Join(dir, strconv.Itoa(e.ID))
+		if err = os.MkdirAll(path, 0700); err != nil {
+			return
+		}
+
+		/* delete gathered logs - they will be rescanned using the lastlogsize received from server */
+		var files []string
+		if files, err = filepath.Glob(filepath.Join(path, "log[_.]*")); err != nil {
+			return
+		}
+
+		for _, f := range files {
+			if err = os.Remove(f); err != nil {
+				return
+			}
+		}
+
+		// validate remaining segments, truncating incomplete records
+		for _, name := range []string{"data", "command"} {
+			var l *segmentLog
+
+			if l, err = openSegmentLog(path, name, segmentMaxSize); err != nil {
+				return
+			}
+
+			if err = l.close(); err != nil {
+				return
+			}
+		}
+	}
+
+	var data []byte
+	if data, err = json.Marshal(entries); err != nil {
+		return
+	}
+
+	return os.WriteFile(filepath.Join(dir, segmentRegistryFile), data, 0600)
+}
+
+func (c *SegmentCache) sync() {
+	for _, l := range []*segmentLog{c.data, c.log, c.command} {
+		if err := l.sync(); err != nil {
+			c.Errf("cannot sync persistent buffer %s: %s", l.name, err)
+			panic(err)
+		}
+	}
+}
+
+// resultsGet returns the oldest data and log results ordered by id. The last data and log records
+// are returned to acknowledge them after successful upload.
+func (c *SegmentCache) resultsGet() (results []*AgentData, lastData *segmentRecord, lastLog *segmentRecord,
+	err error) {
+
+	var dataRecords, logRecords []*segmentRecord
+
+	if dataRecords, err = c.data.read(DataLimit); err != nil {
+		return
+	}
+
+	if logRecords, err = c.log.read(DataLimit); err != nil {
+		return
+	}
+
+	for len(results) < DataLimit && (len(dataRecords) != 0 || len(logRecords) != 0) {
+		var rec *segmentRecord
+
+		if len(logRecords) == 0 || (len(dataRecords) != 0 && dataRecords[0].id < logRecords[0].id) {
+			rec, lastData = dataRecords[0], dataRecords[0]
+			dataRecords = dataRecords[1:]
+		} else {
+			rec, lastLog = logRecords[0], logRecords[0]
+			logRecords = logRecords[1:]
+		}
+
+		var result AgentData
+		if err = json.Unmarshal(rec.payload, &result); err != nil {
+			return nil, nil, nil, fmt.Errorf("cannot parse cached value: %w", err)
+		}
+		results = append(results, &result)
+	}
+
+	return
+}
+
+func (c *SegmentCache) commandResultsGet() (results []*AgentCommands, lastCommand *segmentRecord, err error) {
+	var records []*segmentRecord
+
+	if records, err = c.command.read(DataLimit); err != nil {
+		return
+	}
+
+	for _, rec := range records {
+		var result AgentCommands
+		if err = json.Unmarshal(rec.payload, &result); err != nil {
+			return nil, nil, fmt.Errorf("cannot parse cached command result: %w", err)
+		}
+		results = append(results, &result)
+		lastCommand = rec
+	}
+
+	return
+}
+
+func (c *SegmentCache) upload(u Uploader) (err error) {
+	var results []*AgentData
+	var cresults []*AgentCommands
+	var lastData, lastLog, lastCommand *segmentRecord
+	var errs []error
+
+	defer func() {
+		if nil == err || errs != nil { // report errors not related to Write
+			return
+		}
+
+		errs = append(errs, err)
+		if !reflect.DeepEqual(errs, c.lastErrors) {
+			c.Warningf("cannot upload history data: %s", err)
+			c.lastErrors = errs
+		}
+	}()
+
+	if results, lastData, lastLog, err = c.resultsGet(); err != nil {
+		return
+	}
+
+	if cresults, lastCommand, err = c.commandResultsGet(); err != nil {
+		return
+	}
+
+	reqLen := len(results) + len(cresults)
+
+	if reqLen == 0 {
+		return
+	}
+
+	request := AgentDataRequest{
+		Request:  "agent data",
+		Data:     results,
+		Commands: cresults,
+		Session:  u.Session(),
+		Host:     u.Hostname(),
+		Version:  version.Long(),
+		Variant:  agent.Variant,
+	}
+
+	var data []byte
+
+	if data, err = json.Marshal(&request); err != nil {
+		c.Errf("cannot convert cached history to json: %s", err.Error())
+
+		return
+	}
+
+	timeout := reqLen * c.timeout
+	if timeout > 60 {
+		timeout = 60
+	}
+	var upload bool
+
+	if upload, errs = u.Write(data, time.Duration(timeout)*time.Second); errs != nil {
+		if !reflect.DeepEqual(errs, c.lastErrors) {
+			for i := 0; i < len(errs); i++ {
+				c.Warningf("%s", errs[i])
+			}
+			c.Warningf("history upload to [%s] [%s] started to fail", u.Addr(), u.Hostname())
+			c.lastErrors = errs
+		}
+		err = errors.New("history upload failed")
+
+		return
+	}
+
+	c.EnableUpload(upload)
+
+	if c.lastErrors != nil {
+		c.Warningf("history upload to [%s] [%s] is working again", u.Addr(), u.Hostname())
+		c.lastErrors = nil
+	}
+
+	if lastData != nil {
+		if err = c.data.ack(lastData); err != nil {
+			return fmt.Errorf("cannot remove uploaded data: %w", err)
+		}
+	}
+	if lastLog != nil {
+		if err = c.log.ack(lastLog); err != nil {
+			return fmt.Errorf("cannot remove uploaded log data: %w", err)
+		}
+		if oldest := c.log.oldestClock(); oldest == 0 || time.Now().Unix()-oldest < c.storagePeriod {
+			atomic.StoreUint32(&c.persistFlag, 0)
+		}
+	}
+	if lastCommand != nil {
+		if err = c.command.ack(lastCommand); err != nil {
+			return fmt.Errorf("cannot remove uploaded command results: %w", err)
+		}
+	}
+
+	c.sync()
+
+	return
+}
+
+func (c *SegmentCache) flushOutput(u Uploader) {
+	if c.retry != nil {
+		c.retry.Stop()
+		c.retry = nil
+	}
+
+	if err := c.upload(u); err != nil && u.CanRetry() {
+		c.retry = time.AfterFunc(UploadRetryInterval, func() { c.Upload(u) })
+	}
+}
+
+func (c *SegmentCache) append(l *segmentLog, id uint64, clock int64, v interface{}) {
+	payload, err := json.Marshal(v)
+	if err == nil {
+		if err = l.append(id, clock, payload); err == nil && l.unsynced >= SegmentSyncRecords {
+			err = l.sync()
+		}
+	}
+
+	if err != nil {
+		c.Errf("cannot write to persistent buffer %s: %s", l.name, err)
+		panic(err)
+	}
+}
+
+func (c *SegmentCache) write(r *plugin.Result) {
+	c.lastDataID++
+
+	now := time.Now().Unix()
+
+	if r.Persistent {
+		if oldest := c.log.oldestClock(); oldest != 0 && now-oldest > c.storagePeriod {
+			atomic.StoreUint32(&c.persistFlag, 1)
+		}
+		c.append(c.log, c.lastDataID, now, newAgentData(c.lastDataID, r))
+
+		return
+	}
+
+	if oldest := c.data.oldestClock(); oldest != 0 && now-oldest > c.storagePeriod+StorageTolerance {
+		if err := c.data.expire(now - c.storagePeriod); err != nil {
+			c.Errf("cannot delete old data from persistent buffer: %s", err)
+		}
+	}
+	c.append(c.data, c.lastDataID, now, newAgentData(c.lastDataID, r))
+}
+
+func (c *SegmentCache) writeCommand(cr *CommandResult) {
+	log.Debugf("cache command(%d) result:%s error:%s", cr.ID, cr.Result, cr.Error)
+	c.lastCommandID++
+
+	now := time.Now().Unix()
+
+	if oldest := c.command.oldestClock(); oldest != 0 && now-oldest > c.storagePeriod+StorageTolerance {
+		if err := c.command.expire(now - c.storagePeriod); err != nil {
+			c.Errf("cannot delete old commands from persistent buffer: %s", err)
+		}
+	}
+
+	c.append(c.command, c.lastCommandID, now, newAgentCommands(cr))
+}
+
+func (c *SegmentCache) run() {
+	defer log.PanicHook()
+	c.Debugf("starting segment cache")
+
+	ticker := time.NewTicker(SegmentSyncInterval)
+	defer ticker.Stop()
+
+loop:
+	for {
+		select {
+		case u := <-c.input:
+			if u == nil {
+				break loop
+			}
+			switch v := u.(type) {
+			case Uploader:
+				c.flushOutput(v)
+			case *plugin.Result:
+				c.write(v)
+			case *CommandResult:
+				c.writeCommand(v)
+			case *agent.AgentOptions:
+				c.updateOptions(v)
+			}
+		case <-ticker.C:
+			c.sync()
+		}
+	}
+	c.Debugf("segment cache has been stopped")
+
+	for _, l := range []*segmentLog{c.data, c.log, c.command} {
+		if err := l.close(); err != nil {
+			c.Errf("cannot close persistent buffer %s: %s", l.name, err)
+		}
+	}
+	monitor.Unregister(monitor.Output)
+}
+
+func (c *SegmentCache) updateOptions(options *agent.AgentOptions) {
+	c.storagePeriod = int64(options.PersistentBufferPeriod)
+	c.timeout = options.Timeout
+}
+
+func (c *SegmentCache) init(options *agent.AgentOptions) {
+	c.updateOptions(options)
+
+	dir, err := segmentCacheDir(options.PersistentBufferFile, c.uploader.Addr(), c.uploader.Hostname())
+	if err == nil {
+		if c.data, err = openSegmentLog(dir, "data", segmentMaxSize); err == nil {
+			if c.log, err = openSegmentLog(dir, "log", segmentMaxSize); err == nil {
+				c.command, err = openSegmentLog(dir, "command", segmentMaxSize)
+			}
+		}
+	}
+
+	if err != nil {
+		c.Errf("cannot open persistent buffer: %s", err)
+		panic(err)
+	}
+
+	c.lastDataID = c.data.lastID()
+	if id := c.log.lastID(); id > c.lastDataID {
+		c.lastDataID = id
+	}
+	c.lastCommandID = c.command.lastID()
+}
+
+func (c *SegmentCache) Start() {
+	// register with secondary group to stop result cache after other components are stopped
+	monitor.Register(monitor.Output)
+	go c.run()
+}
+
+func (c *SegmentCache) SlotsAvailable() int {
+	return int(^uint(0) >> 1) //Max int
+}
+
+func (c *SegmentCache) PersistSlotsAvailable() int {
+	if atomic.LoadUint32(&c.persistFlag) == 1 {
+		return 0
+	}
+
+	return int(^uint(0) >> 1) //Max int
+}
@@ -0,0 +1,191 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+package resultcache
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"golang.zabbix.com/agent2/internal/agent"
+	"golang.zabbix.com/sdk/log"
+	"golang.zabbix.com/sdk/plugin"
+)
+
+func appendRecords(t *testing.T, l *segmentLog, from uint64, to uint64) {
+	for id := from; id <= to; id++ {
+		if err := l.append(id, int64(id), []byte(fmt.Sprintf("value %d", id))); err != nil {
+			t.Fatalf("cannot append record %d: %s", id, err)
+		}
+	}
+}
+
+func checkRecords(t *testing.T, l *segmentLog, limit int, from uint64, to uint64) []*segmentRecord {
+	records, err := l.read(limit)
+	if err != nil {
+		t.Fatalf("cannot read records: %s", err)
+	}
+
+	if uint64(len(records)) != to-from+1 {
+		t.Fatalf("expected %d records while got %d", to-from+1, len(records))
+	}
+
+	for i, r := range records {
+		id := from + uint64(i)
+		if r.id != id || string(r.payload) != fmt.Sprintf("value %d", id) {
+			t.Fatalf("expected record %d while got %d:%s", id, r.id, string(r.payload))
+		}
+	}
+
+	return records
+}
+
+func TestSegmentLog(t *testing.T) {
+	dir := t.TempDir()
+
+	// small segment size to test segment rotation and removal
+	l, err := openSegmentLog(dir, "data", 100)
+	if err != nil {
+		t.Fatalf("cannot open segment log: %s", err)
+	}
+
+	appendRecords(t, l, 1, 20)
+	records := checkRecords(t, l, 10, 1, 10)
+
+	if err = l.ack(records[len(records)-1]); err != nil {
+		t.Fatalf("cannot acknowledge records: %s", err)
+	}
+	checkRecords(t, l, 100, 11, 20)
+
+	if err = l.close(); err != nil {
+		t.Fatalf("cannot close segment log: %s", err)
+	}
+
+	// simulate crash during write by appending incomplete record to the last segment
+	last := l.segments[len(l.segments)-1].path
+	f, err := os.OpenFile(last, os.O_WRONLY|os.O_APPEND, 0)
+	if err != nil {
+		t.Fatalf("cannot open segment: %s", err)
+	}
+	_, _ = f.Write([]byte{10, 0, 0, 0, 1, 2})
+	f.Close()
+
+	if l, err = openSegmentLog(dir, "data", 100); err != nil {
+		t.Fatalf("cannot reopen segment log: %s", err)
+	}
+
+	if l.lastID() != 20 {
+		t.Fatalf("expected last id 20 while got %d", l.lastID())
+	}
+
+	records = checkRecords(t, l, 100, 11, 20)
+	appendRecords(t, l, 21, 25)
+
+	if err = l.ack(records[len(records)-1]); err != nil {
+		t.Fatalf("cannot acknowledge records: %s", err)
+	}
+	records = checkRecords(t, l, 100, 21, 25)
+
+	if err = l.ack(records[len(records)-1]); err != nil {
+		t.Fatalf("cannot acknowledge records: %s", err)
+	}
+
+	if !l.empty() {
+		t.Fatalf("expected empty segment log")
+	}
+
+	appendRecords(t, l, 26, 26)
+	checkRecords(t, l, 100, 26, 26)
+
+	if err = l.close(); err != nil {
+		t.Fatalf("cannot close segment log: %s", err)
+	}
+
+	files, _ := filepath.Glob(filepath.Join(dir, "data_*"+segmentSuffix))
+	if len(files) != 1 {
+		t.Fatalf("expected single segment file while got %d", len(files))
+	}
+}
+
+type benchUploader struct {
+	values int
+}
+
+func (u *benchUploader) Write(data []byte, timeout time.Duration) (upload bool, err []error) {
+	u.values++
+	return true, nil
+}
+
+func (u *benchUploader) Addr() string {
+	return ""
+}
+
+func (u *benchUploader) CanRetry() bool {
+	return false
+}
+
+func (u *benchUploader) Hostname() string {
+	return ""
+}
+
+func (u *benchUploader) Session() string {
+	return ""
+}
+
+type benchCache interface {
+	write(r *plugin.Result)
+	flushOutput(u Uploader)
+}
+
+// benchmarkPersistentBuffer writes values to persistent buffer uploading them every 1000 values,
+// which corresponds to 10k values/s rate with the default upload interval
+func benchmarkPersistentBuffer(b *testing.B, bufferType string, file string) {
+	_ = log.Open(log.Console, log.Info, "", 0)
+
+	agent.Options.EnablePersistentBuffer = 1
+	agent.Options.PersistentBufferFile = filepath.Join(b.TempDir(), file)
+	agent.Options.PersistentBufferType = bufferType
+	agent.Options.PersistentBufferPeriod = 3600
+
+	if err := Prepare(&agent.Options, [][]string{{""}}, []string{""}); err != nil {
+		b.Fatalf("cannot prepare persistent buffer: %s", err)
+	}
+
+	u := &benchUploader{}
+	cache := New(&agent.Options, 0, u).(benchCache)
+
+	value := "0123456789abcdef"
+	result := plugin.Result{Itemid: 1, Value: &value, Ts: time.Now()}
+
+	b.ResetTimer()
+
+	for i := 1; i <= b.N; i++ {
+		cache.write(&result)
+		if i%1000 == 0 {
+			cache.flushOutput(u)
+		}
+	}
+	cache.flushOutput(u)
+}
+
+func BenchmarkPersistentBufferSQLite(b *testing.B) {
+	benchmarkPersistentBuffer(b, PersistentBufferSQLite, "buffer.db")
+}
+
+func BenchmarkPersistentBufferSegment(b *testing.B) {
+	benchmarkPersistentBuffer(b, PersistentBufferSegment, "buffer")
+}
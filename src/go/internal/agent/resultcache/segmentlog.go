@@ -0,0 +1,488 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+package resultcache
+
+import (
+	"bufio"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+)
+
+// Segment log is an append-only record log split into segment files. Every record is stored as
+// a fixed size header followed by the payload:
+//
+//	length  uint32 - payload length
+//	crc     uint32 - CRC32 (IEEE) checksum of id, write clock and payload
+//	id      uint64 - record identifier, ascending within log
+//	clock   int64  - record write clock
+//
+// Records are removed by deleting whole segments once all their records are acknowledged. The id
+// of the last acknowledged record is kept in a separate file, so that partially acknowledged
+// segment can be resumed after restart.
+
+const (
+	segmentHeaderSize   = 24
+	segmentMaxSize      = 16 * 1024 * 1024
+	segmentMaxRecordLen = 256 * 1024 * 1024
+	segmentSuffix       = ".seg"
+	segmentAckSuffix    = ".ack"
+)
+
+type segment struct {
+	path        string
+	firstID     uint64
+	lastID      uint64
+	oldestClock int64
+	newestClock int64
+	size        int64
+}
+
+// segmentPos is the position right after a record, used to acknowledge records up to it
+type segmentPos struct {
+	seg    *segment
+	offset int64
+}
+
+type segmentRecord struct {
+	id      uint64
+	clock   int64
+	payload []byte
+	end     segmentPos
+}
+
+type segmentLog struct {
+	dir         string
+	name        string
+	maxSize     int64
+	segments    []*segment
+	file        *os.File
+	writer      *bufio.Writer
+	headOffset  int64
+	ackID       uint64
+	ackModified bool
+	unsynced    int
+	header      [segmentHeaderSize]byte
+}
+
+func (l *segmentLog) segmentPath(id uint64) string {
+	return filepath.Join(l.dir, fmt.Sprintf("%s_%016x%s", l.name, id, segmentSuffix))
+}
+
+func (l *segmentLog) ackPath() string {
+	return filepath.Join(l.dir, l.name+segmentAckSuffix)
+}
+
+func segmentChecksum(header []byte, payload []byte) uint32 {
+	crc := crc32.ChecksumIEEE(header[8:segmentHeaderSize])
+
+	return crc32.Update(crc, crc32.IEEETable, payload)
+}
+
+// readSegmentRecord reads the next record from segment. The payload buffer is reused if it is
+// large enough. io.EOF is returned at the end of segment and io.ErrUnexpectedEOF if the last
+// record is incomplete or corrupted.
+func readSegmentRecord(r io.Reader, buf []byte) (id uint64, clock int64, payload []byte, err error) {
+	var header [segmentHeaderSize]byte
+
+	if _, err = io.ReadFull(r, header[:]); err != nil {
+		return
+	}
+
+	n := binary.LittleEndian.Uint32(header[0:])
+	if n > segmentMaxRecordLen {
+		return 0, 0, nil, io.ErrUnexpectedEOF
+	}
+
+	if uint32(cap(buf)) < n {
+		buf = make([]byte, n)
+	}
+	payload = buf[:n]
+
+	if _, err = io.ReadFull(r, payload); err != nil {
+		if err == io.EOF {
+			err = io.ErrUnexpectedEOF
+		}
+
+		return
+	}
+
+	if binary.LittleEndian.Uint32(header[4:]) != segmentChecksum(header[:], payload) {
+		return 0, 0, nil, io.ErrUnexpectedEOF
+	}
+
+	id = binary.LittleEndian.Uint64(header[8:])
+	clock = int64(binary.LittleEndian.Uint64(header[16:]))
+
+	return
+}
+
+// scan reads segment file contents to restore its record range. Incomplete or corrupted records at
+// the end of segment (left by a crash during write) are truncated.
+func (s *segment) scan() (err error) {
+	var f *os.File
+
+	if f, err = os.OpenFile(s.path, os.O_RDWR, 0); err != nil {
+		return
+	}
+	defer f.Close()
+
+	var buf []byte
+	r := bufio.NewReader(f)
+	s.size = 0
+
+	for {
+		var id uint64
+		var clock int64
+
+		if id, clock, buf, err = readSegmentRecord(r, buf); err != nil {
+			break
+		}
+
+		if s.firstID == 0 {
+			s.firstID = id
+			s.oldestClock = clock
+		}
+		s.lastID = id
+		s.newestClock = clock
+		s.size += segmentHeaderSize + int64(len(buf))
+	}
+
+	if err == io.EOF {
+		return nil
+	}
+
+	if err == io.ErrUnexpectedEOF {
+		return f.Truncate(s.size)
+	}
+
+	return
+}
+
+func openSegmentLog(dir string, name string, maxSize int64) (l *segmentLog, err error) {
+	l = &segmentLog{dir: dir, name: name, maxSize: maxSize}
+
+	var entries []os.DirEntry
+	if entries, err = os.ReadDir(dir); err != nil {
+		return nil, err
+	}
+
+	for _, e := range entries {
+		if e.IsDir() || !strings.HasPrefix(e.Name(), name+"_") || !strings.HasSuffix(e.Name(), segmentSuffix) {
+			continue
+		}
+
+		s := &segment{path: filepath.Join(dir, e.Name())}
+		if err = s.scan(); err != nil {
+			return nil, fmt.Errorf("cannot read segment %s: %w", s.path, err)
+		}
+
+		if s.size == 0 {
+			_ = os.Remove(s.path)
+			continue
+		}
+		l.segments = append(l.segments, s)
+	}
+
+	sort.Slice(l.segments, func(i, j int) bool { return l.segments[i].firstID < l.segments[j].firstID })
+
+	if data, err := os.ReadFile(l.ackPath()); err == nil && len(data) == 8 {
+		l.ackID = binary.LittleEndian.Uint64(data)
+	}
+
+	if err = l.skipAcknowledged(); err != nil {
+		return nil, err
+	}
+
+	return l, nil
+}
+
+// skipAcknowledged removes segments and moves the log head past records acknowledged before restart
+func (l *segmentLog) skipAcknowledged() (err error) {
+	for len(l.segments) != 0 && l.segments[0].lastID <= l.ackID {
+		if err = os.Remove(l.segments[0].path); err != nil {
+			return
+		}
+		l.segments = l.segments[1:]
+	}
+
+	if len(l.segments) == 0 || l.segments[0].firstID > l.ackID {
+		return
+	}
+
+	var f *os.File
+	if f, err = os.Open(l.segments[0].path); err != nil {
+		return
+	}
+	defer f.Close()
+
+	var buf []byte
+	r := bufio.NewReader(f)
+
+	for l.headOffset < l.segments[0].size {
+		var id uint64
+		var clock int64
+
+		if id, clock, buf, err = readSegmentRecord(r, buf); err != nil {
+			return
+		}
+
+		if id > l.ackID {
+			break
+		}
+		l.headOffset += segmentHeaderSize + int64(len(buf))
+		l.segments[0].oldestClock = clock
+	}
+
+	return nil
+}
+
+func (l *segmentLog) closeActive() (err error) {
+	if l.file == nil {
+		return
+	}
+
+	if err = l.writer.Flush(); err == nil {
+		err = l.file.Sync()
+	}
+
+	if cerr := l.file.Close(); err == nil {
+		err = cerr
+	}
+
+	l.file = nil
+
+	return
+}
+
+// append writes record to the active segment, starting a new segment when the active one is full.
+// The data is buffered and is guaranteed to be on disk only after sync.
+func (l *segmentLog) append(id uint64, clock int64, payload []byte) (err error) {
+	if l.file == nil || l.segments[len(l.segments)-1].size >= l.maxSize {
+		if err = l.closeActive(); err != nil {
+			return
+		}
+
+		s := &segment{path: l.segmentPath(id), firstID: id, oldestClock: clock}
+		if l.file, err = os.OpenFile(s.path, os.O_WRONLY|os.O_CREATE|os.O_TRUNC, 0600); err != nil {
+			return
+		}
+
+		if l.writer == nil {
+			l.writer = bufio.NewWriterSize(l.file, 64*1024)
+		} else {
+			l.writer.Reset(l.file)
+		}
+
+		if len(l.segments) == 0 {
+			l.headOffset = 0
+		}
+		l.segments = append(l.segments, s)
+	}
+
+	binary.LittleEndian.PutUint32(l.header[0:], uint32(len(payload)))
+	binary.LittleEndian.PutUint64(l.header[8:], id)
+	binary.LittleEndian.PutUint64(l.header[16:], uint64(clock))
+	binary.LittleEndian.PutUint32(l.header[4:], segmentChecksum(l.header[:], payload))
+
+	if _, err = l.writer.Write(l.header[:]); err != nil {
+		return
+	}
+
+	if _, err = l.writer.Write(payload); err != nil {
+		return
+	}
+
+	s := l.segments[len(l.segments)-1]
+	if len(l.segments) == 1 && s.size == l.headOffset {
+		s.oldestClock = clock
+	}
+	s.lastID = id
+	s.newestClock = clock
+	s.size += segmentHeaderSize + int64(len(payload))
+	l.unsynced++
+
+	return
+}
+
+// sync flushes buffered records and acknowledgement to disk
+func (l *segmentLog) sync() (err error) {
+	if l.file != nil && l.unsynced != 0 {
+		if err = l.writer.Flush(); err != nil {
+			return
+		}
+
+		if err = l.file.Sync(); err != nil {
+			return
+		}
+	}
+	l.unsynced = 0
+
+	if l.ackModified {
+		var data [8]byte
+
+		binary.LittleEndian.PutUint64(data[:], l.ackID)
+		if err = os.WriteFile(l.ackPath(), data[:], 0600); err != nil {
+			return
+		}
+		l.ackModified = false
+	}
+
+	return
+}
+
+// read returns up to limit records starting from the log head without removing them
+func (l *segmentLog) read(limit int) (records []*segmentRecord, err error) {
+	if l.writer != nil {
+		if err = l.writer.Flush(); err != nil {
+			return
+		}
+	}
+
+	offset := l.headOffset
+
+	for _, s := range l.segments {
+		if len(records) >= limit {
+			break
+		}
+
+		if err = s.read(offset, limit-len(records), &records); err != nil {
+			return nil, err
+		}
+		offset = 0
+	}
+
+	return
+}
+
+func (s *segment) read(offset int64, limit int, records *[]*segmentRecord) (err error) {
+	if offset >= s.size {
+		return
+	}
+
+	var f *os.File
+	if f, err = os.Open(s.path); err != nil {
+		return
+	}
+	defer f.Close()
+
+	r := bufio.NewReader(io.NewSectionReader(f, offset, s.size-offset))
+
+	for ; limit > 0 && offset < s.size; limit-- {
+		var rec segmentRecord
+
+		if rec.id, rec.clock, rec.payload, err = readSegmentRecord(r, nil); err != nil {
+			return fmt.Errorf("cannot read segment %s: %w", s.path, err)
+		}
+
+		offset += segmentHeaderSize + int64(len(rec.payload))
+		rec.end = segmentPos{seg: s, offset: offset}
+		*records = append(*records, &rec)
+	}
+
+	return nil
+}
+
+// ack removes records up to the specified record (inclusive), deleting fully acknowledged segments.
+// The active segment is kept open for writing even if all its records are acknowledged.
+func (l *segmentLog) ack(rec *segmentRecord) (err error) {
+	for len(l.segments) != 0 && l.segments[0] != rec.end.seg {
+		if err = l.removeHead(); err != nil {
+			return
+		}
+	}
+
+	if len(l.segments) == 0 {
+		return errors.New("acknowledged segment is not found")
+	}
+
+	l.headOffset = rec.end.offset
+	// records are written in clock order, so the acknowledged record clock is the lower bound
+	rec.end.seg.oldestClock = rec.clock
+
+	if l.headOffset >= rec.end.seg.size && (len(l.segments) > 1 || l.file == nil) {
+		err = l.removeHead()
+	}
+
+	l.ackID = rec.id
+	l.ackModified = true
+
+	return
+}
+
+// removeHead removes the first segment, closing it if it's the active segment
+func (l *segmentLog) removeHead() (err error) {
+	if len(l.segments) == 1 {
+		if err = l.closeActive(); err != nil {
+			return
+		}
+	}
+
+	if err = os.Remove(l.segments[0].path); err != nil && !os.IsNotExist(err) {
+		return
+	}
+
+	l.segments = l.segments[1:]
+	l.headOffset = 0
+
+	return nil
+}
+
+// expire removes segments with all records written before the specified clock
+func (l *segmentLog) expire(clock int64) (err error) {
+	for len(l.segments) != 0 && l.segments[0].newestClock < clock {
+		if err = l.removeHead(); err != nil {
+			return
+		}
+	}
+
+	return
+}
+
+func (l *segmentLog) empty() bool {
+	return len(l.segments) == 0 || (len(l.segments) == 1 && l.headOffset >= l.segments[0].size)
+}
+
+// oldestClock returns write clock of the oldest segment or 0 if the log is empty
+func (l *segmentLog) oldestClock() int64 {
+	if l.empty() {
+		return 0
+	}
+
+	return l.segments[0].oldestClock
+}
+
+// lastID returns id of the last written record
+func (l *segmentLog) lastID() uint64 {
+	if len(l.segments) == 0 {
+		return l.ackID
+	}
+
+	return l.segments[len(l.segments)-1].lastID
+}
+
+func (l *segmentLog) close() (err error) {
+	if err = l.sync(); err != nil {
+		return
+	}
+
+	return l.closeActive()
+}
@@ -190,7 +190,7 @@ func (c *client) addRequest(p *pluginAgent, r *Request, timeout int, sink plugin
 					if err = task.reschedule(now); err != nil {
 						return
 					}
-					p.tasks.Update(task)
+					p.updateTask(task)
 					log.Debugf("[%d] updated exporter task for plugin '%s' itemid:%d key '%s'",
 						c.id, p.name(), task.item.itemid, task.item.key)
 				}
@@ -62,6 +62,8 @@ type Manager struct {
 	pluginQueue pluginHeap
 	clients     map[uint64]*client
 	aliases     *alias.Manager
+	// recurring tasks waiting for their next check
+	timers *timerWheel
 	// number of active tasks (running in their own goroutines)
 	activeTasksNum int
 	// number of seconds left on shutdown timer
@@ -140,6 +142,11 @@ func (m *Manager) cleanupClient(c *client, now time.Time) {
 		log.Debugf("[%d] deactivate unused plugin %s", c.id, p.name())
 
 		// deactivate recurring tasks
+		for _, t := range m.timers.tasks(p) {
+			if t.isActive() && t.isRecurring() {
+				t.deactivate()
+			}
+		}
 		for deactivate := true; deactivate; {
 			deactivate = false
 			for _, t := range p.tasks {
@@ -417,9 +424,23 @@ func (m *Manager) processCommandRequest(update *commandRequest) {
 	}
 }
 
+// expireTask moves task from timer wheel into its plugin task queue
+func (m *Manager) expireTask(task performer) {
+	p := task.getPlugin()
+	p.enqueueTask(task)
+	if !p.queued() {
+		if p.hasCapacity() {
+			heap.Push(&m.pluginQueue, p)
+		}
+	} else {
+		m.pluginQueue.Update(p)
+	}
+}
+
 // processQueue processes queued plugins/tasks
 func (m *Manager) processQueue(now time.Time) {
 	seconds := now.Unix()
+	m.timers.advance(seconds, m.expireTask)
 	for p := m.pluginQueue.Peek(); p != nil; p = m.pluginQueue.Peek() {
 		if task := p.peekTask(); task != nil {
 			if task.getScheduled().Unix() > seconds {
@@ -489,7 +510,7 @@ func (m *Manager) processFinishRequest(task performer) {
 	if p.active() && task.isActive() && task.isRecurring() {
 		if err := task.reschedule(time.Now()); err != nil {
 			log.Warningf("cannot reschedule plugin %s: %s", p.impl.Name(), err)
-		} else {
+		} else if !m.timers.add(task) {
 			p.enqueueTask(task)
 		}
 	}
@@ -505,6 +526,9 @@ func (m *Manager) processFinishRequest(task performer) {
 // rescheduleQueue reschedules all queued tasks. This is done whenever time
 // difference between ticks exceeds limits (for example during daylight saving changes).
 func (m *Manager) rescheduleQueue(now time.Time) {
+	m.timers.flush(m.expireTask)
+	m.timers.now = now.Unix()
+
 	// easier to rebuild queues than update each element
 	queue := make(pluginHeap, 0, len(m.pluginQueue))
 	for _, p := range m.pluginQueue {
@@ -524,6 +548,7 @@ func (m *Manager) rescheduleQueue(now time.Time) {
 func (m *Manager) deactivatePlugins() {
 	m.shutdownSeconds = shutdownTimeout
 
+	m.timers.flush(func(t performer) {})
 	m.pluginQueue = make(pluginHeap, 0, len(m.pluginQueue))
 	for _, p := range m.plugins {
 		if p.refcount != 0 {
@@ -631,6 +656,7 @@ run:
 					continue
 				}
 
+				m.timers.flush(m.expireTask)
 				m.processAndFlushUserParamQueue(time.Now())
 
 				tasks := make(map[string]performerHeap)
@@ -675,6 +701,7 @@ run:
 func (m *Manager) init() {
 	m.input = make(chan interface{}, 10)
 	m.pluginQueue = make(pluginHeap, 0, len(plugin.Metrics))
+	m.timers = newTimerWheel(time.Now().Unix())
 	m.clients = make(map[uint64]*client)
 	m.plugins = make(map[string]*pluginAgent)
 	m.shutdownSeconds = shutdownInactive
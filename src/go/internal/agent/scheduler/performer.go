@@ -37,6 +37,8 @@ type performer interface {
 	getIndex() int
 	// sets task index in the plugin task queue
 	setIndex(index int)
+	// returns task position in the timer wheel
+	getTimerPos() *timerPos
 	// returns true if the task is active
 	isActive() bool
 	// deactivates task, removing from plugin task queue if necessary
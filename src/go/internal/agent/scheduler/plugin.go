@@ -26,6 +26,8 @@ type pluginAgent struct {
 	impl plugin.Accessor
 	// queue of tasks to perform
 	tasks performerHeap
+	// number of tasks waiting in the timer wheel
+	timers int
 	// maximum plugin capacity
 	maxCapacity int
 	// used plugin capacity
@@ -68,6 +70,21 @@ func (p *pluginAgent) removeTask(index int) {
 	heap.Remove(&p.tasks, index)
 }
 
+// updateTask updates task position in the task queue or in the timer wheel after it was rescheduled
+func (p *pluginAgent) updateTask(task performer) {
+	if pos := task.getTimerPos(); pos.slot != nil {
+		w := pos.wheel
+		w.remove(task)
+		if !w.add(task) {
+			p.enqueueTask(task)
+		}
+
+		return
+	}
+
+	p.tasks.Update(task)
+}
+
 func (p *pluginAgent) reserveCapacity(task performer) {
 	p.usedCapacity += task.getWeight()
 }
@@ -59,7 +59,7 @@ func (m *Manager) getStatus() (result string) {
 		}
 		status.WriteString(fmt.Sprintf("[%s]\nactive: %t\n%scapacity: %d/%d\ncheck on start: %d\ntasks: %d\n",
 			info.ref.name(), info.ref.active(), extInfo, info.ref.usedCapacity, info.ref.maxCapacity,
-			info.ref.forceActiveChecksOnStart, len(info.ref.tasks)))
+			info.ref.forceActiveChecksOnStart, len(info.ref.tasks)+info.ref.timers))
 		sort.Slice(info.metrics, func(l, r int) bool { return info.metrics[l].Key < info.metrics[r].Key })
 		for _, metric := range info.metrics {
 			status.WriteString(metric.Key)
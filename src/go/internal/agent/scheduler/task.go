@@ -49,6 +49,7 @@ type taskBase struct {
 	plugin    *pluginAgent
 	scheduled time.Time
 	index     int
+	timer     timerPos
 	active    bool
 	recurring bool
 }
@@ -77,10 +78,17 @@ func (t *taskBase) setIndex(index int) {
 	t.index = index
 }
 
+func (t *taskBase) getTimerPos() *timerPos {
+	return &t.timer
+}
+
 func (t *taskBase) deactivate() {
 	if t.index != -1 {
 		t.plugin.removeTask(t.index)
 	}
+	if t.timer.slot != nil {
+		t.timer.wheel.removePos(&t.timer, t.plugin)
+	}
 	t.active = false
 }
 
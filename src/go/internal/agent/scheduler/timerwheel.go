@@ -0,0 +1,202 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+package scheduler
+
+// Hierarchical timer wheel with one second resolution. The first level has a slot for every
+// second, while each slot of the upper levels covers the whole span of the level below. When
+// the wheel time reaches the start of an upper level slot, its tasks are cascaded to lower
+// levels. Task insertion and removal are O(1), expiration is O(1) per task.
+const (
+	timerLevel0Bits = 8
+	timerLevelNBits = 6
+	timerLevels     = 4
+	// maximum delay the wheel can hold, tasks scheduled later are cascaded until they fit
+	timerMaxDelay = 1<<(timerLevel0Bits+(timerLevels-1)*timerLevelNBits) - 1
+)
+
+type timerSlot []performer
+
+// timerPos is task position in the timer wheel
+type timerPos struct {
+	wheel *timerWheel
+	slot  *timerSlot
+	index int
+}
+
+type timerWheel struct {
+	// wheel time in seconds, tasks scheduled at this time or before are expired
+	now    int64
+	levels [timerLevels][]timerSlot
+	num    int
+}
+
+func timerLevelShift(level int) uint {
+	if level == 0 {
+		return 0
+	}
+
+	return uint(timerLevel0Bits + (level-1)*timerLevelNBits)
+}
+
+func newTimerWheel(now int64) *timerWheel {
+	w := &timerWheel{now: now}
+	w.levels[0] = make([]timerSlot, 1<<timerLevel0Bits)
+	for i := 1; i < timerLevels; i++ {
+		w.levels[i] = make([]timerSlot, 1<<timerLevelNBits)
+	}
+
+	return w
+}
+
+// add inserts task into the wheel. False is returned if the task is already expired and was not added.
+func (w *timerWheel) add(t performer) bool {
+	expire := t.getScheduled().Unix()
+	delta := expire - w.now
+
+	if delta <= 0 {
+		return false
+	}
+
+	if delta > timerMaxDelay {
+		expire = w.now + timerMaxDelay
+		delta = timerMaxDelay
+	}
+
+	level := 0
+	for ; level < timerLevels-1; level++ {
+		if delta < 1<<timerLevelShift(level+1) {
+			break
+		}
+	}
+
+	slots := w.levels[level]
+	slot := &slots[(expire>>timerLevelShift(level))&int64(len(slots)-1)]
+
+	pos := t.getTimerPos()
+	pos.wheel = w
+	pos.slot = slot
+	pos.index = len(*slot)
+	*slot = append(*slot, t)
+
+	w.num++
+	t.getPlugin().timers++
+
+	return true
+}
+
+// remove removes task from the wheel
+func (w *timerWheel) remove(t performer) {
+	w.removePos(t.getTimerPos(), t.getPlugin())
+}
+
+// removePos removes task at the specified position from the wheel
+func (w *timerWheel) removePos(pos *timerPos, p *pluginAgent) {
+	if pos.slot == nil {
+		return
+	}
+
+	slot := *pos.slot
+	last := len(slot) - 1
+	if pos.index != last {
+		slot[pos.index] = slot[last]
+		slot[pos.index].getTimerPos().index = pos.index
+	}
+	slot[last] = nil
+	*pos.slot = slot[:last]
+
+	pos.slot = nil
+	w.num--
+	p.timers--
+}
+
+// takeSlot removes all tasks from slot and returns them
+func (w *timerWheel) takeSlot(slot *timerSlot) []performer {
+	tasks := *slot
+	if len(tasks) == 0 {
+		return nil
+	}
+	*slot = make(timerSlot, 0, len(tasks))
+
+	for _, t := range tasks {
+		t.getTimerPos().slot = nil
+		t.getPlugin().timers--
+	}
+	w.num -= len(tasks)
+
+	return tasks
+}
+
+// advance moves wheel time forward to the specified time, calling expire for every task
+// scheduled up to that time
+func (w *timerWheel) advance(now int64, expire func(t performer)) {
+	for w.now < now {
+		w.now++
+
+		if w.num == 0 {
+			w.now = now
+			break
+		}
+
+		// cascade upper levels starting with the highest one
+		for level := timerLevels - 1; level > 0; level-- {
+			shift := timerLevelShift(level)
+			if w.now&(1<<shift-1) != 0 {
+				continue
+			}
+
+			slots := w.levels[level]
+			for _, t := range w.takeSlot(&slots[(w.now>>shift)&int64(len(slots)-1)]) {
+				if !w.add(t) {
+					expire(t)
+				}
+			}
+		}
+
+		slots := w.levels[0]
+		for _, t := range w.takeSlot(&slots[w.now&int64(len(slots)-1)]) {
+			expire(t)
+		}
+	}
+}
+
+// flush removes all tasks from the wheel, calling expire for each of them
+func (w *timerWheel) flush(expire func(t performer)) {
+	for level := range w.levels {
+		for i := range w.levels[level] {
+			for _, t := range w.takeSlot(&w.levels[level][i]) {
+				expire(t)
+			}
+		}
+	}
+}
+
+// tasks returns tasks of the specified plugin waiting in the wheel
+func (w *timerWheel) tasks(p *pluginAgent) (tasks []performer) {
+	if p.timers == 0 {
+		return
+	}
+
+	for level := range w.levels {
+		for _, slot := range w.levels[level] {
+			for _, t := range slot {
+				if t.getPlugin() == p {
+					tasks = append(tasks, t)
+				}
+			}
+		}
+	}
+
+	return
+}
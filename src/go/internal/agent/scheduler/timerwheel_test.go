@@ -0,0 +1,150 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+package scheduler
+
+import (
+	"container/heap"
+	"math/rand"
+	"testing"
+	"time"
+)
+
+type mockTimerTask struct {
+	taskBase
+	delay int64
+}
+
+func (t *mockTimerTask) perform(s Scheduler) {
+}
+
+func (t *mockTimerTask) reschedule(now time.Time) (err error) {
+	t.scheduled = time.Unix(now.Unix()+t.delay, priorityExporterTaskNs)
+	return
+}
+
+func newMockTimerTasks(p *pluginAgent, num int, now time.Time) (tasks []*mockTimerTask) {
+	r := rand.New(rand.NewSource(0))
+	delays := []int64{1, 5, 10, 30, 60, 300, 600, 3600, 86400}
+
+	tasks = make([]*mockTimerTask, num)
+	for i := range tasks {
+		tasks[i] = &mockTimerTask{
+			taskBase: taskBase{plugin: p, index: -1, active: true, recurring: true},
+			delay:    delays[r.Intn(len(delays))],
+		}
+		tasks[i].scheduled = time.Unix(now.Unix()+r.Int63n(tasks[i].delay)+1, priorityExporterTaskNs)
+	}
+
+	return
+}
+
+func TestTimerWheel(t *testing.T) {
+	p := &pluginAgent{index: -1}
+	start := time.Unix(1700000000, 0)
+	w := newTimerWheel(start.Unix())
+
+	tasks := newMockTimerTasks(p, 1000, start)
+	// tasks beyond maximum wheel delay
+	for i := 0; i < 10; i++ {
+		task := &mockTimerTask{taskBase: taskBase{plugin: p, index: -1, active: true}}
+		task.scheduled = time.Unix(start.Unix()+timerMaxDelay+int64(i)*100000, 0)
+		tasks = append(tasks, task)
+	}
+
+	for _, task := range tasks {
+		if !w.add(task) {
+			t.Fatalf("cannot add task scheduled at %d", task.scheduled.Unix())
+		}
+	}
+
+	// remove some tasks before they expire
+	removed := make(map[performer]bool)
+	for i := 0; i < len(tasks); i += 7 {
+		tasks[i].deactivate()
+		removed[tasks[i]] = true
+	}
+
+	if p.timers != len(tasks)-len(removed) {
+		t.Fatalf("expected %d tasks in wheel while got %d", len(tasks)-len(removed), p.timers)
+	}
+
+	expired := make(map[performer]bool)
+	expire := func(task performer) {
+		if task.getScheduled().Unix() != w.now {
+			t.Fatalf("task scheduled at %d expired at %d", task.getScheduled().Unix(), w.now)
+		}
+		if removed[task] || expired[task] {
+			t.Fatalf("unexpected task scheduled at %d expired", task.getScheduled().Unix())
+		}
+		expired[task] = true
+	}
+
+	// advance in uneven steps to cover multi-second gaps
+	for now := start.Unix(); now < start.Unix()+timerMaxDelay+1000000; now += 1 + now%3 {
+		w.advance(now, expire)
+	}
+
+	if len(expired) != len(tasks)-len(removed) || p.timers != 0 || w.num != 0 {
+		t.Fatalf("expected %d expired tasks while got %d", len(tasks)-len(removed), len(expired))
+	}
+}
+
+// The benchmarks simulate scheduler processing a second with 50k recurring tasks. Tasks due at the
+// current second are performed and rescheduled, either directly into plugin task queue or into
+// timer wheel, from where they are moved into plugin task queue only when due.
+
+func BenchmarkTaskQueueHeap(b *testing.B) {
+	p := &pluginAgent{index: -1}
+	now := time.Unix(1700000000, 0)
+
+	for _, task := range newMockTimerTasks(p, 50000, now) {
+		p.enqueueTask(task)
+	}
+
+	b.ResetTimer()
+
+	for i := 0; i < b.N; i++ {
+		now = now.Add(time.Second)
+		for task := p.peekTask(); task != nil && task.getScheduled().Unix() <= now.Unix(); task = p.peekTask() {
+			p.popTask()
+			_ = task.reschedule(now)
+			p.enqueueTask(task)
+		}
+	}
+}
+
+func BenchmarkTaskQueueTimerWheel(b *testing.B) {
+	p := &pluginAgent{index: -1}
+	now := time.Unix(1700000000, 0)
+	w := newTimerWheel(now.Unix())
+
+	for _, task := range newMockTimerTasks(p, 50000, now) {
+		w.add(task)
+	}
+
+	b.ResetTimer()
+
+	for i := 0; i < b.N; i++ {
+		now = now.Add(time.Second)
+		w.advance(now.Unix(), func(t performer) { heap.Push(&p.tasks, t) })
+		for task := p.peekTask(); task != nil && task.getScheduled().Unix() <= now.Unix(); task = p.peekTask() {
+			p.popTask()
+			_ = task.reschedule(now)
+			if !w.add(task) {
+				p.enqueueTask(task)
+			}
+		}
+	}
+}
@@ -32,6 +32,7 @@
 #include "zbxthreads.h"
 #include "zbxtime.h"
 #include "zbxmedia.h"
+#include "zbxevent.h"
 
 typedef struct
 {
@@ -743,6 +744,32 @@ static void	am_service_add_event_tags(zbx_vector_events_tags_t *events_tags)
 	zbx_free(data);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes problems with added tags from problem cache               *
+ *                                                                            *
+ * Parameters: update_events_tags - [IN] events with added tags               *
+ *                                                                            *
+ ******************************************************************************/
+static void	am_problem_cache_invalidate(const zbx_vector_events_tags_t *update_events_tags)
+{
+	zbx_vector_uint64_t	eventids;
+
+	zbx_vector_uint64_create(&eventids);
+
+	for (int i = 0; i < update_events_tags->values_num; i++)
+	{
+		const zbx_event_tags_t	*event_tags = update_events_tags->values[i];
+
+		if (0 != event_tags->need_to_add_problem_tag && 0 != event_tags->tags.values_num)
+			zbx_vector_uint64_append(&eventids, event_tags->eventid);
+	}
+
+	zbx_problem_cache_invalidate_events(&eventids);
+
+	zbx_vector_uint64_destroy(&eventids);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves alert updates from alert manager and flushes them into  *
@@ -855,7 +882,10 @@ static int	am_db_flush_results(zbx_am_db_t *amdb)
 		while (ZBX_DB_DOWN == (ret = zbx_db_commit()));
 
 		if (ZBX_DB_OK == ret)
+		{
+			am_problem_cache_invalidate(&update_events_tags);
 			am_service_add_event_tags(&update_events_tags);
+		}
 
 		for (i = 0; i < results_num; i++)
 		{
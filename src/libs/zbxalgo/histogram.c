@@ -0,0 +1,190 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxalgo.h"
+
+/* Values below 2 * ZBX_HDR_HISTOGRAM_SUB_NUM have their own buckets. Larger values are split into */
+/* power of two ranges, each range divided into ZBX_HDR_HISTOGRAM_SUB_NUM linear buckets, so the  */
+/* bucket width never exceeds 1/ZBX_HDR_HISTOGRAM_SUB_NUM of the values it contains.               */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns index of the most significant bit set                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hdr_histogram_msb(zbx_uint64_t value)
+{
+	int	msb = 0;
+
+	if (0 != (value >> 32))
+	{
+		value >>= 32;
+		msb += 32;
+	}
+
+	if (0 != (value >> 16))
+	{
+		value >>= 16;
+		msb += 16;
+	}
+
+	if (0 != (value >> 8))
+	{
+		value >>= 8;
+		msb += 8;
+	}
+
+	if (0 != (value >> 4))
+	{
+		value >>= 4;
+		msb += 4;
+	}
+
+	if (0 != (value >> 2))
+	{
+		value >>= 2;
+		msb += 2;
+	}
+
+	if (0 != (value >> 1))
+		msb += 1;
+
+	return msb;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns bucket index for the specified value                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hdr_histogram_bucket_index(zbx_uint64_t value)
+{
+	int	shift;
+
+	if (value < 2 * ZBX_HDR_HISTOGRAM_SUB_NUM)
+		return (int)value;
+
+	if (ZBX_HDR_HISTOGRAM_VALUE_BITS <= (shift = hdr_histogram_msb(value)))
+		return ZBX_HDR_HISTOGRAM_BUCKETS_NUM - 1;
+
+	shift -= ZBX_HDR_HISTOGRAM_SUB_BITS;
+
+	return shift * ZBX_HDR_HISTOGRAM_SUB_NUM + (int)(value >> shift);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the largest value counted in the specified bucket         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	hdr_histogram_bucket_max(int index)
+{
+	int	shift;
+
+	if (index < 2 * ZBX_HDR_HISTOGRAM_SUB_NUM)
+		return (zbx_uint64_t)index;
+
+	/* the last bucket also counts all values beyond histogram range */
+	if (ZBX_HDR_HISTOGRAM_BUCKETS_NUM - 1 == index)
+		return ZBX_MAX_UINT64;
+
+	shift = index / ZBX_HDR_HISTOGRAM_SUB_NUM - 1;
+
+	return (((zbx_uint64_t)(index - shift * ZBX_HDR_HISTOGRAM_SUB_NUM) + 1) << shift) - 1;
+}
+
+void	zbx_hdr_histogram_clear(zbx_hdr_histogram_t *hist)
+{
+	memset(hist, 0, sizeof(zbx_hdr_histogram_t));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to histogram                                           *
+ *                                                                            *
+ * Parameters: hist  - [IN/OUT]                                               *
+ *             value - [IN] value to add                                      *
+ *             count - [IN] number of times the value was observed            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hdr_histogram_add(zbx_hdr_histogram_t *hist, zbx_uint64_t value, zbx_uint64_t count)
+{
+	hist->buckets[hdr_histogram_bucket_index(value)] += count;
+	hist->count += count;
+	hist->sum += value * count;
+
+	if (value > hist->max)
+		hist->max = value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds values counted in source histogram to target histogram       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hdr_histogram_merge(zbx_hdr_histogram_t *dst, const zbx_hdr_histogram_t *src)
+{
+	if (0 == src->count)
+		return;
+
+	for (int i = 0; i < ZBX_HDR_HISTOGRAM_BUCKETS_NUM; i++)
+		dst->buckets[i] += src->buckets[i];
+
+	dst->count += src->count;
+	dst->sum += src->sum;
+
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates value at the specified percentile                      *
+ *                                                                            *
+ * Parameters: hist       - [IN]                                              *
+ *             percentile - [IN] percentile (0-100)                           *
+ *                                                                            *
+ * Return value: The largest value equivalent (within histogram precision) to *
+ *               the value at the specified percentile or 0 if histogram is   *
+ *               empty.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_hdr_histogram_percentile(const zbx_hdr_histogram_t *hist, double percentile)
+{
+	zbx_uint64_t	rank, total = 0;
+
+	if (0 == hist->count)
+		return 0;
+
+	rank = (zbx_uint64_t)(percentile / 100 * (double)hist->count + 0.5);
+
+	if (0 == rank)
+		rank = 1;
+
+	for (int i = 0; i < ZBX_HDR_HISTOGRAM_BUCKETS_NUM; i++)
+	{
+		if (rank <= (total += hist->buckets[i]))
+			return MIN(hdr_histogram_bucket_max(i), hist->max);
+	}
+
+	return hist->max;
+}
+
+double	zbx_hdr_histogram_avg(const zbx_hdr_histogram_t *hist)
+{
+	if (0 == hist->count)
+		return 0;
+
+	return (double)hist->sum / (double)hist->count;
+}
@@ -338,6 +338,7 @@ static zbx_dc_um_handle_t	*dc_um_handle = NULL;
  *           | Zabbix internal  | zabbix[proxy,discovery]              |      *
  *           | Zabbix internal  | zabbix[proxy,<proxyname>,lastaccess] |      *
  *           | Zabbix internal  | zabbix[proxy,<proxyname>,delay]      |      *
+ *           | Zabbix internal  | zabbix[housekeeper,*]                |      *
  *           | Zabbix aggregate | *                                    |      *
  *           | Calculated       | *                                    |      *
  *           '------------------+--------------------------------------'      *
@@ -380,6 +381,8 @@ int	zbx_is_item_processed_by_server(unsigned char type, const char *key)
 				{
 					if (0 == strcmp(arg1, "proxy") && 0 == strcmp(arg2, "discovery"))
 						ret = SUCCEED;
+					else if (0 == strcmp(arg1, "housekeeper"))
+						ret = SUCCEED;
 
 					goto clean;
 				}
@@ -9152,6 +9155,8 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	if (SUCCEED != vps_monitor_create(&config->vps_monitor, error))
 		goto out;
 
+	memset(&config->hk_stats, 0, sizeof(config->hk_stats));
+
 #define CREATE_HASHSET(hashset, hashset_size)									\
 														\
 	CREATE_HASHSET_EXT(hashset, hashset_size, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC)
@@ -10383,6 +10388,53 @@ void	zbx_dc_config_get_active_items_by_hostid(zbx_dc_item_t *items, zbx_uint64_t
 		errcodes[j] = FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get preprocessing steps of the specified items                    *
+ *                                                                            *
+ * Parameters: items    - [IN] items retrieved from configuration cache       *
+ *             errcodes - [IN] item retrieval error codes                     *
+ *             steps    - [OUT] preprocessing steps of each item              *
+ *             num      - [IN] number of items                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_get_items_preproc_steps(const zbx_dc_item_t *items, const int *errcodes,
+		zbx_vector_pp_step_ptr_t *steps, size_t num)
+{
+	RDLOCK_CACHE;
+
+	for (size_t i = 0; i < num; i++)
+	{
+		const ZBX_DC_ITEM		*dc_item;
+		const ZBX_DC_PREPROCITEM	*preprocitem;
+
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		if (NULL == (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &items[i].itemid)) ||
+				NULL == (preprocitem = dc_item->preproc_item))
+		{
+			continue;
+		}
+
+		for (int j = 0; j < preprocitem->preproc_ops.values_num; j++)
+		{
+			const zbx_dc_preproc_op_t	*op = (const zbx_dc_preproc_op_t *)preprocitem->preproc_ops.values[j];
+			zbx_pp_step_t			*step;
+
+			step = (zbx_pp_step_t *)zbx_malloc(NULL, sizeof(zbx_pp_step_t));
+			step->type = op->type;
+			step->error_handler = op->error_handler;
+			step->params = zbx_strdup(NULL, op->params);
+			step->error_handler_params = zbx_strdup(NULL, op->error_handler_params);
+
+			zbx_vector_pp_step_ptr_append(&steps[i], step);
+		}
+	}
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: sync item preprocessing steps with preprocessing manager cache,   *
@@ -16871,6 +16923,19 @@ void	zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay)
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the configuration cache revision                              *
+ *                                                                            *
+ * Comments: The revision is read without locking, it is only used to detect  *
+ *           configuration changes and drop data derived from the old one.    *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_config_revision(void)
+{
+	return config->revision.config;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get the configuration revision received from server               *
@@ -17187,3 +17252,36 @@ zbx_dc_um_shared_handle_t	*zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_
 
 	return handle;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates housekeeper statistics after deleting a batch of events  *
+ *          or problems, so that progress is visible during housekeeping      *
+ *                                                                            *
+ * Parameters: deleted    - [IN] number of deleted events or problems         *
+ *             sec        - [IN] time spent deleting them                     *
+ *             batch_size - [IN] next deletion batch size                     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_update_hk_stats(int deleted, double sec, int batch_size)
+{
+	WRLOCK_CACHE;
+
+	config->hk_stats.deleted += (zbx_uint64_t)deleted;
+	config->hk_stats.rps = (0 < sec ? deleted / sec : 0);
+	config->hk_stats.batch_size = batch_size;
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets housekeeper statistics                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hk_stats(zbx_hk_stats_t *stats)
+{
+	RDLOCK_CACHE;
+	*stats = config->hk_stats;
+	UNLOCK_CACHE;
+}
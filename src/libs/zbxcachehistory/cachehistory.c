@@ -108,6 +108,11 @@ typedef struct
 	unsigned char		db_trigger_queue_lock;
 
 	zbx_hc_proxyqueue_t	proxyqueue;
+
+	/* value latency histograms (in microseconds) of the current and the last period */
+	zbx_hdr_histogram_t	latency[ZBX_HC_LATENCY_STAGES_NUM];
+	zbx_hdr_histogram_t	latency_last[ZBX_HC_LATENCY_STAGES_NUM];
+	int			latency_period;
 }
 ZBX_DC_CACHE;
 
@@ -144,6 +149,7 @@ typedef struct
 	int		severity;	/* for log items only */
 	int		logeventid;	/* for log items only */
 	int		mtime;
+	double		ingest;
 	unsigned char	item_value_type;
 	unsigned char	value_type;
 	unsigned char	state;
@@ -156,6 +162,15 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
+/* ingest time of the value being added to local history cache */
+static double		item_value_ingest = 0;
+
+/* value latency tracking of history syncer batch */
+static zbx_hdr_histogram_t	hc_latency_local[ZBX_HC_LATENCY_STAGES_NUM];
+static double		hc_latency_ingest[ZBX_HC_SYNC_MAX];
+static int		hc_latency_values_num = 0;
+static double		hc_latency_mark_time;
+
 static void	hc_add_item_values(dc_item_value_t *values, int values_num);
 static void	hc_queue_item(zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
@@ -1754,6 +1769,14 @@ void	zbx_db_mass_update_items(const zbx_vector_item_diff_ptr_t *item_diff,
 
 	if (i != item_diff->values_num || 0 != inventory_values->values_num)
 	{
+#if defined(HAVE_POSTGRESQL)
+		/* on failure the changes are saved with text SQL below */
+		if (i != item_diff->values_num && SUCCEED == zbx_db_prepared_statements_enabled() &&
+				SUCCEED == zbx_db_save_item_changes_prepared(item_diff, ZBX_FLAGS_ITEM_DIFF_UPDATE_DB))
+		{
+			i = item_diff->values_num;
+		}
+#endif
 		zbx_db_begin_multiple_update(&sql, &sql_alloc, &sql_offset);
 
 		if (i != item_diff->values_num)
@@ -1955,6 +1978,8 @@ static dc_item_value_t	*dc_local_get_history_slot(void)
 		item_values = (dc_item_value_t *)zbx_realloc(item_values, item_values_alloc * sizeof(dc_item_value_t));
 	}
 
+	item_values[item_values_num].ingest = item_value_ingest;
+
 	return &item_values[item_values_num++];
 }
 
@@ -2193,6 +2218,9 @@ void	zbx_dc_add_history(zbx_uint64_t itemid, unsigned char item_value_type, unsi
 {
 	unsigned char	value_flags;
 
+	/* values added directly to history cache start latency tracking in history cache */
+	item_value_ingest = 0;
+
 	if (ITEM_STATE_NOTSUPPORTED == state)
 	{
 		zbx_uint64_t	lastlogsize;
@@ -2310,6 +2338,8 @@ void	zbx_dc_add_history_variant(zbx_uint64_t itemid, unsigned char value_type, u
 	zbx_uint64_t	lastlogsize;
 	int		mtime;
 
+	item_value_ingest = value_opt->ingest;
+
 	if (0 != (value_opt->flags & ZBX_PP_VALUE_OPT_META))
 	{
 		value_flags = ZBX_DC_FLAG_META;
@@ -2771,6 +2801,49 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts time interval to value latency histogram units           *
+ *                                                                            *
+ * Parameters: sec - [IN] time interval in seconds                            *
+ *                                                                            *
+ * Return value: time interval in microseconds                                *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	hc_latency_value(double sec)
+{
+	/* negative intervals are possible if system time has been changed */
+	if (0 >= sec)
+		return 0;
+
+	return (zbx_uint64_t)(sec * 1000000);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts new value latency statistics period if necessary           *
+ *                                                                            *
+ * Parameters: now - [IN] current time                                        *
+ *                                                                            *
+ * Comments: This function must be called with history cache locked.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_latency_update_period(int now)
+{
+	int	period = now - now % ZBX_HC_LATENCY_PERIOD;
+
+	if (period == cache->latency_period)
+		return;
+
+	if (period - ZBX_HC_LATENCY_PERIOD == cache->latency_period)
+		memcpy(cache->latency_last, cache->latency, sizeof(cache->latency));
+	else
+		memset(cache->latency_last, 0, sizeof(cache->latency_last));
+
+	memset(cache->latency, 0, sizeof(cache->latency));
+	cache->latency_period = period;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds item values to the history cache                             *
@@ -2788,6 +2861,10 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 	dc_item_value_t	*item_value;
 	int		i;
 	zbx_hc_item_t	*item;
+	double		now;
+
+	now = zbx_time();
+	hc_latency_update_period((int)now);
 
 	for (i = 0; i < values_num; i++)
 	{
@@ -2830,6 +2907,17 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 			item = hc_get_item(item_value->itemid);
 		}
 
+		data->cached = now;
+
+		if (0 != item_value->ingest)
+		{
+			data->ingest = item_value->ingest;
+			zbx_hdr_histogram_add(&cache->latency[ZBX_HC_LATENCY_PREPROCESSING],
+					hc_latency_value(now - item_value->ingest), 1);
+		}
+		else
+			data->ingest = now;
+
 		if (NULL == item)
 		{
 			item = hc_add_item(item_value->itemid, data);
@@ -2948,6 +3036,9 @@ void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t
 {
 	int		i, history_num = 0;
 	zbx_hc_item_t	*item;
+	double		now;
+
+	now = zbx_time();
 
 	/* we don't need to lock history cache because no other processes can  */
 	/* change item's history data until it is pushed back to history queue */
@@ -2958,8 +3049,72 @@ void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t
 		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
 			continue;
 
+		zbx_hdr_histogram_add(&hc_latency_local[ZBX_HC_LATENCY_CACHE], hc_latency_value(now - item->tail->cached),
+				1);
+		hc_latency_ingest[history_num] = item->tail->ingest;
+
 		hc_copy_history_data(&history[history_num++], item->itemid, item->tail);
 	}
+
+	hc_latency_values_num = history_num;
+	hc_latency_mark_time = now;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: records the time spent by history values retrieved with           *
+ *          zbx_hc_get_item_values() in the specified processing stage        *
+ *                                                                            *
+ * Parameters: stage - [IN] processing stage that has been finished since     *
+ *                          values were retrieved or previous stage was       *
+ *                          finished (ZBX_HC_LATENCY_*)                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_latency_mark(int stage)
+{
+	double	now;
+
+	if (0 == hc_latency_values_num)
+		return;
+
+	now = zbx_time();
+	zbx_hdr_histogram_add(&hc_latency_local[stage], hc_latency_value(now - hc_latency_mark_time),
+			(zbx_uint64_t)hc_latency_values_num);
+	hc_latency_mark_time = now;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value latency statistics of the processed history values to  *
+ *          history cache                                                     *
+ *                                                                            *
+ * Comments: This function must be called with history cache locked.          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_latency_flush(void)
+{
+	double	now;
+
+	now = zbx_time();
+
+	for (int i = 0; i < hc_latency_values_num; i++)
+	{
+		zbx_hdr_histogram_add(&hc_latency_local[ZBX_HC_LATENCY_TOTAL], hc_latency_value(now - hc_latency_ingest[i]),
+				1);
+	}
+
+	hc_latency_update_period((int)now);
+
+	for (int i = 0; i < ZBX_HC_LATENCY_STAGES_NUM; i++)
+	{
+		if (0 == hc_latency_local[i].count)
+			continue;
+
+		zbx_hdr_histogram_merge(&cache->latency[i], &hc_latency_local[i]);
+		zbx_hdr_histogram_clear(&hc_latency_local[i]);
+	}
+
+	hc_latency_values_num = 0;
 }
 
 /******************************************************************************
@@ -2980,6 +3135,9 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
 
+	if (0 != hc_latency_values_num)
+		hc_latency_flush();
+
 	for (i = 0; i < history_items->values_num; i++)
 	{
 		item = history_items->values[i];
@@ -3371,6 +3529,55 @@ void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get value latency statistics of the last full period              *
+ *                                                                            *
+ * Parameters: latency - [OUT] latency histograms (in microseconds) of all    *
+ *                             processing stages, the array must have         *
+ *                             ZBX_HC_LATENCY_STAGES_NUM elements             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_get_latency(zbx_hdr_histogram_t *latency)
+{
+	LOCK_CACHE;
+
+	hc_latency_update_period((int)time(NULL));
+	memcpy(latency, cache->latency_last, sizeof(cache->latency_last));
+
+	UNLOCK_CACHE;
+}
+
+static const char	*hc_latency_stages[ZBX_HC_LATENCY_STAGES_NUM] = {"preprocessing", "cache", "dbflush",
+		"triggers", "total"};
+
+const char	*zbx_hc_latency_stage_string(int stage)
+{
+	if (0 > stage || ZBX_HC_LATENCY_STAGES_NUM <= stage)
+		return "unknown";
+
+	return hc_latency_stages[stage];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get value processing stage by name                                *
+ *                                                                            *
+ * Return value: The processing stage (ZBX_HC_LATENCY_*) or FAIL if the       *
+ *               name is unknown.                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_hc_latency_stage_by_name(const char *name)
+{
+	for (int i = 0; i < ZBX_HC_LATENCY_STAGES_NUM; i++)
+	{
+		if (0 == strcmp(name, hc_latency_stages[i]))
+			return i;
+	}
+
+	return FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks if database trigger queue table is locked                  *
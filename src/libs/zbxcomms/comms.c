@@ -43,6 +43,8 @@
 #	define SOCK_CLOEXEC 0	/* SOCK_CLOEXEC is Linux-specific, available since 2.6.23 */
 #endif
 
+static zbx_compress_stats_update_f	compress_stats_update_cb = NULL;
+
 static int	socket_set_nonblocking(ZBX_SOCKET s);
 static void	tcp_set_socket_strerror_from_getaddrinfo(const char *ip);
 static ssize_t	tcp_read(zbx_socket_t *s, char *buffer, size_t size, short *events);
@@ -74,6 +76,7 @@ zbx_config_tls_t	*zbx_config_tls_new(void)
 	config_tls->cipher_all		= NULL;
 	config_tls->cipher_cmd13	= NULL;
 	config_tls->cipher_cmd		= NULL;
+	config_tls->kernel_offload	= 0;
 
 	return config_tls;
 }
@@ -369,6 +372,34 @@ void	zbx_socket_clean(zbx_socket_t *s)
 	s->buf_type = ZBX_BUF_TYPE_STAT;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets callback for collecting message compression statistics       *
+ *                                                                            *
+ * Parameters: update_cb - [IN] callback called for every compressed and      *
+ *                              uncompressed message                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_init_compress_stats(zbx_compress_stats_update_f update_cb)
+{
+	compress_stats_update_cb = update_cb;
+}
+
+static void	tcp_compress_stats_update(int direction, size_t bytes, size_t bytes_compressed, double time)
+{
+	if (NULL != compress_stats_update_cb)
+		compress_stats_update_cb(direction, bytes, bytes_compressed, time);
+}
+
+static void	tcp_uncompress_stream_free(zbx_socket_t *s)
+{
+	if (NULL != s->uncompress_stream)
+	{
+		zbx_uncompress_stream_free(s->uncompress_stream);
+		s->uncompress_stream = NULL;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: free socket's dynamic buffer                                      *
@@ -378,6 +409,8 @@ static void	zbx_socket_free(zbx_socket_t *s)
 {
 	if (ZBX_BUF_TYPE_DYN == s->buf_type)
 		zbx_free(s->buffer);
+
+	tcp_uncompress_stream_free(s);
 }
 
 /******************************************************************************
@@ -839,6 +872,8 @@ int	zbx_tcp_send_context_init(const char *data, size_t len, size_t reserved, uns
 		/* compress if not compressed yet */
 		if (0 == reserved)
 		{
+			double	time_start = zbx_time(), time_compress;
+
 			if (SUCCEED != zbx_compress(data, len, &context->compressed_data, &context->send_len))
 			{
 				zbx_set_socket_strerror("cannot compress data: %s", zbx_compress_strerror());
@@ -846,6 +881,14 @@ int	zbx_tcp_send_context_init(const char *data, size_t len, size_t reserved, uns
 				return FAIL;
 			}
 
+			time_compress = zbx_time() - time_start;
+			tcp_compress_stats_update(ZBX_COMPRESS_STATS_SENT, len, context->send_len, time_compress);
+
+			zabbix_log(LOG_LEVEL_TRACE, "%s(): compressed " ZBX_FS_SIZE_T " bytes to " ZBX_FS_SIZE_T
+					" bytes with compression ratio %.1f in " ZBX_FS_DBL " sec", __func__,
+					(zbx_fs_size_t)len, (zbx_fs_size_t)context->send_len,
+					(double)len / (double)MAX(context->send_len, 1), time_compress);
+
 			context->data = context->compressed_data;
 			reserved = len;
 		}
@@ -1970,6 +2013,33 @@ int	zbx_socket_check_deadline(zbx_socket_t *s)
 #define ZBX_TCP_EXPECT_LENGTH		4
 #define ZBX_TCP_EXPECT_SIZE		5
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompresses received chunk of large compressed message           *
+ *                                                                            *
+ * Parameters: s       - [IN] socket with active uncompress stream            *
+ *             context - [IN/OUT] receive context                             *
+ *             data    - [IN] received data                                   *
+ *             len     - [IN] received data length                            *
+ *                                                                            *
+ * Return value: SUCCEED - the data was uncompressed                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	tcp_uncompress_stream_update(zbx_socket_t *s, zbx_tcp_recv_context_t *context, const char *data,
+		size_t len)
+{
+	double	time_start = zbx_time();
+	int	ret;
+
+	if (SUCCEED != (ret = zbx_uncompress_stream_update(s->uncompress_stream, data, len)))
+		zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+
+	context->uncompress_time += zbx_time() - time_start;
+
+	return ret;
+}
+
 void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *tcp_recv_context, unsigned char flags)
 {
 	tcp_recv_context->buf_dyn_bytes = 0;
@@ -1978,6 +2048,7 @@ void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *tcp_recv
 	tcp_recv_context->expected_len = 16 * ZBX_MEBIBYTE;
 	tcp_recv_context->reserved = 0;
 	tcp_recv_context->expect = ZBX_TCP_EXPECT_HEADER;
+	tcp_recv_context->uncompress_time = 0;
 #if defined(_WINDOWS)
 	tcp_recv_context->max_len = ZBX_MAX_RECV_DATA_SIZE;
 #else
@@ -2009,7 +2080,20 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 		else
 		{
 			if (context->buf_dyn_bytes + (size_t)nbytes <= context->expected_len)
-				memcpy(s->buffer + context->buf_dyn_bytes, s->buf_stat, (size_t)nbytes);
+			{
+				if (NULL != s->uncompress_stream)
+				{
+					if (SUCCEED != tcp_uncompress_stream_update(s, context, s->buf_stat,
+							(size_t)nbytes))
+					{
+						tcp_uncompress_stream_free(s);
+						nbytes = ZBX_PROTO_ERROR;
+						goto out;
+					}
+				}
+				else
+					memcpy(s->buffer + context->buf_dyn_bytes, s->buf_stat, (size_t)nbytes);
+			}
 			context->buf_dyn_bytes += (size_t)nbytes;
 		}
 
@@ -2114,6 +2198,30 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 				context->buf_stat_bytes -= context->offset;
 				memmove(s->buf_stat, s->buf_stat + context->offset, context->buf_stat_bytes);
 			}
+			else if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
+			{
+				/* uncompress large message while receiving it, without buffering compressed data */
+				s->buf_type = ZBX_BUF_TYPE_DYN;
+				s->buffer = (char *)zbx_malloc(NULL, context->reserved + 1);
+				context->buf_dyn_bytes = context->buf_stat_bytes - context->offset;
+				context->buf_stat_bytes = 0;
+
+				if (NULL == (s->uncompress_stream = zbx_uncompress_stream_create(s->buffer,
+						context->reserved)))
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+
+				if (SUCCEED != tcp_uncompress_stream_update(s, context, s->buf_stat + context->offset,
+						MIN(context->buf_dyn_bytes, context->expected_len)))
+				{
+					tcp_uncompress_stream_free(s);
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+			}
 			else
 			{
 				s->buf_type = ZBX_BUF_TYPE_DYN;
@@ -2134,10 +2242,44 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 	{
 		if (context->buf_stat_bytes + context->buf_dyn_bytes == context->expected_len)
 		{
-			if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
+			if (NULL != s->uncompress_stream)
+			{
+				size_t	out_size;
+				int	ret;
+
+				ret = zbx_uncompress_stream_finish(s->uncompress_stream, &out_size);
+				tcp_uncompress_stream_free(s);
+
+				if (SUCCEED != ret)
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+
+				if (out_size != context->reserved)
+				{
+					zbx_set_socket_strerror("size of uncompressed data is less than expected");
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+
+				s->read_bytes = context->reserved;
+
+				tcp_compress_stats_update(ZBX_COMPRESS_STATS_RECEIVED, context->reserved,
+						context->buf_dyn_bytes, context->uncompress_time);
+
+				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
+						" compression ratio %.1f, uncompressed in " ZBX_FS_DBL " sec", __func__,
+						(zbx_fs_size_t)context->buf_dyn_bytes,
+						(double)context->reserved / (double)context->buf_dyn_bytes,
+						context->uncompress_time);
+			}
+			else if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
 			{
 				char	*out;
 				size_t	out_size = context->reserved;
+				double	time_start = zbx_time(), time_uncompress;
 
 				out = (char *)zbx_malloc(NULL, context->reserved + 1);
 				if (FAIL == zbx_uncompress(s->buffer, context->buf_stat_bytes + context->buf_dyn_bytes,
@@ -2164,11 +2306,15 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 				s->buffer = out;
 				s->read_bytes = context->reserved;
 
+				time_uncompress = zbx_time() - time_start;
+				tcp_compress_stats_update(ZBX_COMPRESS_STATS_RECEIVED, context->reserved,
+						context->buf_stat_bytes + context->buf_dyn_bytes, time_uncompress);
+
 				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
-						" compression ratio %.1f", __func__,
+						" compression ratio %.1f, uncompressed in " ZBX_FS_DBL " sec", __func__,
 						(zbx_fs_size_t)(context->buf_stat_bytes + context->buf_dyn_bytes),
 						(double)context->reserved / (double)(context->buf_stat_bytes +
-						context->buf_dyn_bytes));
+						context->buf_dyn_bytes), time_uncompress);
 			}
 			else
 				s->read_bytes = context->buf_stat_bytes + context->buf_dyn_bytes;
@@ -2221,6 +2367,10 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 		s->buffer[s->read_bytes] = '\0';
 	}
 out:
+	/* keep uncompress stream only while waiting for more data of the message */
+	if (ZBX_PROTO_ERROR == nbytes && (NULL == events || 0 == *events))
+		tcp_uncompress_stream_free(s);
+
 	return (ZBX_PROTO_ERROR == nbytes ? FAIL : (ssize_t)(s->read_bytes + context->offset));
 
 #undef ZBX_TCP_EXPECT_HEADER
@@ -18,6 +18,34 @@
 
 #include "zbxcrypto.h"
 
+static zbx_tls_stats_update_f	tls_stats_update_cb = NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets callback for collecting TLS handshake statistics             *
+ *                                                                            *
+ * Parameters: update_cb - [IN] callback called for every established TLS     *
+ *                              connection                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_init_stats(zbx_tls_stats_update_f update_cb)
+{
+	tls_stats_update_cb = update_cb;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts established TLS connection in TLS statistics               *
+ *                                                                            *
+ * Parameters: counter - [IN] ZBX_TLS_STATS_* counter to increment            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_stats_update(int counter)
+{
+	if (NULL != tls_stats_update_cb)
+		tls_stats_update_cb(counter);
+}
+
 void	zbx_psk_warn_misconfig(const char *psk_identity)
 {
 	zabbix_log(LOG_LEVEL_WARNING, "same PSK identity \"%s\" but different PSK values used in proxy configuration"
@@ -28,6 +28,7 @@ void	zbx_tls_close(zbx_socket_t *s);
 void	zbx_read_psk_file(const char *file_name, char **psk, size_t *psk_len);
 void	zbx_check_psk_identity_len(size_t psk_identity_len);
 void	zbx_psk_warn_misconfig(const char *psk_identity);
+void	zbx_tls_stats_update(int counter);
 
 #endif	/* #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL) */
 
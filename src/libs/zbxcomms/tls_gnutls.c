@@ -857,6 +857,31 @@ void	zbx_tls_init_parent(zbx_get_program_type_f zbx_get_program_type_cb_arg)
 	zbx_tls_library_init(ZBX_TLS_INIT_THREADS);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates session ticket keys in a parent process                 *
+ *                                                                            *
+ * Comments: session resumption is not supported with GnuTLS                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_init_ticket_keys(void)
+{
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: warns in a parent process if kernel TLS offload is requested but  *
+ *          not supported                                                     *
+ *                                                                            *
+ * Comments: non-zero TLSKernelOffload is rejected during configuration       *
+ *           validation in GnuTLS builds                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_check_kernel_offload(const zbx_config_tls_t *config_tls)
+{
+	ZBX_UNUSED(config_tls);
+}
+
 static void	zbx_gnutls_priority_init_or_exit(gnutls_priority_t *ciphersuites, const char *priority_str,
 		const char *err_msg)
 {
@@ -1472,6 +1497,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 
 	s->connection_type = tls_connect;
 
+	/* sessions are not resumed with GnuTLS */
+	zbx_tls_stats_update(ZBX_TLS_STATS_HANDSHAKES_FULL);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s-%s-%s-" ZBX_FS_SIZE_T ")", __func__,
 			gnutls_protocol_get_name(gnutls_protocol_get_version(s->tls_ctx->ctx)),
 			gnutls_kx_get_name(gnutls_kx_get(s->tls_ctx->ctx)),
@@ -1755,6 +1783,8 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		return FAIL;
 	}
 
+	zbx_tls_stats_update(ZBX_TLS_STATS_HANDSHAKES_FULL);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s-%s-%s-" ZBX_FS_SIZE_T ")", __func__,
 			gnutls_protocol_get_name(gnutls_protocol_get_version(s->tls_ctx->ctx)),
 			gnutls_kx_get_name(gnutls_kx_get(s->tls_ctx->ctx)),
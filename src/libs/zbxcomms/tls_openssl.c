@@ -213,6 +213,33 @@ static ZBX_THREAD_LOCAL char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN +
 /* buffer for messages produced by zbx_openssl_info_cb() */
 ZBX_THREAD_LOCAL char				info_buf[256];
 
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* only OpenSSL 1.1.1 or newer */
+#	define ZBX_TLS_RESUME_SESSIONS
+
+/* lifetime of resumable certificate-based TLS sessions in seconds */
+#	define ZBX_TLS_SESSION_TIMEOUT		600
+/* maximum number of sessions kept in client session cache */
+#	define ZBX_TLS_SESSION_CACHE_MAX	4096
+
+/* session ticket keys shared by all processes forked after zbx_tls_init_ticket_keys() */
+static unsigned char	ticket_keys[80];
+static long		ticket_keys_len = 0;
+
+typedef struct
+{
+	char		*key;
+	SSL_SESSION	*session;
+}
+zbx_tls_session_t;
+
+/* client session cache of outgoing certificate-based connections */
+static ZBX_THREAD_LOCAL zbx_hashset_t	*tls_sessions = NULL;
+#endif
+
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)	/* OpenSSL 3.0.0 or newer with kernel TLS */
+#	define ZBX_TLS_KTLS
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get state, alert, error information on TLS connection             *
@@ -808,6 +835,7 @@ void	zbx_tls_init_parent(zbx_get_program_type_f zbx_get_program_type_cb_arg)
 	zbx_get_program_type_cb = zbx_get_program_type_cb_arg;
 
 	zbx_tls_library_init(ZBX_TLS_INIT_THREADS);
+	zbx_tls_init_ticket_keys();
 }
 
 static const char	*zbx_ctx_name(SSL_CTX *param)
@@ -865,6 +893,270 @@ static int	zbx_set_ecdhe_parameters(SSL_CTX *ctx)
 	return ret;
 }
 
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+static void	tls_session_clean(void *data)
+{
+	zbx_tls_session_t	*cached = (zbx_tls_session_t *)data;
+
+	zbx_free(cached->key);
+	SSL_SESSION_free(cached->session);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: makes room in full client session cache                          *
+ *                                                                            *
+ * Comments: Expired sessions are removed. If there are none, an arbitrary    *
+ *           session is removed.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_sessions_evict(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_tls_session_t	*cached;
+	time_t			now;
+	int			removed = 0;
+
+	now = time(NULL);
+
+	zbx_hashset_iter_reset(tls_sessions, &iter);
+
+	while (NULL != (cached = (zbx_tls_session_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (now < (time_t)(SSL_SESSION_get_time(cached->session) + SSL_SESSION_get_timeout(cached->session)))
+			continue;
+
+		zbx_hashset_iter_remove(&iter);
+		removed++;
+	}
+
+	if (0 != removed)
+		return;
+
+	zbx_hashset_iter_reset(tls_sessions, &iter);
+
+	if (NULL != zbx_hashset_iter_next(&iter))
+		zbx_hashset_iter_remove(&iter);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stores new session of outgoing connection in client session cache *
+ *                                                                            *
+ * Return value:                                                              *
+ *     1 - the session is referenced by the cache                             *
+ *     0 - the session was not stored                                         *
+ *                                                                            *
+ * Comments:                                                                  *
+ *     This is a callback function, its arguments are defined in OpenSSL.     *
+ *     With TLS 1.3 it is called when a session ticket is received after the  *
+ *     handshake, usually while reading the response.                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	tls_session_new_cb(SSL *ssl, SSL_SESSION *session)
+{
+	const zbx_tls_context_t	*tls_ctx;
+	zbx_tls_session_t	*cached, session_local;
+
+	if (NULL == (tls_ctx = (const zbx_tls_context_t *)SSL_get_app_data(ssl)) || NULL == tls_ctx->session_key)
+		return 0;
+
+	if (NULL == tls_sessions)
+	{
+		tls_sessions = (zbx_hashset_t *)zbx_malloc(NULL, sizeof(zbx_hashset_t));
+		zbx_hashset_create_ext(tls_sessions, 100, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+				ZBX_DEFAULT_STR_COMPARE_FUNC, tls_session_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+				ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	session_local.key = tls_ctx->session_key;
+
+	if (NULL != (cached = (zbx_tls_session_t *)zbx_hashset_search(tls_sessions, &session_local)))
+	{
+		SSL_SESSION_free(cached->session);
+		cached->session = session;
+
+		return 1;
+	}
+
+	if (ZBX_TLS_SESSION_CACHE_MAX <= tls_sessions->num_data)
+		tls_sessions_evict();
+
+	session_local.key = zbx_strdup(NULL, tls_ctx->session_key);
+	session_local.session = session;
+	zbx_hashset_insert(tls_sessions, &session_local, sizeof(session_local));
+
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: offers cached session for resumption of outgoing connection       *
+ *                                                                            *
+ * Parameters: s           - [IN] socket with TLS context being connected     *
+ *             tls_arg1    - [IN] required certificate issuer                 *
+ *             tls_arg2    - [IN] required certificate subject                *
+ *             server_name - [IN] server name indication, can be NULL         *
+ *                                                                            *
+ * Comments: Sessions are cached per peer address and required peer           *
+ *           certificate attributes, the peer certificate of resumed session  *
+ *           is verified as usual after the handshake.                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_session_resume(zbx_socket_t *s, const char *tls_arg1, const char *tls_arg2,
+		const char *server_name)
+{
+	zbx_tls_session_t	*cached, session_local;
+
+	s->tls_ctx->session_key = zbx_dsprintf(NULL, "%s\n%s\n%s\n%s", s->peer, ZBX_NULL2EMPTY_STR(server_name),
+			ZBX_NULL2EMPTY_STR(tls_arg1), ZBX_NULL2EMPTY_STR(tls_arg2));
+
+	SSL_set_app_data(s->tls_ctx->ctx, s->tls_ctx);
+
+	if (NULL == tls_sessions)
+		return;
+
+	session_local.key = s->tls_ctx->session_key;
+
+	if (NULL == (cached = (zbx_tls_session_t *)zbx_hashset_search(tls_sessions, &session_local)))
+		return;
+
+	if (1 != SSL_SESSION_is_resumable(cached->session) || 1 != SSL_set_session(s->tls_ctx->ctx, cached->session))
+		zbx_hashset_remove_direct(tls_sessions, cached);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes session of failed outgoing connection from client        *
+ *          session cache                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_session_forget(const zbx_tls_context_t *tls_ctx)
+{
+	zbx_tls_session_t	session_local;
+
+	if (NULL == tls_sessions || NULL == tls_ctx->session_key)
+		return;
+
+	session_local.key = tls_ctx->session_key;
+	zbx_hashset_remove(tls_sessions, &session_local);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decides whether session from ticket sent by client can be        *
+ *          resumed                                                           *
+ *                                                                            *
+ * Comments:                                                                  *
+ *     This is a callback function, its arguments are defined in OpenSSL.     *
+ *                                                                            *
+ *     Only certificate-based sessions are resumed. Resumption of PSK-based   *
+ *     session would skip zbx_psk_server_cb() which looks up the PSK and its  *
+ *     usage in configuration cache for each connection.                      *
+ *                                                                            *
+ ******************************************************************************/
+static SSL_TICKET_RETURN	tls_decrypt_ticket_cb(SSL *ssl, SSL_SESSION *session, const unsigned char *keyname,
+		size_t keyname_length, SSL_TICKET_STATUS status, void *arg)
+{
+	ZBX_UNUSED(ssl);
+	ZBX_UNUSED(keyname);
+	ZBX_UNUSED(keyname_length);
+	ZBX_UNUSED(arg);
+
+	switch (status)
+	{
+		case SSL_TICKET_SUCCESS:
+		case SSL_TICKET_SUCCESS_RENEW:
+			if (NULL == SSL_SESSION_get0_peer(session))
+				return SSL_TICKET_RETURN_IGNORE;
+
+			return SSL_TICKET_SUCCESS == status ? SSL_TICKET_RETURN_USE : SSL_TICKET_RETURN_USE_RENEW;
+		case SSL_TICKET_EMPTY:
+		case SSL_TICKET_NO_DECRYPT:
+			return SSL_TICKET_RETURN_IGNORE_RENEW;
+		default:
+			return SSL_TICKET_RETURN_ABORT;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables resumption of certificate-based sessions with session     *
+ *          tickets                                                           *
+ *                                                                            *
+ * Comments: Client sessions are kept in client session cache of the process, *
+ *           OpenSSL internal session cache remains disabled. Tickets issued  *
+ *           by server are encrypted with keys shared by all processes.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_ctx_enable_resumption(SSL_CTX *ctx)
+{
+	long	keys_len;
+
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(ctx, tls_session_new_cb);
+	SSL_CTX_set_timeout(ctx, ZBX_TLS_SESSION_TIMEOUT);
+	SSL_CTX_set_session_ticket_cb(ctx, NULL, tls_decrypt_ticket_cb, NULL);
+
+	if (0 == ticket_keys_len)
+		return;
+
+	if (0 >= (keys_len = SSL_CTX_get_tlsext_ticket_keys(ctx, NULL, 0)) || ticket_keys_len < keys_len ||
+			1 != SSL_CTX_set_tlsext_ticket_keys(ctx, ticket_keys, keys_len))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot set session ticket keys for %s, sessions will be resumed only"
+				" by the same process", zbx_ctx_name(ctx));
+	}
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: warns in a parent process if kernel TLS offload is requested but  *
+ *          OpenSSL library does not support it                               *
+ *                                                                            *
+ * Comments: Logged once here rather than by zbx_tls_init_child() in every    *
+ *           child process.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_check_kernel_offload(const zbx_config_tls_t *config_tls)
+{
+#if defined(ZBX_TLS_KTLS)
+	ZBX_UNUSED(config_tls);
+#else
+	if (0 != config_tls->kernel_offload)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "parameter \"TLSKernelOffload\" is ignored: OpenSSL library was built"
+				" without kernel TLS support");
+	}
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates session ticket keys in a parent process, the keys are   *
+ *          inherited by child processes so that a session established with   *
+ *          one of them can be resumed with another                           *
+ *                                                                            *
+ * Comments: Forked processes cannot receive new keys, so the keys are not    *
+ *           rotated until restart. This trades forward secrecy of TLS 1.2    *
+ *           sessions for resumption across processes, see TLSCertFile in     *
+ *           server and proxy configuration files.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tls_init_ticket_keys(void)
+{
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+	if (1 != RAND_bytes(ticket_keys, sizeof(ticket_keys)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot generate TLS session ticket keys");
+		return;
+	}
+
+	ticket_keys_len = (long)sizeof(ticket_keys);
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: read available configuration parameters and initialize TLS        *
@@ -1150,14 +1442,20 @@ void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type
 
 		SSL_CTX_set_info_callback(ctx_cert, zbx_openssl_info_cb);
 
-		/* use server ciphersuite preference, do not use RFC 4507 ticket extension */
-		SSL_CTX_set_options(ctx_cert, SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_NO_TICKET);
+		/* use server ciphersuite preference */
+		SSL_CTX_set_options(ctx_cert, SSL_OP_CIPHER_SERVER_PREFERENCE);
 
 		/* do not connect to unpatched servers */
 		SSL_CTX_clear_options(ctx_cert, SSL_OP_LEGACY_SERVER_CONNECT);
 
-		/* disable session caching */
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+		/* resume sessions with session tickets */
+		tls_ctx_enable_resumption(ctx_cert);
+#else
+		/* do not use RFC 4507 ticket extension, disable session caching */
+		SSL_CTX_set_options(ctx_cert, SSL_OP_NO_TICKET);
 		SSL_CTX_set_session_cache_mode(ctx_cert, SSL_SESS_CACHE_OFF);
+#endif
 
 		/* try to enable ECDH ciphersuites */
 		if (SUCCEED == zbx_set_ecdhe_parameters(ctx_cert))
@@ -1323,9 +1621,15 @@ void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type
 			SSL_CTX_set_psk_server_callback(ctx_all, zbx_psk_server_cb);
 		}
 
-		SSL_CTX_set_options(ctx_all, SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_NO_TICKET);
+		SSL_CTX_set_options(ctx_all, SSL_OP_CIPHER_SERVER_PREFERENCE);
 		SSL_CTX_clear_options(ctx_all, SSL_OP_LEGACY_SERVER_CONNECT);
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+		/* certificate-based sessions can be resumed, PSK-based sessions are ignored in ticket callback */
+		tls_ctx_enable_resumption(ctx_all);
+#else
+		SSL_CTX_set_options(ctx_all, SSL_OP_NO_TICKET);
 		SSL_CTX_set_session_cache_mode(ctx_all, SSL_SESS_CACHE_OFF);
+#endif
 
 		if (SUCCEED == zbx_set_ecdhe_parameters(ctx_all))
 			ciphers = ZBX_CIPHERS_CERT_ECDHE ZBX_CIPHERS_CERT ":" ZBX_CIPHERS_PSK_ECDHE ZBX_CIPHERS_PSK;
@@ -1433,6 +1737,23 @@ void	zbx_tls_init_child(const zbx_config_tls_t *config_tls, zbx_get_program_type
 		goto out1;
 	}
 #endif /* defined(HAVE_OPENSSL_WITH_PSK) */
+#if defined(ZBX_TLS_KTLS)
+	/* without kernel TLS support the parameter was reported by zbx_tls_check_kernel_offload() in parent */
+	if (0 != config_tls->kernel_offload)
+	{
+		/* OpenSSL falls back to userspace encryption if kernel does not support negotiated ciphersuite */
+		if (NULL != ctx_cert)
+			SSL_CTX_set_options(ctx_cert, SSL_OP_ENABLE_KTLS);
+#if defined(HAVE_OPENSSL_WITH_PSK)
+		if (NULL != ctx_psk)
+			SSL_CTX_set_options(ctx_psk, SSL_OP_ENABLE_KTLS);
+
+		if (NULL != ctx_all)
+			SSL_CTX_set_options(ctx_all, SSL_OP_ENABLE_KTLS);
+#endif
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() kernel TLS offload enabled", __func__);
+	}
+#endif
 #ifndef _WINDOWS
 	zbx_sigmask(SIG_SETMASK, &orig_mask, NULL);
 #endif
@@ -1474,6 +1795,13 @@ void	zbx_tls_free(void)
 
 	if (NULL != ctx_all)
 		SSL_CTX_free(ctx_all);
+#endif
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+	if (NULL != tls_sessions)
+	{
+		zbx_hashset_destroy(tls_sessions);
+		zbx_free(tls_sessions);
+	}
 #endif
 	if (NULL != my_psk)
 	{
@@ -1485,6 +1813,49 @@ void	zbx_tls_free(void)
 	zbx_tls_library_deinit(ZBX_TLS_INIT_PROCESS);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts full and abbreviated handshakes of established connections *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_handshake_stats_update(const SSL *ssl)
+{
+	int	reused = SSL_session_reused(ssl);
+
+	zbx_tls_stats_update(1 == reused ? ZBX_TLS_STATS_HANDSHAKES_RESUMED : ZBX_TLS_STATS_HANDSHAKES_FULL);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() session %s", __func__, 1 == reused ? "resumed" : "established");
+}
+
+#if defined(ZBX_TLS_KTLS)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts and logs whether record encryption of established         *
+ *          connection was offloaded to kernel                                *
+ *                                                                            *
+ * Comments: OpenSSL enables kernel TLS separately for sending and receiving  *
+ *           after the handshake if kernel supports negotiated TLS version    *
+ *           and ciphersuite, otherwise records are processed by OpenSSL.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	tls_ktls_report(const zbx_socket_t *s)
+{
+	int	ktls_send, ktls_recv;
+
+	if (0 == (SSL_get_options(s->tls_ctx->ctx) & SSL_OP_ENABLE_KTLS))
+		return;
+
+	ktls_send = (int)BIO_get_ktls_send(SSL_get_wbio(s->tls_ctx->ctx));
+	ktls_recv = (int)BIO_get_ktls_recv(SSL_get_rbio(s->tls_ctx->ctx));
+
+	if (0 != ktls_send || 0 != ktls_recv)
+		zbx_tls_stats_update(ZBX_TLS_STATS_KTLS);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() connection with %s kernel TLS offload send:%s receive:%s", __func__,
+			s->peer, 0 != ktls_send ? "YES" : "NO", 0 != ktls_recv ? "YES" : "NO");
+}
+#endif
+
 static int	zbx_tls_get_error(const SSL *s, ssize_t res, const char *func, size_t *error_alloc,
 		size_t *error_offset, char **error)
 {
@@ -1599,6 +1970,7 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 	{
 		s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
 		s->tls_ctx->ctx = NULL;
+		s->tls_ctx->session_key = NULL;
 		initialized = 0;
 	}
 	else
@@ -1625,6 +1997,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
 				goto out;
 			}
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+			tls_session_resume(s, tls_arg1, tls_arg2, server_name);
+#endif
 		}
 	}
 	else if (ZBX_TCP_SEC_TLS_PSK == tls_connect)
@@ -1783,6 +2158,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 		{
 			zbx_snprintf_alloc(error, &error_alloc, &error_offset, "%s",
 					X509_verify_cert_error_string(verify_result));
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+			tls_session_forget(s->tls_ctx);
+#endif
 			zbx_tls_close(s);
 			goto out1;
 		}
@@ -1790,6 +2168,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 		/* if required verify peer certificate Issuer and Subject */
 		if (SUCCEED != zbx_verify_issuer_subject(s->tls_ctx, tls_arg1, tls_arg2, error))
 		{
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+			tls_session_forget(s->tls_ctx);
+#endif
 			zbx_tls_close(s);
 			goto out1;
 		}
@@ -1797,6 +2178,10 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 
 	s->connection_type = tls_connect;
 
+	tls_handshake_stats_update(s->tls_ctx->ctx);
+#if defined(ZBX_TLS_KTLS)
+	tls_ktls_report(s);
+#endif
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s)", __func__,
 			SSL_get_version(s->tls_ctx->ctx), SSL_get_cipher(s->tls_ctx->ctx));
 
@@ -1806,6 +2191,10 @@ out:	/* an error occurred */
 	if (NULL != s->tls_ctx->ctx)
 		SSL_free(s->tls_ctx->ctx);
 
+#if defined(ZBX_TLS_RESUME_SESSIONS)
+	tls_session_forget(s->tls_ctx);
+#endif
+	zbx_free(s->tls_ctx->session_key);
 	zbx_free(s->tls_ctx);
 out1:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s error:'%s'", __func__, zbx_result_string(ret),
@@ -1843,6 +2232,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
 	s->tls_ctx->ctx = NULL;
+	s->tls_ctx->session_key = NULL;
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
 	incoming_connection_has_psk = 0;	/* assume certificate-based connection by default */
@@ -2069,6 +2459,10 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		zbx_tls_close(s);
 		return FAIL;
 	}
+#endif
+	tls_handshake_stats_update(s->tls_ctx->ctx);
+#if defined(ZBX_TLS_KTLS)
+	tls_ktls_report(s);
 #endif
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s)", __func__,
 			SSL_get_version(s->tls_ctx->ctx), cipher_name);
@@ -2275,6 +2669,7 @@ void	zbx_tls_close(zbx_socket_t *s)
 		SSL_free(s->tls_ctx->ctx);
 	}
 
+	zbx_free(s->tls_ctx->session_key);
 	zbx_free(s->tls_ctx);
 }
 
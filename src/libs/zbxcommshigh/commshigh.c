@@ -528,11 +528,14 @@ static int	comms_check_redirect(const char *data, zbx_vector_addr_ptr_t *addrs,
  * Comments: If response contains valid redirect block the address list will  *
  *           be updated accordingly and connection will be retried with the   *
  *           new address.                                                     *
+ *           Flags are added to the protocol header of sent data, for example *
+ *           ZBX_TCP_COMPRESS to send compressed data.                        *
  *                                                                            *
  ******************************************************************************/
 int	zbx_comms_exchange_with_redirect(const char *source_ip, zbx_vector_addr_ptr_t *addrs, int timeout,
 		int connect_timeout, int retry_interval, int loglevel, const zbx_config_tls_t *config_tls,
-		const char *data, char *(*connect_callback)(void *), void *cb_data, char **out, char **error)
+		unsigned char flags, const char *data, char *(*connect_callback)(void *), void *cb_data, char **out,
+		char **error)
 {
 	zbx_socket_t		sock;
 	int			ret = FAIL, retries = 0, retry = ZBX_REDIRECT_NONE;
@@ -557,7 +560,7 @@ retry:
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() sending: %s", __func__, data);
 
-	if (SUCCEED != zbx_tcp_send(&sock, data))
+	if (SUCCEED != zbx_tcp_send_ext(&sock, data, strlen(data), 0, ZBX_TCP_PROTOCOL | flags, 0))
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "unable to send to [%s]:%d: %s",
 				addrs->values[0]->ip, addrs->values[0]->port, zbx_socket_strerror());
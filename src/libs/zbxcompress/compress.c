@@ -20,6 +20,15 @@
 #include "zlib.h"
 
 #define ZBX_COMPRESS_STRERROR_LEN	512
+#define ZBX_COMPRESS_CHUNK_SIZE		(64 * ZBX_KIBIBYTE)
+
+struct zbx_uncompress_stream
+{
+	z_stream	zs;
+	char		*out;
+	size_t		size_out;
+	int		finished;
+};
 
 static int	zbx_zlib_errno = 0;
 
@@ -72,20 +81,54 @@ const char	*zbx_compress_strerror(void)
  ******************************************************************************/
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
 {
-	Bytef	*buf;
-	uLongf	buf_size;
+	z_stream	zs;
+	char		*buf;
+	size_t		buf_alloc, buf_max, offset = 0, left = size_in;
+
+	memset(&zs, 0, sizeof(zs));
+
+	if (Z_OK != (zbx_zlib_errno = deflateInit(&zs, Z_DEFAULT_COMPRESSION)))
+		return FAIL;
+
+	/* start with estimated output size and grow it on demand instead of allocating the worst case size */
+	buf_max = compressBound(size_in);
+	buf_alloc = MIN(buf_max, MAX(size_in / 4, ZBX_COMPRESS_CHUNK_SIZE));
+	buf = (char *)zbx_malloc(NULL, buf_alloc);
+
+	zs.next_in = (Bytef *)(uintptr_t)in;
+
+	do
+	{
+		if (0 == zs.avail_in && 0 != left)
+		{
+			zs.avail_in = (uInt)MIN(left, UINT_MAX);
+			left -= zs.avail_in;
+		}
+
+		if (offset == buf_alloc)
+		{
+			buf_alloc = MIN(buf_alloc * 2, MAX(buf_max, buf_alloc + ZBX_COMPRESS_CHUNK_SIZE));
+			buf = (char *)zbx_realloc(buf, buf_alloc);
+		}
+
+		zs.next_out = (Bytef *)buf + offset;
+		zs.avail_out = (uInt)MIN(buf_alloc - offset, UINT_MAX);
 
-	buf_size = compressBound(size_in);
-	buf = (Bytef *)zbx_malloc(NULL, buf_size);
+		zbx_zlib_errno = deflate(&zs, 0 == left ? Z_FINISH : Z_NO_FLUSH);
+		offset = (size_t)((char *)zs.next_out - buf);
+	}
+	while (Z_OK == zbx_zlib_errno || (Z_BUF_ERROR == zbx_zlib_errno && offset == buf_alloc));
+
+	deflateEnd(&zs);
 
-	if (Z_OK != (zbx_zlib_errno = compress(buf, &buf_size, (const Bytef *)in, size_in)))
+	if (Z_STREAM_END != zbx_zlib_errno)
 	{
 		zbx_free(buf);
 		return FAIL;
 	}
 
-	*out = (char *)buf;
-	*size_out = buf_size;
+	*out = buf;
+	*size_out = offset;
 
 	return SUCCEED;
 }
@@ -115,6 +158,121 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates stream for uncompressing data received in chunks          *
+ *                                                                            *
+ * Parameters: out      - [IN] the output buffer                              *
+ *             size_out - [IN] the output buffer size                         *
+ *                                                                            *
+ * Return value: created stream or NULL in the case of failure                *
+ *                                                                            *
+ * Comments: Data is uncompressed directly into the output buffer, so the     *
+ *           compressed data does not need to be buffered as a whole.         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	zbx_uncompress_stream_t	*stream;
+
+	stream = (zbx_uncompress_stream_t *)zbx_malloc(NULL, sizeof(zbx_uncompress_stream_t));
+	memset(&stream->zs, 0, sizeof(stream->zs));
+
+	if (Z_OK != (zbx_zlib_errno = inflateInit(&stream->zs)))
+	{
+		zbx_free(stream);
+		return NULL;
+	}
+
+	stream->out = out;
+	stream->size_out = size_out;
+	stream->finished = 0;
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompresses next chunk of data                                   *
+ *                                                                            *
+ * Parameters: stream  - [IN] the uncompress stream                           *
+ *             in      - [IN] the data chunk to uncompress                    *
+ *             size_in - [IN] the data chunk size                             *
+ *                                                                            *
+ * Return value: SUCCEED - the data was uncompressed successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_update(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	const char	*end = in + size_in;
+
+	stream->zs.next_in = (Bytef *)(uintptr_t)in;
+
+	while ((const char *)stream->zs.next_in != end)
+	{
+		size_t	offset;
+
+		if (0 != stream->finished)
+		{
+			zbx_zlib_errno = Z_DATA_ERROR;
+			return FAIL;
+		}
+
+		offset = stream->zs.total_out;
+
+		stream->zs.avail_in = (uInt)MIN((size_t)(end - (const char *)stream->zs.next_in), UINT_MAX);
+		stream->zs.next_out = (Bytef *)stream->out + offset;
+		stream->zs.avail_out = (uInt)MIN(stream->size_out - offset, UINT_MAX);
+
+		switch (zbx_zlib_errno = inflate(&stream->zs, Z_NO_FLUSH))
+		{
+			case Z_STREAM_END:
+				stream->finished = 1;
+				break;
+			case Z_OK:
+				break;
+			case Z_NEED_DICT:
+				zbx_zlib_errno = Z_DATA_ERROR;
+				return FAIL;
+			default:
+				return FAIL;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes uncompressing data                                       *
+ *                                                                            *
+ * Parameters: stream   - [IN] the uncompress stream                          *
+ *             size_out - [OUT] the uncompressed data size                    *
+ *                                                                            *
+ * Return value: SUCCEED - the compressed data was complete                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	if (0 == stream->finished)
+	{
+		zbx_zlib_errno = Z_DATA_ERROR;
+		return FAIL;
+	}
+
+	*size_out = stream->zs.total_out;
+
+	return SUCCEED;
+}
+
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	inflateEnd(&stream->zs);
+	zbx_free(stream);
+}
+
 #else
 
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
@@ -135,6 +293,33 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 	return FAIL;
 }
 
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	ZBX_UNUSED(out);
+	ZBX_UNUSED(size_out);
+	return NULL;
+}
+
+int	zbx_uncompress_stream_update(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(in);
+	ZBX_UNUSED(size_in);
+	return FAIL;
+}
+
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(size_out);
+	return FAIL;
+}
+
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+}
+
 const char	*zbx_compress_strerror(void)
 {
 	return "";
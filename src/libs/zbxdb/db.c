@@ -28,6 +28,7 @@
 #	include "zbxdbschema.h"
 #	include "oci.h"
 #elif defined(HAVE_POSTGRESQL)
+#	include "zbxalgo.h"
 #	include <libpq-fe.h>
 #elif defined(HAVE_SQLITE3)
 #	include <sqlite3.h>
@@ -104,11 +105,42 @@ static ub4	OCI_DBserver_status(void);
 #define ZBX_PG_UNIQUE_VIOLATION	"23505"
 #define ZBX_PG_DEADLOCK		"40P01"
 
+/* the maximum number of named prepared statements kept per connection */
+#define ZBX_PG_STATEMENTS_MAX	256
+
+typedef struct
+{
+	char	*sql;
+	char	name[16];
+}
+zbx_pg_statement_t;
+
+#if defined(LIBPQ_HAS_PIPELINING)
+/* the maximum number of commands queued in pipeline before their results are collected */
+#define ZBX_PG_PIPELINE_MAX	1000
+
+typedef struct
+{
+	char	*sql;
+	int	prepare;	/* 1 - statement preparation, 0 - statement execution */
+}
+zbx_pg_pipeline_cmd_t;
+#endif
+
 static PGconn			*conn = NULL;
 static int			ZBX_TSDB_VERSION = -1;
 static zbx_uint32_t		ZBX_PG_SVERSION = ZBX_DBVERSION_UNDEFINED;
 char				ZBX_PG_ESCAPE_BACKSLASH = 1;
 static int 			ZBX_TIMESCALE_COMPRESSION_AVAILABLE = OFF;
+static int			pg_prepared_statements = 0;
+static zbx_hashset_t		pg_statements;	/* prepared statements of the current connection */
+static int			pg_statements_created = 0;
+static int			pg_statements_seq = 0;
+#if defined(LIBPQ_HAS_PIPELINING)
+static int			pg_pipeline_txn = 0;	/* statements of the current transaction are pipelined */
+static zbx_vector_ptr_t		pg_pipeline_cmds;	/* commands sent in pipeline, waiting for results */
+static int			pg_pipeline_created = 0;
+#endif
 #elif defined(HAVE_SQLITE3)
 static sqlite3			*conn = NULL;
 static zbx_mutex_t		sqlite_access = ZBX_MUTEX_NULL;
@@ -392,6 +424,238 @@ static int	is_recoverable_postgresql_error(const PGconn *pg_conn, const PGresult
 
 	return FAIL;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks result of non-select statement execution                   *
+ *                                                                            *
+ * Parameters: result - [IN] statement result                                 *
+ *             sql    - [IN] statement text for error logging                 *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or ZBX_DB_OK (on success)                                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	pg_check_command_result(const PGresult *result, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	if (NULL == result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	if (PGRES_COMMAND_OK == PQresultStatus(result))
+		return ZBX_DB_OK;
+
+	zbx_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
+		errcode = ERR_Z3008;
+	else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
+		errcode = ERR_Z3009;
+	else
+		errcode = ERR_Z3005;
+
+	zbx_db_errlog(errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
+
+static void	pg_statement_clean(void *data)
+{
+	zbx_free(((zbx_pg_statement_t *)data)->sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: forgets cached prepared statements, must be called when database  *
+ *          connection is closed or reopened                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	pg_statements_reset(void)
+{
+	if (0 != pg_statements_created)
+		zbx_hashset_clear(&pg_statements);
+}
+
+#if defined(LIBPQ_HAS_PIPELINING)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes statement from prepared statement cache                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	pg_statement_remove(const char *sql)
+{
+	zbx_pg_statement_t	stmt_local;
+
+	stmt_local.sql = (char *)sql;
+	zbx_hashset_remove(&pg_statements, &stmt_local);
+}
+
+static void	pg_pipeline_cmd_free(void *data)
+{
+	zbx_pg_pipeline_cmd_t	*cmd = (zbx_pg_pipeline_cmd_t *)data;
+
+	zbx_free(cmd->sql);
+	zbx_free(cmd);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: forgets commands sent in pipeline, must be called when database   *
+ *          connection is closed or reopened                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	pg_pipeline_reset(void)
+{
+	pg_pipeline_txn = 0;
+
+	if (0 != pg_pipeline_created)
+		zbx_vector_ptr_clear_ext(&pg_pipeline_cmds, pg_pipeline_cmd_free);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enters pipeline mode if it is not active yet                      *
+ *                                                                            *
+ * Return value: ZBX_DB_OK or ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on       *
+ *               recoverable error)                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	pg_pipeline_begin(void)
+{
+	if (PQ_PIPELINE_OFF != PQpipelineStatus(conn))
+		return ZBX_DB_OK;
+
+	if (1 != PQenterPipelineMode(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "entering pipeline mode");
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	if (0 == pg_pipeline_created)
+	{
+		zbx_vector_ptr_create(&pg_pipeline_cmds);
+		pg_pipeline_created = 1;
+	}
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: registers command sent in pipeline to collect its result later    *
+ *                                                                            *
+ * Parameters: sql     - [IN] statement text                                  *
+ *             prepare - [IN] 1 - statement preparation                       *
+ *                            0 - statement execution                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	pg_pipeline_add_cmd(const char *sql, int prepare)
+{
+	zbx_pg_pipeline_cmd_t	*cmd;
+
+	cmd = (zbx_pg_pipeline_cmd_t *)zbx_malloc(NULL, sizeof(zbx_pg_pipeline_cmd_t));
+	cmd->sql = zbx_strdup(NULL, sql);
+	cmd->prepare = prepare;
+	zbx_vector_ptr_append(&pg_pipeline_cmds, cmd);
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: collects results of commands sent in pipeline and leaves          *
+ *          pipeline mode                                                     *
+ *                                                                            *
+ * Return value: ZBX_DB_OK or ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on       *
+ *               recoverable error)                                           *
+ *                                                                            *
+ * Comments: Failure of any pipelined command fails the current transaction.  *
+ *           Connection is used in blocking mode - results are small and the  *
+ *           number of pending commands is limited, so sending cannot         *
+ *           deadlock with the server waiting for results to be read.         *
+ *                                                                            *
+ ******************************************************************************/
+static int	pg_pipeline_sync(void)
+{
+	int	ret = ZBX_DB_OK;
+#if defined(LIBPQ_HAS_PIPELINING)
+	int		i;
+	PGresult	*result;
+
+	if (NULL == conn || PQ_PIPELINE_OFF == PQpipelineStatus(conn))
+		return ZBX_DB_OK;
+
+	if (1 != PQpipelineSync(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "pipeline synchronization");
+		ret = CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+		goto out;
+	}
+
+	for (i = 0; i < pg_pipeline_cmds.values_num; i++)
+	{
+		zbx_pg_pipeline_cmd_t	*cmd = (zbx_pg_pipeline_cmd_t *)pg_pipeline_cmds.values[i];
+		int			rc = ZBX_DB_FAIL;
+
+		if (NULL == (result = PQgetResult(conn)))
+		{
+			ret = pg_check_command_result(NULL, cmd->sql);
+			break;
+		}
+
+		/* commands following the failed one are skipped by server without reporting errors */
+		if (PGRES_PIPELINE_ABORTED != PQresultStatus(result))
+			rc = pg_check_command_result(result, cmd->sql);
+
+		PQclear(result);
+
+		if (ZBX_DB_OK != rc)
+		{
+			if (ZBX_DB_OK == ret)
+				ret = rc;
+
+			if (0 != cmd->prepare)
+				pg_statement_remove(cmd->sql);
+		}
+
+		/* results of each command are terminated by NULL */
+		while (NULL != (result = PQgetResult(conn)))
+			PQclear(result);
+	}
+
+	if (i == pg_pipeline_cmds.values_num)
+	{
+		if (NULL == (result = PQgetResult(conn)) || PGRES_PIPELINE_SYNC != PQresultStatus(result))
+		{
+			zbx_db_errlog(ERR_Z3005, 0, "unexpected pipeline synchronization result",
+					"pipeline synchronization");
+			ret = ZBX_DB_DOWN;
+		}
+
+		PQclear(result);
+	}
+
+	if (1 != PQexitPipelineMode(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "leaving pipeline mode");
+		ret = ZBX_DB_DOWN;
+	}
+out:
+	zbx_vector_ptr_clear_ext(&pg_pipeline_cmds, pg_pipeline_cmd_free);
+
+	if (ZBX_DB_OK != ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "pipelined query failed, setting transaction as failed");
+		txn_error = ret;
+	}
+#endif
+	return ret;
+}
 #endif
 
 /******************************************************************************
@@ -786,6 +1050,12 @@ int	zbx_db_connect_basic(const zbx_config_dbhigh_t *cfg)
 	keywords[i] = NULL;
 	values[i] = NULL;
 
+	pg_statements_reset();
+#if defined(LIBPQ_HAS_PIPELINING)
+	pg_pipeline_reset();
+#endif
+	pg_prepared_statements = cfg->config_db_prepared_statements;
+
 	conn = PQconnectdbParams(keywords, values, 0);
 
 	zbx_free(cport);
@@ -1005,6 +1275,11 @@ void	zbx_db_close_basic(void)
 		PQfinish(conn);
 		conn = NULL;
 	}
+
+	pg_statements_reset();
+#if defined(LIBPQ_HAS_PIPELINING)
+	pg_pipeline_reset();
+#endif
 #elif defined(HAVE_SQLITE3)
 	if (NULL != conn)
 	{
@@ -1071,6 +1346,10 @@ int	zbx_db_commit_basic(void)
 		assert(0);
 	}
 
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	pg_pipeline_txn = 0;
+	(void)pg_pipeline_sync();
+#endif
 	if (ZBX_DB_OK != txn_error)
 		return ZBX_DB_FAIL; /* commit called on failed transaction */
 
@@ -1117,6 +1396,10 @@ int	zbx_db_rollback_basic(void)
 		assert(0);
 	}
 
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	pg_pipeline_txn = 0;
+	(void)pg_pipeline_sync();
+#endif
 	last_txn_error = txn_error;
 
 	/* allow rollback of failed transaction */
@@ -1483,7 +1766,6 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	sword		err = OCI_SUCCESS;
 #elif defined(HAVE_POSTGRESQL)
 	PGresult	*result;
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		err;
 	char		*error = NULL;
@@ -1497,6 +1779,10 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	if (0 == txn_level)
 		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
 
+#if defined(HAVE_POSTGRESQL)
+	/* statements without parameters are not pipelined, results of pipelined ones must be collected first */
+	(void)pg_pipeline_sync();
+#endif
 	if (ZBX_DB_OK != txn_error)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
@@ -1575,31 +1861,7 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 #elif defined(HAVE_POSTGRESQL)
 	result = PQexec(conn,sql);
 
-	if (NULL == result)
-	{
-		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
-		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
-	}
-	else if (PGRES_COMMAND_OK != PQresultStatus(result))
-	{
-		zbx_err_codes_t	errcode;
-
-		zbx_postgresql_error(&error, result);
-
-		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
-			errcode = ERR_Z3008;
-		else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
-			errcode = ERR_Z3009;
-		else
-			errcode = ERR_Z3005;
-
-		zbx_db_errlog(errcode, 0, error, sql);
-		zbx_free(error);
-
-		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
-	}
-
-	if (ZBX_DB_OK == ret)
+	if (ZBX_DB_OK == (ret = pg_check_command_result(result, sql)))
 		ret = atoi(PQcmdTuples(result));
 
 	PQclear(result);
@@ -1662,6 +1924,230 @@ clean:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables pipelining of statements with parameters till the end of  *
+ *          the current transaction                                           *
+ *                                                                            *
+ * Comments: Pipelined statements are sent without waiting for their results, *
+ *           which are collected when statement without parameters or select  *
+ *           is executed or the transaction ends, so the number of affected   *
+ *           rows is not reported. Requires prepared statements to be enabled *
+ *           and PostgreSQL 14 or newer client library, otherwise statements  *
+ *           are executed synchronously.                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_pipeline_enable(void)
+{
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	if (0 < txn_level && 0 != pg_prepared_statements)
+		pg_pipeline_txn = 1;
+#endif
+}
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if statements with parameters are executed as named        *
+ *          prepared statements                                               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_prepared_statements_enabled(void)
+{
+	return 0 != pg_prepared_statements ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds cached prepared statement or prepares a new one             *
+ *                                                                            *
+ * Parameters: sql        - [IN] statement with $1 ... $N parameters          *
+ *             params_num - [IN] number of parameters                         *
+ *             stmt       - [OUT] prepared statement or NULL if statement     *
+ *                                must be executed unnamed                    *
+ *                                                                            *
+ * Return value: ZBX_DB_OK or ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on       *
+ *               recoverable error)                                           *
+ *                                                                            *
+ * Comments: In pipeline mode the statement is cached before its preparation  *
+ *           result is known and is removed from cache if preparation fails.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	pg_statement_get(const char *sql, int params_num, zbx_pg_statement_t **stmt)
+{
+	zbx_pg_statement_t	stmt_local;
+	PGresult		*result;
+	int			ret;
+
+	if (0 == pg_statements_created)
+	{
+		zbx_hashset_create_ext(&pg_statements, 0, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+				ZBX_DEFAULT_STR_COMPARE_FUNC, pg_statement_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+				ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+		pg_statements_created = 1;
+	}
+
+	stmt_local.sql = (char *)sql;
+
+	if (NULL != (*stmt = (zbx_pg_statement_t *)zbx_hashset_search(&pg_statements, &stmt_local)))
+		return ZBX_DB_OK;
+
+	/* when the cache is full statement is executed unnamed, being parsed and planned every time */
+	if (ZBX_PG_STATEMENTS_MAX <= pg_statements.num_data)
+		return ZBX_DB_OK;
+
+	zbx_snprintf(stmt_local.name, sizeof(stmt_local.name), "zbx_stmt_%d", ++pg_statements_seq);
+
+#if defined(LIBPQ_HAS_PIPELINING)
+	if (0 != pg_pipeline_txn)
+	{
+		if (1 != PQsendPrepare(conn, stmt_local.name, sql, params_num, NULL))
+		{
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+			return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+		}
+
+		pg_pipeline_add_cmd(sql, 1);
+	}
+	else
+#endif
+	{
+		result = PQprepare(conn, stmt_local.name, sql, params_num, NULL);
+		ret = pg_check_command_result(result, sql);
+		PQclear(result);
+
+		if (ZBX_DB_OK != ret)
+			return ret;
+	}
+
+	stmt_local.sql = zbx_strdup(NULL, sql);
+	*stmt = (zbx_pg_statement_t *)zbx_hashset_insert(&pg_statements, &stmt_local, sizeof(stmt_local));
+
+	return ZBX_DB_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: Execute SQL statement with parameters. For non-select statements  *
+ *          only.                                                             *
+ *                                                                            *
+ * Parameters: sql        - [IN] statement with $1 ... $N parameters          *
+ *             params_num - [IN] number of parameters                         *
+ *             params     - [IN] parameter values in text format, NULL        *
+ *                               pointer for SQL NULL value                   *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows affected (on success)                      *
+ *                                                                            *
+ * Comments: The statement is parsed and planned by database on the first     *
+ *           execution and afterwards reused by name for the lifetime of the  *
+ *           connection. Statement text is the cache key, so the text must    *
+ *           depend only on the statement shape and not on the values.        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_execute_prepared_basic(const char *sql, int params_num, const char * const *params)
+{
+	char			*sql_printable = NULL;
+	int			ret = ZBX_DB_OK;
+	double			sec = 0;
+	PGresult		*result;
+	zbx_pg_statement_t	*stmt = NULL;
+#if defined(LIBPQ_HAS_PIPELINING)
+	int			rc;
+#endif
+
+	if (0 != config_log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				db_replace_nonprintable_chars(sql, &sql_printable));
+		ret = ZBX_DB_FAIL;
+		goto clean;
+	}
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", txn_level,
+				db_replace_nonprintable_chars(sql, &sql_printable));
+
+		for (int i = 0; i < params_num; i++)
+		{
+			char	*param_printable = NULL;
+
+			zabbix_log(LOG_LEVEL_DEBUG, "  $%d [%s]", i + 1, NULL == params[i] ? "null" :
+					db_replace_nonprintable_chars(params[i], &param_printable));
+			zbx_free(param_printable);
+		}
+	}
+
+#if defined(LIBPQ_HAS_PIPELINING)
+	if (0 != pg_pipeline_txn && ZBX_DB_OK != (ret = pg_pipeline_begin()))
+		goto out;
+#endif
+	if (0 != pg_prepared_statements && ZBX_DB_OK != (ret = pg_statement_get(sql, params_num, &stmt)))
+		goto out;
+
+#if defined(LIBPQ_HAS_PIPELINING)
+	if (0 != pg_pipeline_txn)
+	{
+		if (NULL != stmt)
+			rc = PQsendQueryPrepared(conn, stmt->name, params_num, params, NULL, NULL, 0);
+		else
+			rc = PQsendQueryParams(conn, sql, params_num, NULL, params, NULL, NULL, 0);
+
+		if (1 != rc)
+		{
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+			ret = CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+			goto out;
+		}
+
+		pg_pipeline_add_cmd(sql, 0);
+
+		if (ZBX_PG_PIPELINE_MAX <= pg_pipeline_cmds.values_num)
+			ret = pg_pipeline_sync();
+
+		goto out;
+	}
+#endif
+	if (NULL != stmt)
+		result = PQexecPrepared(conn, stmt->name, params_num, params, NULL, NULL, 0);
+	else
+		result = PQexecParams(conn, sql, params_num, NULL, params, NULL, NULL, 0);
+
+	if (ZBX_DB_OK == (ret = pg_check_command_result(result, sql)))
+		ret = atoi(PQcmdTuples(result));
+
+	PQclear(result);
+out:
+	if (0 != config_log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)config_log_slow_queries / 1000.0)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec,
+					db_replace_nonprintable_chars(sql, &sql_printable));
+		}
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed",
+				db_replace_nonprintable_chars(sql, &sql_printable));
+		txn_error = ZBX_DB_FAIL;
+	}
+clean:
+	zbx_free(sql_printable);
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -1691,6 +2177,9 @@ zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args)
 
 	sql = zbx_dvsprintf(sql, fmt, args);
 
+#if defined(HAVE_POSTGRESQL)
+	(void)pg_pipeline_sync();
+#endif
 	if (ZBX_DB_OK != txn_error)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
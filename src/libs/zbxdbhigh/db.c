@@ -158,6 +158,7 @@ zbx_config_dbhigh_t	*zbx_config_dbhigh_new(void)
 
 	config_dbhigh = (zbx_config_dbhigh_t *)zbx_malloc(NULL, sizeof(zbx_config_dbhigh_t));
 	memset(config_dbhigh, 0, sizeof(zbx_config_dbhigh_t));
+	config_dbhigh->config_db_prepared_statements = 1;
 
 	return config_dbhigh;
 }
@@ -483,6 +484,37 @@ int	zbx_db_execute_once(const char *fmt, ...)
 	return rc;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute a non-select statement with parameters                    *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_execute_prepared(const char *sql, int params_num, const char * const *params)
+{
+	int	rc;
+
+	rc = zbx_db_execute_prepared_basic(sql, params_num, params);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_db_close();
+		zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_execute_prepared_basic(sql, params_num, params)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: check if numeric field value is null                              *
@@ -2822,7 +2854,8 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, zbx_db_value_t **values
 			case ZBX_TYPE_SHORTTEXT:
 			case ZBX_TYPE_CUID:
 			case ZBX_TYPE_BLOB:
-#ifdef HAVE_ORACLE
+#if defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
+				/* PostgreSQL values are escaped when building statement text if necessary */
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
@@ -2911,6 +2944,253 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
 	zbx_vector_ptr_destroy(&values);
 }
 
+#if defined(HAVE_POSTGRESQL)
+static void	db_array_add_delim(char **array, size_t *array_alloc, size_t *array_offset)
+{
+	zbx_chrcpy_alloc(array, array_alloc, array_offset, 0 == *array_offset ? '{' : ',');
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds element to array literal used as statement parameter        *
+ *                                                                            *
+ * Parameters: array        - [IN/OUT] array literal being built              *
+ *             array_alloc  - [IN/OUT]                                        *
+ *             array_offset - [IN/OUT] 0 for empty array                      *
+ *             value        - [IN] element value                              *
+ *                                                                            *
+ * Comments: The array literal must be finished by zbx_db_array_close().      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_array_add_str(char **array, size_t *array_alloc, size_t *array_offset, const char *value)
+{
+	const char	*ptr;
+
+	db_array_add_delim(array, array_alloc, array_offset);
+	zbx_chrcpy_alloc(array, array_alloc, array_offset, '"');
+
+	while ('\0' != *(ptr = value + strcspn(value, "\"\\")))
+	{
+		zbx_strncpy_alloc(array, array_alloc, array_offset, value, (size_t)(ptr - value));
+		zbx_chrcpy_alloc(array, array_alloc, array_offset, '\\');
+		zbx_chrcpy_alloc(array, array_alloc, array_offset, *ptr);
+		value = ptr + 1;
+	}
+
+	zbx_strcpy_alloc(array, array_alloc, array_offset, value);
+	zbx_chrcpy_alloc(array, array_alloc, array_offset, '"');
+}
+
+void	zbx_db_array_add_uint64(char **array, size_t *array_alloc, size_t *array_offset, zbx_uint64_t value)
+{
+	db_array_add_delim(array, array_alloc, array_offset);
+	zbx_snprintf_alloc(array, array_alloc, array_offset, ZBX_FS_UI64, value);
+}
+
+void	zbx_db_array_add_int(char **array, size_t *array_alloc, size_t *array_offset, int value)
+{
+	db_array_add_delim(array, array_alloc, array_offset);
+	zbx_snprintf_alloc(array, array_alloc, array_offset, "%d", value);
+}
+
+void	zbx_db_array_add_dbl(char **array, size_t *array_alloc, size_t *array_offset, double value)
+{
+	db_array_add_delim(array, array_alloc, array_offset);
+	zbx_snprintf_alloc(array, array_alloc, array_offset, ZBX_FS_DBL64_SQL, value);
+}
+
+void	zbx_db_array_add_null(char **array, size_t *array_alloc, size_t *array_offset)
+{
+	db_array_add_delim(array, array_alloc, array_offset);
+	zbx_strcpy_alloc(array, array_alloc, array_offset, "NULL");
+}
+
+void	zbx_db_array_close(char **array, size_t *array_alloc, size_t *array_offset)
+{
+	if (0 == *array_offset)
+		zbx_chrcpy_alloc(array, array_alloc, array_offset, '{');
+
+	zbx_chrcpy_alloc(array, array_alloc, array_offset, '}');
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns PostgreSQL array type of the specified field              *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*db_array_type(const zbx_db_field_t *field)
+{
+	switch (field->type)
+	{
+		case ZBX_TYPE_ID:
+			return "bigint[]";
+		case ZBX_TYPE_INT:
+			return "integer[]";
+		case ZBX_TYPE_UINT:
+			return "numeric[]";
+		case ZBX_TYPE_FLOAT:
+			return "double precision[]";
+		case ZBX_TYPE_CHAR:
+		case ZBX_TYPE_TEXT:
+		case ZBX_TYPE_SHORTTEXT:
+		case ZBX_TYPE_LONGTEXT:
+		case ZBX_TYPE_CUID:
+			return "text[]";
+		default:
+			return NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if bulk insert can be executed as prepared statement with  *
+ *          array parameters                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_is_prepared(const zbx_db_insert_t *self)
+{
+	if (SUCCEED != zbx_db_prepared_statements_enabled())
+		return FAIL;
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		if (NULL == db_array_type(self->fields.values[i]))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes bulk insert as prepared statement passing each column    *
+ *          values in single array parameter                                  *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: SUCCEED if the operation completed successfully or           *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: The statement text depends only on table and fields, so it is    *
+ *           parsed and planned once per connection regardless of the number  *
+ *           of rows.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_execute_prepared(const zbx_db_insert_t *self)
+{
+	char	*sql = NULL, **params;
+	size_t	sql_alloc = 0, sql_offset = 0, *params_alloc, *params_offset, params_size = 0;
+	int	ret = SUCCEED, i, j;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "insert into %s (", self->table->table);
+
+	for (j = 0; j < self->fields.values_num; j++)
+	{
+		if (0 != j)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, self->fields.values[j]->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") select ");
+
+	for (j = 0; j < self->fields.values_num; j++)
+	{
+		if (0 != j)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (0 != (self->fields.values[j]->flags & ZBX_UPPER))
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "upper(c%d)", j + 1);
+		else
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "c%d", j + 1);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " from unnest(");
+
+	for (j = 0; j < self->fields.values_num; j++)
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%s$%d::%s", 0 != j ? "," : "", j + 1,
+				db_array_type(self->fields.values[j]));
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") as t(");
+
+	for (j = 0; j < self->fields.values_num; j++)
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%sc%d", 0 != j ? "," : "", j + 1);
+
+	zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ')');
+
+	params = (char **)zbx_calloc(NULL, (size_t)self->fields.values_num, sizeof(char *));
+	params_alloc = (size_t *)zbx_calloc(NULL, (size_t)self->fields.values_num, sizeof(size_t));
+	params_offset = (size_t *)zbx_calloc(NULL, (size_t)self->fields.values_num, sizeof(size_t));
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = self->rows.values[i];
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+			size_t			offset = params_offset[j];
+
+			switch (self->fields.values[j]->type)
+			{
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+						zbx_db_array_add_null(&params[j], &params_alloc[j], &params_offset[j]);
+					else
+						zbx_db_array_add_uint64(&params[j], &params_alloc[j], &params_offset[j],
+								value->ui64);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_db_array_add_uint64(&params[j], &params_alloc[j], &params_offset[j],
+							value->ui64);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_db_array_add_int(&params[j], &params_alloc[j], &params_offset[j], value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_db_array_add_dbl(&params[j], &params_alloc[j], &params_offset[j], value->dbl);
+					break;
+				default:
+					zbx_db_array_add_str(&params[j], &params_alloc[j], &params_offset[j], value->str);
+					break;
+			}
+
+			params_size += params_offset[j] - offset;
+		}
+
+		/* limit parameter size similarly to overflowed multi-row inserts */
+		if (i + 1 != self->rows.values_num && ZBX_MAX_OVERFLOW_SQL_SIZE >= params_size)
+			continue;
+
+		for (j = 0; j < self->fields.values_num; j++)
+			zbx_db_array_close(&params[j], &params_alloc[j], &params_offset[j]);
+
+		if (ZBX_DB_OK > zbx_db_execute_prepared(sql, self->fields.values_num, (const char * const *)params))
+		{
+			ret = FAIL;
+			break;
+		}
+
+		for (j = 0; j < self->fields.values_num; j++)
+			params_offset[j] = 0;
+
+		params_size = 0;
+	}
+
+	for (j = 0; j < self->fields.values_num; j++)
+		zbx_free(params[j]);
+
+	zbx_free(params_offset);
+	zbx_free(params_alloc);
+	zbx_free(params);
+	zbx_free(sql);
+
+	return ret;
+}
+#endif
+
 #if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
 /******************************************************************************
  *                                                                            *
@@ -2968,6 +3248,8 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 #	ifdef HAVE_MYSQL
 	char		*sql_values = NULL;
 	size_t		sql_values_alloc = 0, sql_values_offset = 0;
+#	elif defined(HAVE_POSTGRESQL)
+	char		*value_esc;
 #	endif
 #else
 	zbx_db_bind_context_t	*contexts;
@@ -2996,6 +3278,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		self->autoincrement = -1;
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (SUCCEED == db_insert_is_prepared(self))
+		return db_insert_execute_prepared(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -3151,8 +3438,13 @@ retry_oracle:
 					}
 					else
 						zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
-
+#	ifdef HAVE_POSTGRESQL
+					value_esc = zbx_db_dyn_escape_string(value->str);
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value_esc);
+					zbx_free(value_esc);
+#	else
 					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+#	endif
 
 					if (0 != (field->flags & ZBX_UPPER))
 					{
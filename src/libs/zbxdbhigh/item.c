@@ -72,3 +72,151 @@ void	zbx_db_save_item_changes(char **sql, size_t *sql_alloc, size_t *sql_offset,
 		zbx_db_execute_overflowed_sql(sql, sql_alloc, sql_offset);
 	}
 }
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: save item state, error, mtime, lastlogsize changes to database    *
+ *          with single prepared statement per combination of changed         *
+ *          columns                                                           *
+ *                                                                            *
+ * Parameters: item_diff - [IN] item changes, the same item must not be       *
+ *                              listed more than once                         *
+ *             mask      - [IN] changes to save                               *
+ *                                                                            *
+ * Return value: SUCCEED - the changes were saved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_save_item_changes_prepared(const zbx_vector_item_diff_ptr_t *item_diff, zbx_uint64_t mask)
+{
+#define ITEM_DIFF_COLUMNS_NUM	4
+	static const struct
+	{
+		zbx_uint64_t	flag;
+		const char	*name;
+		const char	*type;
+	}
+	columns[ITEM_DIFF_COLUMNS_NUM] = {
+		{ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTLOGSIZE, "lastlogsize", "numeric[]"},
+		{ZBX_FLAGS_ITEM_DIFF_UPDATE_MTIME, "mtime", "integer[]"},
+		{ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE, "state", "integer[]"},
+		{ZBX_FLAGS_ITEM_DIFF_UPDATE_ERROR, "error", "text[]"}
+	};
+
+	char			*sql = NULL, *params[ITEM_DIFF_COLUMNS_NUM + 1] = {0};
+	size_t			sql_alloc = 0, params_alloc[ITEM_DIFF_COLUMNS_NUM + 1] = {0},
+				params_offset[ITEM_DIFF_COLUMNS_NUM + 1];
+	int			i, j, ret = SUCCEED;
+	zbx_uint64_t		shapes = 0, shape;
+	const zbx_db_field_t	*field_error;
+
+	field_error = zbx_db_get_field(zbx_db_get_table("item_rtdata"), "error");
+
+	mask &= ZBX_FLAGS_ITEM_DIFF_UPDATE_DB;
+
+	for (i = 0; i < item_diff->values_num; i++)
+		shapes |= __UINT64_C(1) << (item_diff->values[i]->flags & mask);
+
+	/* each combination of updated columns has its own statement */
+	for (shape = 1; shape <= mask && SUCCEED == ret; shape++)
+	{
+		size_t	sql_offset = 0;
+		int	params_num = 1;
+		char	delim = ' ';
+
+		if (0 == (shapes & (__UINT64_C(1) << shape)))
+			continue;
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "update item_rtdata set");
+
+		for (j = 0; j < ITEM_DIFF_COLUMNS_NUM; j++)
+		{
+			if (0 == (shape & columns[j].flag))
+				continue;
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%c%s=v.%s", delim, columns[j].name,
+					columns[j].name);
+			delim = ',';
+		}
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " from unnest($1::bigint[]");
+
+		for (j = 0; j < ITEM_DIFF_COLUMNS_NUM; j++)
+		{
+			if (0 != (shape & columns[j].flag))
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ",$%d::%s", ++params_num, columns[j].type);
+		}
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") as v(itemid");
+
+		for (j = 0; j < ITEM_DIFF_COLUMNS_NUM; j++)
+		{
+			if (0 != (shape & columns[j].flag))
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ",%s", columns[j].name);
+		}
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") where item_rtdata.itemid=v.itemid");
+
+		memset(params_offset, 0, sizeof(params_offset));
+
+		for (i = 0; i < item_diff->values_num; i++)
+		{
+			const zbx_item_diff_t	*diff = item_diff->values[i];
+			int			param = 0;
+
+			if (shape != (diff->flags & mask))
+				continue;
+
+			zbx_db_array_add_uint64(&params[param], &params_alloc[param], &params_offset[param],
+					diff->itemid);
+
+			if (0 != (shape & ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTLOGSIZE))
+			{
+				param++;
+				zbx_db_array_add_uint64(&params[param], &params_alloc[param], &params_offset[param],
+						diff->lastlogsize);
+			}
+
+			if (0 != (shape & ZBX_FLAGS_ITEM_DIFF_UPDATE_MTIME))
+			{
+				param++;
+				zbx_db_array_add_int(&params[param], &params_alloc[param], &params_offset[param],
+						diff->mtime);
+			}
+
+			if (0 != (shape & ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE))
+			{
+				param++;
+				zbx_db_array_add_int(&params[param], &params_alloc[param], &params_offset[param],
+						(int)diff->state);
+			}
+
+			if (0 != (shape & ZBX_FLAGS_ITEM_DIFF_UPDATE_ERROR))
+			{
+				char	*error;
+
+				param++;
+				error = zbx_db_dyn_escape_string_basic(diff->error, ZBX_SIZE_T_MAX, field_error->length,
+						ESCAPE_SEQUENCE_OFF);
+				zbx_db_array_add_str(&params[param], &params_alloc[param], &params_offset[param], error);
+				zbx_free(error);
+			}
+		}
+
+		for (j = 0; j < params_num; j++)
+			zbx_db_array_close(&params[j], &params_alloc[j], &params_offset[j]);
+
+		if (ZBX_DB_OK > zbx_db_execute_prepared(sql, params_num, (const char * const *)params))
+			ret = FAIL;
+	}
+
+	for (j = 0; j < ITEM_DIFF_COLUMNS_NUM + 1; j++)
+		zbx_free(params[j]);
+
+	zbx_free(sql);
+
+	return ret;
+#undef ITEM_DIFF_COLUMNS_NUM
+}
+#endif
@@ -5528,6 +5528,8 @@ int	zbx_db_copy_template_elements(zbx_uint64_t hostid, zbx_vector_uint64_t *lnk_
 	int			i, res = SUCCEED;
 	char			*template_names, err[MAX_STRING_LEN];
 	zbx_db_insert_t		*db_insert_htemplates;
+	double			sec, sec_items = 0, sec_host_prototypes = 0, sec_triggers = 0, sec_graphs = 0,
+				sec_httptests = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -5590,22 +5592,222 @@ int	zbx_db_copy_template_elements(zbx_uint64_t hostid, zbx_vector_uint64_t *lnk_
 		hosttemplateid++;
 	}
 
+	sec = zbx_time();
 	DBcopy_template_items(hostid, lnk_templateids, audit_context_mode);
+	sec_items = zbx_time() - sec;
+
+	sec = zbx_time();
 	DBcopy_template_host_prototypes(hostid, lnk_templateids, audit_context_mode, db_insert_htemplates);
 
 	zbx_db_insert_execute(db_insert_htemplates);
 	zbx_db_insert_clean(db_insert_htemplates);
 	zbx_free(db_insert_htemplates);
+	sec_host_prototypes = zbx_time() - sec;
+
+	sec = zbx_time();
+	res = DBcopy_template_triggers(hostid, lnk_templateids, audit_context_mode, error);
+	sec_triggers = zbx_time() - sec;
 
-	if (SUCCEED == (res = DBcopy_template_triggers(hostid, lnk_templateids, audit_context_mode, error)))
+	if (SUCCEED == res)
 	{
+		sec = zbx_time();
 		res = DBcopy_template_graphs(hostid, lnk_templateids, audit_context_mode);
+		sec_graphs = zbx_time() - sec;
+
+		sec = zbx_time();
 		DBcopy_template_httptests(hostid, lnk_templateids, audit_context_mode);
+		sec_httptests = zbx_time() - sec;
 	}
 clean:
 	zbx_vector_uint64_destroy(&templateids);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(res));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s items:" ZBX_FS_DBL " sec, host prototypes:" ZBX_FS_DBL " sec,"
+			" triggers:" ZBX_FS_DBL " sec, graphs:" ZBX_FS_DBL " sec, web scenarios:" ZBX_FS_DBL " sec",
+			__func__, zbx_result_string(res), sec_items, sec_host_prototypes, sec_triggers, sec_graphs,
+			sec_httptests);
+
+	return res;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies elements from specified templates to several hosts         *
+ *                                                                            *
+ * Parameters:                                                                *
+ *             hostids            - [IN] host ids from database               *
+ *             lnk_templateids    - [IN] templates to link, sorted            *
+ *             link_type          - [IN] 0 - manual, 1 - LLD automatic        *
+ *             audit_context_mode - [IN]                                      *
+ *             errors             - [OUT] error messages                      *
+ *                                                                            *
+ * Return value: SUCCEED - templates were linked to all hosts                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Items are copied to all hosts in one pass, see                   *
+ *           DBcopy_template_items_hosts(). Hosts with some of the templates  *
+ *           already linked are processed by zbx_db_copy_template_elements(). *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_template_elements_hosts(const zbx_vector_uint64_t *hostids,
+		const zbx_vector_uint64_t *lnk_templateids, zbx_host_template_link_type link_type,
+		int audit_context_mode, zbx_vector_str_t *errors)
+{
+	zbx_vector_uint64_t	templateids, lnk, link_hostids;
+	zbx_uint64_t		hosttemplateid, hostid;
+	int			i, j, res = SUCCEED;
+	char			*template_names, *error, err[MAX_STRING_LEN];
+	zbx_db_insert_t		*db_insert_htemplates;
+	double			sec, sec_items = 0, sec_host_prototypes = 0, sec_triggers = 0, sec_graphs = 0,
+				sec_httptests = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __func__, hostids->values_num);
+
+	zbx_vector_uint64_create(&templateids);
+	zbx_vector_uint64_create(&lnk);
+	zbx_vector_uint64_create(&link_hostids);
+
+	zbx_vector_uint64_append_array(&lnk, lnk_templateids->values, lnk_templateids->values_num);
+
+	for (i = 0; i < hostids->values_num; i++)
+	{
+		hostid = hostids->values[i];
+
+		zbx_vector_uint64_clear(&templateids);
+		get_templates_by_hostid(hostid, &templateids);
+
+		for (j = 0; j < lnk.values_num; j++)
+		{
+			if (FAIL != zbx_vector_uint64_search(&templateids, lnk.values[j],
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			{
+				break;
+			}
+		}
+
+		/* some of templates are already linked, the host has a different set of templates to link */
+		if (j != lnk.values_num)
+		{
+			zbx_vector_uint64_t	host_lnk;
+
+			zbx_vector_uint64_create(&host_lnk);
+			zbx_vector_uint64_append_array(&host_lnk, lnk.values, lnk.values_num);
+
+			error = NULL;
+
+			if (SUCCEED != zbx_db_copy_template_elements(hostid, &host_lnk, link_type, audit_context_mode,
+					&error))
+			{
+				zbx_vector_str_append(errors, error);
+				res = FAIL;
+			}
+
+			zbx_vector_uint64_destroy(&host_lnk);
+			continue;
+		}
+
+		zbx_vector_uint64_append_array(&templateids, lnk.values, lnk.values_num);
+		zbx_vector_uint64_sort(&templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		if (SUCCEED != validate_linked_templates(&templateids, err, sizeof(err)) ||
+				SUCCEED != validate_host(hostid, &lnk, err, sizeof(err)))
+		{
+			template_names = get_template_names(&lnk);
+
+			zbx_vector_str_append(errors, zbx_dsprintf(NULL, "%s to host \"%s\": %s", template_names,
+					zbx_host_string(hostid), err));
+
+			zbx_free(template_names);
+			res = FAIL;
+			continue;
+		}
+
+		zbx_vector_uint64_append(&link_hostids, hostid);
+	}
+
+	if (0 == link_hostids.values_num)
+		goto clean;
+
+	hosttemplateid = zbx_db_get_maxid_num("hosts_templates", lnk.values_num * link_hostids.values_num);
+
+	db_insert_htemplates = zbx_malloc(NULL, sizeof(zbx_db_insert_t));
+
+	zbx_db_insert_prepare(db_insert_htemplates, "hosts_templates",  "hosttemplateid", "hostid", "templateid",
+			"link_type", (char *)NULL);
+
+	for (i = 0; i < link_hostids.values_num; i++)
+	{
+		for (j = 0; j < lnk.values_num; j++)
+		{
+			zbx_db_insert_add_values(db_insert_htemplates, hosttemplateid, link_hostids.values[i],
+					lnk.values[j], link_type);
+			zbx_audit_host_update_json_add_parent_template(audit_context_mode, link_hostids.values[i],
+					hosttemplateid, lnk.values[j], link_type);
+
+			hosttemplateid++;
+		}
+	}
+
+	sec = zbx_time();
+	DBcopy_template_items_hosts(&link_hostids, &lnk, audit_context_mode);
+	sec_items = zbx_time() - sec;
+
+	sec = zbx_time();
+
+	for (i = 0; i < link_hostids.values_num; i++)
+	{
+		DBcopy_template_host_prototypes(link_hostids.values[i], &lnk, audit_context_mode,
+				db_insert_htemplates);
+	}
+
+	zbx_db_insert_execute(db_insert_htemplates);
+	zbx_db_insert_clean(db_insert_htemplates);
+	zbx_free(db_insert_htemplates);
+	sec_host_prototypes = zbx_time() - sec;
+
+	/* triggers, graphs and web scenarios depend on host items and are copied to each host separately */
+	for (i = 0; i < link_hostids.values_num; i++)
+	{
+		hostid = link_hostids.values[i];
+		error = NULL;
+
+		sec = zbx_time();
+
+		if (SUCCEED != DBcopy_template_triggers(hostid, &lnk, audit_context_mode, &error))
+		{
+			sec_triggers += zbx_time() - sec;
+
+			zbx_vector_str_append(errors, error);
+			res = FAIL;
+			continue;
+		}
+
+		sec_triggers += zbx_time() - sec;
+		sec = zbx_time();
+
+		if (SUCCEED != DBcopy_template_graphs(hostid, &lnk, audit_context_mode))
+		{
+			sec_graphs += zbx_time() - sec;
+
+			res = FAIL;
+			continue;
+		}
+
+		sec_graphs += zbx_time() - sec;
+		sec = zbx_time();
+
+		DBcopy_template_httptests(hostid, &lnk, audit_context_mode);
+
+		sec_httptests += zbx_time() - sec;
+	}
+clean:
+	zbx_vector_uint64_destroy(&link_hostids);
+	zbx_vector_uint64_destroy(&lnk);
+	zbx_vector_uint64_destroy(&templateids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s items:" ZBX_FS_DBL " sec, host prototypes:" ZBX_FS_DBL " sec,"
+			" triggers:" ZBX_FS_DBL " sec, graphs:" ZBX_FS_DBL " sec, web scenarios:" ZBX_FS_DBL " sec",
+			__func__, zbx_result_string(res), sec_items, sec_host_prototypes, sec_triggers, sec_graphs,
+			sec_httptests);
 
 	return res;
 }
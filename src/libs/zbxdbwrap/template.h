@@ -188,6 +188,8 @@ typedef struct
 zbx_template_item_t;
 
 void	DBcopy_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *templateids, int audit_context_mode);
+void	DBcopy_template_items_hosts(const zbx_vector_uint64_t *hostids, const zbx_vector_uint64_t *templateids,
+		int audit_context_mode);
 void	zbx_audit_item_update_json_add_data(int audit_context_mode, zbx_uint64_t itemid,
 		const zbx_template_item_t *item, zbx_uint64_t hostid);
 #endif
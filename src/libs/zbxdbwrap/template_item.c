@@ -28,6 +28,9 @@
 #include "zbx_host_constants.h"
 #include "zbx_trigger_constants.h"
 
+/* maximum number of items copied to hosts in one pass */
+#define ZBX_TEMPLATE_ITEMS_BULK_MAX	20000
+
 struct _zbx_template_item_preproc_t
 {
 	zbx_uint64_t	item_preprocid;
@@ -162,6 +165,79 @@ static void	DBget_interfaces_by_hostid(zbx_uint64_t hostid, zbx_uint64_t *interf
 	zbx_db_free_result(result);
 }
 
+/* auxiliary function for DBcopy_template_items_hosts() */
+static void	DBget_interfaces_by_hostids(const zbx_vector_uint64_t *hostids, zbx_uint64_t *interfaceids)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	unsigned char	type;
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t	hostid;
+	int		index;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select hostid,type,interfaceid"
+			" from interface"
+			" where type in (%d,%d,%d,%d)"
+				" and main=1"
+				" and",
+			INTERFACE_TYPE_AGENT, INTERFACE_TYPE_SNMP, INTERFACE_TYPE_IPMI, INTERFACE_TYPE_JMX);
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hostid", hostids->values, hostids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(hostid, row[0]);
+
+		if (FAIL == (index = zbx_vector_uint64_bsearch(hostids, hostid, ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			continue;
+		}
+
+		ZBX_STR2UCHAR(type, row[1]);
+		ZBX_STR2UINT64(interfaceids[index * INTERFACE_TYPE_COUNT + type - 1], row[2]);
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects host interface for item of the specified type             *
+ *                                                                            *
+ * Parameters: type         - [IN] item type                                  *
+ *             interfaceids - [IN] host main interfaces indexed by interface  *
+ *                                 type - 1                                   *
+ *                                                                            *
+ * Return value: interface id or 0 if item does not use interface             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	get_template_item_interfaceid(unsigned char type, const zbx_uint64_t *interfaceids)
+{
+	unsigned char	interface_type;
+	int		i;
+
+	switch (interface_type = zbx_get_interface_type_by_item_type(type))
+	{
+		case INTERFACE_TYPE_UNKNOWN:
+		case INTERFACE_TYPE_OPT:
+			return 0;
+		case INTERFACE_TYPE_ANY:
+			for (i = 0; INTERFACE_TYPE_COUNT > i; i++)
+			{
+				if (0 != interfaceids[zbx_get_interface_type_priority(i) - 1])
+					break;
+			}
+			return interfaceids[zbx_get_interface_type_priority(i) - 1];
+		default:
+			return interfaceids[interface_type - 1];
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: read template items from database                                 *
@@ -183,8 +259,7 @@ static void	get_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *t
 	zbx_db_result_t		result;
 	zbx_db_row_t		row;
 	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0, i;
-	unsigned char		interface_type;
+	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_template_item_t	*item;
 	zbx_uint64_t		interfaceids[4];
 
@@ -252,23 +327,7 @@ static void	get_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *t
 		ZBX_STR2UCHAR(item->evaltype, row[27]);
 
 		item->interfaceid_orig = 0;
-		switch (interface_type = zbx_get_interface_type_by_item_type(item->type))
-		{
-			case INTERFACE_TYPE_UNKNOWN:
-			case INTERFACE_TYPE_OPT:
-				item->interfaceid = 0;
-				break;
-			case INTERFACE_TYPE_ANY:
-				for (i = 0; INTERFACE_TYPE_COUNT > i; i++)
-				{
-					if (0 != interfaceids[zbx_get_interface_type_priority(i) - 1])
-						break;
-				}
-				item->interfaceid = interfaceids[zbx_get_interface_type_priority(i) - 1];
-				break;
-			default:
-				item->interfaceid = interfaceids[interface_type - 1];
-		}
+		item->interfaceid = get_template_item_interfaceid(item->type, interfaceids);
 
 		item->name_orig = NULL;
 		item->name = zbx_strdup(NULL, row[1]);
@@ -976,6 +1035,34 @@ dependent:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares bulk inserts of new items                                *
+ *                                                                            *
+ * Parameters: db_insert_items   - [OUT] items insert                         *
+ *             db_insert_irtdata - [OUT] item_rtdata insert                   *
+ *             db_insert_irtname - [OUT] item_rtname insert                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	prepare_template_items_insert(zbx_db_insert_t *db_insert_items, zbx_db_insert_t *db_insert_irtdata,
+		zbx_db_insert_t *db_insert_irtname)
+{
+	zbx_db_insert_prepare(db_insert_items, "items", "itemid", "name", "key_", "hostid", "type",
+			"value_type", "delay", "history", "trends", "status", "trapper_hosts", "units",
+			"formula", "logtimefmt", "valuemapid", "params", "ipmi_sensor",
+			"snmp_oid", "authtype", "username", "password", "publickey", "privatekey",
+			"templateid", "flags", "description", "inventory_link", "interfaceid", "lifetime",
+			"evaltype","jmx_endpoint", "master_itemid",
+			"timeout", "url", "query_fields", "posts", "status_codes", "follow_redirects",
+			"post_type", "http_proxy", "headers", "retrieve_mode", "request_method",
+			"output_format", "ssl_cert_file", "ssl_key_file", "ssl_key_password", "verify_peer",
+			"verify_host", "allow_traps", "discover", (char *)NULL);
+
+	zbx_db_insert_prepare(db_insert_irtdata, "item_rtdata", "itemid", (char *)NULL);
+	zbx_db_insert_prepare(db_insert_irtname, "item_rtname", "itemid", "name_resolved",
+			"name_resolved_upper", (char *)NULL);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: saves template items to target host in database                   *
@@ -1011,21 +1098,7 @@ static void	save_template_items(zbx_uint64_t hostid, zbx_vector_ptr_t *items, in
 	if (0 != new_items)
 	{
 		itemid = zbx_db_get_maxid_num("items", new_items);
-
-		zbx_db_insert_prepare(&db_insert_items, "items", "itemid", "name", "key_", "hostid", "type",
-				"value_type", "delay", "history", "trends", "status", "trapper_hosts", "units",
-				"formula", "logtimefmt", "valuemapid", "params", "ipmi_sensor",
-				"snmp_oid", "authtype", "username", "password", "publickey", "privatekey",
-				"templateid", "flags", "description", "inventory_link", "interfaceid", "lifetime",
-				"evaltype","jmx_endpoint", "master_itemid",
-				"timeout", "url", "query_fields", "posts", "status_codes", "follow_redirects",
-				"post_type", "http_proxy", "headers", "retrieve_mode", "request_method",
-				"output_format", "ssl_cert_file", "ssl_key_file", "ssl_key_password", "verify_peer",
-				"verify_host", "allow_traps", "discover", (char *)NULL);
-
-		zbx_db_insert_prepare(&db_insert_irtdata, "item_rtdata", "itemid", (char *)NULL);
-		zbx_db_insert_prepare(&db_insert_irtname, "item_rtname", "itemid", "name_resolved",
-				"name_resolved_upper", (char *)NULL);
+		prepare_template_items_insert(&db_insert_items, &db_insert_irtdata, &db_insert_irtname);
 	}
 
 	if (0 != upd_items)
@@ -1259,11 +1332,10 @@ static void	save_template_lld_rules(zbx_vector_ptr_t *items, zbx_vector_ptr_t *r
  *                                                                            *
  * Purpose: saves host item prototypes in database                            *
  *                                                                            *
- * Parameters:  hostid  - [IN] target host                                    *
- *              items   - [IN] template items                                 *
+ * Parameters:  items   - [IN] template items, can belong to several hosts    *
  *                                                                            *
  ******************************************************************************/
-static void	save_template_discovery_prototypes(zbx_uint64_t hostid, zbx_vector_ptr_t *items)
+static void	save_template_discovery_prototypes(zbx_vector_ptr_t *items)
 {
 	typedef struct
 	{
@@ -1301,14 +1373,13 @@ static void	save_template_discovery_prototypes(zbx_uint64_t hostid, zbx_vector_p
 
 	zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
 			"select i.itemid,r.itemid"
 			" from items i,item_discovery id,items r"
 			" where i.templateid=id.itemid"
 				" and id.parent_itemid=r.templateid"
-				" and r.hostid=" ZBX_FS_UI64
-				" and",
-			hostid);
+				" and r.hostid=i.hostid"
+				" and");
 	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", itemids.values, itemids.values_num);
 
 	result = zbx_db_select("%s", sql);
@@ -2268,7 +2339,18 @@ static void	lld_override_operations_load(zbx_vector_ptr_t *overrides, const zbx_
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset_t *lld_items,
+/******************************************************************************
+ *                                                                            *
+ * Purpose: saves template lld rule overrides to target hosts                 *
+ *                                                                            *
+ * Parameters: overrides          - [IN] template lld rule overrides          *
+ *             lld_items          - [IN] array of hosts lld items indexed by  *
+ *                                       templateid                           *
+ *             hosts_num          - [IN] number of hosts in lld_items         *
+ *             audit_context_mode - [IN]                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset_t *lld_items, int hosts_num,
 		int audit_context_mode)
 {
 	zbx_uint64_t			overrideid, override_operationid = 0, override_conditionid = 0;
@@ -2277,6 +2359,7 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 					db_insert_optrends, db_insert_opseverity, db_insert_optag, db_insert_optemplate,
 					db_insert_opinventory;
 	int				i, j, k, conditions_num, operations_num;
+	char				*formula;
 	lld_override_t			*override;
 	lld_override_codition_t		*override_condition;
 	zbx_lld_override_operation_t	*override_operation;
@@ -2285,7 +2368,7 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (0 != overrides->values_num)
-		overrideid = zbx_db_get_maxid_num("lld_override", overrides->values_num);
+		overrideid = zbx_db_get_maxid_num("lld_override", overrides->values_num * hosts_num);
 
 	zbx_db_insert_prepare(&db_insert, "lld_override", "lld_overrideid", "itemid", "name", "step", "evaltype",
 			"formula", "stop", (char *)NULL);
@@ -2301,10 +2384,10 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 	}
 
 	if (0 != operations_num)
-		override_operationid = zbx_db_get_maxid_num("lld_override_operation", operations_num);
+		override_operationid = zbx_db_get_maxid_num("lld_override_operation", operations_num * hosts_num);
 
 	if (0 != conditions_num)
-		override_conditionid = zbx_db_get_maxid_num("lld_override_condition", conditions_num);
+		override_conditionid = zbx_db_get_maxid_num("lld_override_condition", conditions_num * hosts_num);
 
 	zbx_db_insert_prepare(&db_insert_ooperations, "lld_override_operation", "lld_override_operationid",
 				"lld_overrideid", "operationobject", "operator", "value", (char *)NULL);
@@ -2332,19 +2415,23 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 	zbx_db_insert_prepare(&db_insert_opinventory, "lld_override_opinventory", "lld_override_operationid",
 			"inventory_mode", (char *)NULL);
 
-	for (i = 0; i < overrides->values_num; i++)
+	/* overrides are copied to each host in turn */
+	for (i = 0; i < overrides->values_num * hosts_num; i++)
 	{
 		zbx_template_item_t	item_local, *pitem_local = &item_local;
 
-		override = (lld_override_t *)overrides->values[i];
+		override = (lld_override_t *)overrides->values[i % overrides->values_num];
 
 		item_local.templateid = override->itemid;
-		if (NULL == (pitem = (const zbx_template_item_t **)zbx_hashset_search(lld_items, &pitem_local)))
+		if (NULL == (pitem = (const zbx_template_item_t **)zbx_hashset_search(
+				&lld_items[i / overrides->values_num], &pitem_local)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
+		formula = zbx_strdup(NULL, override->formula);
+
 		for (j = 0; j < override->override_conditions.values_num; j++)
 		{
 			override_condition = (lld_override_codition_t *)override->override_conditions.values[j];
@@ -2360,8 +2447,8 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 
 			if (ZBX_CONDITION_EVAL_TYPE_EXPRESSION == override->evaltype)
 			{
-				update_template_lld_formula(&override->formula,
-						override_condition->override_conditionid, override_conditionid);
+				update_template_lld_formula(&formula, override_condition->override_conditionid,
+						override_conditionid);
 			}
 
 			override_conditionid++;
@@ -2369,13 +2456,15 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 
 		/* prepare lld_override insert after formula is updated */
 		zbx_db_insert_add_values(&db_insert, overrideid, (*pitem)->itemid, override->name, (int)override->step,
-				(int)override->evaltype, override->formula, (int)override->stop);
+				(int)override->evaltype, formula, (int)override->stop);
 
 		zbx_audit_discovery_rule_update_json_add_lld_override(audit_context_mode, (*pitem)->itemid, overrideid,
 				override->name, (int)override->step, (int)override->stop);
 
 		zbx_audit_discovery_rule_update_json_add_lld_override_filter(audit_context_mode, (*pitem)->itemid,
-				overrideid, (int)override->evaltype, override->formula);
+				overrideid, (int)override->evaltype, formula);
+
+		zbx_free(formula);
 
 		for (j = 0; j < override->override_operations.values_num; j++)
 		{
@@ -2549,7 +2638,7 @@ static void	save_template_lld_overrides(zbx_vector_ptr_t *overrides, zbx_hashset
 }
 
 static void	copy_template_lld_overrides(const zbx_vector_uint64_t *templateids,
-		const zbx_vector_uint64_t *lld_itemids, zbx_hashset_t *lld_items, int audit_context_mode)
+		const zbx_vector_uint64_t *lld_itemids, zbx_hashset_t *lld_items, int hosts_num, int audit_context_mode)
 {
 	char			*sql = NULL;
 	size_t			sql_alloc = 0, sql_offset = 0;
@@ -2625,7 +2714,7 @@ static void	copy_template_lld_overrides(const zbx_vector_uint64_t *templateids,
 	{
 		lld_override_conditions_load(&overrides, &overrideids, &sql, &sql_alloc);
 		lld_override_operations_load(&overrides, &overrideids, &sql, &sql_alloc);
-		save_template_lld_overrides(&overrides, lld_items, audit_context_mode);
+		save_template_lld_overrides(&overrides, lld_items, hosts_num, audit_context_mode);
 	}
 	zbx_free(sql);
 
@@ -3308,6 +3397,296 @@ static void	prepare_lld_items(const zbx_vector_ptr_t *items, zbx_vector_uint64_t
 	zbx_vector_uint64_sort(lld_itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies loaded template items to hosts in one pass                 *
+ *                                                                            *
+ * Parameters: hostids            - [IN] target hosts, sorted                 *
+ *             templateids        - [IN]                                      *
+ *             items              - [IN/OUT] template items, identifiers and  *
+ *                                           formulas are set for each host   *
+ *             lld_rules          - [IN/OUT] template lld rule conditions     *
+ *             formulas           - [IN] template formulas of expression type *
+ *                                       lld rules, NULL for other items      *
+ *             lld_itemids        - [IN] lld rules having overrides removed   *
+ *             audit_context_mode - [IN]                                      *
+ *             sec_save           - [IN/OUT] time spent saving items          *
+ *             sec_copy           - [IN/OUT] time spent copying preprocessing,*
+ *                                           parameters and tags              *
+ *             sec_lld            - [IN/OUT] time spent copying lld data      *
+ *                                                                            *
+ * Comments: Rows for all hosts are added to shared bulk inserts which are    *
+ *           executed once per table.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	copy_template_items_hosts_pass(const zbx_vector_uint64_t *hostids,
+		const zbx_vector_uint64_t *templateids, zbx_vector_ptr_t *items, zbx_vector_ptr_t *lld_rules,
+		char **formulas, const zbx_vector_uint64_t *lld_itemids, int audit_context_mode, double *sec_save,
+		double *sec_copy, double *sec_lld)
+{
+	zbx_vector_ptr_t	host_items;
+	zbx_hashset_t		*lld_items = NULL;
+	zbx_uint64_t		*interfaceids, itemid, conditionid;
+	zbx_db_insert_t		db_insert_items, db_insert_irtdata, db_insert_irtname;
+	zbx_template_item_t	*item;
+	zbx_lld_rule_map_t	*rule;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i, j, new_conditions = 0;
+	double			sec;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __func__, hostids->values_num);
+
+	sec = zbx_time();
+
+	zbx_vector_ptr_create(&host_items);
+
+	interfaceids = (zbx_uint64_t *)zbx_calloc(NULL, (size_t)hostids->values_num * INTERFACE_TYPE_COUNT,
+			sizeof(zbx_uint64_t));
+	DBget_interfaces_by_hostids(hostids, interfaceids);
+
+	/* reserve condition identifiers as a block per lld rule, the block is taken by hosts in turn */
+	for (i = 0; i < lld_rules->values_num; i++)
+		new_conditions += ((zbx_lld_rule_map_t *)lld_rules->values[i])->conditions.values_num;
+
+	if (0 != (new_conditions *= hostids->values_num))
+	{
+		conditionid = zbx_db_get_maxid_num("item_condition", new_conditions);
+
+		for (i = 0; i < lld_rules->values_num; i++)
+		{
+			rule = (zbx_lld_rule_map_t *)lld_rules->values[i];
+
+			rule->conditionid = conditionid;
+			conditionid += (zbx_uint64_t)(rule->conditions.values_num * hostids->values_num);
+		}
+	}
+
+	if (0 != lld_rules->values_num)
+	{
+		lld_items = (zbx_hashset_t *)zbx_malloc(NULL, sizeof(zbx_hashset_t) * (size_t)hostids->values_num);
+
+		for (i = 0; i < hostids->values_num; i++)
+		{
+			zbx_hashset_create(&lld_items[i], (size_t)lld_rules->values_num, template_item_hash_func,
+					template_item_compare_func);
+		}
+	}
+
+	itemid = zbx_db_get_maxid_num("items", items->values_num * hostids->values_num);
+	prepare_template_items_insert(&db_insert_items, &db_insert_irtdata, &db_insert_irtname);
+
+	zbx_vector_ptr_reserve(&host_items, (size_t)(items->values_num * hostids->values_num));
+
+	for (i = 0; i < hostids->values_num; i++)
+	{
+		for (j = 0; j < items->values_num; j++)
+		{
+			item = (zbx_template_item_t *)items->values[j];
+
+			item->interfaceid = get_template_item_interfaceid(item->type,
+					&interfaceids[i * INTERFACE_TYPE_COUNT]);
+
+			if (NULL != formulas[j])
+				item->formula = zbx_strdup(item->formula, formulas[j]);
+		}
+
+		update_template_lld_rule_formulas(items, lld_rules);
+
+		for (j = 0; j < items->values_num; j++)
+		{
+			item = (zbx_template_item_t *)items->values[j];
+
+			/* dependent items are saved within recursive save_template_item calls while saving master */
+			if (0 == item->master_itemid)
+			{
+				save_template_item(hostids->values[i], &itemid, item, &db_insert_items,
+						&db_insert_irtdata, &db_insert_irtname, audit_context_mode, &sql,
+						&sql_alloc, &sql_offset);
+			}
+		}
+
+		/* Template items are reused for the next host, so remember identifiers assigned for this host. */
+		/* The copies share the rest of the data with template items and are freed with zbx_ptr_free(). */
+		for (j = 0; j < items->values_num; j++)
+		{
+			zbx_template_item_t	*host_item;
+
+			host_item = (zbx_template_item_t *)zbx_malloc(NULL, sizeof(zbx_template_item_t));
+			memcpy(host_item, items->values[j], sizeof(zbx_template_item_t));
+			host_item->formula = NULL;
+
+			zbx_vector_ptr_append(&host_items, host_item);
+
+			if (0 != (ZBX_FLAG_DISCOVERY_RULE & host_item->flags))
+				zbx_hashset_insert(&lld_items[i], &host_item, sizeof(zbx_template_item_t *));
+		}
+
+		for (j = 0; j < lld_rules->values_num; j++)
+		{
+			rule = (zbx_lld_rule_map_t *)lld_rules->values[j];
+			rule->conditionid += (zbx_uint64_t)rule->conditions.values_num;
+		}
+	}
+
+	zbx_db_insert_execute(&db_insert_items);
+	zbx_db_insert_clean(&db_insert_items);
+
+	zbx_db_insert_execute(&db_insert_irtname);
+	zbx_db_insert_clean(&db_insert_irtname);
+	zbx_db_insert_execute(&db_insert_irtdata);
+	zbx_db_insert_clean(&db_insert_irtdata);
+
+	/* rewind lld rule condition identifiers to the start of reserved blocks */
+	for (i = 0; i < lld_rules->values_num; i++)
+	{
+		rule = (zbx_lld_rule_map_t *)lld_rules->values[i];
+		rule->conditionid -= (zbx_uint64_t)(rule->conditions.values_num * hostids->values_num);
+	}
+
+	save_template_lld_rules(&host_items, lld_rules, new_conditions, audit_context_mode);
+	save_template_discovery_prototypes(&host_items);
+
+	*sec_save += zbx_time() - sec;
+	sec = zbx_time();
+
+	copy_template_items_preproc(&host_items, audit_context_mode);
+	copy_template_item_script_params(&host_items, audit_context_mode);
+	copy_template_item_tags(&host_items, audit_context_mode);
+
+	*sec_copy += zbx_time() - sec;
+	sec = zbx_time();
+
+	if (0 != lld_rules->values_num)
+	{
+		copy_template_lld_macro_paths(&host_items, audit_context_mode);
+		copy_template_lld_overrides(templateids, lld_itemids, lld_items, hostids->values_num,
+				audit_context_mode);
+
+		for (i = 0; i < hostids->values_num; i++)
+			zbx_hashset_destroy(&lld_items[i]);
+
+		zbx_free(lld_items);
+	}
+
+	*sec_lld += zbx_time() - sec;
+
+	zbx_free(interfaceids);
+	zbx_free(sql);
+
+	zbx_vector_ptr_clear_ext(&host_items, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&host_items);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies template items to hosts without items having template     *
+ *          item keys                                                         *
+ *                                                                            *
+ * Parameters: hostids            - [IN] target hosts, sorted                 *
+ *             templateids        - [IN]                                      *
+ *             audit_context_mode - [IN]                                      *
+ *                                                                            *
+ * Comments: Template items with their lld rule conditions, preprocessing,    *
+ *           parameters, tags, lld macro paths and overrides are read once.   *
+ *           Hosts are then processed in passes of at most                   *
+ *           ZBX_TEMPLATE_ITEMS_BULK_MAX new items, so that memory used by    *
+ *           bulk inserts does not grow with the number of hosts.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	copy_template_items_new_hosts(const zbx_vector_uint64_t *hostids,
+		const zbx_vector_uint64_t *templateids, int audit_context_mode)
+{
+	zbx_vector_ptr_t	items, lld_rules;
+	zbx_vector_uint64_t	lld_itemids, pass_hostids;
+	zbx_hashset_t		template_lld_items;
+	zbx_template_item_t	*item;
+	char			**formulas = NULL;
+	int			i, hosts_num, passes = 0;
+	double			sec, sec_load = 0, sec_save = 0, sec_copy = 0, sec_lld = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __func__, hostids->values_num);
+
+	zbx_vector_ptr_create(&items);
+	zbx_vector_ptr_create(&lld_rules);
+	zbx_vector_uint64_create(&lld_itemids);
+
+	sec = zbx_time();
+
+	/* none of the hosts has items with template item keys - all template items are new */
+	get_template_items(0, templateids, &items);
+
+	if (0 == items.values_num)
+		goto out;
+
+	get_template_lld_rule_map(&items, &lld_rules);
+
+	link_template_dependent_items(&items);
+	link_template_items_preproc(templateids, &items);
+	link_template_items_tag(templateids, &items);
+	link_template_items_param(templateids, &items);
+
+	zbx_hashset_create(&template_lld_items, (size_t)items.values_num, template_item_hash_func,
+			template_item_compare_func);
+
+	prepare_lld_items(&items, &lld_itemids, &template_lld_items);
+	if (0 != template_lld_items.num_data)
+		link_template_lld_macro_paths(templateids, &lld_itemids, &template_lld_items, &items);
+
+	zbx_hashset_destroy(&template_lld_items);
+
+	/* keep template formulas of expression type lld rules, they are translated for each host */
+	formulas = (char **)zbx_calloc(NULL, (size_t)items.values_num, sizeof(char *));
+
+	for (i = 0; i < items.values_num; i++)
+	{
+		item = (zbx_template_item_t *)items.values[i];
+
+		if (0 != (ZBX_FLAG_DISCOVERY_RULE & item->flags) && ZBX_CONDITION_EVAL_TYPE_EXPRESSION == item->evaltype)
+			formulas[i] = zbx_strdup(NULL, item->formula);
+	}
+
+	sec_load = zbx_time() - sec;
+
+	if (0 == (hosts_num = ZBX_TEMPLATE_ITEMS_BULK_MAX / items.values_num))
+		hosts_num = 1;
+
+	zbx_vector_uint64_create(&pass_hostids);
+
+	for (i = 0; i < hostids->values_num; i += hosts_num)
+	{
+		zbx_vector_uint64_clear(&pass_hostids);
+		zbx_vector_uint64_append_array(&pass_hostids, hostids->values + i,
+				MIN(hosts_num, hostids->values_num - i));
+
+		copy_template_items_hosts_pass(&pass_hostids, templateids, &items, &lld_rules, formulas, &lld_itemids,
+				audit_context_mode, &sec_save, &sec_copy, &sec_lld);
+		passes++;
+	}
+
+	zbx_vector_uint64_destroy(&pass_hostids);
+
+	for (i = 0; i < items.values_num; i++)
+		zbx_free(formulas[i]);
+
+	zbx_free(formulas);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d passes:%d load:" ZBX_FS_DBL " sec, save items:"
+			ZBX_FS_DBL " sec, copy preprocessing, parameters and tags:" ZBX_FS_DBL " sec, lld:" ZBX_FS_DBL
+			" sec", __func__, items.values_num * hostids->values_num, passes, sec_load, sec_save, sec_copy,
+			sec_lld);
+
+	zbx_vector_uint64_destroy(&lld_itemids);
+
+	zbx_vector_ptr_clear_ext(&lld_rules, (zbx_clean_func_t)free_lld_rule_map);
+	zbx_vector_ptr_destroy(&lld_rules);
+
+	zbx_vector_ptr_clear_ext(&items, (zbx_clean_func_t)free_template_item);
+	zbx_vector_ptr_destroy(&items);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: copies template items to host                                     *
@@ -3324,12 +3703,15 @@ void	DBcopy_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *templ
 	int			new_conditions = 0;
 	zbx_vector_uint64_t	lld_itemids;
 	zbx_hashset_t		lld_items;
+	double			sec, sec_load = 0, sec_save = 0, sec_copy = 0, sec_lld = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	zbx_vector_ptr_create(&items);
 	zbx_vector_ptr_create(&lld_rules);
 
+	sec = zbx_time();
+
 	get_template_items(hostid, templateids, &items);
 
 	if (0 == items.values_num)
@@ -3344,13 +3726,24 @@ void	DBcopy_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *templ
 	link_template_items_preproc(templateids, &items);
 	link_template_items_tag(templateids, &items);
 	link_template_items_param(templateids, &items);
+
+	sec_load = zbx_time() - sec;
+	sec = zbx_time();
+
 	save_template_items(hostid, &items, audit_context_mode);
 	save_template_lld_rules(&items, &lld_rules, new_conditions, audit_context_mode);
-	save_template_discovery_prototypes(hostid, &items);
+	save_template_discovery_prototypes(&items);
+
+	sec_save = zbx_time() - sec;
+	sec = zbx_time();
+
 	copy_template_items_preproc(&items, audit_context_mode);
 	copy_template_item_script_params(&items, audit_context_mode);
 	copy_template_item_tags(&items, audit_context_mode);
 
+	sec_copy = zbx_time() - sec;
+	sec = zbx_time();
+
 	zbx_vector_uint64_create(&lld_itemids);
 	zbx_hashset_create(&lld_items, (size_t)items.values_num, template_item_hash_func, template_item_compare_func);
 
@@ -3359,17 +3752,108 @@ void	DBcopy_template_items(zbx_uint64_t hostid, const zbx_vector_uint64_t *templ
 	{
 		link_template_lld_macro_paths(templateids, &lld_itemids, &lld_items, &items);
 		copy_template_lld_macro_paths(&items, audit_context_mode);
-		copy_template_lld_overrides(templateids, &lld_itemids, &lld_items, audit_context_mode);
+		copy_template_lld_overrides(templateids, &lld_itemids, &lld_items, 1, audit_context_mode);
 	}
 
 	zbx_hashset_destroy(&lld_items);
 	zbx_vector_uint64_destroy(&lld_itemids);
+
+	sec_lld = zbx_time() - sec;
 out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() items:%d load:" ZBX_FS_DBL " sec, save items:" ZBX_FS_DBL " sec,"
+			" copy preprocessing, parameters and tags:" ZBX_FS_DBL " sec, lld:" ZBX_FS_DBL " sec", __func__,
+			items.values_num, sec_load, sec_save, sec_copy, sec_lld);
+
 	zbx_vector_ptr_clear_ext(&lld_rules, (zbx_clean_func_t)free_lld_rule_map);
 	zbx_vector_ptr_destroy(&lld_rules);
 
 	zbx_vector_ptr_clear_ext(&items, (zbx_clean_func_t)free_template_item);
 	zbx_vector_ptr_destroy(&items);
+}
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies template items to several hosts                            *
+ *                                                                            *
+ * Parameters:                                                                *
+ *             hostids            - [IN]                                      *
+ *             templateids        - [IN]                                      *
+ *             audit_context_mode - [IN]                                      *
+ *                                                                            *
+ * Comments: Hosts that already have items with template item keys need the  *
+ *           existing items updated and are processed one by one. Items of    *
+ *           the remaining hosts are inserted in one pass.                    *
+ *                                                                            *
+ ******************************************************************************/
+void	DBcopy_template_items_hosts(const zbx_vector_uint64_t *hostids, const zbx_vector_uint64_t *templateids,
+		int audit_context_mode)
+{
+	zbx_vector_uint64_t	new_hostids, upd_hostids;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		hostid;
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __func__, hostids->values_num);
+
+	if (1 == hostids->values_num)
+	{
+		DBcopy_template_items(hostids->values[0], templateids, audit_context_mode);
+		goto out;
+	}
+
+	zbx_vector_uint64_create(&new_hostids);
+	zbx_vector_uint64_create(&upd_hostids);
+
+	zbx_vector_uint64_append_array(&new_hostids, hostids->values, hostids->values_num);
+	zbx_vector_uint64_sort(&new_hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&new_hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select distinct hi.hostid"
+			" from items hi,items ti"
+			" where hi.key_=ti.key_"
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hi.hostid", new_hostids.values,
+			new_hostids.values_num);
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "ti.hostid", templateids->values,
+			templateids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(hostid, row[0]);
+		zbx_vector_uint64_append(&upd_hostids, hostid);
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+
+	for (i = 0; i < upd_hostids.values_num; i++)
+	{
+		int	index;
+
+		if (FAIL != (index = zbx_vector_uint64_bsearch(&new_hostids, upd_hostids.values[i],
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+		{
+			zbx_vector_uint64_remove(&new_hostids, index);
+		}
+
+		DBcopy_template_items(upd_hostids.values[i], templateids, audit_context_mode);
+	}
+
+	if (0 != new_hostids.values_num)
+		copy_template_items_new_hosts(&new_hostids, templateids, audit_context_mode);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() inserted for %d hosts, updated for %d hosts", __func__,
+			new_hostids.values_num, upd_hostids.values_num);
+
+	zbx_vector_uint64_destroy(&upd_hostids);
+	zbx_vector_uint64_destroy(&new_hostids);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
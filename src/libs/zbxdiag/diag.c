@@ -24,6 +24,8 @@
 #include "zbxtime.h"
 #include "zbxnum.h"
 #include "zbxstr.h"
+#include "zbxprof.h"
+#include "zbxself.h"
 
 #define ZBX_DIAG_SECTION_MAX	64
 #define ZBX_DIAG_FIELD_MAX	64
@@ -32,6 +34,7 @@
 #define ZBX_DIAG_HISTORYCACHE_VALUES		0x00000002
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_DATA	0x00000004
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX	0x00000008
+#define ZBX_DIAG_HISTORYCACHE_LATENCY		0x00000010
 
 #define ZBX_DIAG_HISTORYCACHE_SIMPLE	(ZBX_DIAG_HISTORYCACHE_ITEMS | \
 					ZBX_DIAG_HISTORYCACHE_VALUES)
@@ -42,6 +45,9 @@
 #define ZBX_DIAG_CONNECTOR_VALUES			0x00000001
 #define ZBX_DIAG_CONNECTOR_SIMPLE		(ZBX_DIAG_CONNECTOR_VALUES)
 
+#define ZBX_DIAG_PROFILER_INTERVAL		0x00000001
+#define ZBX_DIAG_PROFILER_SIMPLE		(ZBX_DIAG_PROFILER_INTERVAL)
+
 ZBX_PTR_VECTOR_IMPL(diag_map_ptr, zbx_diag_map_t *)
 
 static zbx_diag_add_section_info_func_t	add_diag_cb;
@@ -240,6 +246,34 @@ static void	diag_historycache_add_items(struct zbx_json *json, const char *field
 	zbx_json_close(json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add value latency statistics of history processing stages to json *
+ *                                                                            *
+ * Parameters: json    - [IN/OUT] the json to update                          *
+ *             latency - [IN] latency histograms of all processing stages     *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_historycache_add_latency(struct zbx_json *json, const zbx_hdr_histogram_t *latency)
+{
+	zbx_json_addarray(json, "latency");
+
+	for (int i = 0; i < ZBX_HC_LATENCY_STAGES_NUM; i++)
+	{
+		zbx_json_addobject(json, NULL);
+		zbx_json_addstring(json, "stage", zbx_hc_latency_stage_string(i), ZBX_JSON_TYPE_STRING);
+		zbx_json_adduint64(json, "count", latency[i].count);
+		zbx_json_addfloat(json, "avg", zbx_hdr_histogram_avg(&latency[i]) / 1000000);
+		zbx_json_addfloat(json, "p50", (double)zbx_hdr_histogram_percentile(&latency[i], 50) / 1000000);
+		zbx_json_addfloat(json, "p90", (double)zbx_hdr_histogram_percentile(&latency[i], 90) / 1000000);
+		zbx_json_addfloat(json, "p99", (double)zbx_hdr_histogram_percentile(&latency[i], 99) / 1000000);
+		zbx_json_addfloat(json, "max", (double)latency[i].max / 1000000);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add requested history cache diagnostic information to json data   *
@@ -260,12 +294,14 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 	zbx_uint64_t			fields;
 	zbx_diag_map_t			field_map[] = {
 							{"", ZBX_DIAG_HISTORYCACHE_SIMPLE |
-								ZBX_DIAG_HISTORYCACHE_MEMORY},
+								ZBX_DIAG_HISTORYCACHE_MEMORY |
+								ZBX_DIAG_HISTORYCACHE_LATENCY},
 							{"items", ZBX_DIAG_HISTORYCACHE_ITEMS},
 							{"values", ZBX_DIAG_HISTORYCACHE_VALUES},
 							{"memory", ZBX_DIAG_HISTORYCACHE_MEMORY},
 							{"memory.data", ZBX_DIAG_HISTORYCACHE_MEMORY_DATA},
 							{"memory.index", ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX},
+							{"latency", ZBX_DIAG_HISTORYCACHE_LATENCY},
 							{NULL, 0}
 						};
 
@@ -310,6 +346,22 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 			zbx_json_close(json);
 		}
 
+		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_LATENCY))
+		{
+			zbx_hdr_histogram_t	*latency;
+
+			latency = (zbx_hdr_histogram_t *)zbx_malloc(NULL, sizeof(zbx_hdr_histogram_t) *
+					ZBX_HC_LATENCY_STAGES_NUM);
+
+			time1 = zbx_time();
+			zbx_hc_get_latency(latency);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			diag_historycache_add_latency(json, latency);
+			zbx_free(latency);
+		}
+
 		if (0 != tops.values_num)
 		{
 			zbx_json_addobject(json, "top");
@@ -416,14 +468,14 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_PROBLEM_CACHE"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_PROBLEM_CACHE"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
@@ -449,6 +501,112 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 	zbx_json_close(json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add sampled profiling statistics of the most active functions of  *
+ *          each process type to json                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_add_profiler_functions(struct zbx_json *json, const char *field, int limit)
+{
+	zbx_json_addarray(json, field);
+
+	for (unsigned char proc_type = 0; proc_type < ZBX_PROCESS_TYPE_COUNT; proc_type++)
+	{
+		zbx_prof_stat_t	*stats;
+		int		stats_num;
+
+		zbx_selfmon_get_prof_stats(proc_type, &stats, &stats_num);
+
+		for (int i = 0; i < stats_num && i < limit; i++)
+		{
+			zbx_json_addobject(json, NULL);
+			zbx_json_addstring(json, "process", get_process_type_string(proc_type),
+					ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(json, "function", stats[i].func_name, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(json, "scope", zbx_prof_scope_string(stats[i].scope),
+					ZBX_JSON_TYPE_STRING);
+			zbx_json_addfloat(json, "cpu", (double)stats[i].samples * ZBX_PROF_SAMPLING_INTERVAL / 1000000);
+			zbx_json_adduint64(json, "locked", stats[i].locked);
+			zbx_json_addfloat(json, "wait", stats[i].sec_wait);
+			zbx_json_close(json);
+		}
+
+		zbx_free(stats);
+	}
+
+	zbx_json_close(json);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add requested sampling profiler diagnostic information to json    *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: jp    - [IN] the request                                       *
+ *             json  - [IN/OUT] the json to update                            *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the information was added successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_diag_add_profiler_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error)
+{
+	zbx_vector_diag_map_ptr_t	tops;
+	int				ret;
+	double				time1, time_total = 0;
+	zbx_uint64_t			fields;
+	zbx_diag_map_t			field_map[] = {
+							{"", ZBX_DIAG_PROFILER_SIMPLE},
+							{"interval", ZBX_DIAG_PROFILER_INTERVAL},
+							{NULL, 0}
+						};
+
+	zbx_vector_diag_map_ptr_create(&tops);
+
+	if (SUCCEED == (ret = zbx_diag_parse_request(jp, field_map, &fields, &tops, error)))
+	{
+		zbx_json_addobject(json, ZBX_DIAG_PROFILER);
+
+		if (0 != (fields & ZBX_DIAG_PROFILER_INTERVAL))
+			zbx_json_addfloat(json, "interval", (double)ZBX_PROF_SAMPLING_INTERVAL / 1000000);
+
+		if (0 != tops.values_num)
+		{
+			zbx_json_addobject(json, "top");
+
+			for (int i = 0; i < tops.values_num; i++)
+			{
+				zbx_diag_map_t	*map = tops.values[i];
+
+				if (0 == strcmp(map->name, "functions"))
+				{
+					time1 = zbx_time();
+					diag_add_profiler_functions(json, map->name, (int)map->value);
+					time_total += zbx_time() - time1;
+				}
+				else
+				{
+					*error = zbx_dsprintf(*error, "Unsupported top field: %s", map->name);
+					ret = FAIL;
+					break;
+				}
+			}
+
+			zbx_json_close(json);
+		}
+
+		zbx_json_addfloat(json, "time", time_total);
+		zbx_json_close(json);
+	}
+
+	zbx_vector_diag_map_ptr_clear_ext(&tops, zbx_diag_map_free);
+	zbx_vector_diag_map_ptr_destroy(&tops);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get diagnostic information                                        *
@@ -553,6 +711,9 @@ static void	diag_prepare_default_request(struct zbx_json *j, unsigned int flags)
 	if (0 != (flags & (1 << ZBX_DIAGINFO_PROXYBUFFER)))
 		diag_add_section_request(j, ZBX_DIAG_PROXYBUFFER, NULL);
 
+	if (0 != (flags & (1 << ZBX_DIAGINFO_PROFILER)))
+		diag_add_section_request(j, ZBX_DIAG_PROFILER, "functions", NULL);
+
 }
 
 /******************************************************************************
@@ -701,6 +862,7 @@ static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t
 	diag_log_memory_info(jp, "memory.data", "$.memory.data", out, out_alloc, out_offset);
 	diag_log_memory_info(jp, "memory.index", "$.memory.index", out, out_alloc, out_offset);
 
+	diag_log_top_view(jp, "latency", "$.latency", out, out_alloc, out_offset);
 	diag_log_top_view(jp, "top.values", "$.top.values", out, out_alloc, out_offset);
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
@@ -830,6 +992,26 @@ static void	diag_log_proxybuffer(struct zbx_json_parse *jp, char **out, size_t *
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log sampling profiler diagnostic information                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_profiler(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	char	*msg = NULL;
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "== profiler diagnostic information ==");
+
+	diag_get_simple_values(jp, &msg);
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
+	zbx_free(msg);
+
+	diag_log_top_view(jp, "top.functions", "$.top.functions", out, out_alloc, out_offset);
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: log diagnostic information                                        *
@@ -896,6 +1078,8 @@ void	zbx_diag_log_info(unsigned int flags, char **result)
 				diag_log_connector(&jp_section, result, &result_alloc, &result_offset);
 			else if (0 == strcmp(section, ZBX_DIAG_PROXYBUFFER))
 				diag_log_proxybuffer(&jp_section, result, &result_alloc, &result_offset);
+			else if (0 == strcmp(section, ZBX_DIAG_PROFILER))
+				diag_log_profiler(&jp_section, result, &result_alloc, &result_offset);
 		}
 	}
 	else
@@ -0,0 +1,620 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxevent.h"
+
+#include "zbxalgo.h"
+#include "zbxmutexs.h"
+#include "zbxshmem.h"
+#include "zbxstr.h"
+
+/*
+ * The problem cache contains open problems of triggers whose problems were loaded from database.
+ * A trigger is either cached with all its open problems or not cached at all, so a cached trigger
+ * without problems means that trigger has no open problems.
+ *
+ * Cached problems are changed only by processes holding the corresponding trigger locks, other
+ * changes (problem tags added by alert syncer) drop the affected triggers from cache and increase
+ * cache revision, so problems loaded from database concurrently are not cached.
+ */
+
+#define PC_TRIGGERS_INIT_SIZE	1000
+#define PC_PROBLEMS_INIT_SIZE	1000
+#define PC_STRPOOL_INIT_SIZE	1000
+
+#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
+
+typedef struct
+{
+	const char	*tag;
+	const char	*value;
+}
+zbx_pc_tag_t;
+
+typedef struct zbx_pc_problem
+{
+	zbx_uint64_t		eventid;
+	zbx_uint64_t		triggerid;
+	zbx_pc_tag_t		*tags;
+	int			tags_num;
+	struct zbx_pc_problem	*prev;
+	struct zbx_pc_problem	*next;
+}
+zbx_pc_problem_t;
+
+typedef struct
+{
+	zbx_uint64_t		triggerid;
+	zbx_pc_problem_t	*problems;
+}
+zbx_pc_trigger_t;
+
+typedef struct
+{
+	zbx_hashset_t	triggers;
+	zbx_hashset_t	problems;
+	zbx_hashset_t	strpool;
+
+	/* increased when problems are changed without holding trigger locks */
+	zbx_uint64_t	revision;
+}
+zbx_pc_cache_t;
+
+static zbx_pc_cache_t	*cache = NULL;
+
+static zbx_shmem_info_t	*pc_mem = NULL;
+
+static zbx_mutex_t	pc_lock = ZBX_MUTEX_NULL;
+
+ZBX_SHMEM_FUNC_IMPL(__pc, pc_mem)
+
+#define LOCK_CACHE	zbx_mutex_lock(pc_lock)
+#define UNLOCK_CACHE	zbx_mutex_unlock(pc_lock)
+
+static zbx_hash_t	pc_strpool_hash_func(const void *data)
+{
+	return ZBX_DEFAULT_STRING_HASH_FUNC((const char *)data + REFCOUNT_FIELD_SIZE);
+}
+
+static int	pc_strpool_compare_func(const void *d1, const void *d2)
+{
+	return strcmp((const char *)d1 + REFCOUNT_FIELD_SIZE, (const char *)d2 + REFCOUNT_FIELD_SIZE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies string to the cache string pool                            *
+ *                                                                            *
+ * Return value: The copied string or NULL if there was not enough space in   *
+ *               cache.                                                       *
+ *                                                                            *
+ * Comments: Tag names and values are highly repetitive, so matching strings  *
+ *           share the same copy with reference counter.                      *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*pc_strdup(const char *str)
+{
+	void	*ptr;
+	size_t	len = strlen(str) + 1;
+
+	if (NULL == (ptr = zbx_hashset_insert_ext(&cache->strpool, str - REFCOUNT_FIELD_SIZE,
+			REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE, REFCOUNT_FIELD_SIZE + len,
+			ZBX_HASHSET_UNIQ_FALSE)))
+	{
+		return NULL;
+	}
+
+	(*(zbx_uint32_t *)ptr)++;
+
+	return (const char *)ptr + REFCOUNT_FIELD_SIZE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases string copied with pc_strdup()                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	pc_strfree(const char *str)
+{
+	void	*ptr;
+
+	if (NULL == str)
+		return;
+
+	ptr = (void *)(str - REFCOUNT_FIELD_SIZE);
+
+	if (0 == --(*(zbx_uint32_t *)ptr))
+		zbx_hashset_remove_direct(&cache->strpool, ptr);
+}
+
+static void	pc_problem_clear(zbx_pc_problem_t *problem)
+{
+	for (int i = 0; i < problem->tags_num; i++)
+	{
+		pc_strfree(problem->tags[i].tag);
+		pc_strfree(problem->tags[i].value);
+	}
+
+	if (NULL != problem->tags)
+		__pc_shmem_free_func(problem->tags);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes problem from cache                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	pc_problem_remove(zbx_pc_problem_t *problem)
+{
+	if (NULL != problem->prev)
+	{
+		problem->prev->next = problem->next;
+	}
+	else
+	{
+		zbx_pc_trigger_t	*trigger;
+
+		if (NULL != (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers, &problem->triggerid)))
+			trigger->problems = problem->next;
+		else
+			THIS_SHOULD_NEVER_HAPPEN;
+	}
+
+	if (NULL != problem->next)
+		problem->next->prev = problem->prev;
+
+	pc_problem_clear(problem);
+	zbx_hashset_remove_direct(&cache->problems, problem);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes trigger with its problems from cache                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	pc_trigger_remove(zbx_pc_trigger_t *trigger)
+{
+	zbx_pc_problem_t	*problem, *next;
+
+	for (problem = trigger->problems; NULL != problem; problem = next)
+	{
+		next = problem->next;
+		pc_problem_clear(problem);
+		zbx_hashset_remove_direct(&cache->problems, problem);
+	}
+
+	zbx_hashset_remove_direct(&cache->triggers, trigger);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes all triggers and problems from cache                      *
+ *                                                                            *
+ * Comments: Used when cache runs out of memory - the triggers will be loaded *
+ *           again from database when needed.                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	pc_reset(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_pc_problem_t	*problem;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() triggers:%d problems:%d", __func__, cache->triggers.num_data,
+			cache->problems.num_data);
+
+	zbx_hashset_iter_reset(&cache->problems, &iter);
+	while (NULL != (problem = (zbx_pc_problem_t *)zbx_hashset_iter_next(&iter)))
+		pc_problem_clear(problem);
+
+	zbx_hashset_clear(&cache->problems);
+	zbx_hashset_clear(&cache->triggers);
+
+	cache->revision++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds problem to cached trigger                                    *
+ *                                                                            *
+ * Parameters: trigger - [IN] cached trigger                                  *
+ *             eventid - [IN] problem event identifier                        *
+ *             tags    - [IN] problem tags                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the problem was added                              *
+ *               FAIL    - not enough space in cache                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	pc_problem_add(zbx_pc_trigger_t *trigger, zbx_uint64_t eventid, const zbx_vector_tags_ptr_t *tags)
+{
+	zbx_pc_problem_t	*problem, problem_local = {.eventid = eventid, .triggerid = trigger->triggerid};
+
+	if (NULL != zbx_hashset_search(&cache->problems, &eventid))
+		return SUCCEED;
+
+	if (NULL == (problem = (zbx_pc_problem_t *)zbx_hashset_insert(&cache->problems, &problem_local,
+			sizeof(problem_local))))
+	{
+		return FAIL;
+	}
+
+	if (0 != tags->values_num)
+	{
+		size_t	size = sizeof(zbx_pc_tag_t) * (size_t)tags->values_num;
+
+		if (NULL == (problem->tags = (zbx_pc_tag_t *)__pc_shmem_malloc_func(NULL, size)))
+			goto fail;
+
+		for (int i = 0; i < tags->values_num; i++)
+		{
+			zbx_pc_tag_t	*tag = &problem->tags[problem->tags_num];
+
+			if (NULL == (tag->tag = pc_strdup(tags->values[i]->tag)))
+				goto fail;
+
+			if (NULL == (tag->value = pc_strdup(tags->values[i]->value)))
+			{
+				pc_strfree(tag->tag);
+				goto fail;
+			}
+
+			problem->tags_num++;
+		}
+	}
+
+	if (NULL != (problem->next = trigger->problems))
+		problem->next->prev = problem;
+
+	trigger->problems = problem;
+
+	return SUCCEED;
+fail:
+	pc_problem_clear(problem);
+	zbx_hashset_remove_direct(&cache->problems, problem);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes problem cache                                         *
+ *                                                                            *
+ * Parameters: cache_size - [IN] size of shared memory, 0 to disable cache    *
+ *             error      - [OUT]                                             *
+ *                                                                            *
+ * Return value: SUCCEED - the cache was initialized successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_problem_cache_init(zbx_uint64_t cache_size, char **error)
+{
+	int	ret = FAIL;
+
+	if (0 == cache_size)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "%s(): problem cache disabled", __func__);
+		return SUCCEED;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != zbx_mutex_create(&pc_lock, ZBX_MUTEX_PROBLEM_CACHE, error))
+		goto out;
+
+	if (SUCCEED != zbx_shmem_create(&pc_mem, cache_size, "problem cache size", "ProblemCacheSize", 1, error))
+		goto out;
+
+	if (NULL == (cache = (zbx_pc_cache_t *)__pc_shmem_malloc_func(NULL, sizeof(zbx_pc_cache_t))))
+	{
+		*error = zbx_strdup(*error, "cannot allocate problem cache header");
+		goto out;
+	}
+
+	memset(cache, 0, sizeof(zbx_pc_cache_t));
+
+	zbx_hashset_create_ext(&cache->triggers, PC_TRIGGERS_INIT_SIZE, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL, __pc_shmem_malloc_func, __pc_shmem_realloc_func,
+			__pc_shmem_free_func);
+
+	zbx_hashset_create_ext(&cache->problems, PC_PROBLEMS_INIT_SIZE, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL, __pc_shmem_malloc_func, __pc_shmem_realloc_func,
+			__pc_shmem_free_func);
+
+	zbx_hashset_create_ext(&cache->strpool, PC_STRPOOL_INIT_SIZE, pc_strpool_hash_func, pc_strpool_compare_func,
+			NULL, __pc_shmem_malloc_func, __pc_shmem_realloc_func, __pc_shmem_free_func);
+
+	if (NULL == cache->triggers.slots || NULL == cache->problems.slots || NULL == cache->strpool.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate problem cache data storage");
+		goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys problem cache                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_cache_destroy(void)
+{
+	if (NULL == cache)
+		return;
+
+	pc_reset();
+
+	zbx_hashset_destroy(&cache->strpool);
+	zbx_hashset_destroy(&cache->problems);
+	zbx_hashset_destroy(&cache->triggers);
+
+	__pc_shmem_free_func(cache);
+	cache = NULL;
+
+	zbx_shmem_destroy(pc_mem);
+	pc_mem = NULL;
+	zbx_mutex_destroy(&pc_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets cached open problems of the specified triggers               *
+ *                                                                            *
+ * Parameters: triggerids      - [IN] trigger identifiers                     *
+ *             problems        - [OUT] open problems of cached triggers       *
+ *             triggerids_miss - [OUT] triggers not found in cache            *
+ *                                                                            *
+ * Return value: cache revision to be passed to zbx_problem_cache_set() when  *
+ *               caching problems of missing triggers                         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_problem_cache_get(const zbx_vector_uint64_t *triggerids, zbx_vector_ptr_t *problems,
+		zbx_vector_uint64_t *triggerids_miss)
+{
+	zbx_uint64_t	revision;
+
+	if (NULL == cache)
+	{
+		zbx_vector_uint64_append_array(triggerids_miss, triggerids->values, triggerids->values_num);
+		return 0;
+	}
+
+	LOCK_CACHE;
+
+	for (int i = 0; i < triggerids->values_num; i++)
+	{
+		zbx_pc_trigger_t	*trigger;
+
+		if (NULL == (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers,
+				&triggerids->values[i])))
+		{
+			zbx_vector_uint64_append(triggerids_miss, triggerids->values[i]);
+			continue;
+		}
+
+		for (const zbx_pc_problem_t *pc_problem = trigger->problems; NULL != pc_problem;
+				pc_problem = pc_problem->next)
+		{
+			zbx_event_problem_t	*problem;
+
+			problem = (zbx_event_problem_t *)zbx_malloc(NULL, sizeof(zbx_event_problem_t));
+			problem->eventid = pc_problem->eventid;
+			problem->triggerid = pc_problem->triggerid;
+			zbx_vector_tags_ptr_create(&problem->tags);
+			zbx_vector_tags_ptr_reserve(&problem->tags, (size_t)pc_problem->tags_num);
+
+			for (int j = 0; j < pc_problem->tags_num; j++)
+			{
+				zbx_tag_t	*tag;
+
+				tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+				tag->tag = zbx_strdup(NULL, pc_problem->tags[j].tag);
+				tag->value = zbx_strdup(NULL, pc_problem->tags[j].value);
+				zbx_vector_tags_ptr_append(&problem->tags, tag);
+			}
+
+			zbx_vector_ptr_append(problems, problem);
+		}
+	}
+
+	revision = cache->revision;
+
+	UNLOCK_CACHE;
+
+	return revision;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: caches open problems of triggers loaded from database             *
+ *                                                                            *
+ * Parameters: triggerids - [IN] loaded triggers (sorted)                     *
+ *             problems   - [IN] open problems, problems of other triggers    *
+ *                               are ignored                                  *
+ *             revision   - [IN] cache revision returned by                   *
+ *                               zbx_problem_cache_get() before loading       *
+ *                                                                            *
+ * Comments: The problems are not cached if cache revision has changed since  *
+ *           the loading, as they might have been changed in the meantime.    *
+ *           Triggers that are already cached are left unchanged.             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_cache_set(const zbx_vector_uint64_t *triggerids, const zbx_vector_ptr_t *problems,
+		zbx_uint64_t revision)
+{
+	zbx_vector_uint64_t	triggerids_new;
+
+	if (NULL == cache || 0 == triggerids->values_num)
+		return;
+
+	zbx_vector_uint64_create(&triggerids_new);
+
+	LOCK_CACHE;
+
+	if (revision != cache->revision)
+		goto out;
+
+	for (int i = 0; i < triggerids->values_num; i++)
+	{
+		zbx_pc_trigger_t	trigger_local = {.triggerid = triggerids->values[i]};
+
+		/* triggers cached meanwhile by other process already have all their open problems */
+		if (NULL != zbx_hashset_search(&cache->triggers, &trigger_local.triggerid))
+			continue;
+
+		if (NULL == zbx_hashset_insert(&cache->triggers, &trigger_local, sizeof(trigger_local)))
+		{
+			pc_reset();
+			goto out;
+		}
+
+		zbx_vector_uint64_append(&triggerids_new, trigger_local.triggerid);
+	}
+
+	for (int i = 0; i < problems->values_num; i++)
+	{
+		const zbx_event_problem_t	*problem = (const zbx_event_problem_t *)problems->values[i];
+		zbx_pc_trigger_t		*trigger;
+
+		if (FAIL == zbx_vector_uint64_bsearch(&triggerids_new, problem->triggerid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			continue;
+		}
+
+		if (NULL == (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers, &problem->triggerid)))
+			continue;
+
+		if (SUCCEED != pc_problem_add(trigger, problem->eventid, &problem->tags))
+		{
+			pc_reset();
+			goto out;
+		}
+	}
+out:
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_destroy(&triggerids_new);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates cached triggers with new and recovered problems           *
+ *                                                                            *
+ * Parameters: problem_events - [IN] new trigger problem events               *
+ *             r_eventids     - [IN] recovered problem event identifiers      *
+ *                                                                            *
+ * Comments: New problems are added only to the already cached triggers,      *
+ *           problems of other triggers will be loaded from database.         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_cache_update(const zbx_vector_db_event_t *problem_events, const zbx_vector_uint64_t *r_eventids)
+{
+	if (NULL == cache)
+		return;
+
+	LOCK_CACHE;
+
+	for (int i = 0; i < r_eventids->values_num; i++)
+	{
+		zbx_pc_problem_t	*problem;
+
+		if (NULL != (problem = (zbx_pc_problem_t *)zbx_hashset_search(&cache->problems,
+				&r_eventids->values[i])))
+		{
+			pc_problem_remove(problem);
+		}
+	}
+
+	for (int i = 0; i < problem_events->values_num; i++)
+	{
+		const zbx_db_event	*event = problem_events->values[i];
+		zbx_pc_trigger_t	*trigger;
+
+		if (NULL == (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers, &event->objectid)))
+			continue;
+
+		if (SUCCEED != pc_problem_add(trigger, event->eventid, &event->tags))
+		{
+			pc_reset();
+			break;
+		}
+	}
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes the specified triggers from cache                         *
+ *                                                                            *
+ * Parameters: triggerids - [IN]                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_cache_invalidate_triggers(const zbx_vector_uint64_t *triggerids)
+{
+	if (NULL == cache || 0 == triggerids->values_num)
+		return;
+
+	LOCK_CACHE;
+
+	for (int i = 0; i < triggerids->values_num; i++)
+	{
+		zbx_pc_trigger_t	*trigger;
+
+		if (NULL != (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers,
+				&triggerids->values[i])))
+		{
+			pc_trigger_remove(trigger);
+		}
+	}
+
+	cache->revision++;
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes triggers of the specified problems from cache             *
+ *                                                                            *
+ * Parameters: eventids - [IN] problem event identifiers                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_problem_cache_invalidate_events(const zbx_vector_uint64_t *eventids)
+{
+	if (NULL == cache || 0 == eventids->values_num)
+		return;
+
+	LOCK_CACHE;
+
+	for (int i = 0; i < eventids->values_num; i++)
+	{
+		zbx_pc_problem_t	*problem;
+		zbx_pc_trigger_t	*trigger;
+
+		if (NULL == (problem = (zbx_pc_problem_t *)zbx_hashset_search(&cache->problems, &eventids->values[i])))
+			continue;
+
+		if (NULL != (trigger = (zbx_pc_trigger_t *)zbx_hashset_search(&cache->triggers, &problem->triggerid)))
+			pc_trigger_remove(trigger);
+	}
+
+	cache->revision++;
+
+	UNLOCK_CACHE;
+}
@@ -630,6 +630,228 @@ static int	is_strict_macro(const char *macro)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets value of macro already resolved in the same string           *
+ *                                                                            *
+ * Comments: macros are matched by the whole token text, so indexed macros    *
+ *           ({ITEM.VALUE1}, {ITEM.VALUE2}) and function macros with          *
+ *           different functions or parameters are resolved separately.       *
+ *           Only the current substitution call is covered - resolved values  *
+ *           are not shared between strings of the same event, only token     *
+ *           locations are kept between calls (see macro_template_get()).     *
+ *                                                                            *
+ * Parameters: resolved - [IN] resolved macro tokens and their values         *
+ *             data     - [IN] string with macros being substituted           *
+ *             loc      - [IN] macro token location in data                   *
+ *                                                                            *
+ * Return value: resolved value or NULL if the macro was not resolved yet     *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*resolved_macro_get(const zbx_vector_ptr_pair_t *resolved, const char *data,
+		const zbx_strloc_t *loc)
+{
+	size_t	len = loc->r - loc->l + 1;
+
+	for (int i = 0; i < resolved->values_num; i++)
+	{
+		const char	*macro = (const char *)resolved->values[i].first;
+
+		if (0 == strncmp(macro, data + loc->l, len) && '\0' == macro[len])
+			return (const char *)resolved->values[i].second;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remembers resolved macro value so that other occurrences of the   *
+ *          same macro in the string are replaced without resolving it again  *
+ *                                                                            *
+ * Parameters: resolved - [IN/OUT] resolved macro tokens and their values     *
+ *             data     - [IN] string with macros being substituted           *
+ *             loc      - [IN] macro token location in data                   *
+ *             value    - [IN] resolved value                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	resolved_macro_add(zbx_vector_ptr_pair_t *resolved, const char *data, const zbx_strloc_t *loc,
+		const char *value)
+{
+	zbx_ptr_pair_t	pair;
+
+	pair.first = zbx_dsprintf(NULL, "%.*s", (int)(loc->r - loc->l + 1), data + loc->l);
+	pair.second = zbx_strdup(NULL, value);
+
+	zbx_vector_ptr_pair_append(resolved, pair);
+}
+
+static void	resolved_macros_free(zbx_vector_ptr_pair_t *resolved)
+{
+	for (int i = 0; i < resolved->values_num; i++)
+	{
+		zbx_free(resolved->values[i].first);
+		zbx_free(resolved->values[i].second);
+	}
+
+	zbx_vector_ptr_pair_destroy(resolved);
+}
+
+/* macro types with strings shared by many events - message templates, trigger and event names */
+#define ZBX_MACRO_TEMPLATE_TYPES	(ZBX_MACRO_TYPE_MESSAGE_NORMAL | ZBX_MACRO_TYPE_MESSAGE_RECOVERY |	\
+		ZBX_MACRO_TYPE_MESSAGE_UPDATE | ZBX_MACRO_TYPE_TRIGGER_DESCRIPTION | ZBX_MACRO_TYPE_EVENT_NAME)
+
+#define ZBX_MACRO_TEMPLATES_MAX	1000
+
+typedef struct
+{
+	char			*data;
+	size_t			size;
+	zbx_token_search_t	token_search;
+
+	/* locations (left, right) of tokens found while substituting macros one after another */
+	zbx_vector_uint64_pair_t	tokens;
+}
+zbx_macro_template_t;
+
+static zbx_hashset_t	macro_templates;
+static zbx_uint64_t	macro_templates_revision;
+
+static zbx_hash_t	macro_template_hash_func(const void *d)
+{
+	const zbx_macro_template_t	*template = (const zbx_macro_template_t *)d;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(template->data, template->size, ZBX_DEFAULT_HASH_SEED);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(&template->token_search, sizeof(template->token_search), hash);
+}
+
+static int	macro_template_compare_func(const void *d1, const void *d2)
+{
+	const zbx_macro_template_t	*t1 = (const zbx_macro_template_t *)d1;
+	const zbx_macro_template_t	*t2 = (const zbx_macro_template_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(t1->token_search, t2->token_search);
+	ZBX_RETURN_IF_NOT_EQUAL(t1->size, t2->size);
+
+	return memcmp(t1->data, t2->data, t1->size);
+}
+
+static void	macro_template_clear(zbx_macro_template_t *template)
+{
+	zbx_free(template->data);
+	zbx_vector_uint64_pair_destroy(&template->tokens);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets tokenized macro template, tokenizing and caching the string  *
+ *          when it is substituted for the first time                         *
+ *                                                                            *
+ * Parameters: data         - [IN] string with macros before substitution     *
+ *             size         - [IN] string size including terminating zero     *
+ *             token_search - [IN]                                            *
+ *                                                                            *
+ * Return value: tokenized template or NULL if template cache is full         *
+ *                                                                            *
+ * Comments: Templates are cached in process memory by the string contents.   *
+ *           The cache is dropped when configuration cache revision changes,  *
+ *           so it holds only templates of the current configuration.         *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_macro_template_t	*macro_template_get(const char *data, size_t size,
+		zbx_token_search_t token_search)
+{
+	zbx_macro_template_t	template_local, *template;
+	zbx_uint64_t		revision;
+	zbx_token_t		token;
+
+	revision = zbx_dc_get_config_revision();
+
+	if (0 == macro_templates.num_slots)
+	{
+		zbx_hashset_create_ext(&macro_templates, 100, macro_template_hash_func, macro_template_compare_func,
+				(zbx_clean_func_t)macro_template_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+				ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+	else if (revision != macro_templates_revision)
+		zbx_hashset_clear(&macro_templates);
+
+	macro_templates_revision = revision;
+
+	template_local.data = (char *)data;
+	template_local.size = size;
+	template_local.token_search = token_search;
+
+	if (NULL != (template = (zbx_macro_template_t *)zbx_hashset_search(&macro_templates, &template_local)))
+		return template;
+
+	if (ZBX_MACRO_TEMPLATES_MAX <= macro_templates.num_data)
+		return NULL;
+
+	template = (zbx_macro_template_t *)zbx_hashset_insert(&macro_templates, &template_local,
+			sizeof(template_local));
+	template->data = (char *)zbx_malloc(NULL, size);
+	memcpy(template->data, data, size);
+	zbx_vector_uint64_pair_create(&template->tokens);
+
+	for (int pos = 0; SUCCEED == zbx_token_find(data, pos, &token, token_search); pos = token.loc.r + 1)
+	{
+		zbx_uint64_pair_t	pair = {.first = token.loc.l, .second = token.loc.r};
+
+		zbx_vector_uint64_pair_append(&template->tokens, pair);
+	}
+
+	return template;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds next token in string being substituted                      *
+ *                                                                            *
+ * Parameters: template     - [IN/OUT] tokenized template, reset to NULL when *
+ *                                     substitution deviates from it          *
+ *             index        - [IN/OUT] next template token                    *
+ *             data         - [IN] string being substituted                   *
+ *             data_len     - [IN] string size including terminating zero     *
+ *             pos          - [IN] position to search from                    *
+ *             token        - [OUT]                                           *
+ *             token_search - [IN]                                            *
+ *                                                                            *
+ * Return value: SUCCEED - token was found                                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The string is changed only before the search position, so while  *
+ *           macros are replaced one after another the rest of the string     *
+ *           matches the template after the previous token. Next token is     *
+ *           then taken from template and only parsed again instead of        *
+ *           scanning text before it. Otherwise the string is scanned.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	macro_template_next_token(const zbx_macro_template_t **template, int *index, const char *data,
+		size_t data_len, int pos, zbx_token_t *token, zbx_token_search_t token_search)
+{
+	if (NULL != *template)
+	{
+		const zbx_vector_uint64_pair_t	*tokens = &(*template)->tokens;
+		zbx_uint64_t			start = (0 == *index ? 0 : tokens->values[*index - 1].second + 1);
+		int				shift = (int)data_len - (int)(*template)->size;
+
+		if ((zbx_uint64_t)(pos - shift) == start)
+		{
+			if (*index == tokens->values_num)
+				return FAIL;
+
+			return zbx_token_find(data, (int)tokens->values[(*index)++].first + shift, token, token_search);
+		}
+
+		*template = NULL;
+	}
+
+	return zbx_token_find(data, pos, token, token_search);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: substitute simple macros in data string with real values.         *
@@ -643,7 +865,7 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 		int maxerrlen)
 {
 	char				c, *replace_to = NULL, sql[64], *m_ptr;
-	const char			*m;
+	const char			*m, *resolved_value;
 	int				N_functionid, indexed_macro, ret, res = SUCCEED,
 					pos = 0, found, user_names_found = 0, raw_value;
 	size_t				data_alloc, data_len;
@@ -656,6 +878,9 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 					*user_surname = NULL;
 	zbx_dc_um_handle_t		*um_handle;
 	zbx_db_event			*cause_event = NULL, *cause_recovery_event = NULL;
+	zbx_vector_ptr_pair_t		resolved;
+	const zbx_macro_template_t	*template = NULL;
+	int				template_index = 0;
 
 	if (NULL == data || NULL == *data || '\0' == **data)
 	{
@@ -679,11 +904,19 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 
 	um_handle = zbx_dc_open_user_macros();
 	zbx_vector_uint64_create(&hostids);
+	zbx_vector_ptr_pair_create(&resolved);
 
 	data_alloc = data_len = strlen(*data) + 1;
 
-	for (found = SUCCEED; SUCCEED == res && SUCCEED == found;
-			found = zbx_token_find(*data, pos, &token, token_search))
+	/* the first token is already found, template is used to find the following ones */
+	if (0 != (macro_type & ZBX_MACRO_TEMPLATE_TYPES) &&
+			NULL != (template = macro_template_get(*data, data_len, token_search)))
+	{
+		template_index = 1;
+	}
+
+	for (found = SUCCEED; SUCCEED == res && SUCCEED == found; found = macro_template_next_token(&template,
+			&template_index, *data, data_len, pos, &token, token_search))
 	{
 		indexed_macro = 0;
 		N_functionid = 1;
@@ -692,6 +925,17 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 		inner_token = token;
 		ret = SUCCEED;
 
+		/* templated messages often repeat the same macros, resolve each of them only once, */
+		/* failed macros are not remembered and are resolved again on the next occurrence    */
+		if (NULL != (resolved_value = resolved_macro_get(&resolved, *data, &token.loc)))
+		{
+			pos = token.loc.r;
+			pos += zbx_replace_mem_dyn(data, &data_alloc, &data_len, token.loc.l,
+					token.loc.r - token.loc.l + 1, resolved_value, strlen(resolved_value));
+			pos++;
+			continue;
+		}
+
 		switch (token.type)
 		{
 			case ZBX_TOKEN_OBJECTID:
@@ -2805,6 +3049,9 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 
 		if (NULL != replace_to)
 		{
+			if (SUCCEED == ret)
+				resolved_macro_add(&resolved, *data, &token.loc, replace_to);
+
 			pos = token.loc.r;
 
 			pos += zbx_replace_mem_dyn(data, &data_alloc, &data_len, token.loc.l,
@@ -2820,6 +3067,8 @@ int	substitute_simple_macros_impl(const zbx_uint64_t *actionid, const zbx_db_eve
 
 	zbx_vc_flush_stats();
 
+	resolved_macros_free(&resolved);
+
 	zbx_free(user_username);
 	zbx_free(user_name);
 	zbx_free(user_surname);
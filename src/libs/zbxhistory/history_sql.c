@@ -163,6 +163,9 @@ static int	sql_writer_flush(void)
 	{
 		zbx_db_begin();
 
+		/* send all inserts of the batch without waiting for each result */
+		zbx_db_pipeline_enable();
+
 		for (i = 0; i < writer.dbinserts.values_num; i++)
 		{
 			zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
@@ -1332,8 +1332,10 @@ struct zbx_json	*zbx_json_clone(const struct zbx_json *src)
 	if (src->buffer != src->buf_stat)
 	{
 		dst->buffer = (char *)zbx_malloc(NULL, dst->buffer_allocated);
-		memcpy(dst->buffer, src->buffer, src->buffer_size);
+		memcpy(dst->buffer, src->buffer, src->buffer_size + 1);
 	}
+	else
+		dst->buffer = dst->buf_stat;
 
 	return dst;
 }
@@ -55,7 +55,7 @@ static void	common_sigusr_handler(int flags)
 			zbx_prof_enable(ZBX_RTC_GET_SCOPE(flags));
 			break;
 		case ZBX_RTC_PROF_DISABLE:
-			zbx_prof_disable();
+			zbx_prof_disable(ZBX_RTC_GET_SCOPE(flags));
 			break;
 		case ZBX_RTC_LOG_LEVEL_DECREASE:
 			zabbix_decrease_log_level();
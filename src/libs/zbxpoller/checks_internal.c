@@ -587,6 +587,127 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 			SET_DBL_RESULT(result, value);
 		}
 	}
+	else if (0 == strcmp(tmp, "profiler"))			/* zabbix[profiler,<type>,<limit>] */
+	{
+		unsigned char	process_type;
+		unsigned int	limit = 25;
+		zbx_prof_stat_t	*stats;
+		int		stats_num;
+		struct zbx_json	json;
+
+		if (2 > nparams || nparams > 3)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		if (ZBX_PROCESS_TYPE_COUNT <= (process_type = (unsigned char)get_process_type_by_name(
+				get_rparam(&request, 1))))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+
+		if (NULL != (tmp = get_rparam(&request, 2)) && '\0' != *tmp &&
+				(SUCCEED != zbx_is_uint31(tmp, &limit) || 0 == limit))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+			goto out;
+		}
+
+		zbx_selfmon_get_prof_stats(process_type, &stats, &stats_num);
+
+		zbx_json_initarray(&json, ZBX_JSON_STAT_BUF_LEN);
+
+		for (int i = 0; i < stats_num && i < (int)limit; i++)
+		{
+			zbx_json_addobject(&json, NULL);
+			zbx_json_addstring(&json, "function", stats[i].func_name, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&json, "scope", zbx_prof_scope_string(stats[i].scope), ZBX_JSON_TYPE_STRING);
+			zbx_json_addfloat(&json, "cpu", (double)stats[i].samples * ZBX_PROF_SAMPLING_INTERVAL / 1000000);
+			zbx_json_adduint64(&json, "locked", stats[i].locked);
+			zbx_json_addfloat(&json, "wait", stats[i].sec_wait);
+			zbx_json_close(&json);
+		}
+
+		zbx_json_close(&json);
+		SET_TEXT_RESULT(result, zbx_strdup(NULL, json.buffer));
+
+		zbx_json_free(&json);
+		zbx_free(stats);
+	}
+	else if (0 == strcmp(tmp, "compression"))		/* zabbix[compression,<direction>,<mode>] */
+	{
+		int			direction;
+		zbx_compress_stats_t	stats;
+
+		if (2 > nparams || nparams > 3)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		tmp = get_rparam(&request, 1);
+
+		if (0 == strcmp(tmp, "sent"))
+			direction = ZBX_COMPRESS_STATS_SENT;
+		else if (0 == strcmp(tmp, "received"))
+			direction = ZBX_COMPRESS_STATS_RECEIVED;
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+
+		zbx_selfmon_get_compress_stats(direction, &stats);
+
+		tmp = get_rparam(&request, 2);
+
+		if (NULL == tmp || '\0' == *tmp || 0 == strcmp(tmp, "ratio"))
+		{
+			SET_DBL_RESULT(result, 0 == stats.bytes_compressed ? 0 :
+					(double)stats.bytes / (double)stats.bytes_compressed);
+		}
+		else if (0 == strcmp(tmp, "time"))
+			SET_DBL_RESULT(result, stats.time);
+		else if (0 == strcmp(tmp, "messages"))
+			SET_UI64_RESULT(result, stats.messages);
+		else if (0 == strcmp(tmp, "bytes"))
+			SET_UI64_RESULT(result, stats.bytes);
+		else if (0 == strcmp(tmp, "compressed"))
+			SET_UI64_RESULT(result, stats.bytes_compressed);
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+			goto out;
+		}
+	}
+	else if (0 == strcmp(tmp, "tls"))			/* zabbix[tls,<mode>] */
+	{
+		zbx_uint64_t	stats[ZBX_TLS_STATS_COUNT];
+
+		if (2 < nparams)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		zbx_selfmon_get_tls_stats(stats);
+
+		tmp = get_rparam(&request, 1);
+
+		if (NULL == tmp || '\0' == *tmp || 0 == strcmp(tmp, "full"))
+			SET_UI64_RESULT(result, stats[ZBX_TLS_STATS_HANDSHAKES_FULL]);
+		else if (0 == strcmp(tmp, "resumed"))
+			SET_UI64_RESULT(result, stats[ZBX_TLS_STATS_HANDSHAKES_RESUMED]);
+		else if (0 == strcmp(tmp, "ktls"))
+			SET_UI64_RESULT(result, stats[ZBX_TLS_STATS_KTLS]);
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+	}
 	else if (0 == strcmp(tmp, "wcache"))			/* zabbix[wcache,<cache>,<mode>] */
 	{
 		if (2 > nparams || nparams > 3)
@@ -724,6 +845,51 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 			goto out;
 		}
 	}
+	else if (0 == strcmp(tmp, "latency"))			/* zabbix[latency,<stage>,<mode>] */
+	{
+		int			stage;
+		zbx_hdr_histogram_t	*latency;
+
+		if (2 > nparams || nparams > 3)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		if (FAIL == (stage = zbx_hc_latency_stage_by_name(get_rparam(&request, 1))))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+
+		latency = (zbx_hdr_histogram_t *)zbx_malloc(NULL, sizeof(zbx_hdr_histogram_t) * ZBX_HC_LATENCY_STAGES_NUM);
+		zbx_hc_get_latency(latency);
+
+		tmp = get_rparam(&request, 2);
+
+		if (NULL == tmp || '\0' == *tmp || 0 == strcmp(tmp, "avg"))
+			SET_DBL_RESULT(result, zbx_hdr_histogram_avg(&latency[stage]) / 1000000);
+		else if (0 == strcmp(tmp, "p50"))
+			SET_DBL_RESULT(result, (double)zbx_hdr_histogram_percentile(&latency[stage], 50) / 1000000);
+		else if (0 == strcmp(tmp, "p90"))
+			SET_DBL_RESULT(result, (double)zbx_hdr_histogram_percentile(&latency[stage], 90) / 1000000);
+		else if (0 == strcmp(tmp, "p95"))
+			SET_DBL_RESULT(result, (double)zbx_hdr_histogram_percentile(&latency[stage], 95) / 1000000);
+		else if (0 == strcmp(tmp, "p99"))
+			SET_DBL_RESULT(result, (double)zbx_hdr_histogram_percentile(&latency[stage], 99) / 1000000);
+		else if (0 == strcmp(tmp, "max"))
+			SET_DBL_RESULT(result, (double)latency[stage].max / 1000000);
+		else if (0 == strcmp(tmp, "count"))
+			SET_UI64_RESULT(result, latency[stage].count);
+		else
+		{
+			zbx_free(latency);
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+			goto out;
+		}
+
+		zbx_free(latency);
+	}
 	else if (0 == strcmp(tmp, "rcache"))			/* zabbix[rcache,<cache>,<mode>] */
 	{
 		if (2 > nparams || nparams > 3)
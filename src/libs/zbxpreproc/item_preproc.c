@@ -29,150 +29,6 @@
 
 #include "zbxnum.h"
 
-/******************************************************************************
- *                                                                            *
- * Purpose: returns numeric type hint based on item value type                *
- *                                                                            *
- * Parameters: value_type - [IN] item value type                              *
- *                                                                            *
- * Return value: variant numeric type or none                                 *
- *                                                                            *
- ******************************************************************************/
-static int	item_preproc_numeric_type_hint(unsigned char value_type)
-{
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_FLOAT:
-			return ZBX_VARIANT_DBL;
-		case ITEM_VALUE_TYPE_UINT64:
-			return ZBX_VARIANT_UI64;
-		default:
-			return ZBX_VARIANT_NONE;
-	}
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: convert variant value to the requested type                       *
- *                                                                            *
- * Parameters: value  - [IN/OUT] value to convert                             *
- *             type   - [IN] new value type                                   *
- *             errmsg - [OUT]                                                 *
- *                                                                            *
- * Return value: SUCCEED - the value was converted successfully               *
- *               FAIL - otherwise, errmsg contains the error message          *
- *                                                                            *
- ******************************************************************************/
-int	item_preproc_convert_value(zbx_variant_t *value, unsigned char type, char **errmsg)
-{
-	if (FAIL == zbx_variant_convert(value, type))
-	{
-		*errmsg = zbx_dsprintf(*errmsg, "cannot convert value to %s", zbx_get_variant_type_desc(type));
-		return FAIL;
-	}
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: converts variant value to numeric                                 *
- *                                                                            *
- * Parameters: value_num  - [OUT] converted value                             *
- *             value      - [IN] value to convert                             *
- *             value_type - [IN] item value type                              *
- *             errmsg     - [OUT]                                             *
- *                                                                            *
- * Return value: SUCCEED - the value was converted successfully               *
- *               FAIL - otherwise                                             *
- *                                                                            *
- ******************************************************************************/
-int	zbx_item_preproc_convert_value_to_numeric(zbx_variant_t *value_num, const zbx_variant_t *value,
-		unsigned char value_type, char **errmsg)
-{
-	int	ret = FAIL, type_hint;
-
-	switch (value->type)
-	{
-		case ZBX_VARIANT_DBL:
-		case ZBX_VARIANT_UI64:
-			zbx_variant_copy(value_num, value);
-			ret = SUCCEED;
-			break;
-		case ZBX_VARIANT_STR:
-			ret = zbx_variant_set_numeric(value_num, value->data.str);
-			break;
-		default:
-			ret = FAIL;
-	}
-
-	if (FAIL == ret)
-	{
-		*errmsg = zbx_strdup(*errmsg, "cannot convert value to numeric type");
-		return FAIL;
-	}
-
-	if (ZBX_VARIANT_NONE != (type_hint = item_preproc_numeric_type_hint(value_type)))
-	{
-		if (FAIL == zbx_variant_convert(value_num, type_hint))
-		{
-			*errmsg = zbx_dsprintf(*errmsg, "cannot convert value from %s to %s",
-					zbx_variant_type_desc(value_num), zbx_get_variant_type_desc(type_hint));
-			zabbix_log(LOG_LEVEL_CRIT, *errmsg);
-			return FAIL;
-		}
-	}
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: execute custom multiplier preprocessing operation on variant      *
- *          value type                                                        *
- *                                                                            *
- * Parameters: value_type - [IN] item type                                    *
- *             value      - [IN/OUT] value to process                         *
- *             params     - [IN] operation parameters                         *
- *             errmsg     - [OUT]                                             *
- *                                                                            *
- * Return value: SUCCEED - the preprocessing step finished successfully       *
- *               FAIL - otherwise, errmsg contains the error message          *
- *                                                                            *
- ******************************************************************************/
-int	item_preproc_multiplier_variant(unsigned char value_type, zbx_variant_t *value, const char *params,
-		char **errmsg)
-{
-	zbx_uint64_t	multiplier_ui64, value_ui64;
-	double		value_dbl;
-	zbx_variant_t	value_num;
-
-	if (FAIL == zbx_item_preproc_convert_value_to_numeric(&value_num, value, value_type, errmsg))
-		return FAIL;
-
-	switch (value_num.type)
-	{
-		case ZBX_VARIANT_DBL:
-			value_dbl = value_num.data.dbl * atof(params);
-			zbx_variant_clear(value);
-			zbx_variant_set_dbl(value, value_dbl);
-			break;
-		case ZBX_VARIANT_UI64:
-			if (SUCCEED == zbx_is_uint64(params, &multiplier_ui64))
-				value_ui64 = value_num.data.ui64 * multiplier_ui64;
-			else
-				value_ui64 = (zbx_uint64_t)((double)value_num.data.ui64 * atof(params));
-
-			zbx_variant_clear(value);
-			zbx_variant_set_ui64(value, value_ui64);
-			break;
-	}
-
-	zbx_variant_clear(&value_num);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: execute delta type preprocessing operation                        *
@@ -415,7 +271,7 @@ int	item_preproc_trim(zbx_variant_t *value, int op_type, const char *params, cha
 	char	*params_raw;
 	size_t	params_len;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	params_len = strlen(params);
@@ -562,7 +418,7 @@ int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg)
 
 	zbx_uint64_t	value_ui64;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	zbx_ltrim(value->data.str, " \"");
@@ -611,64 +467,6 @@ int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg)
 #undef HEX2UINT64
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: execute regular expression substitution operation                 *
- *                                                                            *
- * Parameters: value  - [IN/OUT] value to process                             *
- *             params - [IN] operation parameters                             *
- *             errmsg - [OUT]                                                 *
- *                                                                            *
- * Return value: SUCCEED - the value was processed successfully               *
- *               FAIL - otherwise                                             *
- *                                                                            *
- ******************************************************************************/
-int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
-{
-	char		*pattern, *output, *new_value = NULL;
-	char		*regex_error = NULL;
-	zbx_regexp_t	*regex = NULL;
-	int		ret = FAIL;
-
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
-		return FAIL;
-
-	pattern = zbx_strdup(NULL, params);
-
-	if (NULL == (output = strchr(pattern, '\n')))
-	{
-		*errmsg = zbx_strdup(*errmsg, "cannot find second parameter");
-		goto out;
-	}
-
-	*output++ = '\0';
-
-	if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
-	{
-		*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
-		zbx_free(regex_error);
-		goto out;
-	}
-
-	if (FAIL == zbx_mregexp_sub_precompiled(value->data.str, regex, output, ZBX_MAX_RECV_DATA_SIZE, &new_value))
-	{
-		*errmsg = zbx_strdup(*errmsg, "pattern does not match");
-		goto out;
-	}
-
-	zbx_variant_clear(value);
-	zbx_variant_set_str(value, new_value);
-
-	ret = SUCCEED;
-out:
-	if (NULL != regex)
-		zbx_regexp_free(regex);
-
-	zbx_free(pattern);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: validates value to be within the specified range                  *
@@ -886,7 +684,7 @@ int	item_preproc_get_error_from_json(const zbx_variant_t *value, const char *par
 
 	zbx_variant_copy(&value_str, value);
 
-	if (FAIL == (ret = item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
+	if (FAIL == (ret = zbx_item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
 		goto out;
@@ -951,7 +749,7 @@ int	item_preproc_get_error_from_xml(const zbx_variant_t *value, const char *para
 
 	zbx_variant_copy(&value_str, value);
 
-	if (FAIL == (ret = item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
+	if (FAIL == (ret = zbx_item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
 		goto out;
@@ -1042,7 +840,7 @@ int	item_preproc_get_error_from_regex(const zbx_variant_t *value, const char *pa
 
 	zbx_variant_copy(&value_str, value);
 
-	if (FAIL == (ret = item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
+	if (FAIL == (ret = zbx_item_preproc_convert_value(&value_str, ZBX_VARIANT_STR, error)))
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
 		goto out;
@@ -1169,82 +967,6 @@ out:
 #undef ZBX_PP_MATCH_TYPE_ANY
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: throttles value by suppressing identical values                   *
- *                                                                            *
- * Parameters: value         - [IN/OUT] value to process                      *
- *             ts            - [IN] value timestamp                           *
- *             history_value - [IN] historical data of item with delta        *
- *                                  preprocessing operation                   *
- *             history_ts    - [OUT] timestamp of historical data             *
- *                                                                            *
- * Return value: SUCCEED - the value was calculated successfully              *
- *               FAIL - otherwise                                             *
- *                                                                            *
- ******************************************************************************/
-int	item_preproc_throttle_value(zbx_variant_t *value, const zbx_timespec_t *ts,
-		zbx_variant_t *history_value, zbx_timespec_t *history_ts)
-{
-	int	ret;
-
-	ret = zbx_variant_compare(value, history_value);
-
-	zbx_variant_clear(history_value);
-	zbx_variant_copy(history_value, value);
-
-	if (0 == ret)
-		zbx_variant_clear(value);
-	else
-		*history_ts = *ts;
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: throttles value by suppressing identical values                   *
- *                                                                            *
- * Parameters: value         - [IN/OUT] value to process                      *
- *             ts            - [IN] value timestamp                           *
- *             params        - [IN] throttle period                           *
- *             history_value - [IN] historical data of item with delta        *
- *                                  preprocessing operation                   *
- *             history_ts    - [IN/OUT] timestamp of historical data          *
- *             errmsg        - [OUT]                                          *
- *                                                                            *
- * Return value: SUCCEED - the value was calculated successfully              *
- *               FAIL - otherwise                                             *
- *                                                                            *
- ******************************************************************************/
-int	item_preproc_throttle_timed_value(zbx_variant_t *value, const zbx_timespec_t *ts, const char *params,
-		zbx_variant_t *history_value, zbx_timespec_t *history_ts, char **errmsg)
-{
-	int	ret, timeout, period = 0;
-
-	if (FAIL == zbx_is_time_suffix(params, &timeout, (int)strlen(params)))
-	{
-		*errmsg = zbx_dsprintf(*errmsg, "invalid time period: %s", params);
-		zbx_variant_clear(history_value);
-		return FAIL;
-	}
-
-	ret = zbx_variant_compare(value, history_value);
-
-	zbx_variant_clear(history_value);
-	zbx_variant_copy(history_value, value);
-
-	if (ZBX_VARIANT_NONE != history_value->type)
-		period = ts->sec - history_ts->sec;
-
-	if (0 == ret && period < timeout )
-		zbx_variant_clear(value);
-	else
-		*history_ts = *ts;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: executes script passed with params                                *
@@ -1267,7 +989,7 @@ int	item_preproc_script(zbx_es_t *es, zbx_variant_t *value, const char *params,
 	const char	*code2;
 	int		size;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	if (SUCCEED != zbx_es_is_env_initialized(es))
@@ -1412,7 +1134,7 @@ int	item_preproc_csv_to_json(zbx_variant_t *value, const char *params, char **er
 	size_t		data_len, delim_sz = 1, quote_sz = 0, step;
 	int		ret = SUCCEED;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	delim[0] = ',';
@@ -1658,7 +1380,7 @@ int	item_preproc_xml_to_json(zbx_variant_t *value, char **errmsg)
 {
 	char	*json = NULL;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	if (FAIL == zbx_xml_to_json(value->data.str, &json, errmsg))
@@ -1709,7 +1431,7 @@ int	item_preproc_str_replace(zbx_variant_t *value, const char *params, char **er
 	replace_str = (char *)zbx_malloc(NULL, len_replace + 1);
 	unescape_param(ZBX_PREPROC_STR_REPLACE, ptr + 1, len_replace, replace_str);
 
-	if (SUCCEED == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (SUCCEED == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 	{
 		new_string = zbx_string_replace(value->data.str, search_str, replace_str);
 		zbx_variant_clear(value);
@@ -57,7 +57,7 @@ static int	pp_execute_multiply(unsigned char value_type, zbx_variant_t *value, c
 	{
 		error = zbx_dsprintf(NULL, "a numerical value is expected or the value is out of range");
 	}
-	else if (SUCCEED == item_preproc_multiplier_variant(value_type, value, buffer, &errmsg))
+	else if (SUCCEED == zbx_item_preproc_multiplier_variant(value_type, value, buffer, &errmsg))
 	{
 		return SUCCEED;
 	}
@@ -211,7 +211,7 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
 	char	*errmsg = NULL, *ptr;
 	int	len;
 
-	if (SUCCEED == item_preproc_regsub_op(value, params, &errmsg))
+	if (SUCCEED == zbx_item_preproc_regsub_op(value, params, &errmsg))
 		return SUCCEED;
 
 	if (NULL == (ptr = strchr(params, '\n')))
@@ -251,7 +251,7 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 	{
 		zbx_jsonobj_t	obj;
 
-		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			return FAIL;
 
 		if (FAIL == zbx_jsonobj_open(value->data.str, &obj))
@@ -281,7 +281,7 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 		if (NULL == (index = (zbx_pp_cache_jsonpath_t *)cache->data))
 		{
-			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+			if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 				return FAIL;
 
 			index = (zbx_pp_cache_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_jsonpath_t));
@@ -418,7 +418,7 @@ static int	pp_execute_xpath_query(zbx_variant_t *value, const char *params, char
 {
 	char	*errmsg = NULL;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, error))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, error))
 		return FAIL;
 
 	if (SUCCEED == zbx_query_xpath(value, params, &errmsg))
@@ -630,7 +630,7 @@ static int	pp_throttle_timed_value(zbx_variant_t *value, zbx_timespec_t ts, cons
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == item_preproc_throttle_timed_value(value, &ts, params, history_value, history_ts, &errmsg))
+	if (SUCCEED == zbx_item_preproc_throttle_timed_value(value, &ts, params, history_value, history_ts, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -707,7 +707,7 @@ static int	pp_execute_prometheus_query(zbx_pp_cache_t *cache, zbx_variant_t *val
 
 	if (NULL == cache || ZBX_PREPROC_PROMETHEUS_PATTERN != cache->type)
 	{
-		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			goto out;
 
 		ret = zbx_prometheus_pattern(value->data.str, pattern, request, output, &value_out, &err);
@@ -724,7 +724,7 @@ static int	pp_execute_prometheus_query(zbx_pp_cache_t *cache, zbx_variant_t *val
 
 		if (NULL == (prom_cache = (zbx_prometheus_t *)cache->data))
 		{
-			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+			if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 				goto out;
 
 			prom_cache = (zbx_prometheus_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_t));
@@ -805,7 +805,7 @@ static int	pp_execute_prometheus_to_json_conversion(zbx_pp_cache_t *cache, zbx_v
 
 	if (NULL == cache || ZBX_PREPROC_PROMETHEUS_PATTERN != cache->type)
 	{
-		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			goto out;
 
 		ret = zbx_prometheus_to_json(value->data.str, params, &value_out, &err);
@@ -822,7 +822,7 @@ static int	pp_execute_prometheus_to_json_conversion(zbx_pp_cache_t *cache, zbx_v
 
 		if (NULL == (prom_cache = (zbx_prometheus_t *)cache->data))
 		{
-			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+			if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 				goto out;
 
 			prom_cache = (zbx_prometheus_t *)zbx_malloc(NULL, sizeof(zbx_prometheus_t));
@@ -1120,7 +1120,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_error_from_regex(value, params);
 			goto out;
 		case ZBX_PREPROC_THROTTLE_VALUE:
-			ret = item_preproc_throttle_value(value, &ts, history_value, history_ts);
+			ret = zbx_item_preproc_throttle_value(value, &ts, history_value, history_ts);
 			goto out;
 		case ZBX_PREPROC_THROTTLE_TIMED_VALUE:
 			ret = pp_throttle_timed_value(value, ts, params, history_value, history_ts);
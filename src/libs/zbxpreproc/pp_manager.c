@@ -372,6 +372,7 @@ static zbx_pp_item_t	*pp_manager_get_cacheable_dependent_item(zbx_pp_manager_t *
  *             exclude_itemid - [IN] dependent itemid to exclude, can be 0    *
  *             value          - [IN] value                                    *
  *             ts             - [IN] value timestamp                          *
+ *             ingest         - [IN] master value ingest time                 *
  *             cache          - [IN] preprocessing cache                      *
  *                                   (optional, can be NULL)                  *
  *                                                                            *
@@ -380,9 +381,10 @@ static zbx_pp_item_t	*pp_manager_get_cacheable_dependent_item(zbx_pp_manager_t *
  ******************************************************************************/
 static void	pp_manager_queue_dependents(zbx_pp_manager_t *manager, zbx_pp_item_preproc_t *preproc,
 		zbx_dc_um_shared_handle_t *um_handle, zbx_uint64_t exclude_itemid, const zbx_variant_t *value,
-		zbx_timespec_t ts, zbx_pp_cache_t *cache)
+		zbx_timespec_t ts, double ingest, zbx_pp_cache_t *cache)
 {
-	int	queued_num = 0;
+	int			queued_num = 0;
+	zbx_pp_value_opt_t	value_opt = {.flags = ZBX_PP_VALUE_OPT_NONE, .ingest = ingest};
 
 	if (0 == preproc->dep_itemids_num)
 		return;
@@ -407,13 +409,13 @@ static void	pp_manager_queue_dependents(zbx_pp_manager_t *manager, zbx_pp_item_p
 
 		if (ZBX_PP_PROCESS_PARALLEL == item->preproc->mode)
 		{
-			new_task = pp_task_value_create(item->itemid, item->preproc, um_handle, NULL, ts, NULL,
-					cache);
+			new_task = pp_task_value_create(item->itemid, item->preproc, um_handle, NULL, ts,
+					&value_opt, cache);
 		}
 		else
 		{
 			new_task = pp_task_value_seq_create(item->itemid, item->preproc, um_handle, NULL, ts,
-					NULL, cache);
+					&value_opt, cache);
 		}
 
 		pp_task_queue_push_immediate(&manager->queue, new_task);
@@ -448,8 +450,9 @@ static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp
 	if (NULL != (item = pp_manager_get_cacheable_dependent_item(manager, d->preproc->dep_itemids,
 			d->preproc->dep_itemids_num)))
 	{
-		zbx_pp_task_t	*dep_task;
-		zbx_variant_t	value;
+		zbx_pp_task_t		*dep_task;
+		zbx_variant_t		value;
+		zbx_pp_value_opt_t	value_opt = {.flags = ZBX_PP_VALUE_OPT_NONE, .ingest = d->opt.ingest};
 
 		dep_task = pp_task_dependent_create(task->itemid, d->preproc);
 		zbx_pp_task_dependent_t	*d_dep = (zbx_pp_task_dependent_t *)PP_TASK_DATA(dep_task);
@@ -458,13 +461,16 @@ static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp
 		zbx_variant_set_none(&value);
 
 		d_dep->primary = pp_task_value_create(item->itemid, item->preproc, d->um_handle, &value, d->ts,
-				NULL, d_dep->cache);
+				&value_opt, d_dep->cache);
 
 		pp_task_queue_push_immediate(&manager->queue, dep_task);
 		pp_task_queue_notify(&manager->queue);
 	}
 	else
-		pp_manager_queue_dependents(manager, d->preproc, d->um_handle, 0, &d->result, d->ts, NULL);
+	{
+		pp_manager_queue_dependents(manager, d->preproc, d->um_handle, 0, &d->result, d->ts, d->opt.ingest,
+				NULL);
+	}
 }
 
 /******************************************************************************
@@ -484,7 +490,8 @@ static zbx_pp_task_t	*pp_manager_queue_dependent_task_result(zbx_pp_manager_t *m
 	zbx_pp_task_value_t	*dp = (zbx_pp_task_value_t *)PP_TASK_DATA(task_value);
 
 	pp_manager_queue_value_task_result(manager, d->primary);
-	pp_manager_queue_dependents(manager, d->preproc, dp->um_handle, task_value->itemid, &dp->result, dp->ts, d->cache);
+	pp_manager_queue_dependents(manager, d->preproc, dp->um_handle, task_value->itemid, &dp->result, dp->ts,
+			dp->opt.ingest, d->cache);
 
 	d->primary = NULL;
 	pp_task_free(task);
@@ -749,6 +756,7 @@ static void	preproc_item_value_extract_data(zbx_preproc_item_value_t *value, zbx
 		zbx_pp_value_opt_t *opt)
 {
 	opt->flags = ZBX_PP_VALUE_OPT_NONE;
+	opt->ingest = value->ingest;
 
 	if (NULL != value->ts)
 	{
@@ -134,7 +134,7 @@ static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_fie
  ******************************************************************************/
 static zbx_uint32_t	preprocessor_pack_value(zbx_ipc_message_t *message, zbx_preproc_item_value_t *value)
 {
-	zbx_packed_field_t	fields[24], *offset = fields;	/* 24 - max field count */
+	zbx_packed_field_t	fields[25], *offset = fields;	/* 25 - max field count */
 	unsigned char		ts_marker, result_marker, log_marker;
 
 	ts_marker = (NULL != value->ts);
@@ -145,6 +145,7 @@ static zbx_uint32_t	preprocessor_pack_value(zbx_ipc_message_t *message, zbx_prep
 	*offset++ = PACKED_FIELD(&value->item_value_type, sizeof(unsigned char));
 	*offset++ = PACKED_FIELD(&value->item_flags, sizeof(unsigned char));
 	*offset++ = PACKED_FIELD(&value->state, sizeof(unsigned char));
+	*offset++ = PACKED_FIELD(&value->ingest, sizeof(double));
 	*offset++ = PACKED_FIELD(value->error, 0);
 	*offset++ = PACKED_FIELD(&ts_marker, sizeof(unsigned char));
 
@@ -609,6 +610,7 @@ zbx_uint32_t	zbx_preprocessor_unpack_value(zbx_preproc_item_value_t *value, unsi
 	offset += zbx_deserialize_char(offset, &value->item_value_type);
 	offset += zbx_deserialize_char(offset, &value->item_flags);
 	offset += zbx_deserialize_char(offset, &value->state);
+	offset += zbx_deserialize_double(offset, &value->ingest);
 	offset += zbx_deserialize_str(offset, &value->error, value_len);
 	offset += zbx_deserialize_char(offset, &ts_marker);
 
@@ -844,7 +846,7 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigne
 {
 	zbx_preproc_item_value_t	value = {.itemid = itemid, .hostid = hostid, .item_value_type = item_value_type,
 					.error = error, .item_flags = item_flags, .state = state, .ts = ts,
-					.result = result};
+					.result = result, .ingest = zbx_time()};
 	size_t				value_len = 0, len;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -45,6 +45,7 @@ typedef struct
 	char			*error;		 /* error message (if any) */
 	unsigned char		item_flags;	 /* item flags */
 	unsigned char		state;		 /* item state */
+	double			ingest;		 /* time value was passed for processing */
 }
 zbx_preproc_item_value_t;
 
@@ -131,7 +131,10 @@ zbx_pp_task_t	*pp_task_value_create(zbx_uint64_t itemid, zbx_pp_item_preproc_t *
 	if (NULL != value_opt)
 		d->opt = *value_opt;
 	else
+	{
 		d->opt.flags = ZBX_PP_VALUE_OPT_NONE;
+		d->opt.ingest = 0;
+	}
 
 	d->preproc = zbx_pp_item_preproc_copy(preproc);
 	d->um_handle = zbx_dc_um_shared_handle_copy(um_handle);
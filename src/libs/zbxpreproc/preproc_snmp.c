@@ -824,7 +824,7 @@ int	item_preproc_snmp_walk_to_value(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 	if (NULL == cache || ZBX_PREPROC_SNMP_WALK_VALUE != cache->type)
 	{
-		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			return FAIL;
 
 		ret = preproc_snmp_value_from_walk(value->data.str, params, &value_out, &err);
@@ -841,7 +841,7 @@ int	item_preproc_snmp_walk_to_value(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 		if (NULL == (snmp_cache = (zbx_snmp_value_cache_t *)cache->data))
 		{
-			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+			if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 				return FAIL;
 
 			snmp_cache = (zbx_snmp_value_cache_t *)zbx_malloc(NULL, sizeof(zbx_snmp_value_cache_t));
@@ -877,7 +877,7 @@ int	item_preproc_snmp_get_to_value(zbx_variant_t *value, const char *params, cha
 	char	*err = NULL;
 	int	ret = FAIL, format;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	zbx_remove_chars(value->data.str, "\r\n");
@@ -916,7 +916,7 @@ int	item_preproc_snmp_walk_to_json(zbx_variant_t *value, const char *params, cha
 	zbx_vector_snmp_walk_to_json_param_t	parsed_params;
 	zbx_snmp_value_pair_t			p;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
 
 	zbx_vector_snmp_walk_to_json_param_create(&parsed_params);
@@ -0,0 +1,283 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxpreprocbase.h"
+
+#include "zbxjson.h"
+#include "zbxnum.h"
+#include "zbxstr.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if step can be evaluated by agent before throttling        *
+ *                                                                            *
+ * Comments: Only stateless steps are allowed, so that evaluating them on     *
+ *           values discarded by agent does not change the results of the     *
+ *           following values on server.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_pushdown_step_stateless(int type)
+{
+	switch (type)
+	{
+		case ZBX_PREPROC_MULTIPLIER:
+		case ZBX_PREPROC_REGSUB:
+		case ZBX_PREPROC_JSONPATH:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: select preprocessing steps to be pushed down to agent             *
+ *                                                                            *
+ * Parameters: steps - [IN/OUT] item preprocessing steps, the steps that      *
+ *                              cannot be pushed down are removed             *
+ *                                                                            *
+ * Comments: Agent evaluates the leading stateless steps up to and including  *
+ *           the throttling step only to decide if the value would be         *
+ *           discarded. The values passing throttling are sent unchanged and  *
+ *           preprocessed by server as usual, so the pushed down steps are    *
+ *           idempotent and the item history stays the same.                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_pushdown_select(zbx_vector_pp_step_ptr_t *steps)
+{
+	int	steps_num = 0;
+
+	for (int i = 0; i < steps->values_num; i++)
+	{
+		int	type = steps->values[i]->type;
+
+		if (ZBX_PREPROC_THROTTLE_VALUE == type || ZBX_PREPROC_THROTTLE_TIMED_VALUE == type)
+		{
+			steps_num = i + 1;
+			break;
+		}
+
+		if (SUCCEED != pp_pushdown_step_stateless(type))
+			break;
+	}
+
+	while (steps_num < steps->values_num)
+	{
+		zbx_pp_step_free(steps->values[steps->values_num - 1]);
+		zbx_vector_pp_step_ptr_remove_noorder(steps, steps->values_num - 1);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create pushed down preprocessing steps                            *
+ *                                                                            *
+ * Parameters: value_type - [IN] item value type                              *
+ *             steps      - [IN/OUT] preprocessing steps, moved to the        *
+ *                                   created object                           *
+ *                                                                            *
+ * Return value: The created pushed down preprocessing steps.                 *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_pushdown_t	*zbx_pp_pushdown_create(unsigned char value_type, zbx_vector_pp_step_ptr_t *steps)
+{
+	zbx_pp_pushdown_t	*pushdown;
+
+	pushdown = (zbx_pp_pushdown_t *)zbx_malloc(NULL, sizeof(zbx_pp_pushdown_t));
+	pushdown->value_type = value_type;
+	zbx_vector_pp_step_ptr_create(&pushdown->steps);
+	zbx_vector_pp_step_ptr_append_array(&pushdown->steps, steps->values, steps->values_num);
+	zbx_vector_pp_step_ptr_clear(steps);
+
+	zbx_variant_set_none(&pushdown->history_value);
+	pushdown->history_ts.sec = 0;
+	pushdown->history_ts.ns = 0;
+
+	return pushdown;
+}
+
+void	zbx_pp_pushdown_free(zbx_pp_pushdown_t *pushdown)
+{
+	zbx_vector_pp_step_ptr_clear_ext(&pushdown->steps, zbx_pp_step_free);
+	zbx_vector_pp_step_ptr_destroy(&pushdown->steps);
+	zbx_variant_clear(&pushdown->history_value);
+	zbx_free(pushdown);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compare pushed down preprocessing steps                           *
+ *                                                                            *
+ * Return value: SUCCEED - the steps are the same                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_pp_pushdown_compare(const zbx_pp_pushdown_t *pushdown, unsigned char value_type,
+		const zbx_vector_pp_step_ptr_t *steps)
+{
+	if (pushdown->value_type != value_type || pushdown->steps.values_num != steps->values_num)
+		return FAIL;
+
+	for (int i = 0; i < steps->values_num; i++)
+	{
+		if (pushdown->steps.values[i]->type != steps->values[i]->type ||
+				0 != strcmp(pushdown->steps.values[i]->params, steps->values[i]->params))
+		{
+			return FAIL;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reset throttling history, so the next value is not discarded      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_pushdown_reset(zbx_pp_pushdown_t *pushdown)
+{
+	zbx_variant_clear(&pushdown->history_value);
+	pushdown->history_ts.sec = 0;
+	pushdown->history_ts.ns = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute 'multiply by' step the same way as preprocessing worker   *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_pushdown_multiply(unsigned char value_type, zbx_variant_t *value, const char *params,
+		char **errmsg)
+{
+	char	buffer[MAX_STRING_LEN];
+
+	zbx_strlcpy(buffer, params, sizeof(buffer));
+	zbx_trim_float(buffer);
+
+	if (FAIL == zbx_is_double(buffer, NULL))
+	{
+		*errmsg = zbx_strdup(*errmsg, "a numerical value is expected or the value is out of range");
+		return FAIL;
+	}
+
+	return zbx_item_preproc_multiplier_variant(value_type, value, buffer, errmsg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute 'jsonpath' step the same way as preprocessing worker      *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_pushdown_jsonpath(zbx_variant_t *value, const char *params, char **errmsg)
+{
+	char		*data = NULL;
+	zbx_jsonobj_t	obj;
+
+	if (FAIL == zbx_item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
+		return FAIL;
+
+	if (FAIL == zbx_jsonobj_open(value->data.str, &obj))
+	{
+		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+		return FAIL;
+	}
+
+	if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+	{
+		zbx_jsonobj_clear(&obj);
+		*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+		return FAIL;
+	}
+
+	zbx_jsonobj_clear(&obj);
+
+	if (NULL == data)
+	{
+		*errmsg = zbx_strdup(*errmsg, "no data matches the specified path");
+		return FAIL;
+	}
+
+	zbx_variant_clear(value);
+	zbx_variant_set_str(value, data);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute pushed down preprocessing steps                           *
+ *                                                                            *
+ * Parameters: pushdown - [IN] pushed down preprocessing steps                *
+ *             value    - [IN] value to process                               *
+ *             ts       - [IN] value timestamp                                *
+ *                                                                            *
+ * Return value: SUCCEED - the value must be sent to server                   *
+ *               FAIL    - the value would be discarded by server             *
+ *                                                                            *
+ * Comments: If a step fails the value is sent and the throttling history is  *
+ *           reset, leaving error handling to server.                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_pp_pushdown_execute(zbx_pp_pushdown_t *pushdown, const char *value, const zbx_timespec_t *ts)
+{
+	zbx_variant_t	value_var;
+	char		*errmsg = NULL;
+	int		ret = SUCCEED;
+
+	zbx_variant_set_str(&value_var, zbx_strdup(NULL, value));
+
+	for (int i = 0; i < pushdown->steps.values_num && SUCCEED == ret; i++)
+	{
+		const zbx_pp_step_t	*step = pushdown->steps.values[i];
+
+		switch (step->type)
+		{
+			case ZBX_PREPROC_MULTIPLIER:
+				ret = pp_pushdown_multiply(pushdown->value_type, &value_var, step->params, &errmsg);
+				break;
+			case ZBX_PREPROC_REGSUB:
+				ret = zbx_item_preproc_regsub_op(&value_var, step->params, &errmsg);
+				break;
+			case ZBX_PREPROC_JSONPATH:
+				ret = pp_pushdown_jsonpath(&value_var, step->params, &errmsg);
+				break;
+			case ZBX_PREPROC_THROTTLE_VALUE:
+				ret = zbx_item_preproc_throttle_value(&value_var, ts, &pushdown->history_value,
+						&pushdown->history_ts);
+				break;
+			case ZBX_PREPROC_THROTTLE_TIMED_VALUE:
+				ret = zbx_item_preproc_throttle_timed_value(&value_var, ts, step->params,
+						&pushdown->history_value, &pushdown->history_ts, &errmsg);
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				ret = FAIL;
+		}
+	}
+
+	if (SUCCEED != ret)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot execute pushed down preprocessing: %s", ZBX_NULL2STR(errmsg));
+		zbx_free(errmsg);
+		zbx_pp_pushdown_reset(pushdown);
+		ret = SUCCEED;
+	}
+	else if (ZBX_VARIANT_NONE == value_var.type)
+		ret = FAIL;
+
+	zbx_variant_clear(&value_var);
+
+	return ret;
+}
@@ -16,6 +16,10 @@
 #include "zbxalgo.h"
 #include "zbxtime.h"
 
+#ifndef _WINDOWS
+#	include <sys/time.h>
+#endif
+
 #define PROF_LEVEL_MAX	10
 
 typedef struct
@@ -26,75 +30,75 @@ typedef struct
 	double			sec_wait;
 	unsigned int		locked;
 	zbx_prof_scope_t	scope;
+
+	/* sampling mode statistics, updated from signal handler */
+	volatile zbx_uint64_t	samples;
+
+	/* statistics already passed to flush callback */
+	zbx_uint64_t		samples_flushed;
+	unsigned int		locked_flushed;
+	double			sec_wait_flushed;
 }
 zbx_func_profile_t;
 
-ZBX_PTR_VECTOR_DECL(func_profiles, zbx_func_profile_t*)
-ZBX_PTR_VECTOR_IMPL(func_profiles, zbx_func_profile_t*)
-
 static volatile int					zbx_prof_scope_requested;
+static zbx_prof_flush_func_t				zbx_prof_flush_cb;
 
-static ZBX_THREAD_LOCAL zbx_vector_func_profiles_t	zbx_func_profiles;
+static ZBX_THREAD_LOCAL zbx_hashset_t			zbx_func_profiles;
 static ZBX_THREAD_LOCAL zbx_prof_scope_t		zbx_prof_scope;
 static ZBX_THREAD_LOCAL int				zbx_prof_initialized;
 
 static ZBX_THREAD_LOCAL zbx_func_profile_t		*zbx_func_profile[PROF_LEVEL_MAX];
 #undef PROF_LEVEL_MAX
-static ZBX_THREAD_LOCAL int				zbx_func_profile_level;
+static ZBX_THREAD_LOCAL volatile int			zbx_func_profile_level;
+
+/* samples taken outside of profiled functions */
+static ZBX_THREAD_LOCAL volatile zbx_uint64_t		zbx_prof_samples_other;
+static ZBX_THREAD_LOCAL zbx_uint64_t			zbx_prof_samples_other_flushed;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets callback to store sampled profiling statistics               *
+ *                                                                            *
+ * Parameters: flush_cb - [IN] callback function, called periodically by      *
+ *                             every process with sampling enabled            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_prof_init(zbx_prof_flush_func_t flush_cb)
+{
+	zbx_prof_flush_cb = flush_cb;
+}
 
-static void	zbx_prof_init(void)
+static void	zbx_prof_init_profiles(void)
 {
 	if (0 == zbx_prof_initialized)
 	{
 		zbx_prof_initialized = 1;
-		zbx_vector_func_profiles_create(&zbx_func_profiles);
+		zbx_hashset_create(&zbx_func_profiles, 100, ZBX_DEFAULT_PTR_HASH_FUNC, ZBX_DEFAULT_PTR_COMPARE_FUNC);
 	}
 }
 
-static int	compare_func_profile(const void *d1, const void *d2)
-{
-	const zbx_func_profile_t	*func_profile1 = *((const zbx_func_profile_t * const *)d1);
-	const zbx_func_profile_t	*func_profile2 = *((const zbx_func_profile_t * const *)d2);
-
-	ZBX_RETURN_IF_NOT_EQUAL(func_profile1->func_name, func_profile2->func_name);
-
-	return 0;
-}
-
-static void	func_profile_free(zbx_func_profile_t *func_profile)
-{
-	zbx_free(func_profile);
-}
-
 void	zbx_prof_start(const char *func_name, zbx_prof_scope_t scope)
 {
 	if (0 != zbx_prof_scope)
 	{
-		int			i;
-#if defined(__hpux)
-		/* fix for compiling with HP-UX bundled cc compiler */
-		zbx_func_profile_t	*func_profile, func_profile_local = {func_name, 0};
-#else
-		zbx_func_profile_t	*func_profile, func_profile_local = {.func_name = func_name};
-#endif
-		if (FAIL == (i = zbx_vector_func_profiles_bsearch(&zbx_func_profiles, &func_profile_local,
-				compare_func_profile)))
+		zbx_func_profile_t	*func_profile, func_profile_local = {0};
+
+		func_profile_local.func_name = func_name;
+
+		if (NULL == (func_profile = (zbx_func_profile_t *)zbx_hashset_search(&zbx_func_profiles,
+				&func_profile_local)))
 		{
-			func_profile = zbx_malloc(NULL, sizeof(zbx_func_profile_t));
-			func_profile->func_name = func_name;
-			func_profile->sec = 0;
-			func_profile->locked = 0;
-			func_profile->sec_wait = 0;
-			func_profile->scope = scope;
-
-			zbx_vector_func_profiles_append(&zbx_func_profiles, func_profile);
-			zbx_vector_func_profiles_sort(&zbx_func_profiles, compare_func_profile);
+			func_profile_local.scope = scope;
+			func_profile = (zbx_func_profile_t *)zbx_hashset_insert(&zbx_func_profiles,
+					&func_profile_local, sizeof(func_profile_local));
 		}
-		else
-			func_profile = zbx_func_profiles.values[i];
 
 		func_profile->locked++;
-		func_profile->start = zbx_time();
+
+		/* sampling mode measures only waiting for locks */
+		if (0 != (zbx_prof_scope & ZBX_PROF_ALL) || ZBX_PROF_PROCESSING != scope)
+			func_profile->start = zbx_time();
 
 		zbx_func_profile[zbx_func_profile_level] = func_profile;
 		zbx_func_profile_level++;
@@ -120,12 +124,15 @@ void	zbx_prof_end(void)
 		zbx_func_profile_t	*func_profile;
 
 		func_profile = zbx_func_profile[zbx_func_profile_level - 1];
-		func_profile->sec += zbx_time() - func_profile->start;
+
+		if (0 != (zbx_prof_scope & ZBX_PROF_ALL))
+			func_profile->sec += zbx_time() - func_profile->start;
+
 		zbx_func_profile_level--;
 	}
 }
 
-static const char	*get_scope_string(zbx_prof_scope_t scope)
+const char	*zbx_prof_scope_string(zbx_prof_scope_t scope)
 {
 	switch (scope)
 	{
@@ -140,9 +147,9 @@ static const char	*get_scope_string(zbx_prof_scope_t scope)
 
 static void	zbx_print_prof(const char *info)
 {
-	if (0 != zbx_prof_scope)
+	if (0 != (zbx_prof_scope & ZBX_PROF_ALL))
 	{
-		int			i;
+		zbx_hashset_iter_t	iter;
 		zbx_func_profile_t	*func_profile;
 		static ZBX_THREAD_LOCAL char	*str = NULL;
 		static ZBX_THREAD_LOCAL size_t	str_alloc;
@@ -151,10 +158,9 @@ static void	zbx_print_prof(const char *info)
 					total_mutex_busy_lock = 0;
 		unsigned int		total_locked_mutex = 0, total_locked_rwlock = 0;
 
-		for (i = 0; i < zbx_func_profiles.values_num; i++)
+		zbx_hashset_iter_reset(&zbx_func_profiles, &iter);
+		while (NULL != (func_profile = (zbx_func_profile_t *)zbx_hashset_iter_next(&iter)))
 		{
-			func_profile = zbx_func_profiles.values[i];
-
 			if (0 == (zbx_prof_scope & func_profile->scope))
 				continue;
 
@@ -167,7 +173,7 @@ static void	zbx_print_prof(const char *info)
 			{
 				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "\n%s() %s : locked:%u holding:"
 						ZBX_FS_DBL " sec waiting:"ZBX_FS_DBL " sec",
-						func_profile->func_name, get_scope_string(func_profile->scope),
+						func_profile->func_name, zbx_prof_scope_string(func_profile->scope),
 						func_profile->locked, func_profile->sec - func_profile->sec_wait,
 						func_profile->sec_wait);
 
@@ -201,7 +207,7 @@ static void	zbx_print_prof(const char *info)
 						total_mutex_busy_lock, total_mutex_wait_lock);
 			}
 
-			if (ZBX_PROF_ALL == zbx_prof_scope)
+			if (ZBX_PROF_ALL == (zbx_prof_scope & ZBX_PROF_ALL))
 			{
 				zbx_snprintf_alloc(&str, &str_alloc, &str_offset, "\nlocking total : locked:%u holding:"
 						ZBX_FS_DBL " sec waiting:" ZBX_FS_DBL " sec",
@@ -215,38 +221,188 @@ static void	zbx_print_prof(const char *info)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables profiling                                                 *
+ *                                                                            *
+ * Parameters: scope - [IN] profiling scope, all instrumented scopes if not   *
+ *                          specified                                         *
+ *                                                                            *
+ * Comments: Sampling is enabled only when requested explicitly and is kept   *
+ *           when instrumented scope is changed.                              *
+ *                                                                            *
+ ******************************************************************************/
 void	zbx_prof_enable(zbx_prof_scope_t scope)
 {
+	if (ZBX_PROF_SAMPLING == scope)
+	{
+		zbx_prof_scope_requested |= ZBX_PROF_SAMPLING;
+		return;
+	}
+
 	if (0 == scope)
 		scope = ZBX_PROF_ALL;
 
-	zbx_prof_scope_requested = (int)scope;
+	zbx_prof_scope_requested = (zbx_prof_scope_requested & ZBX_PROF_SAMPLING) | (int)scope;
 }
 
-void	zbx_prof_disable(void)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: disables profiling                                                *
+ *                                                                            *
+ * Parameters: scope - [IN] ZBX_PROF_SAMPLING to disable sampling, otherwise  *
+ *                          instrumented profiling is disabled                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_prof_disable(zbx_prof_scope_t scope)
 {
-	zbx_prof_scope_requested = 0;
+	if (ZBX_PROF_SAMPLING == scope)
+		zbx_prof_scope_requested &= ~ZBX_PROF_SAMPLING;
+	else
+		zbx_prof_scope_requested &= ZBX_PROF_SAMPLING;
 }
 
 static void	zbx_reset_prof(void)
 {
 	if (0 != zbx_prof_initialized)
-		zbx_vector_func_profiles_clear_ext(&zbx_func_profiles, func_profile_free);
+		zbx_hashset_clear(&zbx_func_profiles);
+
+	zbx_prof_samples_other = 0;
+	zbx_prof_samples_other_flushed = 0;
+}
+
+#ifndef _WINDOWS
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attributes CPU time sample to the innermost profiled function     *
+ *                                                                            *
+ ******************************************************************************/
+static void	prof_sample_handler(int sig)
+{
+	int	level = zbx_func_profile_level;
+
+	ZBX_UNUSED(sig);
+
+	if (0 != level)
+		zbx_func_profile[level - 1]->samples++;
+	else
+		zbx_prof_samples_other++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts or stops CPU time sampling timer of the calling process    *
+ *                                                                            *
+ ******************************************************************************/
+static void	prof_set_sampling(int enable)
+{
+	struct itimerval	timer = {0};
+
+	if (0 != enable)
+	{
+		struct sigaction	phan;
+
+		sigemptyset(&phan.sa_mask);
+		phan.sa_flags = SA_RESTART;
+		phan.sa_handler = prof_sample_handler;
+		sigaction(SIGPROF, &phan, NULL);
+
+		timer.it_interval.tv_usec = ZBX_PROF_SAMPLING_INTERVAL;
+		timer.it_value.tv_usec = ZBX_PROF_SAMPLING_INTERVAL;
+	}
+
+	if (0 != setitimer(ITIMER_PROF, &timer, NULL))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot set profiling timer: %s", zbx_strerror(errno));
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes sampled statistics collected since the last flush to the   *
+ *          flush callback                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	prof_flush_samples(const char *info)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_func_profile_t	*func_profile;
+	zbx_prof_stat_t		*stats;
+	zbx_uint64_t		samples;
+	int			stats_num = 0;
+
+	stats = (zbx_prof_stat_t *)zbx_malloc(NULL, sizeof(zbx_prof_stat_t) *
+			(size_t)(zbx_func_profiles.num_data + 1));
+
+	zbx_hashset_iter_reset(&zbx_func_profiles, &iter);
+	while (NULL != (func_profile = (zbx_func_profile_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_prof_stat_t	*stat;
+
+		samples = func_profile->samples;
+
+		if (samples == func_profile->samples_flushed && func_profile->locked == func_profile->locked_flushed)
+			continue;
+
+		stat = &stats[stats_num++];
+		stat->func_name = func_profile->func_name;
+		stat->scope = func_profile->scope;
+		stat->samples = samples - func_profile->samples_flushed;
+		stat->locked = func_profile->locked - func_profile->locked_flushed;
+		stat->sec_wait = func_profile->sec_wait - func_profile->sec_wait_flushed;
+
+		func_profile->samples_flushed = samples;
+		func_profile->locked_flushed = func_profile->locked;
+		func_profile->sec_wait_flushed = func_profile->sec_wait;
+	}
+
+	if ((samples = zbx_prof_samples_other) != zbx_prof_samples_other_flushed)
+	{
+		zbx_prof_stat_t	*stat = &stats[stats_num++];
+
+		stat->func_name = ZBX_PROF_OTHER;
+		stat->scope = ZBX_PROF_PROCESSING;
+		stat->samples = samples - zbx_prof_samples_other_flushed;
+		stat->locked = 0;
+		stat->sec_wait = 0;
+
+		zbx_prof_samples_other_flushed = samples;
+	}
+
+	if (0 != stats_num)
+		zbx_prof_flush_cb(info, stats, stats_num);
+
+	zbx_free(stats);
+}
+#endif
+
 void	zbx_prof_update(const char *info, double time_now)
 {
 #define PROF_UPDATE_INTERVAL	30
-	static ZBX_THREAD_LOCAL double	last_update;
+#define PROF_FLUSH_INTERVAL	5
+	static ZBX_THREAD_LOCAL double	last_update, last_flush;
+	zbx_prof_scope_t		scope_old = zbx_prof_scope;
 
 	if (0 != zbx_prof_scope_requested)
 	{
-		zbx_prof_init();
+		zbx_prof_init_profiles();
 		zbx_prof_scope = zbx_prof_scope_requested;
 	}
 	else
 		zbx_prof_scope = 0;
 
+#ifndef _WINDOWS
+	if ((scope_old & ZBX_PROF_SAMPLING) != (zbx_prof_scope & ZBX_PROF_SAMPLING))
+		prof_set_sampling(0 != (zbx_prof_scope & ZBX_PROF_SAMPLING));
+
+	if (0 != (zbx_prof_scope & ZBX_PROF_SAMPLING) && NULL != zbx_prof_flush_cb &&
+			PROF_FLUSH_INTERVAL < time_now - last_flush)
+	{
+		last_flush = time_now;
+		prof_flush_samples(info);
+	}
+#else
+	ZBX_UNUSED(scope_old);
+#endif
+
 	if (PROF_UPDATE_INTERVAL < time_now - last_update)
 	{
 		last_update = time_now;
@@ -256,5 +412,6 @@ void	zbx_prof_update(const char *info, double time_now)
 		else
 			zbx_reset_prof();
 	}
+#undef PROF_FLUSH_INTERVAL
 #undef PROF_UPDATE_INTERVAL
 }
@@ -26,6 +26,8 @@ static int	rtc_parse_scope(const char *str, int *scope)
 		*scope = ZBX_PROF_MUTEX;
 	else if (0 == strcmp(str, "processing"))
 		*scope = ZBX_PROF_PROCESSING;
+	else if (0 == strcmp(str, "sampling"))
+		*scope = ZBX_PROF_SAMPLING;
 	else
 		return FAIL;
 
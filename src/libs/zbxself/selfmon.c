@@ -28,11 +28,27 @@
 
 #define ZBX_SELFMON_FLUSH_DELAY		(ZBX_SELFMON_DELAY * 0.5)
 
+/* maximum number of profiled functions stored per process type */
+#define ZBX_SELFMON_PROF_FUNCS_MAX	64
+
+typedef struct
+{
+	zbx_prof_stat_t	funcs[ZBX_SELFMON_PROF_FUNCS_MAX];
+	int		funcs_num;
+
+	/* samples outside of profiled functions and of functions not fitting into funcs */
+	zbx_prof_stat_t	other;
+}
+zbx_selfmon_prof_t;
+
 typedef struct
 {
 	zbx_timekeeper_t	*monitor;
 	zbx_timekeeper_sync_t	sync;
 	int			process_index[ZBX_PROCESS_TYPE_COUNT];
+	zbx_selfmon_prof_t	*prof;
+	zbx_compress_stats_t	*compress;
+	zbx_uint64_t		*tls;
 }
 zbx_selfmon_collector_t;
 
@@ -62,6 +78,17 @@ static void	sm_sync_unlock(void *data)
 
 #ifndef _WINDOWS
 
+static int	selfmon_prof_stat_compare(const void *d1, const void *d2)
+{
+	const zbx_prof_stat_t	*s1 = (const zbx_prof_stat_t *)d1;
+	const zbx_prof_stat_t	*s2 = (const zbx_prof_stat_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->samples, s1->samples);
+	ZBX_RETURN_IF_NOT_EQUAL(s2->sec_wait, s1->sec_wait);
+
+	return 0;
+}
+
 static int	selfmon_is_process_monitored(unsigned char proc_type)
 {
 	switch (proc_type)
@@ -101,6 +128,15 @@ int	zbx_init_selfmon_collector(zbx_get_config_forks_f get_config_forks, char **e
 
 	sz_total = zbx_timekeeper_get_memmalloc_size(units_num);
 
+	/* sampling profiler statistics per process type, with allocation overhead */
+	sz_total += sizeof(zbx_selfmon_prof_t) * ZBX_PROCESS_TYPE_COUNT + 2 * sizeof(zbx_uint64_t);
+
+	/* message compression statistics, with allocation overhead */
+	sz_total += sizeof(zbx_compress_stats_t) * ZBX_COMPRESS_STATS_COUNT + 2 * sizeof(zbx_uint64_t);
+
+	/* TLS handshake statistics, with allocation overhead */
+	sz_total += sizeof(zbx_uint64_t) * ZBX_TLS_STATS_COUNT + 2 * sizeof(zbx_uint64_t);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() size:" ZBX_FS_SIZE_T, __func__, (zbx_fs_size_t)sz_total);
 
 	if (SUCCEED != zbx_mutex_create(&sm_lock, ZBX_MUTEX_SELFMON, error))
@@ -112,6 +148,17 @@ int	zbx_init_selfmon_collector(zbx_get_config_forks_f get_config_forks, char **e
 	zbx_timekeeper_sync_init(&collector.sync, sm_sync_lock, sm_sync_unlock, (void *)&sm_lock);
 	collector.monitor = zbx_timekeeper_create_ext(units_num, &collector.sync, __sm_shmem_malloc_func,
 			__sm_shmem_realloc_func, __sm_shmem_free_func);
+
+	collector.prof = (zbx_selfmon_prof_t *)__sm_shmem_malloc_func(NULL,
+			sizeof(zbx_selfmon_prof_t) * ZBX_PROCESS_TYPE_COUNT);
+	memset(collector.prof, 0, sizeof(zbx_selfmon_prof_t) * ZBX_PROCESS_TYPE_COUNT);
+
+	collector.compress = (zbx_compress_stats_t *)__sm_shmem_malloc_func(NULL,
+			sizeof(zbx_compress_stats_t) * ZBX_COMPRESS_STATS_COUNT);
+	memset(collector.compress, 0, sizeof(zbx_compress_stats_t) * ZBX_COMPRESS_STATS_COUNT);
+
+	collector.tls = (zbx_uint64_t *)__sm_shmem_malloc_func(NULL, sizeof(zbx_uint64_t) * ZBX_TLS_STATS_COUNT);
+	memset(collector.tls, 0, sizeof(zbx_uint64_t) * ZBX_TLS_STATS_COUNT);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() collector.monitor:%p", __func__, (void *)collector.monitor);
 
@@ -137,6 +184,60 @@ void	zbx_free_selfmon_collector(void)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/* compression and TLS statistics of the calling process not yet added to shared memory */
+static ZBX_THREAD_LOCAL zbx_compress_stats_t	compress_pending[ZBX_COMPRESS_STATS_COUNT];
+static ZBX_THREAD_LOCAL zbx_uint64_t		tls_pending[ZBX_TLS_STATS_COUNT];
+static ZBX_THREAD_LOCAL int			stats_pending;
+static ZBX_THREAD_LOCAL double			stats_flushed;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds compression and TLS statistics of the calling process to     *
+ *          shared memory                                                     *
+ *                                                                            *
+ * Parameters: now - [IN] current time                                        *
+ *                                                                            *
+ * Comments: The statistics are flushed at most once per                      *
+ *           SELFMON_STATS_FLUSH_INTERVAL seconds, so the shared lock is not  *
+ *           taken for every message or connection.                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	selfmon_stats_flush(double now)
+{
+#define SELFMON_STATS_FLUSH_INTERVAL	1
+	int	i;
+
+	if (NULL == collector.compress || SELFMON_STATS_FLUSH_INTERVAL > now - stats_flushed)
+		return;
+
+	stats_flushed = now;
+
+	if (0 == stats_pending)
+		return;
+
+	zbx_mutex_lock(sm_lock);
+
+	for (i = 0; i < ZBX_COMPRESS_STATS_COUNT; i++)
+	{
+		zbx_compress_stats_t	*stats = &collector.compress[i];
+
+		stats->messages += compress_pending[i].messages;
+		stats->bytes += compress_pending[i].bytes;
+		stats->bytes_compressed += compress_pending[i].bytes_compressed;
+		stats->time += compress_pending[i].time;
+	}
+
+	for (i = 0; i < ZBX_TLS_STATS_COUNT; i++)
+		collector.tls[i] += tls_pending[i];
+
+	zbx_mutex_unlock(sm_lock);
+
+	memset(compress_pending, 0, sizeof(compress_pending));
+	memset(tls_pending, 0, sizeof(tls_pending));
+	stats_pending = 0;
+#undef SELFMON_STATS_FLUSH_INTERVAL
+}
+
 /******************************************************************************
  *                                                                            *
  * Parameters: info  - [IN] caller process info                               *
@@ -152,6 +253,9 @@ void	zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char sta
 
 	zbx_timekeeper_update(collector.monitor, unit_index, state);
 
+	/* also flush on state changes, so statistics of processes without traffic are not held back */
+	if (0 != stats_pending)
+		selfmon_stats_flush(zbx_time());
 }
 
 static void	collect_selfmon_stats(void)
@@ -303,6 +407,188 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds sampled profiling statistics of the calling process to the   *
+ *          statistics of its process type                                    *
+ *                                                                            *
+ * Parameters: info      - [IN] caller process type name                      *
+ *             stats     - [IN] statistics collected since the last call      *
+ *             stats_num - [IN] number of statistics                          *
+ *                                                                            *
+ * Comments: Function names are not copied, they point to static strings      *
+ *           which are the same in all forked processes.                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_prof_flush(const char *info, const zbx_prof_stat_t *stats, int stats_num)
+{
+	int			proc_type;
+	zbx_selfmon_prof_t	*prof;
+
+	if (ZBX_PROCESS_TYPE_UNKNOWN == (proc_type = get_process_type_by_name(info)) || NULL == collector.prof)
+		return;
+
+	prof = &collector.prof[proc_type];
+
+	zbx_mutex_lock(sm_lock);
+
+	for (int i = 0; i < stats_num; i++)
+	{
+		zbx_prof_stat_t	*func = NULL;
+		int		j;
+
+		if (0 == strcmp(stats[i].func_name, ZBX_PROF_OTHER))
+			func = &prof->other;
+
+		for (j = 0; NULL == func && j < prof->funcs_num; j++)
+		{
+			if (prof->funcs[j].func_name == stats[i].func_name)
+			{
+				func = &prof->funcs[j];
+				break;
+			}
+		}
+
+		if (NULL == func)
+		{
+			if (ZBX_SELFMON_PROF_FUNCS_MAX > prof->funcs_num)
+			{
+				func = &prof->funcs[prof->funcs_num++];
+				func->func_name = stats[i].func_name;
+				func->scope = stats[i].scope;
+			}
+			else
+				func = &prof->other;
+		}
+
+		func->samples += stats[i].samples;
+		func->locked += stats[i].locked;
+		func->sec_wait += stats[i].sec_wait;
+	}
+
+	zbx_mutex_unlock(sm_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets sampled profiling statistics of the specified process type   *
+ *                                                                            *
+ * Parameters: proc_type - [IN] process type; ZBX_PROCESS_TYPE_*              *
+ *             stats     - [OUT] statistics sorted by samples in descending   *
+ *                               order, must be freed by the caller           *
+ *             stats_num - [OUT] number of statistics                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_get_prof_stats(unsigned char proc_type, zbx_prof_stat_t **stats, int *stats_num)
+{
+	zbx_selfmon_prof_t	*prof = &collector.prof[proc_type];
+
+	zbx_mutex_lock(sm_lock);
+
+	*stats_num = prof->funcs_num;
+	*stats = (zbx_prof_stat_t *)zbx_malloc(NULL, sizeof(zbx_prof_stat_t) * (size_t)(prof->funcs_num + 1));
+	memcpy(*stats, prof->funcs, sizeof(zbx_prof_stat_t) * (size_t)prof->funcs_num);
+
+	if (0 != prof->other.samples || 0 != prof->other.locked)
+	{
+		(*stats)[(*stats_num)++] = prof->other;
+		(*stats)[*stats_num - 1].func_name = ZBX_PROF_OTHER;
+		(*stats)[*stats_num - 1].scope = ZBX_PROF_PROCESSING;
+	}
+
+	zbx_mutex_unlock(sm_lock);
+
+	qsort(*stats, (size_t)*stats_num, sizeof(zbx_prof_stat_t), selfmon_prof_stat_compare);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds compressed or uncompressed message to compression statistics *
+ *                                                                            *
+ * Parameters: direction        - [IN] ZBX_COMPRESS_STATS_SENT or             *
+ *                                     ZBX_COMPRESS_STATS_RECEIVED            *
+ *             bytes            - [IN] uncompressed message size              *
+ *             bytes_compressed - [IN] compressed message size                *
+ *             time             - [IN] time spent compressing or              *
+ *                                     uncompressing the message              *
+ *                                                                            *
+ * Comments: The message is counted in process local statistics which are     *
+ *           periodically added to the totals in shared memory.               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_compress_update(int direction, size_t bytes, size_t bytes_compressed, double time)
+{
+	zbx_compress_stats_t	*stats = &compress_pending[direction];
+
+	stats->messages++;
+	stats->bytes += bytes;
+	stats->bytes_compressed += bytes_compressed;
+	stats->time += time;
+	stats_pending = 1;
+
+	selfmon_stats_flush(zbx_time());
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets message compression statistics                               *
+ *                                                                            *
+ * Parameters: direction - [IN] ZBX_COMPRESS_STATS_SENT or                    *
+ *                              ZBX_COMPRESS_STATS_RECEIVED                   *
+ *             stats     - [OUT] statistics since server start                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_get_compress_stats(int direction, zbx_compress_stats_t *stats)
+{
+	if (NULL == collector.compress)
+	{
+		memset(stats, 0, sizeof(zbx_compress_stats_t));
+		return;
+	}
+
+	zbx_mutex_lock(sm_lock);
+	*stats = collector.compress[direction];
+	zbx_mutex_unlock(sm_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds established TLS connection to TLS statistics                 *
+ *                                                                            *
+ * Parameters: counter - [IN] ZBX_TLS_STATS_* counter to increment            *
+ *                                                                            *
+ * Comments: The connection is counted in process local statistics which are  *
+ *           periodically added to the totals in shared memory.               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_tls_update(int counter)
+{
+	tls_pending[counter]++;
+	stats_pending = 1;
+
+	selfmon_stats_flush(zbx_time());
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets TLS statistics                                               *
+ *                                                                            *
+ * Parameters: stats - [OUT] ZBX_TLS_STATS_COUNT counters since server start  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_selfmon_get_tls_stats(zbx_uint64_t *stats)
+{
+	if (NULL == collector.tls)
+	{
+		memset(stats, 0, sizeof(zbx_uint64_t) * ZBX_TLS_STATS_COUNT);
+		return;
+	}
+
+	zbx_mutex_lock(sm_lock);
+	memcpy(stats, collector.tls, sizeof(zbx_uint64_t) * ZBX_TLS_STATS_COUNT);
+	zbx_mutex_unlock(sm_lock);
+}
+
 static int	sleep_remains;
 
 /******************************************************************************
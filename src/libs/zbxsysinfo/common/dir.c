@@ -82,26 +82,53 @@ static int	queue_directory(zbx_vector_ptr_t *list, char *path, int depth, int ma
 	return FAIL;	/* 'path' did not go into 'list' - don't forget to free 'path' in the caller */
 }
 
+static zbx_hash_t	descriptor_hash(const void *data)
+{
+	const zbx_file_descriptor_t	*file = (const zbx_file_descriptor_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&file->st_ino);
+
+	return ZBX_DEFAULT_HASH_ALGO(&file->st_dev, sizeof(file->st_dev), hash);
+}
+
+static int	descriptor_compare(const void *d1, const void *d2)
+{
+	const zbx_file_descriptor_t	*fa = (const zbx_file_descriptor_t *)d1;
+	const zbx_file_descriptor_t	*fb = (const zbx_file_descriptor_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(fa->st_ino, fb->st_ino);
+	ZBX_RETURN_IF_NOT_EQUAL(fa->st_dev, fb->st_dev);
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: Compares two zbx_file_descriptor_t values to perform search       *
- *          within descriptor vector.                                         *
+ * Purpose: checks if file with multiple hardlinks was already processed and  *
+ *          remembers it otherwise                                            *
  *                                                                            *
- * Parameters: file_a - [IN] file descriptor A                                *
- *             file_b - [IN] file descriptor B                                *
+ * Parameters: descriptors - [IN/OUT] already processed files                 *
+ *             st_dev      - [IN] file device                                 *
+ *             st_ino      - [IN] file serial number                          *
  *                                                                            *
- * Return value: If file descriptor values are the same, 0 is returned        *
- *               otherwise nonzero value is returned.                         *
+ * Return value: SUCCEED - file was already processed                         *
+ *               FAIL    - file is seen for the first time                    *
  *                                                                            *
  ******************************************************************************/
-static int	compare_descriptors(const void *file_a, const void *file_b)
+static int	descriptor_processed(zbx_hashset_t *descriptors, zbx_uint64_t st_dev, zbx_uint64_t st_ino)
 {
-	const zbx_file_descriptor_t	*fa, *fb;
+	zbx_file_descriptor_t	file;
+
+	file.st_dev = st_dev;
+	file.st_ino = st_ino;
+
+	if (NULL != zbx_hashset_search(descriptors, &file))
+		return SUCCEED;
 
-	fa = *((zbx_file_descriptor_t * const *)file_a);
-	fb = *((zbx_file_descriptor_t * const *)file_b);
+	zbx_hashset_insert(descriptors, &file, sizeof(file));
 
-	return (fa->st_ino != fb->st_ino || fa->st_dev != fb->st_dev);
+	return FAIL;
 }
 
 static int	prepare_common_parameters(const AGENT_REQUEST *request, AGENT_RESULT *result, zbx_regexp_t **regex_incl,
@@ -376,17 +403,66 @@ static void	list_vector_destroy(zbx_vector_ptr_t *list)
 	zbx_vector_ptr_destroy(list);
 }
 
-static void	descriptors_vector_destroy(zbx_vector_ptr_t *descriptors)
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+#if defined(HAVE_FSTATAT) && defined(HAVE_DIRFD) && defined(AT_SYMLINK_NOFOLLOW)
+#	define ZBX_DIR_ENTRY_FSTATAT
+#endif
+
+static char	*dir_entry_path(const char *dir, const char *name)
 {
-	zbx_file_descriptor_t	*file;
+	if (0 == strcmp(dir, "/"))
+		return zbx_dsprintf(NULL, "%s%s", dir, name);
+
+	return zbx_dsprintf(NULL, "%s/%s", dir, name);
+}
 
-	while (0 < descriptors->values_num)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets status of directory entry without following symbolic links  *
+ *                                                                            *
+ * Parameters: directory - [IN] open directory stream                         *
+ *             dir       - [IN] path of the directory                         *
+ *             entry     - [IN] directory entry                               *
+ *             type_only - [IN] nonzero if only file type is required         *
+ *             path      - [OUT] full path of the entry if it had to be built *
+ *                               to get the status, NULL otherwise            *
+ *             status    - [OUT] entry status                                 *
+ *                                                                            *
+ * Return value: 0 on success, -1 on failure (errno is set)                   *
+ *                                                                            *
+ * Comments: Entry is looked up relative to the already open directory when   *
+ *           possible, so full path is not built and resolved by kernel for   *
+ *           every entry. If only file type is required and the file system   *
+ *           reports it in directory entry, no system call is made at all -   *
+ *           only st_mode is set in such case.                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	dir_entry_stat(DIR *directory, const char *dir, const struct dirent *entry, int type_only,
+		char **path, zbx_stat_t *status)
+{
+#if defined(DT_UNKNOWN) && defined(DTTOIF)
+	if (0 != type_only && DT_UNKNOWN != entry->d_type)
 	{
-		file = (zbx_file_descriptor_t *)descriptors->values[--descriptors->values_num];
-		zbx_free(file);
+		status->st_mode = DTTOIF(entry->d_type);
+		return 0;
 	}
-	zbx_vector_ptr_destroy(descriptors);
+#else
+	ZBX_UNUSED(type_only);
+#endif
+#ifdef ZBX_DIR_ENTRY_FSTATAT
+	ZBX_UNUSED(dir);
+	ZBX_UNUSED(path);
+
+	return fstatat(dirfd(directory), entry->d_name, status, AT_SYMLINK_NOFOLLOW);
+#else
+	ZBX_UNUSED(directory);
+
+	*path = dir_entry_path(dir, entry->d_name);
+
+	return lstat(*path, status);
+#endif
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -459,10 +535,9 @@ static int	get_file_info_by_handle(wchar_t *wpath, BY_HANDLE_FILE_INFORMATION *l
 	return SUCCEED;
 }
 
-static int	link_processed(DWORD attrib, wchar_t *wpath, zbx_vector_ptr_t *descriptors, char *path)
+static int	link_processed(DWORD attrib, wchar_t *wpath, zbx_hashset_t *descriptors, char *path)
 {
 	BY_HANDLE_FILE_INFORMATION	link_info;
-	zbx_file_descriptor_t		*file;
 	char 				*error;
 
 	/* Behavior like MS file explorer */
@@ -483,18 +558,8 @@ static int	link_processed(DWORD attrib, wchar_t *wpath, zbx_vector_ptr_t *descri
 	if (1 < link_info.nNumberOfLinks)
 	{
 		/* skip file if inode was already processed (multiple hardlinks) */
-		file = (zbx_file_descriptor_t*)zbx_malloc(NULL, sizeof(zbx_file_descriptor_t));
-
-		file->st_dev = link_info.dwVolumeSerialNumber;
-		file->st_ino = DW2UI64(link_info.nFileIndexHigh, link_info.nFileIndexLow);
-
-		if (FAIL != zbx_vector_ptr_search(descriptors, file, compare_descriptors))
-		{
-			zbx_free(file);
-			return SUCCEED;
-		}
-
-		zbx_vector_ptr_append(descriptors, file);
+		return descriptor_processed(descriptors, link_info.dwVolumeSerialNumber,
+				DW2UI64(link_info.nFileIndexHigh, link_info.nFileIndexLow));
 	}
 
 	return FAIL;
@@ -505,7 +570,8 @@ static int	vfs_dir_size_local(AGENT_REQUEST *request, AGENT_RESULT *result, HAND
 	char			*dir = NULL;
 	int			mode, max_depth, ret = SYSINFO_RET_FAIL;
 	zbx_uint64_t		size = 0;
-	zbx_vector_ptr_t	list, descriptors;
+	zbx_vector_ptr_t	list;
+	zbx_hashset_t		descriptors;
 	zbx_stat_t		status;
 	zbx_regexp_t		*regex_incl = NULL, *regex_excl = NULL, *regex_excl_dir = NULL;
 	size_t			dir_len;
@@ -519,7 +585,7 @@ static int	vfs_dir_size_local(AGENT_REQUEST *request, AGENT_RESULT *result, HAND
 		goto err1;
 	}
 
-	zbx_vector_ptr_create(&descriptors);
+	zbx_hashset_create(&descriptors, 100, descriptor_hash, descriptor_compare);
 	zbx_vector_ptr_create(&list);
 
 	dir_len = strlen(dir);	/* store this value before giving away pointer ownership */
@@ -670,7 +736,7 @@ skip:
 	ret = SYSINFO_RET_OK;
 err2:
 	list_vector_destroy(&list);
-	descriptors_vector_destroy(&descriptors);
+	zbx_hashset_destroy(&descriptors);
 err1:
 	regex_incl_excl_free(regex_incl, regex_excl, regex_excl_dir);
 
@@ -682,10 +748,11 @@ static int	vfs_dir_size_local(AGENT_REQUEST *request, AGENT_RESULT *result)
 	char			*dir = NULL;
 	int			mode, max_depth, ret = SYSINFO_RET_FAIL;
 	zbx_uint64_t		size = 0;
-	zbx_vector_ptr_t	list, descriptors;
+	zbx_vector_ptr_t	list;
+	zbx_hashset_t		descriptors;
 	zbx_stat_t		status;
 	zbx_regexp_t		*regex_incl = NULL, *regex_excl = NULL, *regex_excl_dir = NULL;
-	size_t			dir_len;
+	size_t			rel_offset;
 
 	if (SUCCEED != prepare_mode_parameter(request, result, &mode))
 		return ret;
@@ -696,10 +763,11 @@ static int	vfs_dir_size_local(AGENT_REQUEST *request, AGENT_RESULT *result)
 		goto err1;
 	}
 
-	zbx_vector_ptr_create(&descriptors);
+	zbx_hashset_create(&descriptors, 100, descriptor_hash, descriptor_compare);
 	zbx_vector_ptr_create(&list);
 
-	dir_len = strlen(dir);	/* store this value before giving away pointer ownership */
+	/* store this value before giving away pointer ownership */
+	rel_offset = (0 == strcmp(dir, "/") ? 1 : strlen(dir) + 1);
 
 	if (SUCCEED != queue_directory(&list, dir, -1, max_depth))	/* put top directory into list */
 	{
@@ -743,67 +811,54 @@ static int	vfs_dir_size_local(AGENT_REQUEST *request, AGENT_RESULT *result)
 
 		while (NULL != (entry = readdir(directory)))
 		{
-			char	*path;
+			char	*path = NULL;
 
 			if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
 				continue;
 
-			path = zbx_dsprintf(NULL, "%s/%s", item->path, entry->d_name);
+			if (0 != dir_entry_stat(directory, item->path, entry, 0, &path, &status))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "%s() cannot process directory entry '%s' in '%s': %s",
+						__func__, entry->d_name, item->path, zbx_strerror(errno));
+				zbx_free(path);
+				continue;
+			}
 
-			if (0 == lstat(path, &status))
+			if (0 != S_ISDIR(status.st_mode))
 			{
-				if (NULL != regex_excl_dir && 0 != S_ISDIR(status.st_mode))
-				{
-					/* consider only path relative to path given in first parameter */
-					if (0 == zbx_regexp_match_precompiled(path + dir_len + 1, regex_excl_dir))
-					{
-						zbx_free(path);
-						continue;
-					}
-				}
+				if (NULL == path)
+					path = dir_entry_path(item->path, entry->d_name);
 
-				if ((0 != S_ISREG(status.st_mode) || 0 != S_ISLNK(status.st_mode) ||
-						0 != S_ISDIR(status.st_mode)) &&
-						0 != filename_matches(entry->d_name, regex_incl, regex_excl))
+				/* consider only path relative to path given in first parameter */
+				if (NULL != regex_excl_dir &&
+						0 == zbx_regexp_match_precompiled(path + rel_offset, regex_excl_dir))
 				{
-					if (0 != S_ISREG(status.st_mode) && 1 < status.st_nlink)
-					{
-						zbx_file_descriptor_t	*file;
-
-						/* skip file if inode was already processed (multiple hardlinks) */
-						file = (zbx_file_descriptor_t*)zbx_malloc(NULL,
-								sizeof(zbx_file_descriptor_t));
-
-						file->st_dev = status.st_dev;
-						file->st_ino = status.st_ino;
-
-						if (FAIL != zbx_vector_ptr_search(&descriptors, file,
-								compare_descriptors))
-						{
-							zbx_free(file);
-							zbx_free(path);
-							continue;
-						}
-
-						zbx_vector_ptr_append(&descriptors, file);
-					}
-
-					if (SIZE_MODE_APPARENT == mode)
-						size += (zbx_uint64_t)status.st_size;
-					else	/* must be SIZE_MODE_DISK */
-						size += (zbx_uint64_t)status.st_blocks * DISK_BLOCK_SIZE;
+					zbx_free(path);
+					continue;
 				}
+			}
 
-				if (!(0 != S_ISDIR(status.st_mode) && SUCCEED == queue_directory(&list, path,
-						item->depth, max_depth)))
+			if ((0 != S_ISREG(status.st_mode) || 0 != S_ISLNK(status.st_mode) ||
+					0 != S_ISDIR(status.st_mode)) &&
+					0 != filename_matches(entry->d_name, regex_incl, regex_excl))
+			{
+				/* skip file if inode was already processed (multiple hardlinks) */
+				if (0 != S_ISREG(status.st_mode) && 1 < status.st_nlink && SUCCEED ==
+						descriptor_processed(&descriptors, status.st_dev, status.st_ino))
 				{
 					zbx_free(path);
+					continue;
 				}
+
+				if (SIZE_MODE_APPARENT == mode)
+					size += (zbx_uint64_t)status.st_size;
+				else	/* must be SIZE_MODE_DISK */
+					size += (zbx_uint64_t)status.st_blocks * DISK_BLOCK_SIZE;
 			}
-			else
+
+			if (!(0 != S_ISDIR(status.st_mode) && SUCCEED == queue_directory(&list, path,
+					item->depth, max_depth)))
 			{
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() cannot process directory entry '%s': %s",
-						__func__, path, zbx_strerror(errno));
 				zbx_free(path);
 			}
 		}
@@ -818,7 +873,7 @@ skip:
 	ret = SYSINFO_RET_OK;
 err2:
 	list_vector_destroy(&list);
-	descriptors_vector_destroy(&descriptors);
+	zbx_hashset_destroy(&descriptors);
 err1:
 	regex_incl_excl_free(regex_incl, regex_excl, regex_excl_dir);
 
@@ -864,7 +919,7 @@ static int	vfs_dir_info(AGENT_REQUEST *request, AGENT_RESULT *result, HANDLE tim
 	char			*dir = NULL;
 	int			types, max_depth, ret = SYSINFO_RET_FAIL;
 	zbx_uint64_t		count = 0;
-	zbx_vector_ptr_t	list, descriptors;
+	zbx_vector_ptr_t	list;
 	zbx_stat_t		status;
 	zbx_regexp_t		*regex_incl = NULL, *regex_excl = NULL, *regex_excl_dir = NULL;
 	zbx_uint64_t		min_size = 0, max_size = __UINT64_C(0x7fffffffffffffff);
@@ -882,7 +937,6 @@ static int	vfs_dir_info(AGENT_REQUEST *request, AGENT_RESULT *result, HANDLE tim
 	}
 
 	zbx_json_initarray(&j, ZBX_JSON_STAT_BUF_LEN);
-	zbx_vector_ptr_create(&descriptors);
 	zbx_vector_ptr_create(&list);
 
 	dir_len = strlen(dir);	/* store this value before giving away pointer ownership */
@@ -1028,7 +1082,6 @@ skip:
 	ret = SYSINFO_RET_OK;
 err2:
 	list_vector_destroy(&list);
-	descriptors_vector_destroy(&descriptors);
 	zbx_json_free(&j);
 err1:
 	regex_incl_excl_free(regex_incl, regex_excl, regex_excl_dir);
@@ -1049,13 +1102,13 @@ static int	vfs_dir_get_local(AGENT_REQUEST *request, AGENT_RESULT *result, HANDL
 static int	vfs_dir_info(AGENT_REQUEST *request, AGENT_RESULT *result, int count_mode)
 {
 	char			*dir = NULL;
-	int			types, max_depth, ret = SYSINFO_RET_FAIL, count = 0;
+	int			types, max_depth, ret = SYSINFO_RET_FAIL, count = 0, type_only;
 	zbx_vector_ptr_t	list;
 	zbx_stat_t		status;
 	zbx_regexp_t		*regex_incl = NULL, *regex_excl = NULL, *regex_excl_dir = NULL;
 	zbx_uint64_t		min_size = 0, max_size = __UINT64_C(0x7FFFffffFFFFffff);
 	time_t			min_time = 0, max_time = 0x7fffffff;
-	size_t			dir_len;
+	size_t			rel_offset;
 	struct zbx_json		j;
 
 	if (SUCCEED != prepare_count_parameters(request, result, &types, &min_size, &max_size, &min_time, &max_time))
@@ -1067,11 +1120,16 @@ static int	vfs_dir_info(AGENT_REQUEST *request, AGENT_RESULT *result, int count_
 		goto err1;
 	}
 
+	/* without size and time filters entries can be counted by type reported in directory listing */
+	type_only = (0 != count_mode && 0 == min_size && __UINT64_C(0x7FFFffffFFFFffff) == max_size &&
+			0 == min_time && 0x7fffffff == max_time);
+
 	zbx_json_initarray(&j, ZBX_JSON_STAT_BUF_LEN);
 
 	zbx_vector_ptr_create(&list);
 
-	dir_len = strlen(dir);	/* store this value before giving away pointer ownership */
+	/* store this value before giving away pointer ownership */
+	rel_offset = (0 == strcmp(dir, "/") ? 1 : strlen(dir) + 1);
 
 	if (SUCCEED != queue_directory(&list, dir, -1, max_depth))	/* put top directory into list */
 	{
@@ -1103,54 +1161,55 @@ static int	vfs_dir_info(AGENT_REQUEST *request, AGENT_RESULT *result, int count_
 
 		while (NULL != (entry = readdir(directory)))
 		{
-			char	*path;
+			char	*path = NULL;
 
 			if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
 				continue;
 
-			if (0 == strcmp(item->path, "/"))
-				path = zbx_dsprintf(NULL, "%s%s", item->path, entry->d_name);
-			else
-				path = zbx_dsprintf(NULL, "%s/%s", item->path, entry->d_name);
-
-			if (0 == lstat(path, &status))
+			if (0 != dir_entry_stat(directory, item->path, entry, type_only, &path, &status))
 			{
-				if (NULL != regex_excl_dir && 0 != S_ISDIR(status.st_mode))
-				{
-					/* consider only path relative to path given in first parameter */
-					if (0 == zbx_regexp_match_precompiled(path + dir_len + 1, regex_excl_dir))
-					{
-						zbx_free(path);
-						continue;
-					}
-				}
+				zabbix_log(LOG_LEVEL_DEBUG, "%s() cannot process directory entry '%s' in '%s': %s",
+						__func__, entry->d_name, item->path, zbx_strerror(errno));
+				zbx_free(path);
+				continue;
+			}
 
-				if (0 != filename_matches(entry->d_name, regex_incl, regex_excl) && (
-						(S_ISREG(status.st_mode)  && 0 != (types & ZBX_FT_FILE)) ||
-						(S_ISDIR(status.st_mode)  && 0 != (types & ZBX_FT_DIR)) ||
-						(S_ISLNK(status.st_mode)  && 0 != (types & ZBX_FT_SYM)) ||
-						(S_ISSOCK(status.st_mode) && 0 != (types & ZBX_FT_SOCK)) ||
-						(S_ISBLK(status.st_mode)  && 0 != (types & ZBX_FT_BDEV)) ||
-						(S_ISCHR(status.st_mode)  && 0 != (types & ZBX_FT_CDEV)) ||
-						(S_ISFIFO(status.st_mode) && 0 != (types & ZBX_FT_FIFO))) &&
-						(min_size <= (zbx_uint64_t)status.st_size
-								&& (zbx_uint64_t)status.st_size <= max_size) &&
-						(min_time < status.st_mtime &&
-								status.st_mtime <= max_time))
-				{
-					EVALUATE_DIR_ENTITY()
-				}
+			if (0 != S_ISDIR(status.st_mode))
+			{
+				if (NULL == path)
+					path = dir_entry_path(item->path, entry->d_name);
 
-				if (!(0 != S_ISDIR(status.st_mode) && SUCCEED == queue_directory(&list, path,
-						item->depth, max_depth)))
+				/* consider only path relative to path given in first parameter */
+				if (NULL != regex_excl_dir &&
+						0 == zbx_regexp_match_precompiled(path + rel_offset, regex_excl_dir))
 				{
 					zbx_free(path);
+					continue;
 				}
 			}
-			else
+
+			if (0 != filename_matches(entry->d_name, regex_incl, regex_excl) && (
+					(S_ISREG(status.st_mode)  && 0 != (types & ZBX_FT_FILE)) ||
+					(S_ISDIR(status.st_mode)  && 0 != (types & ZBX_FT_DIR)) ||
+					(S_ISLNK(status.st_mode)  && 0 != (types & ZBX_FT_SYM)) ||
+					(S_ISSOCK(status.st_mode) && 0 != (types & ZBX_FT_SOCK)) ||
+					(S_ISBLK(status.st_mode)  && 0 != (types & ZBX_FT_BDEV)) ||
+					(S_ISCHR(status.st_mode)  && 0 != (types & ZBX_FT_CDEV)) ||
+					(S_ISFIFO(status.st_mode) && 0 != (types & ZBX_FT_FIFO))) &&
+					(0 != type_only || (
+					(min_size <= (zbx_uint64_t)status.st_size &&
+							(zbx_uint64_t)status.st_size <= max_size) &&
+					(min_time < status.st_mtime && status.st_mtime <= max_time))))
+			{
+				if (0 == count_mode && NULL == path)
+					path = dir_entry_path(item->path, entry->d_name);
+
+				EVALUATE_DIR_ENTITY()
+			}
+
+			if (!(0 != S_ISDIR(status.st_mode) && SUCCEED == queue_directory(&list, path,
+					item->depth, max_depth)))
 			{
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() cannot process directory entry '%s': %s",
-						__func__, path, zbx_strerror(errno));
 				zbx_free(path);
 			}
 		}
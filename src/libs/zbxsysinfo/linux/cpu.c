@@ -14,6 +14,7 @@
 
 #include "zbxsysinfo.h"
 #include "../sysinfo.h"
+#include "proc.h"
 
 #include "../common/cpustat.h"
 
@@ -193,7 +194,7 @@ int     system_cpu_switches(AGENT_REQUEST *request, AGENT_RESULT *result)
 
 	ZBX_UNUSED(request);
 
-	if (NULL == (f = fopen("/proc/stat", "r")))
+	if (NULL == (f = proc_file_open("/proc/stat")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc/stat: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
@@ -228,7 +229,7 @@ int     system_cpu_intr(AGENT_REQUEST *request, AGENT_RESULT *result)
 
 	ZBX_UNUSED(request);
 
-	if (NULL == (f = fopen("/proc/stat", "r")))
+	if (NULL == (f = proc_file_open("/proc/stat")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc/stat: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
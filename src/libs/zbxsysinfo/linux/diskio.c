@@ -14,6 +14,7 @@
 
 #include "zbxsysinfo.h"
 #include "../sysinfo.h"
+#include "proc.h"
 
 #include "zbxjson.h"
 #include "zbxstr.h"
@@ -90,7 +91,7 @@ int	zbx_get_diskstat(const char *devname, zbx_uint64_t *dstat)
 			dev_exists = SUCCEED;
 	}
 
-	if (NULL == (f = fopen(INFO_FILE_NAME, "r")))
+	if (NULL == (f = proc_file_open(INFO_FILE_NAME)))
 		return FAIL;
 
 	while (NULL != fgets(tmp, sizeof(tmp), f))
@@ -149,7 +150,7 @@ static int	get_kernel_devname(const char *devname, char *kernel_devname, size_t
 		zbx_strscpy(dev_path, ZBX_DEV_PFX);
 	zbx_strscat(dev_path, devname);
 
-	if (zbx_stat(dev_path, &dev_st) < 0 || NULL == (f = fopen(INFO_FILE_NAME, "r")))
+	if (zbx_stat(dev_path, &dev_st) < 0 || NULL == (f = proc_file_open(INFO_FILE_NAME)))
 		return ret;
 
 	while (NULL != fgets(tmp, sizeof(tmp), f))
@@ -109,7 +109,7 @@ static int	vm_memory_available(AGENT_RESULT *result)
 
 	/* try MemAvailable (present since Linux 3.14), falling back to a calculation based on sysinfo() and Cached */
 
-	if (NULL == (f = fopen("/proc/meminfo", "r")))
+	if (NULL == (f = proc_file_open("/proc/meminfo")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc/meminfo: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
@@ -218,7 +218,7 @@ static int	vm_memory_proc_meminfo(const char *meminfo_entry, AGENT_RESULT *resul
 	zbx_uint64_t	value;
 	int		ret = SYSINFO_RET_FAIL;
 
-	if (NULL == (f = fopen("/proc/meminfo", "r")))
+	if (NULL == (f = proc_file_open("/proc/meminfo")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc/meminfo: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
@@ -13,6 +13,7 @@
 **/
 
 #include "../sysinfo.h"
+#include "proc.h"
 
 #include "zbxjson.h"
 #include "zbxcomms.h"
@@ -56,6 +57,8 @@ net_count_info_t;
 #	include <sys/socket.h>
 #	include <linux/netlink.h>
 #	include <linux/inet_diag.h>
+#	include <linux/sock_diag.h>
+#	include <linux/rtnetlink.h>
 
 enum
 {
@@ -74,6 +77,8 @@ enum
 	STATE_MAXSTATES
 };
 
+#define STATE_ALL	((1 << STATE_MAXSTATES) - 1)
+
 enum
 {
 	NLERR_OK = 0,
@@ -89,44 +94,145 @@ enum
 
 static int	nlerr;
 
-static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
+/* callback processing socket returned by netlink query, returns FAIL to stop the query */
+typedef int	(*net_diag_process_func_t)(const struct inet_diag_msg *msg, void *data);
+
+static const char	*nlerr_string(void)
+{
+	switch (nlerr)
+	{
+		case NLERR_UNKNOWN:
+			return "unrecognized netlink error occurred";
+		case NLERR_SOCKCREAT:
+			return "cannot create netlink socket";
+		case NLERR_BADSEND:
+			return "cannot send netlink message to kernel";
+		case NLERR_BADRECV:
+			return "cannot receive netlink message from kernel";
+		case NLERR_RECVTIMEOUT:
+			return "receiving netlink response timed out";
+		case NLERR_RESPTRUNCAT:
+			return "received truncated netlink response from kernel";
+		case NLERR_OPNOTSUPPORTED:
+			return "netlink operation not supported";
+		case NLERR_UNKNOWNMSGTYPE:
+			return "received message of unrecognized type from kernel";
+		default:
+			return "unknown error";
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends port comparison to inet_diag bytecode filter              *
+ *                                                                            *
+ * Parameters: bc     - [IN/OUT] bytecode                                     *
+ *             bc_num - [IN/OUT] number of operations in bytecode             *
+ *             code   - [IN] INET_DIAG_BC_S_EQ or INET_DIAG_BC_D_EQ           *
+ *             port   - [IN]                                                  *
+ *                                                                            *
+ * Comments: The 'no' jump offsets are calculated later by                    *
+ *           net_diag_finalize_bc(), when bytecode length is known.           *
+ *                                                                            *
+ ******************************************************************************/
+static void	net_diag_add_port_bc(struct inet_diag_bc_op *bc, int *bc_num, unsigned char code, unsigned short port)
+{
+	bc[*bc_num].code = code;
+	bc[*bc_num].yes = 2 * sizeof(struct inet_diag_bc_op);
+	bc[*bc_num].no = 0;
+	(*bc_num)++;
+
+	bc[*bc_num].code = INET_DIAG_BC_NOP;
+	bc[*bc_num].yes = 0;
+	bc[*bc_num].no = port;
+	(*bc_num)++;
+}
+
+static void	net_diag_finalize_bc(struct inet_diag_bc_op *bc, int bc_num)
 {
+	/* on mismatch jump beyond the end of bytecode to reject socket */
+	for (int i = 0; i < bc_num; i += 2)
+		bc[i].no = (unsigned short)((bc_num - i + 1) * sizeof(struct inet_diag_bc_op));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queries IPv4 and IPv6 sockets from kernel with NETLINK_SOCK_DIAG  *
+ *                                                                            *
+ * Parameters: protocol     - [IN] IPPROTO_TCP or IPPROTO_UDP                 *
+ *             states       - [IN] bitmask of socket states to return         *
+ *             sport        - [IN] local port to filter by, 0 - any           *
+ *             dport        - [IN] remote port to filter by, 0 - any          *
+ *             process_func - [IN] callback to process returned sockets       *
+ *             data         - [IN] callback data                              *
+ *                                                                            *
+ * Return value: SUCCEED - query was completed or stopped by callback         *
+ *               FAIL    - netlink error occurred, see nlerr                  *
+ *                                                                            *
+ * Comments: Socket states and ports are filtered by kernel, so only the      *
+ *           matching sockets are copied to user space.                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	net_diag_query(unsigned char protocol, unsigned int states, unsigned short sport, unsigned short dport,
+		net_diag_process_func_t process_func, void *data)
+{
+#define NET_DIAG_BUFFER_SIZE	(64 * ZBX_KIBIBYTE)
 	struct
 	{
 		struct nlmsghdr		nlhdr;
-		struct inet_diag_req	r;
+		struct inet_diag_req_v2	r;
+		struct rtattr		rta;
+		struct inet_diag_bc_op	bc[4];
 	}
 	request;
 
-	int			ret = FAIL, fd, status;
+	int			ret = FAIL, fd, status, bc_num = 0;
 	int			families[] = {AF_INET, AF_INET6, AF_UNSPEC};
 	unsigned int		sequence = 0x58425A;
 	struct timeval		timeout = { 1, 500 * 1000 };
 
 	struct sockaddr_nl	s_sa = { AF_NETLINK, 0, 0, 0 };
-	struct iovec		s_io[1] = { { &request, sizeof(request) } };
+	struct iovec		s_io[1] = { { &request, 0 } };
 	struct msghdr		s_msg = { (void *)&s_sa, sizeof(struct sockaddr_nl), s_io, 1, NULL, 0, 0};
 
-	char			buffer[BUFSIZ] = { 0 };
+	char			*buffer;
 
 	struct sockaddr_nl	r_sa = { AF_NETLINK, 0, 0, 0 };
-	struct iovec		r_io[1] = { { buffer, BUFSIZ } };
+	struct iovec		r_io[1] = { { NULL, NET_DIAG_BUFFER_SIZE } };
 	struct msghdr		r_msg = { (void *)&r_sa, sizeof(struct sockaddr_nl), r_io, 1, NULL, 0, 0};
 
 	struct nlmsghdr		*r_hdr;
 
-	*found = 0;
+	memset(&request, 0, sizeof(request));
+
+	if (0 != sport)
+		net_diag_add_port_bc(request.bc, &bc_num, INET_DIAG_BC_S_EQ, sport);
+
+	if (0 != dport)
+		net_diag_add_port_bc(request.bc, &bc_num, INET_DIAG_BC_D_EQ, dport);
+
+	request.nlhdr.nlmsg_len = NLMSG_LENGTH(sizeof(request.r));
+
+	if (0 != bc_num)
+	{
+		net_diag_finalize_bc(request.bc, bc_num);
+
+		request.rta.rta_type = INET_DIAG_REQ_BYTECODE;
+		request.rta.rta_len = RTA_LENGTH(bc_num * sizeof(struct inet_diag_bc_op));
+		request.nlhdr.nlmsg_len += RTA_ALIGN(request.rta.rta_len);
+	}
+
+	request.nlhdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.nlhdr.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+	request.r.sdiag_protocol = protocol;
+	request.r.idiag_states = states;
 
-	request.nlhdr.nlmsg_len = sizeof(request);
-	request.nlhdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ROOT | NLM_F_MATCH;
-	request.nlhdr.nlmsg_pid = 0;
-	request.nlhdr.nlmsg_seq = sequence;
-	request.nlhdr.nlmsg_type = TCPDIAG_GETSOCK;
+	s_io[0].iov_len = request.nlhdr.nlmsg_len;
 
-	memset(&request.r, 0, sizeof(request.r));
-	request.r.idiag_states = (1 << state);
+	buffer = (char *)zbx_malloc(NULL, NET_DIAG_BUFFER_SIZE);
+	r_io[0].iov_base = buffer;
 
-	if (-1 == (fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_INET_DIAG)) ||
+	if (-1 == (fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_SOCK_DIAG)) ||
 			0 != setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (char *)&timeout, sizeof(struct timeval)))
 	{
 		nlerr = NLERR_SOCKCREAT;
@@ -137,7 +243,10 @@ static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
 
 	for (int i = 0; AF_UNSPEC != families[i]; i++)
 	{
-		request.r.idiag_family = families[i];
+		int	done = 0;
+
+		request.nlhdr.nlmsg_seq = ++sequence;
+		request.r.sdiag_family = families[i];
 
 		if (-1 == sendmsg(fd, &s_msg, 0))
 		{
@@ -145,7 +254,7 @@ static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
 			goto out;
 		}
 
-		while (NLERR_OK == nlerr)
+		while (NLERR_OK == nlerr && 0 == done)
 		{
 			status = recvmsg(fd, &r_msg, 0);
 
@@ -165,15 +274,14 @@ static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
 			for (r_hdr = (struct nlmsghdr *)buffer; NLMSG_OK(r_hdr, (unsigned)status);
 					r_hdr = NLMSG_NEXT(r_hdr, status))
 			{
-				struct inet_diag_msg	*r = (struct inet_diag_msg *)NLMSG_DATA(r_hdr);
-
 				if (sequence != r_hdr->nlmsg_seq)
 					continue;
 
 				switch (r_hdr->nlmsg_type)
 				{
 					case NLMSG_DONE:
-						goto out;
+						done = 1;
+						break;
 					case NLMSG_ERROR:
 					{
 						struct nlmsgerr	*err = (struct nlmsgerr *)NLMSG_DATA(r_hdr);
@@ -190,10 +298,10 @@ static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
 
 						goto out;
 					}
-					case 0x12:
-						if (state == r->idiag_state && port == ntohs(r->id.idiag_sport))
+					case SOCK_DIAG_BY_FAMILY:
+						if (SUCCEED != process_func((struct inet_diag_msg *)NLMSG_DATA(r_hdr),
+								data))
 						{
-							*found = 1;
 							goto out;
 						}
 						break;
@@ -201,6 +309,9 @@ static int	find_tcp_port_by_state_nl(unsigned short port, int state, int *found)
 						nlerr = NLERR_UNKNOWNMSGTYPE;
 						break;
 				}
+
+				if (0 != done || NLERR_OK != nlerr)
+					break;
 			}
 		}
 	}
@@ -208,10 +319,48 @@ out:
 	if (-1 != fd)
 		close(fd);
 
+	zbx_free(buffer);
+
 	if (NLERR_OK == nlerr)
 		ret = SUCCEED;
 
 	return ret;
+#undef NET_DIAG_BUFFER_SIZE
+}
+
+static int	net_diag_process_found(const struct inet_diag_msg *msg, void *data)
+{
+	ZBX_UNUSED(msg);
+
+	*(int *)data = 1;
+
+	/* stop the query, one socket is enough */
+	return FAIL;
+}
+
+static int	net_diag_process_unconnected(const struct inet_diag_msg *msg, void *data)
+{
+	/* unconnected datagram sockets have zero remote address and port */
+	for (int i = 0; i < 4; i++)
+	{
+		if (0 != msg->id.idiag_dst[i])
+			return SUCCEED;
+	}
+
+	if (0 != msg->id.idiag_dport)
+		return SUCCEED;
+
+	*(int *)data = 1;
+
+	return FAIL;
+}
+
+static int	find_port_by_state_nl(unsigned char protocol, unsigned short port, int state, int *found)
+{
+	*found = 0;
+
+	return net_diag_query(protocol, 1 << state, port, 0, IPPROTO_TCP == protocol ? net_diag_process_found :
+			net_diag_process_unconnected, found);
 }
 #endif
 
@@ -227,7 +376,7 @@ static int	get_net_stat(const char *if_name, net_stat_t *result, char **error)
 		return SYSINFO_RET_FAIL;
 	}
 
-	if (NULL == (f = fopen("/proc/net/dev", "r")))
+	if (NULL == (f = proc_file_open("/proc/net/dev")))
 	{
 		*error = zbx_dsprintf(NULL, "Cannot open /proc/net/dev: %s", zbx_strerror(errno));
 		return SYSINFO_RET_FAIL;
@@ -572,7 +721,7 @@ int	net_if_discovery(AGENT_REQUEST *request, AGENT_RESULT *result)
 
 	ZBX_UNUSED(request);
 
-	if (NULL == (f = fopen("/proc/net/dev", "r")))
+	if (NULL == (f = proc_file_open("/proc/net/dev")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc/net/dev: %s", zbx_strerror(errno)));
 		return SYSINFO_RET_FAIL;
@@ -631,46 +780,14 @@ int	net_tcp_listen(AGENT_REQUEST *request, AGENT_RESULT *result)
 	}
 
 #ifdef HAVE_INET_DIAG
-	if (SUCCEED == find_tcp_port_by_state_nl(port, STATE_LISTEN, &found))
+	if (SUCCEED == find_port_by_state_nl(IPPROTO_TCP, port, STATE_LISTEN, &found))
 	{
 		ret = SYSINFO_RET_OK;
 		listen = found;
 	}
 	else
 	{
-		const char	*error;
-
-		switch (nlerr)
-		{
-			case NLERR_UNKNOWN:
-				error = "unrecognized netlink error occurred";
-				break;
-			case NLERR_SOCKCREAT:
-				error = "cannot create netlink socket";
-				break;
-			case NLERR_BADSEND:
-				error = "cannot send netlink message to kernel";
-				break;
-			case NLERR_BADRECV:
-				error = "cannot receive netlink message from kernel";
-				break;
-			case NLERR_RECVTIMEOUT:
-				error = "receiving netlink response timed out";
-				break;
-			case NLERR_RESPTRUNCAT:
-				error = "received truncated netlink response from kernel";
-				break;
-			case NLERR_OPNOTSUPPORTED:
-				error = "netlink operation not supported";
-				break;
-			case NLERR_UNKNOWNMSGTYPE:
-				error = "received message of unrecognized type from kernel";
-				break;
-			default:
-				error = "unknown error";
-		}
-
-		zabbix_log(LOG_LEVEL_DEBUG, "netlink interface error: %s", error);
+		zabbix_log(LOG_LEVEL_DEBUG, "netlink interface error: %s", nlerr_string());
 		zabbix_log(LOG_LEVEL_DEBUG, "falling back on reading /proc/net/tcp...");
 #endif
 		buffer = (char *)zbx_malloc(NULL, buffer_alloc);
@@ -714,6 +831,9 @@ int	net_udp_listen(AGENT_REQUEST *request, AGENT_RESULT *result)
 	unsigned short	port;
 	zbx_uint64_t	listen = 0;
 	int		ret = SYSINFO_RET_FAIL, n, buffer_alloc = 64 * ZBX_KIBIBYTE;
+#ifdef HAVE_INET_DIAG
+	int		found;
+#endif
 
 	if (1 < request->nparam)
 	{
@@ -729,6 +849,18 @@ int	net_udp_listen(AGENT_REQUEST *request, AGENT_RESULT *result)
 		return SYSINFO_RET_FAIL;
 	}
 
+#ifdef HAVE_INET_DIAG
+	/* unconnected UDP sockets are reported in TCP_CLOSE state */
+	if (SUCCEED == find_port_by_state_nl(IPPROTO_UDP, port, STATE_CLOSE, &found))
+	{
+		SET_UI64_RESULT(result, found);
+
+		return SYSINFO_RET_OK;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "netlink interface error: %s", nlerr_string());
+	zabbix_log(LOG_LEVEL_DEBUG, "falling back on reading /proc/net/udp...");
+#endif
 	buffer = (char *)zbx_malloc(NULL, buffer_alloc);
 
 	if (0 < (n = proc_read_file("/proc/net/udp", &buffer, &buffer_alloc)))
@@ -812,6 +944,81 @@ static unsigned char	get_connection_state_udp(const char *name)
 	return state;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if socket address matches expected address                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	net_count_match_addr(const net_count_info_t *exp, const ZBX_SOCKADDR *sockaddr)
+{
+	if (NULL == exp->ai)
+		return SUCCEED;
+
+	return zbx_ip_cmp(exp->prefix_sz, exp->ai, sockaddr, 1 == exp->mapped && 0 != exp->prefix_sz ? 0 : 1);
+}
+
+#ifdef HAVE_INET_DIAG
+typedef struct
+{
+	const net_count_info_t	*exp_l;
+	const net_count_info_t	*exp_r;
+	zbx_uint64_t		count;
+}
+net_diag_count_t;
+
+static void	net_diag_get_sockaddr(unsigned char family, const __be32 *addr, ZBX_SOCKADDR *sockaddr)
+{
+	memset(sockaddr, 0, sizeof(ZBX_SOCKADDR));
+
+#ifdef HAVE_IPV6
+#ifdef HAVE_SOCKADDR_STORAGE_SS_FAMILY
+	sockaddr->ss_family = family;
+#else
+	sockaddr->__ss_family = family;
+#endif
+	if (AF_INET6 == family)
+	{
+		memcpy(((struct sockaddr_in6 *)sockaddr)->sin6_addr.s6_addr, addr, 16);
+		return;
+	}
+#else
+	ZBX_UNUSED(family);
+#endif
+	((struct sockaddr_in *)sockaddr)->sin_addr.s_addr = addr[0];
+}
+
+static int	net_diag_process_count(const struct inet_diag_msg *msg, void *data)
+{
+	net_diag_count_t	*dc = (net_diag_count_t *)data;
+	ZBX_SOCKADDR		sockaddr_l, sockaddr_r;
+
+#ifndef HAVE_IPV6
+	if (AF_INET != msg->idiag_family)
+		return SUCCEED;
+#endif
+	/* ports and states are already filtered by kernel */
+	if (NULL != dc->exp_l->ai)
+	{
+		net_diag_get_sockaddr(msg->idiag_family, msg->id.idiag_src, &sockaddr_l);
+
+		if (FAIL == net_count_match_addr(dc->exp_l, &sockaddr_l))
+			return SUCCEED;
+	}
+
+	if (NULL != dc->exp_r->ai)
+	{
+		net_diag_get_sockaddr(msg->idiag_family, msg->id.idiag_dst, &sockaddr_r);
+
+		if (FAIL == net_count_match_addr(dc->exp_r, &sockaddr_r))
+			return SUCCEED;
+	}
+
+	dc->count++;
+
+	return SUCCEED;
+}
+#endif
+
 #ifdef HAVE_IPV6
 static int	scan_ipv6_addr(const char *addr, struct sockaddr_in6 *sa6)
 {
@@ -883,12 +1090,8 @@ static int	get_proc_net_count_ipv6(const char *filename, unsigned char state, ne
 		if ((0 != exp_l->port && exp_l->port != lport) ||
 				(0 != exp_r->port && exp_r->port != rport) ||
 				(0 != state && state != state_f) ||
-				(NULL != exp_l->ai &&
-				FAIL == zbx_ip_cmp(exp_l->prefix_sz, exp_l->ai, &sockaddr_l,
-				1 == exp_l->mapped && 0 != exp_l->prefix_sz ? 0 : 1)) ||
-				(NULL != exp_r->ai &&
-				FAIL == zbx_ip_cmp(exp_r->prefix_sz, exp_r->ai, &sockaddr_r,
-				1 == exp_r->mapped && 0 != exp_r->prefix_sz ? 0 : 1)))
+				FAIL == net_count_match_addr(exp_l, &sockaddr_l) ||
+				FAIL == net_count_match_addr(exp_r, &sockaddr_r))
 		{
 			continue;
 		}
@@ -943,12 +1146,8 @@ static int	get_proc_net_count_ipv4(const char *filename, unsigned char state, ne
 		if ((0 != exp_l->port && exp_l->port != lport) ||
 				(0 != exp_r->port && exp_r->port != rport) ||
 				(0 != state && state != state_f) ||
-				(NULL != exp_l->ai &&
-				FAIL == zbx_ip_cmp(exp_l->prefix_sz, exp_l->ai, &sockaddr_l,
-				1 == exp_l->mapped && 0 != exp_l->prefix_sz ? 0 : 1)) ||
-				(NULL != exp_r->ai &&
-				FAIL == zbx_ip_cmp(exp_r->prefix_sz, exp_r->ai, &sockaddr_r,
-				1 == exp_r->mapped && 0 != exp_r->prefix_sz ? 0 : 1)))
+				FAIL == net_count_match_addr(exp_l, &sockaddr_l) ||
+				FAIL == net_count_match_addr(exp_r, &sockaddr_r))
 		{
 			continue;
 		}
@@ -1070,6 +1269,9 @@ static int	net_socket_count(int conn_type, AGENT_REQUEST *request, AGENT_RESULT
 	unsigned char		state_num = 0;
 	zbx_uint64_t		count = 0;
 	struct addrinfo		hints;
+#ifdef HAVE_INET_DIAG
+	net_diag_count_t	dc;
+#endif
 
 	if (5 < request->nparam)
 	{
@@ -1123,6 +1325,23 @@ static int	net_socket_count(int conn_type, AGENT_REQUEST *request, AGENT_RESULT
 		goto err;
 	}
 
+#ifdef HAVE_INET_DIAG
+	dc.exp_l = &info_l;
+	dc.exp_r = &info_r;
+	dc.count = 0;
+
+	if (SUCCEED == net_diag_query(NET_CONN_TYPE_TCP == conn_type ? IPPROTO_TCP : IPPROTO_UDP,
+			0 == state_num ? STATE_ALL : 1 << state_num, info_l.port, info_r.port, net_diag_process_count,
+			&dc))
+	{
+		count = dc.count;
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "netlink interface error: %s", nlerr_string());
+	zabbix_log(LOG_LEVEL_DEBUG, "falling back on reading /proc/net/%s...", NET_CONN_TYPE_TCP == conn_type ?
+			"tcp" : "udp");
+#endif
 	if (SUCCEED != get_proc_net_count_ipv4(NET_CONN_TYPE_TCP == conn_type ? "/proc/net/tcp" : "/proc/net/udp",
 			state_num, &info_l, &info_r, &count, &error))
 	{
@@ -1138,7 +1357,9 @@ static int	net_socket_count(int conn_type, AGENT_REQUEST *request, AGENT_RESULT
 		goto err;
 	}
 #endif
-
+#ifdef HAVE_INET_DIAG
+out:
+#endif
 	SET_UI64_RESULT(result, count);
 
 	ret = SYSINFO_RET_OK;
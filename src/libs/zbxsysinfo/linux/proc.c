@@ -26,6 +26,7 @@
 #include "zbxalgo.h"
 
 #include <linux/version.h>
+#include <pthread.h>
 
 #define PROC_VAL_TYPE_TEXT	0
 #define PROC_VAL_TYPE_NUM	1
@@ -34,11 +35,42 @@
 #define PROC_ID_TYPE_USER	0
 #define PROC_ID_TYPE_GROUP	1
 
+/* time in seconds during which the /proc snapshot is reused by process items */
+#define PROC_SNAPSHOT_TTL	1.0
+
+/* kernel statistics files are re-read only when older than this, must be less than shortest item interval */
+#define PROC_FILE_TTL		0.5
+#define PROC_FILE_CACHE_SIZE	8
+
+/* memory values parsed from /proc/[pid]/status file */
+#define PROC_VM_SIZE	0
+#define PROC_VM_RSS	1
+#define PROC_VM_PEAK	2
+#define PROC_VM_SWAP	3
+#define PROC_VM_LIB	4
+#define PROC_VM_LCK	5
+#define PROC_VM_PIN	6
+#define PROC_VM_HWM	7
+#define PROC_VM_DATA	8
+#define PROC_VM_STK	9
+#define PROC_VM_EXE	10
+#define PROC_VM_PTE	11
+#define PROC_VM_COUNT	12
+
+static const char	*proc_vm_labels[PROC_VM_COUNT] = {"VmSize:\t", "VmRSS:\t", "VmPeak:\t", "VmSwap:\t",
+			"VmLib:\t", "VmLck:\t", "VmPin:\t", "VmHWM:\t", "VmData:\t", "VmStk:\t", "VmExe:\t",
+			"VmPTE:\t"};
+
 typedef struct
 {
 	pid_t		pid;
+
+	/* real user id from /proc/[pid]/status file */
 	uid_t		uid;
 
+	/* effective user id, the owner of /proc/[pid] directory */
+	uid_t		euid;
+
 	char		*name;
 
 	/* the process name taken from the 0th argument */
@@ -46,9 +78,50 @@ typedef struct
 
 	/* process command line in format <arg0> <arg1> ... <argN>\0 */
 	char		*cmdline;
+
+	/* process state code, see proc(5) */
+	char		state;
+
+	/* memory values and bitmasks of values found and failed to parse */
+	zbx_uint64_t	vm[PROC_VM_COUNT];
+	unsigned int	vm_found;
+	unsigned int	vm_invalid;
 }
 zbx_sysinfo_proc_t;
 
+/* processes sharing the same name or user, used to index /proc snapshot */
+typedef struct
+{
+	const char		*name;
+	zbx_vector_ptr_t	procs;
+}
+proc_index_name_t;
+
+typedef struct
+{
+	zbx_uint64_t		uid;
+	zbx_vector_ptr_t	procs;
+}
+proc_index_uid_t;
+
+/* system processes read from /proc and shared by all process items within PROC_SNAPSHOT_TTL */
+typedef struct
+{
+	zbx_vector_ptr_t	procs;
+	zbx_hashset_t		names;
+	zbx_hashset_t		uids;
+	double			timestamp;
+
+	/* buffer for reading /proc files, reused between processes */
+	char			*buf;
+	size_t			buf_alloc;
+
+	int			initialized;
+}
+proc_snapshot_t;
+
+static proc_snapshot_t	proc_snapshot;
+
 typedef struct
 {
 	unsigned int	pid;
@@ -93,20 +166,6 @@ proc_data_t;
 ZBX_PTR_VECTOR_DECL(proc_data_ptr, proc_data_t *)
 ZBX_PTR_VECTOR_IMPL(proc_data_ptr, proc_data_t *)
 
-/******************************************************************************
- *                                                                            *
- * Purpose: frees process data structure                                      *
- *                                                                            *
- ******************************************************************************/
-static void	zbx_sysinfo_proc_free(zbx_sysinfo_proc_t *proc)
-{
-	zbx_free(proc->name);
-	zbx_free(proc->name_arg0);
-	zbx_free(proc->cmdline);
-
-	zbx_free(proc);
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: frees process data structure                                      *
@@ -281,129 +340,609 @@ static int	get_cmdline(FILE *f_cmd, char **line, size_t *line_offset)
 	return FAIL;
 }
 
-static int	cmp_status(FILE *f_stat, const char *procname)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads whole /proc file into buffer                                *
+ *                                                                            *
+ * Parameters: path      - [IN]                                               *
+ *             buf       - [IN/OUT] buffer, reallocated if necessary          *
+ *             buf_alloc - [IN/OUT] allocated buffer size                     *
+ *             buf_len   - [OUT] number of bytes read                         *
+ *                                                                            *
+ * Return value: SUCCEED - file was read successfully                         *
+ *               FAIL    - failed to open or read file                        *
+ *                                                                            *
+ * Comments: The read data is always followed by terminating zero byte.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_read_file(const char *path, char **buf, size_t *buf_alloc, size_t *buf_len)
+{
+	int	fd;
+	ssize_t	n;
+
+	if (-1 == (fd = open(path, O_RDONLY)))
+		return FAIL;
+
+	*buf_len = 0;
+
+	while (0 < (n = read(fd, *buf + *buf_len, *buf_alloc - *buf_len - 1)))
+	{
+		*buf_len += (size_t)n;
+
+		if (*buf_len == *buf_alloc - 1)
+		{
+			*buf_alloc *= 2;
+			*buf = (char *)zbx_realloc(*buf, *buf_alloc);
+		}
+	}
+
+	close(fd);
+
+	if (-1 == n)
+		return FAIL;
+
+	(*buf)[*buf_len] = '\0';
+
+	return SUCCEED;
+}
+
+typedef struct
+{
+	char	*path;
+	char	*buf;
+	size_t	buf_alloc;
+	size_t	buf_len;
+	double	timestamp;
+}
+proc_file_t;
+
+/* Zabbix agent 2 runs these checks concurrently through cgo, so each thread keeps its own copies. */
+/* At most PROC_FILE_CACHE_SIZE files are kept per thread and they are freed when the thread exits. */
+static ZBX_THREAD_LOCAL proc_file_t	proc_files[PROC_FILE_CACHE_SIZE];
+static ZBX_THREAD_LOCAL int		proc_files_num;
+
+static pthread_once_t	proc_files_once = PTHREAD_ONCE_INIT;
+static pthread_key_t	proc_files_key;
+static int		proc_files_key_created = FAIL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees /proc file copies of exiting thread                         *
+ *                                                                            *
+ * Parameters: data - [IN] the thread proc_files array                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	proc_files_free(void *data)
+{
+	proc_file_t	*files = (proc_file_t *)data;
+
+	for (int i = 0; i < PROC_FILE_CACHE_SIZE && NULL != files[i].path; i++)
+	{
+		zbx_free(files[i].path);
+		zbx_free(files[i].buf);
+	}
+}
+
+static void	proc_files_key_create(void)
+{
+	if (0 == pthread_key_create(&proc_files_key, proc_files_free))
+		proc_files_key_created = SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens system wide /proc file for reading, sharing its contents    *
+ *          between all checks performed during the same collection cycle     *
+ *                                                                            *
+ * Parameters: path - [IN] file path, e.g. "/proc/meminfo"                    *
+ *                                                                            *
+ * Return value: stream for reading file contents or NULL on error (errno is  *
+ *               set), must be closed with zbx_fclose()                       *
+ *                                                                            *
+ * Comments: Files like /proc/stat or /proc/meminfo serve many items which    *
+ *           are usually checked together. Instead of opening and parsing the *
+ *           file for every item, its contents are read once and reused for   *
+ *           PROC_FILE_TTL seconds, returned stream reads from this copy.     *
+ *           The copy belongs to the calling thread and is refreshed by its   *
+ *           next call, so the stream must be closed before opening the same  *
+ *           file again.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+FILE	*proc_file_open(const char *path)
 {
-	char	tmp[MAX_STRING_LEN];
+	proc_file_t	*file = NULL;
+	double		now;
+
+	for (int i = 0; i < proc_files_num; i++)
+	{
+		if (0 == strcmp(proc_files[i].path, path))
+		{
+			file = &proc_files[i];
+			break;
+		}
+	}
+
+	if (NULL == file)
+	{
+		if (PROC_FILE_CACHE_SIZE == proc_files_num)
+			return fopen(path, "r");
+
+		/* register the copies for freeing on thread exit */
+		if (0 == proc_files_num && 0 == pthread_once(&proc_files_once, proc_files_key_create) &&
+				SUCCEED == proc_files_key_created)
+		{
+			(void)pthread_setspecific(proc_files_key, proc_files);
+		}
+
+		file = &proc_files[proc_files_num++];
+		file->path = zbx_strdup(NULL, path);
+		file->buf_alloc = 4 * ZBX_KIBIBYTE;
+		file->buf = (char *)zbx_malloc(NULL, file->buf_alloc);
+		file->buf_len = 0;
+		file->timestamp = 0;
+	}
+
+	now = zbx_time();
+
+	/* also re-read the file if system time was moved backwards */
+	if (now < file->timestamp || PROC_FILE_TTL <= now - file->timestamp)
+	{
+		FILE	*f;
+
+		if (NULL == (f = fopen(path, "r")))
+		{
+			file->timestamp = 0;
+			return NULL;
+		}
+
+		file->buf_len = 0;
 
-	rewind(f_stat);
+		while (NULL != fgets(file->buf + file->buf_len, (int)(file->buf_alloc - file->buf_len), f))
+		{
+			file->buf_len += strlen(file->buf + file->buf_len);
+
+			if (2 > file->buf_alloc - file->buf_len)
+			{
+				file->buf_alloc *= 2;
+				file->buf = (char *)zbx_realloc(file->buf, file->buf_alloc);
+			}
+		}
+
+		zbx_fclose(f);
+		file->timestamp = now;
+	}
+
+	/* empty memory stream cannot be opened */
+	if (0 == file->buf_len)
+		return fopen(path, "r");
+
+	return fmemopen(file->buf, file->buf_len, "r");
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses /proc/[pid]/status file contents                           *
+ *                                                                            *
+ * Parameters: proc - [IN/OUT] process object                                 *
+ *             buf  - [IN] status file contents, modified during parsing      *
+ *                                                                            *
+ * Return value: SUCCEED - status was parsed successfully                     *
+ *               FAIL    - process name was not found                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_parse_status(zbx_sysinfo_proc_t *proc, char *buf)
+{
+	char	*line, *next, *p_value, *p_unit;
 
-	while (NULL != fgets(tmp, (int)sizeof(tmp), f_stat))
+	for (line = buf; NULL != line && '\0' != *line; line = next)
 	{
-		if (0 != strncmp(tmp, "Name:\t", 6))
+		if (NULL != (next = strchr(line, '\n')))
+			*next++ = '\0';
+
+		if (0 == strncmp(line, "Name:\t", 6))
+		{
+			if (NULL == proc->name)
+				proc->name = zbx_strdup(NULL, line + 6);
+
 			continue;
+		}
 
-		zbx_rtrim(tmp + 6, "\n");
-		if (0 == strcmp(tmp + 6, procname))
-			return SUCCEED;
-		break;
+		if (0 == strncmp(line, "State:\t", 7))
+		{
+			proc->state = line[7];
+			continue;
+		}
+
+		if (0 == strncmp(line, "Uid:\t", 5))
+		{
+			unsigned int	uid, euid;
+
+			if (2 == sscanf(line + 5, "%u\t%u", &uid, &euid))
+			{
+				proc->uid = (uid_t)uid;
+				proc->euid = (uid_t)euid;
+			}
+
+			continue;
+		}
+
+		if (0 != strncmp(line, "Vm", 2))
+			continue;
+
+		for (int i = 0; i < PROC_VM_COUNT; i++)
+		{
+			size_t	label_len = strlen(proc_vm_labels[i]);
+
+			if (0 != strncmp(line, proc_vm_labels[i], label_len))
+				continue;
+
+			p_value = line + label_len;
+
+			if (NULL == (p_unit = strrchr(p_value, ' ')))
+			{
+				proc->vm_invalid |= 1 << i;
+				break;
+			}
+
+			*p_unit++ = '\0';
+
+			while (' ' == *p_value)
+				p_value++;
+
+			if (FAIL == zbx_is_uint64(p_value, &proc->vm[i]))
+			{
+				proc->vm_invalid |= 1 << i;
+				break;
+			}
+
+			convert_to_bytes(p_unit, &proc->vm[i]);
+			proc->vm_found |= 1 << i;
+			break;
+		}
 	}
 
-	return FAIL;
+	return NULL != proc->name ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees process data structure                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_sysinfo_proc_free(zbx_sysinfo_proc_t *proc)
+{
+	zbx_free(proc->name);
+	zbx_free(proc->name_arg0);
+	zbx_free(proc->cmdline);
+
+	zbx_free(proc);
 }
 
-static int	check_procname(FILE *f_cmd, FILE *f_stat, const char *procname)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads process command line and status                             *
+ *                                                                            *
+ * Parameters: pid       - [IN]                                               *
+ *             buf       - [IN/OUT] buffer for reading /proc files            *
+ *             buf_alloc - [IN/OUT] allocated buffer size                     *
+ *                                                                            *
+ * Return value: The created process object or NULL if the process files      *
+ *               could not be read (for example process has terminated).      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_sysinfo_proc_t	*proc_read_process(const char *pid, char **buf, size_t *buf_alloc)
 {
-	char	*tmp = NULL, *p;
-	size_t	l;
-	int	ret = SUCCEED;
+	char			path[MAX_STRING_LEN], *ptr;
+	size_t			len;
+	zbx_sysinfo_proc_t	*proc;
 
-	if (NULL == procname || '\0' == *procname)
-		return SUCCEED;
+	zbx_snprintf(path, sizeof(path), "/proc/%s/cmdline", pid);
 
-	/* process name in /proc/[pid]/status contains limited number of characters */
-	if (SUCCEED == cmp_status(f_stat, procname))
-		return SUCCEED;
+	if (SUCCEED != proc_read_file(path, buf, buf_alloc, &len))
+		return NULL;
+
+	proc = (zbx_sysinfo_proc_t *)zbx_malloc(NULL, sizeof(zbx_sysinfo_proc_t));
+	memset(proc, 0, sizeof(zbx_sysinfo_proc_t));
+	proc->uid = (uid_t)-1;
+	proc->euid = (uid_t)-1;
 
-	if (SUCCEED == get_cmdline(f_cmd, &tmp, &l))
+	if (0 != len)
 	{
-		if (NULL == (p = strrchr(tmp, '/')))
-			p = tmp;
+		if (NULL == (ptr = strrchr(*buf, '/')))
+			proc->name_arg0 = zbx_strdup(NULL, *buf);
 		else
-			p++;
+			proc->name_arg0 = zbx_strdup(NULL, ptr + 1);
 
-		if (0 == strcmp(p, procname))
-			goto clean;
+		/* according to proc(5) the arguments are separated by '\0', ignore the terminating ones */
+		if ('\0' == (*buf)[len - 1] && 0 < --len && '\0' == (*buf)[len - 1])
+			len--;
+
+		for (size_t i = 0; i < len; i++)
+		{
+			if ('\0' == (*buf)[i])
+				(*buf)[i] = ' ';
+		}
 	}
 
-	ret = FAIL;
-clean:
-	zbx_free(tmp);
+	proc->cmdline = zbx_strdup(NULL, *buf);
 
-	return ret;
+	zbx_snprintf(path, sizeof(path), "/proc/%s/status", pid);
+
+	if (SUCCEED != proc_read_file(path, buf, buf_alloc, &len) || SUCCEED != proc_parse_status(proc, *buf))
+	{
+		zbx_sysinfo_proc_free(proc);
+		return NULL;
+	}
+
+	proc->pid = (pid_t)atoi(pid);
+
+	return proc;
 }
 
-static int	check_user(FILE *f_stat, struct passwd *usrinfo)
+static void	proc_index_add_name(zbx_hashset_t *index, const char *name, zbx_sysinfo_proc_t *proc)
 {
-	zbx_uint64_t	uid;
+	proc_index_name_t	*entry, entry_local;
 
-	if (NULL == usrinfo || (SUCCEED == proc_read_id(f_stat, PROC_ID_TYPE_USER, &uid) && usrinfo->pw_uid == uid))
-		return SUCCEED;
+	entry_local.name = name;
 
-	return FAIL;
+	if (NULL == (entry = (proc_index_name_t *)zbx_hashset_search(index, &entry_local)))
+	{
+		entry = (proc_index_name_t *)zbx_hashset_insert(index, &entry_local, sizeof(entry_local));
+		zbx_vector_ptr_create(&entry->procs);
+	}
+
+	zbx_vector_ptr_append(&entry->procs, proc);
 }
 
-static int	check_proccomm(FILE *f_cmd, const zbx_regexp_t *proccomm_rxp)
+static void	proc_index_add_uid(zbx_hashset_t *index, uid_t uid, zbx_sysinfo_proc_t *proc)
+{
+	proc_index_uid_t	*entry, entry_local;
+
+	entry_local.uid = (zbx_uint64_t)uid;
+
+	if (NULL == (entry = (proc_index_uid_t *)zbx_hashset_search(index, &entry_local)))
+	{
+		entry = (proc_index_uid_t *)zbx_hashset_insert(index, &entry_local, sizeof(entry_local));
+		zbx_vector_ptr_create(&entry->procs);
+	}
+
+	zbx_vector_ptr_append(&entry->procs, proc);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes all processes from /proc snapshot                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	proc_snapshot_clear(proc_snapshot_t *snapshot)
+{
+	zbx_hashset_iter_t	iter;
+	proc_index_name_t	*name;
+	proc_index_uid_t	*uid;
+
+	zbx_hashset_iter_reset(&snapshot->names, &iter);
+	while (NULL != (name = (proc_index_name_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_destroy(&name->procs);
+	zbx_hashset_clear(&snapshot->names);
+
+	zbx_hashset_iter_reset(&snapshot->uids, &iter);
+	while (NULL != (uid = (proc_index_uid_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_destroy(&uid->procs);
+	zbx_hashset_clear(&snapshot->uids);
+
+	zbx_vector_ptr_clear_ext(&snapshot->procs, (zbx_mem_free_func_t)zbx_sysinfo_proc_free);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads system processes from /proc unless the current snapshot is  *
+ *          recent enough                                                     *
+ *                                                                            *
+ * Return value: SUCCEED - snapshot is up to date                             *
+ *               FAIL    - failed to open /proc directory, errno is set       *
+ *                                                                            *
+ * Comments: The snapshot is parsed once and shared by all process items      *
+ *           evaluated by the current process within PROC_SNAPSHOT_TTL        *
+ *           seconds, so the returned process objects must not be used after  *
+ *           the next call of this function.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_snapshot_update(void)
 {
-	char	*tmp = NULL;
-	size_t	l;
-	int	ret = SUCCEED;
+	DIR		*dir;
+	struct dirent	*entries;
+	double		now;
+	unsigned int	pid;
+
+	now = zbx_time();
 
-	if (NULL == proccomm_rxp)
+	if (0 != proc_snapshot.initialized && now >= proc_snapshot.timestamp &&
+			PROC_SNAPSHOT_TTL > now - proc_snapshot.timestamp)
+	{
 		return SUCCEED;
+	}
 
-	if (SUCCEED == get_cmdline(f_cmd, &tmp, &l))
+	if (NULL == (dir = opendir("/proc")))
+		return FAIL;
+
+	if (0 == proc_snapshot.initialized)
 	{
-		l = l - 2;
+		zbx_vector_ptr_create(&proc_snapshot.procs);
+		zbx_hashset_create(&proc_snapshot.names, 100, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+				ZBX_DEFAULT_STR_COMPARE_FUNC);
+		zbx_hashset_create(&proc_snapshot.uids, 10, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		proc_snapshot.buf_alloc = ZBX_KIBIBYTE * 4;
+		proc_snapshot.buf = (char *)zbx_malloc(NULL, proc_snapshot.buf_alloc);
+		proc_snapshot.initialized = 1;
+	}
+	else
+		proc_snapshot_clear(&proc_snapshot);
 
-		for (size_t i = 0; i < l; i++)
-			if ('\0' == tmp[i])
-				tmp[i] = ' ';
+	while (NULL != (entries = readdir(dir)))
+	{
+		zbx_sysinfo_proc_t	*proc;
 
-		if (0 == zbx_regexp_match_precompiled(tmp, proccomm_rxp))
-			goto clean;
+		/* skip entries not containing pids */
+		if (FAIL == zbx_is_uint32(entries->d_name, &pid))
+			continue;
+
+		if (NULL == (proc = proc_read_process(entries->d_name, &proc_snapshot.buf, &proc_snapshot.buf_alloc)))
+			continue;
+
+		zbx_vector_ptr_append(&proc_snapshot.procs, proc);
+
+		proc_index_add_name(&proc_snapshot.names, proc->name, proc);
+
+		if (NULL != proc->name_arg0 && 0 != strcmp(proc->name, proc->name_arg0))
+			proc_index_add_name(&proc_snapshot.names, proc->name_arg0, proc);
+
+		proc_index_add_uid(&proc_snapshot.uids, proc->uid, proc);
 	}
 
-	ret = FAIL;
-clean:
-	zbx_free(tmp);
+	closedir(dir);
 
-	return ret;
+	proc_snapshot.timestamp = now;
+
+	zabbix_log(LOG_LEVEL_TRACE, "%s() processes:%d", __func__, proc_snapshot.procs.values_num);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the smallest list of snapshot processes that can match the   *
+ *          specified process name and real user                              *
+ *                                                                            *
+ * Parameters: procname - [IN] process name, NULL - all                       *
+ *             usrinfo  - [IN] process real user, NULL - all                  *
+ *                                                                            *
+ * Return value: The list of candidate processes or NULL if no processes can  *
+ *               match.                                                       *
+ *                                                                            *
+ * Comments: The returned processes still must be checked against all         *
+ *           filters.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_vector_ptr_t	*proc_snapshot_select(const char *procname, const struct passwd *usrinfo)
+{
+	const zbx_vector_ptr_t	*procs = &proc_snapshot.procs;
+
+	if (NULL != procname)
+	{
+		proc_index_name_t	*name, name_local;
+
+		name_local.name = procname;
+
+		if (NULL == (name = (proc_index_name_t *)zbx_hashset_search(&proc_snapshot.names, &name_local)))
+			return NULL;
+
+		procs = &name->procs;
+	}
+
+	if (NULL != usrinfo)
+	{
+		proc_index_uid_t	*uid, uid_local;
+
+		uid_local.uid = (zbx_uint64_t)usrinfo->pw_uid;
+
+		if (NULL == (uid = (proc_index_uid_t *)zbx_hashset_search(&proc_snapshot.uids, &uid_local)))
+			return NULL;
+
+		if (uid->procs.values_num < procs->values_num)
+			procs = &uid->procs;
+	}
+
+	return procs;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if process name matches filter                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_match_name(const zbx_sysinfo_proc_t *proc, const char *procname)
+{
+	if (NULL == procname)
+		return SUCCEED;
+
+	if (NULL != proc->name && 0 == strcmp(procname, proc->name))
+		return SUCCEED;
+
+	if (NULL != proc->name_arg0 && 0 == strcmp(procname, proc->name_arg0))
+		return SUCCEED;
+
+	return FAIL;
 }
 
-static int	check_procstate(FILE *f_stat, int zbx_proc_stat)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if process user matches filter                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_match_user(uid_t uid, const struct passwd *usrinfo)
 {
-	char	tmp[MAX_STRING_LEN], *p;
+	if (NULL == usrinfo)
+		return SUCCEED;
 
-	if (ZBX_PROC_STAT_ALL == zbx_proc_stat)
+	if (uid == usrinfo->pw_uid)
 		return SUCCEED;
 
-	rewind(f_stat);
+	return FAIL;
+}
 
-	while (NULL != fgets(tmp, (int)sizeof(tmp), f_stat))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if process state matches filter                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_match_state(const zbx_sysinfo_proc_t *proc, int zbx_proc_stat)
+{
+	switch (zbx_proc_stat)
 	{
-		if (0 != strncmp(tmp, "State:\t", 7))
-			continue;
+		case ZBX_PROC_STAT_ALL:
+			return SUCCEED;
+		case ZBX_PROC_STAT_RUN:
+			return ('R' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_SLEEP:
+			return ('S' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_ZOMB:
+			return ('Z' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_DISK:
+			return ('D' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_TRACE:
+			return ('T' == proc->state) ? SUCCEED : FAIL;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets process memory value parsed from /proc/[pid]/status file     *
+ *                                                                            *
+ * Parameters: proc    - [IN]                                                 *
+ *             vm_type - [IN] see PROC_VM_* defines                           *
+ *             bytes   - [OUT] result in bytes                                *
+ *                                                                            *
+ * Return value: SUCCEED - value was found                                    *
+ *               NOTSUPPORTED - value was not found. For example,             *
+ *                              /proc/NNN/status files for kernel threads do  *
+ *                              not contain "VmSize:" string.                 *
+ *               FAIL - value was found but could not be parsed               *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_get_vm_value(const zbx_sysinfo_proc_t *proc, int vm_type, zbx_uint64_t *bytes)
+{
+	if (0 != (proc->vm_invalid & (1 << vm_type)))
+		return FAIL;
 
-		p = tmp + 7;
+	if (0 == (proc->vm_found & (1 << vm_type)))
+		return NOTSUPPORTED;
 
-		switch (zbx_proc_stat)
-		{
-			case ZBX_PROC_STAT_RUN:
-				return ('R' == *p) ? SUCCEED : FAIL;
-			case ZBX_PROC_STAT_SLEEP:
-				return ('S' == *p) ? SUCCEED : FAIL;
-			case ZBX_PROC_STAT_ZOMB:
-				return ('Z' == *p) ? SUCCEED : FAIL;
-			case ZBX_PROC_STAT_DISK:
-				return ('D' == *p) ? SUCCEED : FAIL;
-			case ZBX_PROC_STAT_TRACE:
-				return ('T' == *p) ? SUCCEED : FAIL;
-			default:
-				return FAIL;
-		}
-	}
+	*bytes = proc->vm[vm_type];
 
-	return FAIL;
+	return SUCCEED;
 }
 
 /******************************************************************************
@@ -659,7 +1198,7 @@ static int	get_total_memory(zbx_uint64_t *total_memory)
 	FILE	*f;
 	int	ret = FAIL;
 
-	if (NULL != (f = fopen("/proc/meminfo", "r")))
+	if (NULL != (f = proc_file_open("/proc/meminfo")))
 	{
 		ret = byte_value_from_proc_file(f, "MemTotal:", NULL, total_memory);
 		zbx_fclose(f);
@@ -685,18 +1224,15 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 #define ZBX_VMEXE	12
 #define ZBX_VMPTE	13
 
-	char		tmp[MAX_STRING_LEN], *procname, *proccomm, *param;
-	DIR		*dir;
-	struct dirent	*entries;
-	struct passwd	*usrinfo;
-	zbx_regexp_t	*proccomm_rxp = NULL;
-	FILE		*f_cmd = NULL, *f_stat = NULL;
-	zbx_uint64_t	mem_size = 0, byte_value = 0, total_memory;
-	double		pct_size = 0.0, pct_value = 0.0;
-	int		do_task, res, mem_type_code, mem_type_tried = 0, proccount = 0, invalid_user = 0,
-			invalid_read = 0, ret = SYSINFO_RET_OK;
-	char		*mem_type = NULL, *rxp_error = NULL;
-	const char	*mem_type_search = NULL;
+	char			*procname, *proccomm, *param;
+	struct passwd		*usrinfo;
+	zbx_regexp_t		*proccomm_rxp = NULL;
+	const zbx_vector_ptr_t	*procs;
+	zbx_uint64_t		mem_size = 0, byte_value = 0, total_memory;
+	double			pct_size = 0.0, pct_value = 0.0;
+	int			do_task, res, mem_type_code, vm_type, mem_type_tried = 0, proccount = 0,
+				invalid_user = 0, invalid_read = 0, ret = SYSINFO_RET_OK;
+	char			*mem_type = NULL, *rxp_error = NULL;
 
 	if (5 < request->nparam)
 	{
@@ -770,70 +1306,72 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 	if (NULL == mem_type || '\0' == *mem_type || 0 == strcmp(mem_type, "vsize"))
 	{
 		mem_type_code = ZBX_VSIZE;		/* current virtual memory size (total program size) */
-		mem_type_search = "VmSize:\t";
+		vm_type = PROC_VM_SIZE;
 	}
 	else if (0 == strcmp(mem_type, "rss"))
 	{
 		mem_type_code = ZBX_RSS;		/* current resident set size (size of memory portions) */
-		mem_type_search = "VmRSS:\t";
+		vm_type = PROC_VM_RSS;
 	}
 	else if (0 == strcmp(mem_type, "pmem"))
 	{
 		mem_type_code = ZBX_PMEM;		/* percentage of real memory used by process */
+		vm_type = PROC_VM_RSS;
 	}
 	else if (0 == strcmp(mem_type, "size"))
 	{
 		mem_type_code = ZBX_SIZE;		/* size of process (code + data + stack) */
+		vm_type = PROC_VM_DATA;
 	}
 	else if (0 == strcmp(mem_type, "peak"))
 	{
 		mem_type_code = ZBX_VMPEAK;		/* peak virtual memory size */
-		mem_type_search = "VmPeak:\t";
+		vm_type = PROC_VM_PEAK;
 	}
 	else if (0 == strcmp(mem_type, "swap"))
 	{
 		mem_type_code = ZBX_VMSWAP;		/* size of swap space used */
-		mem_type_search = "VmSwap:\t";
+		vm_type = PROC_VM_SWAP;
 	}
 	else if (0 == strcmp(mem_type, "lib"))
 	{
 		mem_type_code = ZBX_VMLIB;		/* size of shared libraries */
-		mem_type_search = "VmLib:\t";
+		vm_type = PROC_VM_LIB;
 	}
 	else if (0 == strcmp(mem_type, "lck"))
 	{
 		mem_type_code = ZBX_VMLCK;		/* size of locked memory */
-		mem_type_search = "VmLck:\t";
+		vm_type = PROC_VM_LCK;
 	}
 	else if (0 == strcmp(mem_type, "pin"))
 	{
 		mem_type_code = ZBX_VMPIN;		/* size of pinned pages, they are never swappable */
-		mem_type_search = "VmPin:\t";
+		vm_type = PROC_VM_PIN;
 	}
 	else if (0 == strcmp(mem_type, "hwm"))
 	{
 		mem_type_code = ZBX_VMHWM;		/* peak resident set size ("high water mark") */
-		mem_type_search = "VmHWM:\t";
+		vm_type = PROC_VM_HWM;
 	}
 	else if (0 == strcmp(mem_type, "data"))
 	{
 		mem_type_code = ZBX_VMDATA;		/* size of data segment */
-		mem_type_search = "VmData:\t";
+		vm_type = PROC_VM_DATA;
 	}
 	else if (0 == strcmp(mem_type, "stk"))
 	{
 		mem_type_code = ZBX_VMSTK;		/* size of stack segment */
-		mem_type_search = "VmStk:\t";
+		vm_type = PROC_VM_STK;
 	}
 	else if (0 == strcmp(mem_type, "exe"))
 	{
 		mem_type_code = ZBX_VMEXE;		/* size of text (code) segment */
-		mem_type_search = "VmExe:\t";
+		vm_type = PROC_VM_EXE;
 	}
 	else if (0 == strcmp(mem_type, "pte"))
 	{
 		mem_type_code = ZBX_VMPTE;		/* size of page table entries */
-		mem_type_search = "VmPTE:\t";
+		vm_type = PROC_VM_PTE;
 	}
 	else
 	{
@@ -863,132 +1401,66 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 		}
 	}
 
-	if (NULL == (dir = opendir("/proc")))
+	if (SUCCEED != proc_snapshot_update())
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
 		ret = SYSINFO_RET_FAIL;
 		goto clean_re;
 	}
 
-	while (NULL != (entries = readdir(dir)))
-	{
-		zbx_fclose(f_cmd);
-		zbx_fclose(f_stat);
-
-		if (0 == atoi(entries->d_name))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
-
-		if (NULL == (f_cmd = fopen(tmp, "r")))
-			continue;
+	if (NULL != procname && '\0' == *procname)
+		procname = NULL;
 
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
+	if (NULL == (procs = proc_snapshot_select(procname, usrinfo)))
+		goto out;
 
-		if (NULL == (f_stat = fopen(tmp, "r")))
-			continue;
+	for (int i = 0; i < procs->values_num; i++)
+	{
+		const zbx_sysinfo_proc_t	*proc = (const zbx_sysinfo_proc_t *)procs->values[i];
 
-		if (FAIL == check_procname(f_cmd, f_stat, procname))
+		if (FAIL == proc_match_name(proc, procname))
 			continue;
 
-		if (FAIL == check_user(f_stat, usrinfo))
+		if (FAIL == proc_match_user(proc->uid, usrinfo))
 			continue;
 
-		if (FAIL == check_proccomm(f_cmd, proccomm_rxp))
+		if (NULL != proccomm_rxp && 0 != zbx_regexp_match_precompiled(proc->cmdline, proccomm_rxp))
 			continue;
 
-		rewind(f_stat);
-
 		if (0 == mem_type_tried)
 			mem_type_tried = 1;
 
-		switch (mem_type_code)
+		if (ZBX_SIZE == mem_type_code)
 		{
-			case ZBX_VSIZE:
-			case ZBX_RSS:
-			case ZBX_VMPEAK:
-			case ZBX_VMSWAP:
-			case ZBX_VMLIB:
-			case ZBX_VMLCK:
-			case ZBX_VMPIN:
-			case ZBX_VMHWM:
-			case ZBX_VMDATA:
-			case ZBX_VMSTK:
-			case ZBX_VMEXE:
-			case ZBX_VMPTE:
-				res = byte_value_from_proc_file(f_stat, mem_type_search, NULL, &byte_value);
-
-				if (NOTSUPPORTED == res)
-					continue;
-
-				if (FAIL == res)
-				{
-					invalid_read = 1;
-					goto clean;
-				}
-				break;
-			case ZBX_SIZE:
-				{
-					zbx_uint64_t	m;
+			zbx_uint64_t	m;
 
-					/* VmData, VmStk and VmExe follow in /proc/PID/status file in that order. */
-					/* Therefore we do not rewind f_stat between calls. */
+			vm_type = PROC_VM_DATA;
 
-					mem_type_search = "VmData:\t";
+			if (SUCCEED == (res = proc_get_vm_value(proc, vm_type, &byte_value)))
+			{
+				vm_type = PROC_VM_STK;
 
-					if (SUCCEED == (res = byte_value_from_proc_file(f_stat, mem_type_search, NULL,
-							&byte_value)))
-					{
-						mem_type_search = "VmStk:\t";
-
-						if (SUCCEED == (res = byte_value_from_proc_file(f_stat, mem_type_search,
-								NULL, &m)))
-						{
-							byte_value += m;
-							mem_type_search = "VmExe:\t";
-
-							if (SUCCEED == (res = byte_value_from_proc_file(f_stat,
-									mem_type_search, NULL, &m)))
-							{
-								byte_value += m;
-							}
-						}
-					}
+				if (SUCCEED == (res = proc_get_vm_value(proc, vm_type, &m)))
+				{
+					byte_value += m;
+					vm_type = PROC_VM_EXE;
 
-					if (SUCCEED != res)
-					{
-						if (NOTSUPPORTED == res)
-						{
-							/* NOTSUPPORTED - at least one of data strings not found in */
-							/* the /proc/PID/status file */
-							continue;
-						}
-						else	/* FAIL */
-						{
-							invalid_read = 1;
-							goto clean;
-						}
-					}
+					if (SUCCEED == (res = proc_get_vm_value(proc, vm_type, &m)))
+						byte_value += m;
 				}
-				break;
-			case ZBX_PMEM:
-				mem_type_search = "VmRSS:\t";
-				res = byte_value_from_proc_file(f_stat, mem_type_search, NULL, &byte_value);
+			}
+		}
+		else
+			res = proc_get_vm_value(proc, vm_type, &byte_value);
 
-				if (SUCCEED == res)
-				{
-					pct_value = ((double)byte_value / (double)total_memory) * 100.0;
-				}
-				else if (NOTSUPPORTED == res)
-				{
-					continue;
-				}
-				else	/* FAIL */
-				{
-					invalid_read = 1;
-					goto clean;
-				}
-				break;
+		/* NOTSUPPORTED - at least one of data strings not found in the /proc/PID/status file */
+		if (NOTSUPPORTED == res)
+			continue;
+
+		if (FAIL == res)
+		{
+			invalid_read = 1;
+			break;
 		}
 
 		if (ZBX_PMEM != mem_type_code)
@@ -1007,6 +1479,8 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 		}
 		else
 		{
+			pct_value = ((double)byte_value / (double)total_memory) * 100.0;
+
 			if (0 != proccount++)
 			{
 				if (ZBX_DO_MAX == do_task)
@@ -1020,16 +1494,12 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 				pct_size = pct_value;
 		}
 	}
-clean:
-	zbx_fclose(f_cmd);
-	zbx_fclose(f_stat);
-	closedir(dir);
 
 	if ((0 == proccount && 0 != mem_type_tried) || 0 != invalid_read)
 	{
 		char	*s;
 
-		s = zbx_strdup(NULL, mem_type_search);
+		s = zbx_strdup(NULL, proc_vm_labels[vm_type]);
 		zbx_rtrim(s, ":\t");
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot get amount of \"%s\" memory.", s));
 		zbx_free(s);
@@ -1074,13 +1544,11 @@ clean_re:
 
 int	proc_num(AGENT_REQUEST *request, AGENT_RESULT *result)
 {
-	char		tmp[MAX_STRING_LEN], *procname, *proccomm, *param, *rxp_error = NULL;
-	DIR		*dir;
-	struct dirent	*entries;
-	struct passwd	*usrinfo;
-	zbx_regexp_t	*proccomm_rxp = NULL;
-	FILE		*f_cmd = NULL, *f_stat = NULL;
-	int		proccount = 0, invalid_user = 0, zbx_proc_stat, ret = SYSINFO_RET_OK;
+	char			*procname, *proccomm, *param, *rxp_error = NULL;
+	struct passwd		*usrinfo;
+	zbx_regexp_t		*proccomm_rxp = NULL;
+	const zbx_vector_ptr_t	*procs;
+	int			proccount = 0, invalid_user = 0, zbx_proc_stat, ret = SYSINFO_RET_OK;
 
 	if (4 < request->nparam)
 	{
@@ -1151,48 +1619,37 @@ int	proc_num(AGENT_REQUEST *request, AGENT_RESULT *result)
 	if (1 == invalid_user)	/* handle 0 for non-existent user after all parameters have been parsed and validated */
 		goto out;
 
-	if (NULL == (dir = opendir("/proc")))
+	if (SUCCEED != proc_snapshot_update())
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
 		ret = SYSINFO_RET_FAIL;
 		goto clean;
 	}
 
-	while (NULL != (entries = readdir(dir)))
-	{
-		zbx_fclose(f_cmd);
-		zbx_fclose(f_stat);
-
-		if (0 == atoi(entries->d_name))
-			continue;
-
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
-
-		if (NULL == (f_cmd = fopen(tmp, "r")))
-			continue;
+	if (NULL != procname && '\0' == *procname)
+		procname = NULL;
 
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
+	if (NULL == (procs = proc_snapshot_select(procname, usrinfo)))
+		goto out;
 
-		if (NULL == (f_stat = fopen(tmp, "r")))
-			continue;
+	for (int i = 0; i < procs->values_num; i++)
+	{
+		const zbx_sysinfo_proc_t	*proc = (const zbx_sysinfo_proc_t *)procs->values[i];
 
-		if (FAIL == check_procname(f_cmd, f_stat, procname))
+		if (FAIL == proc_match_name(proc, procname))
 			continue;
 
-		if (FAIL == check_user(f_stat, usrinfo))
+		if (FAIL == proc_match_user(proc->uid, usrinfo))
 			continue;
 
-		if (FAIL == check_proccomm(f_cmd, proccomm_rxp))
+		if (NULL != proccomm_rxp && 0 != zbx_regexp_match_precompiled(proc->cmdline, proccomm_rxp))
 			continue;
 
-		if (FAIL == check_procstate(f_stat, zbx_proc_stat))
+		if (FAIL == proc_match_state(proc, zbx_proc_stat))
 			continue;
 
 		proccount++;
 	}
-	zbx_fclose(f_cmd);
-	zbx_fclose(f_stat);
-	closedir(dir);
 out:
 	SET_UI64_RESULT(result, proccount);
 clean:
@@ -1202,140 +1659,6 @@ clean:
 	return ret;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: returns process name                                              *
- *                                                                            *
- * Parameters: pid -      [IN]                                                *
- *             procname - [OUT]                                               *
- *                                                                            *
- * Return value: SUCCEED                                                      *
- *               FAIL                                                         *
- *                                                                            *
- * Comments: The process name is allocated by this function and must be freed *
- *           by the caller.                                                   *
- *                                                                            *
- ******************************************************************************/
-static int	proc_get_process_name(pid_t pid, char **procname)
-{
-	int	n, fd;
-	char	tmp[MAX_STRING_LEN], *pend, *pstart;
-
-	zbx_snprintf(tmp, sizeof(tmp), "/proc/%d/stat", (int)pid);
-
-	if (-1 == (fd = open(tmp, O_RDONLY)))
-		return FAIL;
-
-	n = read(fd, tmp, sizeof(tmp));
-	close(fd);
-
-	if (-1 == n)
-		return FAIL;
-
-	for (pend = tmp + n - 1; ')' != *pend && pend > tmp; pend--)
-		;
-
-	*pend = '\0';
-
-	if (NULL == (pstart = strchr(tmp, '(')))
-		return FAIL;
-
-	*procname = zbx_strdup(NULL, pstart + 1);
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: returns process command line                                      *
- *                                                                            *
- * Parameters: pid            - [IN]                                          *
- *             cmdline        - [OUT] process command line                    *
- *             cmdline_nbytes - [OUT] number of bytes in command line         *
- *                                                                            *
- * Return value: SUCCEED                                                      *
- *               FAIL                                                         *
- *                                                                            *
- * Comments: The command line is allocated by this function and must be freed *
- *           by the caller.                                                   *
- *                                                                            *
- ******************************************************************************/
-static int	proc_get_process_cmdline(pid_t pid, char **cmdline, size_t *cmdline_nbytes)
-{
-	char	tmp[MAX_STRING_LEN];
-	int	fd, n;
-	size_t	cmdline_alloc = ZBX_KIBIBYTE;
-
-	*cmdline_nbytes = 0;
-	zbx_snprintf(tmp, sizeof(tmp), "/proc/%d/cmdline", (int)pid);
-
-	if (-1 == (fd = open(tmp, O_RDONLY)))
-		return FAIL;
-
-	*cmdline = (char *)zbx_malloc(NULL, cmdline_alloc);
-
-	while (0 < (n = read(fd, *cmdline + *cmdline_nbytes, cmdline_alloc - *cmdline_nbytes)))
-	{
-		*cmdline_nbytes += n;
-
-		if (*cmdline_nbytes == cmdline_alloc)
-		{
-			cmdline_alloc *= 2;
-			*cmdline = (char *)zbx_realloc(*cmdline, cmdline_alloc);
-		}
-	}
-
-	close(fd);
-
-	if (0 < *cmdline_nbytes)
-	{
-		/* add terminating NUL if it is missing due to processes setting their titles or other reasons */
-		if ('\0' != (*cmdline)[*cmdline_nbytes - 1])
-		{
-			if (*cmdline_nbytes == cmdline_alloc)
-			{
-				cmdline_alloc += 1;
-				*cmdline = (char *)zbx_realloc(*cmdline, cmdline_alloc);
-			}
-
-			(*cmdline)[*cmdline_nbytes] = '\0';
-			*cmdline_nbytes += 1;
-		}
-	}
-	else
-	{
-		zbx_free(*cmdline);
-	}
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: returns process user identifier                                   *
- *                                                                            *
- * Parameters: pid - [IN]                                                     *
- *             uid - [OUT]                                                    *
- *                                                                            *
- * Return value: SUCCEED                                                      *
- *               FAIL                                                         *
- *                                                                            *
- ******************************************************************************/
-static int	proc_get_process_uid(pid_t pid, uid_t *uid)
-{
-	char		tmp[MAX_STRING_LEN];
-	zbx_stat_t	st;
-
-	zbx_snprintf(tmp, sizeof(tmp), "/proc/%d", (int)pid);
-
-	if (0 != zbx_stat(tmp, &st))
-		return FAIL;
-
-	*uid = st.st_uid;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: Reads 64 bit unsigned space or zero character terminated integer  *
@@ -1444,57 +1767,6 @@ out:
 	return ret;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: checks if process name matches filter                             *
- *                                                                            *
- ******************************************************************************/
-static int	proc_match_name(const zbx_sysinfo_proc_t *proc, const char *procname)
-{
-	if (NULL == procname)
-		return SUCCEED;
-
-	if (NULL != proc->name && 0 == strcmp(procname, proc->name))
-		return SUCCEED;
-
-	if (NULL != proc->name_arg0 && 0 == strcmp(procname, proc->name_arg0))
-		return SUCCEED;
-
-	return FAIL;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: checks if process user matches filter                             *
- *                                                                            *
- ******************************************************************************/
-static int	proc_match_user(const zbx_sysinfo_proc_t *proc, const struct passwd *usrinfo)
-{
-	if (NULL == usrinfo)
-		return SUCCEED;
-
-	if (proc->uid == usrinfo->pw_uid)
-		return SUCCEED;
-
-	return FAIL;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: checks if process command line matches filter                     *
- *                                                                            *
- ******************************************************************************/
-static int	proc_match_cmdline(const zbx_sysinfo_proc_t *proc, const char *cmdline)
-{
-	if (NULL == cmdline)
-		return SUCCEED;
-
-	if (NULL != proc->cmdline && NULL != zbx_regexp_match(proc->cmdline, cmdline, NULL))
-		return SUCCEED;
-
-	return FAIL;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: gets process cpu utilization data                                 *
@@ -1513,78 +1785,6 @@ void	zbx_proc_get_process_stats(zbx_procstat_util_t *procs, int procs_num)
 	zabbix_log(LOG_LEVEL_TRACE, "End of %s()", __func__);
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: creates process object with specified properties                  *
- *                                                                            *
- * Parameters: pid   - [IN]                                                   *
- *             flags - [IN] flags specifying properties to set                *
- *                                                                            *
- * Return value: The created process object or NULL if property reading       *
- *               failed.                                                      *
- *                                                                            *
- ******************************************************************************/
-static zbx_sysinfo_proc_t	*proc_create(int pid, unsigned int flags)
-{
-	char			*procname = NULL, *cmdline = NULL, *name_arg0 = NULL;
-	uid_t			uid = (uid_t)-1;
-	zbx_sysinfo_proc_t	*proc = NULL;
-	int			ret = FAIL;
-	size_t			cmdline_nbytes;
-
-	if (0 != (flags & ZBX_SYSINFO_PROC_USER) && SUCCEED != proc_get_process_uid(pid, &uid))
-		goto out;
-
-	if (0 != (flags & (ZBX_SYSINFO_PROC_CMDLINE | ZBX_SYSINFO_PROC_NAME)) &&
-			SUCCEED != proc_get_process_cmdline(pid, &cmdline, &cmdline_nbytes))
-	{
-		goto out;
-	}
-
-	if (0 != (flags & ZBX_SYSINFO_PROC_NAME) && SUCCEED != proc_get_process_name(pid, &procname))
-		goto out;
-
-	if (NULL != cmdline)
-	{
-		char		*ptr;
-		unsigned int	i;
-
-		if (0 != (flags & ZBX_SYSINFO_PROC_NAME))
-		{
-			if (NULL == (ptr = strrchr(cmdline, '/')))
-				name_arg0 = zbx_strdup(NULL, cmdline);
-			else
-				name_arg0 = zbx_strdup(NULL, ptr + 1);
-		}
-
-		/* according to proc(5) the arguments are separated by '\0' */
-		for (i = 0; i < cmdline_nbytes - 1; i++)
-			if ('\0' == cmdline[i])
-				cmdline[i] = ' ';
-	}
-
-	ret = SUCCEED;
-out:
-	if (SUCCEED == ret)
-	{
-		proc = (zbx_sysinfo_proc_t *)zbx_malloc(NULL, sizeof(zbx_sysinfo_proc_t));
-
-		proc->pid = pid;
-		proc->uid = uid;
-		proc->name = procname;
-		proc->cmdline = cmdline;
-		proc->name_arg0 = name_arg0;
-	}
-	else
-	{
-		zbx_free(procname);
-		zbx_free(cmdline);
-		zbx_free(name_arg0);
-	}
-
-	return proc;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: gets system processes                                             *
@@ -1596,32 +1796,22 @@ out:
  * Return value: SUCCEED - system processes were retrieved successfully       *
  *               FAIL    - failed to open /proc directory                     *
  *                                                                            *
+ * Comments: The returned processes belong to the shared /proc snapshot which *
+ *           always contains all process properties.                          *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_proc_get_processes(zbx_vector_ptr_t *processes, unsigned int flags)
 {
-	DIR			*dir;
-	struct dirent		*entries;
-	int			ret = FAIL, pid;
-	zbx_sysinfo_proc_t	*proc;
+	int	ret = FAIL;
+
+	ZBX_UNUSED(flags);
 
 	zabbix_log(LOG_LEVEL_TRACE, "In %s()", __func__);
 
-	if (NULL == (dir = opendir("/proc")))
+	if (SUCCEED != proc_snapshot_update())
 		goto out;
 
-	while (NULL != (entries = readdir(dir)))
-	{
-		/* skip entries not containing pids */
-		if (FAIL == zbx_is_uint32(entries->d_name, &pid))
-			continue;
-
-		if (NULL == (proc = proc_create(pid, flags)))
-			continue;
-
-		zbx_vector_ptr_append(processes, proc);
-	}
-
-	closedir(dir);
+	zbx_vector_ptr_append_array(processes, proc_snapshot.procs.values, proc_snapshot.procs.values_num);
 
 	ret = SUCCEED;
 out:
@@ -1637,10 +1827,12 @@ out:
  *                                                                            *
  * Parameters: processes - [IN/OUT] process vector to free                    *
  *                                                                            *
+ * Comments: The process objects are owned by /proc snapshot.                 *
+ *                                                                            *
  ******************************************************************************/
 void	zbx_proc_free_processes(zbx_vector_ptr_t *processes)
 {
-	zbx_vector_ptr_clear_ext(processes, (zbx_mem_free_func_t)zbx_sysinfo_proc_free);
+	zbx_vector_ptr_clear(processes);
 }
 
 /******************************************************************************
@@ -1648,7 +1840,8 @@ void	zbx_proc_free_processes(zbx_vector_ptr_t *processes)
  * Purpose: gets pids matching specified process name, user name and          *
  *          command line                                                      *
  *                                                                            *
- * Parameters: processes   - [IN] list of system processes                    *
+ * Parameters: processes   - [IN] list of system processes returned by        *
+ *                                zbx_proc_get_processes()                    *
  *             procname    - [IN] NULL - all                                  *
  *             username    - [IN] ...                                         *
  *             cmdline     - [IN] ...                                         *
@@ -1680,14 +1873,17 @@ void	zbx_proc_get_matching_pids(const zbx_vector_ptr_t *processes, const char *p
 	{
 		proc = (zbx_sysinfo_proc_t *)processes->values[i];
 
-		if (SUCCEED != proc_match_user(proc, usrinfo))
+		if (SUCCEED != proc_match_user(proc->euid, usrinfo))
 			continue;
 
 		if (SUCCEED != proc_match_name(proc, procname))
 			continue;
 
-		if (SUCCEED != proc_match_cmdline(proc, cmdline))
+		if (NULL != cmdline && ('\0' == *proc->cmdline || NULL == zbx_regexp_match(proc->cmdline, cmdline,
+				NULL)))
+		{
 			continue;
+		}
 
 		zbx_vector_uint64_append(pids, (zbx_uint64_t)proc->pid);
 	}
@@ -17,6 +17,7 @@
 
 #include "zbxtypes.h"
 
+FILE	*proc_file_open(const char *path);
 int	byte_value_from_proc_file(FILE *f, const char *label, const char *guard, zbx_uint64_t *bytes);
 
 #endif
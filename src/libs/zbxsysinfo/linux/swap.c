@@ -13,6 +13,7 @@
 **/
 
 #include "../sysinfo.h"
+#include "proc.h"
 
 #include <linux/sysinfo.h>
 #include <sys/sysinfo.h>
@@ -165,9 +166,9 @@ static int	get_swap_pages(swap_stat_t *result)
 	FILE	*f;
 
 #ifdef KERNEL_2_4
-	if (NULL != (f = fopen("/proc/stat", "r")))
+	if (NULL != (f = proc_file_open("/proc/stat")))
 #else
-	if (NULL != (f = fopen("/proc/vmstat", "r")))
+	if (NULL != (f = proc_file_open("/proc/vmstat")))
 #endif
 	{
 		while (NULL != fgets(line, sizeof(line), f))
@@ -434,6 +434,49 @@ out:
 #undef ZBX_KEY_EVENTLOG
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds preprocessing steps that can be executed by agent to active  *
+ *          check configuration                                               *
+ *                                                                            *
+ * Parameters: json      - [IN/OUT] active check configuration                *
+ *             item      - [IN] active check item                             *
+ *             steps     - [IN/OUT] item preprocessing steps                  *
+ *             um_handle - [IN] user macro cache handle                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	add_preprocessing_pushdown(struct zbx_json *json, const zbx_dc_item_t *item,
+		zbx_vector_pp_step_ptr_t *steps, const zbx_dc_um_handle_t *um_handle)
+{
+	if (ITEM_VALUE_TYPE_LOG == item->value_type)
+		return;
+
+	zbx_pp_pushdown_select(steps);
+
+	if (0 == steps->values_num)
+		return;
+
+	zbx_json_adduint64(json, ZBX_PROTO_TAG_VALUE_TYPE, item->value_type);
+	zbx_json_addarray(json, ZBX_PROTO_TAG_PREPROCESSING);
+
+	for (int i = 0; i < steps->values_num; i++)
+	{
+		char	*params;
+
+		params = zbx_strdup(NULL, steps->values[i]->params);
+		(void)zbx_dc_expand_user_and_func_macros(um_handle, &params, &item->host.hostid, 1, NULL);
+
+		zbx_json_addobject(json, NULL);
+		zbx_json_addint64(json, ZBX_PROTO_TAG_TYPE, steps->values[i]->type);
+		zbx_json_addstring(json, ZBX_PROTO_TAG_PARAMS, params, ZBX_JSON_TYPE_STRING);
+		zbx_json_close(json);
+
+		zbx_free(params);
+	}
+
+	zbx_json_close(json);
+}
+
 /********************************************************************************
  *                                                                              *
  * Purpose: sends list of active checks to host                                 *
@@ -575,15 +618,27 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, zbx_json_parse_t *jp,
 
 	if (0 != num)
 	{
-		zbx_dc_item_t		*dc_items;
-		int			*errcodes, delay;
-		zbx_dc_um_handle_t	*um_handle;
-		char			*timeout = NULL;
+		zbx_dc_item_t			*dc_items;
+		int				*errcodes, delay;
+		zbx_dc_um_handle_t		*um_handle;
+		char				*timeout = NULL;
+		zbx_vector_pp_step_ptr_t	*steps = NULL;
 
 		dc_items = (zbx_dc_item_t *)zbx_malloc(NULL, sizeof(zbx_dc_item_t) * num);
 		errcodes = (int *)zbx_malloc(NULL, sizeof(int) * num);
 		zbx_dc_config_get_active_items_by_hostid(dc_items, hostid, errcodes, num);
 
+		/* agents since 7.2 can execute preprocessing steps discarding throttled values */
+		if (ZBX_COMPONENT_VERSION(7, 2, 0) <= version)
+		{
+			steps = (zbx_vector_pp_step_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_pp_step_ptr_t) * num);
+
+			for (int i = 0; i < num; i++)
+				zbx_vector_pp_step_ptr_create(&steps[i]);
+
+			zbx_dc_config_get_items_preproc_steps(dc_items, errcodes, steps, num);
+		}
+
 		um_handle = zbx_dc_open_user_macros();
 
 		for (int i = 0; i < num; i++)
@@ -652,6 +707,9 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, zbx_json_parse_t *jp,
 
 			zbx_json_addstring(&json, ZBX_PROTO_TAG_TIMEOUT, timeout, ZBX_JSON_TYPE_STRING);
 
+			if (NULL != steps)
+				add_preprocessing_pushdown(&json, &dc_items[i], &steps[i], um_handle);
+
 			zbx_json_close(&json);
 
 			zbx_itemkey_extract_global_regexps(dc_items[i].key, &names);
@@ -662,6 +720,17 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, zbx_json_parse_t *jp,
 
 		zbx_dc_config_clean_items(dc_items, errcodes, num);
 
+		if (NULL != steps)
+		{
+			for (int i = 0; i < num; i++)
+			{
+				zbx_vector_pp_step_ptr_clear_ext(&steps[i], zbx_pp_step_free);
+				zbx_vector_pp_step_ptr_destroy(&steps[i]);
+			}
+
+			zbx_free(steps);
+		}
+
 		zbx_free(errcodes);
 		zbx_free(dc_items);
 
@@ -75,6 +75,13 @@ typedef struct
 	int			pcount;
 	int			lastsent;
 	int			first_error;
+	/* backpressure statistics */
+	zbx_uint64_t		sent_values;	/* values successfully uploaded */
+	zbx_uint64_t		dropped_values;	/* values discarded because buffer was full */
+	zbx_uint64_t		failed_uploads;	/* unsuccessful upload attempts */
+	zbx_uint64_t		early_flushes;	/* uploads started before BufferSend because of high value rate */
+	int			dropped_unreported;	/* values dropped since last warning */
+	int			compress_size;	/* minimum size of upload to compress, 0 - do not compress */
 }
 active_buffer_t;
 
@@ -120,7 +127,7 @@ static void	send_back_unsupported_item(zbx_uint64_t itemid, const char *key, cha
 		zbx_vector_addr_ptr_t *addrs, const zbx_config_tls_t *config_tls, int config_timeout,
 		const char *config_source_ip, int config_buffer_send, int config_buffer_size);
 
-static void	init_active_metrics(int config_buffer_size)
+static void	init_active_metrics(int config_buffer_size, int config_buffer_compress_size)
 {
 	size_t	sz;
 
@@ -138,6 +145,8 @@ static void	init_active_metrics(int config_buffer_size)
 		buffer.first_error = 0;
 	}
 
+	buffer.compress_size = config_buffer_compress_size;
+
 	zbx_vector_command_result_ptr_create(&command_results);
 	zbx_vector_active_metrics_ptr_create(&active_metrics);
 	zbx_vector_active_command_ptr_create(&active_commands);
@@ -161,6 +170,9 @@ static void	free_active_metric(zbx_active_metric_t *metric)
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 	zbx_free(metric->persistent_file_name);
 #endif
+	if (NULL != metric->pushdown)
+		zbx_pp_pushdown_free(metric->pushdown);
+
 	zbx_free(metric);
 }
 
@@ -249,8 +261,34 @@ static int	get_min_nextcheck(void)
 	return min;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates preprocessing steps pushed down by server                 *
+ *                                                                            *
+ * Parameters: metric     - [IN/OUT]                                          *
+ *             value_type - [IN] item value type                              *
+ *             steps      - [IN/OUT] preprocessing steps, moved to metric     *
+ *                                   if changed                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	update_pushdown(zbx_active_metric_t *metric, unsigned char value_type, zbx_vector_pp_step_ptr_t *steps)
+{
+	if (NULL != metric->pushdown)
+	{
+		/* keep throttling history if the steps have not changed */
+		if (SUCCEED == zbx_pp_pushdown_compare(metric->pushdown, value_type, steps))
+			return;
+
+		zbx_pp_pushdown_free(metric->pushdown);
+		metric->pushdown = NULL;
+	}
+
+	if (0 != steps->values_num)
+		metric->pushdown = zbx_pp_pushdown_create(value_type, steps);
+}
+
 static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, zbx_uint64_t lastlogsize, int mtime,
-		int timeout)
+		int timeout, unsigned char value_type, zbx_vector_pp_step_ptr_t *steps)
 {
 	zbx_active_metric_t	*metric;
 
@@ -281,6 +319,9 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 			metric->logfiles_num = 0;
 			metric->start_time = 0.0;
 			metric->processed_bytes = 0;
+
+			if (NULL != metric->pushdown)
+				zbx_pp_pushdown_reset(metric->pushdown);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 			if (NULL != metric->persistent_file_name)
 			{
@@ -318,6 +359,7 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 		}
 
 		metric->timeout = timeout;
+		update_pushdown(metric, value_type, steps);
 
 		goto out;
 	}
@@ -364,6 +406,8 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 	metric->start_time = 0.0;
 	metric->processed_bytes = 0;
 	metric->persistent_file_name = NULL;	/* initialized but not used on Microsoft Windows */
+	metric->pushdown = NULL;
+	update_pushdown(metric, value_type, steps);
 
 	zbx_vector_active_metrics_ptr_append(&active_metrics, metric);
 out:
@@ -414,6 +458,65 @@ static void	add_command(const char *key, zbx_uint64_t id)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses preprocessing steps pushed down by server                  *
+ *                                                                            *
+ * Parameters: jp_row     - [IN] active check configuration                   *
+ *             value_type - [OUT] item value type                             *
+ *             steps      - [OUT] preprocessing steps                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	parse_pushdown(const struct zbx_json_parse *jp_row, unsigned char *value_type,
+		zbx_vector_pp_step_ptr_t *steps)
+{
+	struct zbx_json_parse	jp_steps, jp_step;
+	const char		*p = NULL;
+	char			tmp[MAX_STRING_LEN];
+	int			type;
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp_row, ZBX_PROTO_TAG_PREPROCESSING, &jp_steps))
+		return;
+
+	if (SUCCEED != zbx_json_value_by_name(jp_row, ZBX_PROTO_TAG_VALUE_TYPE, tmp, sizeof(tmp), NULL) ||
+			SUCCEED != zbx_is_uint31(tmp, &type) || ITEM_VALUE_TYPE_NONE <= type)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve value of tag \"%s\"", ZBX_PROTO_TAG_VALUE_TYPE);
+		return;
+	}
+
+	*value_type = (unsigned char)type;
+
+	while (NULL != (p = zbx_json_next(&jp_steps, p)))
+	{
+		zbx_pp_step_t	*step;
+		char		*params = NULL;
+		size_t		params_alloc = 0;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_step) ||
+				SUCCEED != zbx_json_value_by_name(&jp_step, ZBX_PROTO_TAG_TYPE, tmp, sizeof(tmp), NULL) ||
+				SUCCEED != zbx_is_uint31(tmp, &type) ||
+				SUCCEED != zbx_json_value_by_name_dyn(&jp_step, ZBX_PROTO_TAG_PARAMS, &params,
+						&params_alloc, NULL))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot parse preprocessing steps: %s", zbx_json_strerror());
+			zbx_free(params);
+			zbx_vector_pp_step_ptr_clear_ext(steps, zbx_pp_step_free);
+			return;
+		}
+
+		step = (zbx_pp_step_t *)zbx_malloc(NULL, sizeof(zbx_pp_step_t));
+		step->type = type;
+		step->error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+		step->params = params;
+		step->error_handler_params = zbx_strdup(NULL, "");
+		zbx_vector_pp_step_ptr_append(steps, step);
+	}
+
+	/* ignore steps not supported by this agent version */
+	zbx_pp_pushdown_select(steps);
+}
+
 /********************************************************************************
  *                                                                              *
  * Purpose: parses list of active checks received from server                   *
@@ -438,20 +541,23 @@ static void	parse_list_of_checks(char *str, const char *host, unsigned short por
 		zbx_vector_addr_ptr_t *addrs, const zbx_config_tls_t *config_tls, const char *config_source_ip,
 		int config_buffer_send, int config_buffer_size)
 {
-	const char		*p;
-	size_t			name_alloc = 0, delay_alloc = 0;
-	char			*name = NULL, *delay = NULL, expression[MAX_STRING_LEN], tmp[MAX_STRING_LEN] = {0},
-				exp_delimiter, error[MAX_STRING_LEN];
-	zbx_uint64_t		lastlogsize, itemid;
-	struct zbx_json_parse	jp, jp_data, jp_row;
-	zbx_active_metric_t	*metric;
-	zbx_vector_uint64_t	received_itemids;
-	int			mtime, expression_type, case_sensitive, timeout, i;
-	zbx_uint32_t		config_revision;
+	const char			*p;
+	size_t				name_alloc = 0, delay_alloc = 0;
+	char				*name = NULL, *delay = NULL, expression[MAX_STRING_LEN],
+					tmp[MAX_STRING_LEN] = {0}, exp_delimiter, error[MAX_STRING_LEN];
+	zbx_uint64_t			lastlogsize, itemid;
+	struct zbx_json_parse		jp, jp_data, jp_row;
+	zbx_active_metric_t		*metric;
+	zbx_vector_uint64_t		received_itemids;
+	int				mtime, expression_type, case_sensitive, timeout, i;
+	zbx_uint32_t			config_revision;
+	zbx_vector_pp_step_ptr_t	steps;
+	unsigned char			value_type = ITEM_VALUE_TYPE_TEXT;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	zbx_vector_uint64_create(&received_itemids);
+	zbx_vector_pp_step_ptr_create(&steps);
 
 	if (SUCCEED != zbx_json_open(str, &jp))
 	{
@@ -579,7 +685,9 @@ static void	parse_list_of_checks(char *str, const char *host, unsigned short por
 			continue;
 		}
 
-		add_check(zbx_alias_get(name), itemid, delay, lastlogsize, mtime, timeout);
+		parse_pushdown(&jp_row, &value_type, &steps);
+		add_check(zbx_alias_get(name), itemid, delay, lastlogsize, mtime, timeout, value_type, &steps);
+		zbx_vector_pp_step_ptr_clear_ext(&steps, zbx_pp_step_free);
 
 		/* remember what was received */
 		zbx_vector_uint64_append(&received_itemids, itemid);
@@ -670,6 +778,7 @@ static void	parse_list_of_checks(char *str, const char *host, unsigned short por
 		}
 	}
 out:
+	zbx_vector_pp_step_ptr_destroy(&steps);
 	zbx_vector_uint64_destroy(&received_itemids);
 	zbx_free(delay);
 	zbx_free(name);
@@ -896,7 +1005,7 @@ static int	refresh_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config_
 	level = SUCCEED != last_ret ? LOG_LEVEL_DEBUG : LOG_LEVEL_WARNING;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, config_timeout, config_timeout, 0, level,
-			config_tls, json.buffer, NULL, NULL, &data, NULL);
+			config_tls, 0, json.buffer, NULL, NULL, &data, NULL);
 
 	if (SUCCEED == ret)
 	{
@@ -981,6 +1090,43 @@ static int	check_response(const char *response)
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if buffered values must be sent now                        *
+ *                                                                            *
+ * Parameters: now                - [IN] current time                         *
+ *             config_buffer_send - [IN]                                      *
+ *             config_buffer_size - [IN]                                      *
+ *                                                                            *
+ * Return value: SUCCEED - buffer must be sent                                *
+ *               FAIL    - buffer can wait                                    *
+ *                                                                            *
+ * Comments: Besides full buffer and expired BufferSend, buffer which is at   *
+ *           least half full is sent early if values are arriving at a rate   *
+ *           that would overflow it before BufferSend expires. This keeps     *
+ *           uploads smaller and leaves room for values collected while       *
+ *           server is slow to respond, instead of dropping them.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	buffer_send_due(int now, int config_buffer_send, int config_buffer_size)
+{
+	if (config_buffer_size / 2 <= buffer.pcount || config_buffer_size <= buffer.count ||
+			config_buffer_send <= now - buffer.lastsent)
+	{
+		return SUCCEED;
+	}
+
+	/* count / (now - lastsent) * BufferSend > BufferSize */
+	if (config_buffer_size / 2 <= buffer.count && (zbx_uint64_t)buffer.count * (zbx_uint64_t)config_buffer_send >
+			(zbx_uint64_t)config_buffer_size * (zbx_uint64_t)(now - buffer.lastsent))
+	{
+		buffer.early_flushes++;
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
 static int	format_metric_results(struct zbx_json *json, int now, int config_buffer_send, int config_buffer_size)
 {
 	active_buffer_element_t	*el;
@@ -994,8 +1140,7 @@ static int	format_metric_results(struct zbx_json *json, int now, int config_buff
 		goto ret;
 	}
 
-	if (config_buffer_size / 2 > buffer.pcount && config_buffer_size > buffer.count &&
-			config_buffer_send > now - buffer.lastsent)
+	if (SUCCEED != buffer_send_due(now, config_buffer_send, config_buffer_size))
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() now:%d lastsent:%d now-lastsent:%d BufferSend:%d; will not send now",
 				__func__, now, buffer.lastsent, now - buffer.lastsent, config_buffer_send);
@@ -1112,6 +1257,7 @@ static void	clear_metric_results(zbx_vector_addr_ptr_t *addrs, zbx_vector_pre_pe
 			zbx_free(el->value);
 			zbx_free(el->source);
 		}
+		buffer.sent_values += (zbx_uint64_t)buffer.count;
 		buffer.count = 0;
 		buffer.pcount = 0;
 
@@ -1126,12 +1272,49 @@ static void	clear_metric_results(zbx_vector_addr_ptr_t *addrs, zbx_vector_pre_pe
 	}
 	else
 	{
+		buffer.failed_uploads++;
+
 		if (0 == buffer.first_error)
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "Active check data upload started to fail");
 			buffer.first_error = now;
 		}
 	}
+
+	if (0 != buffer.dropped_unreported)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "active check buffer was full, %d value(s) were discarded (total sent:"
+				ZBX_FS_UI64 " discarded:" ZBX_FS_UI64 " failed uploads:" ZBX_FS_UI64 ")",
+				buffer.dropped_unreported, buffer.sent_values, buffer.dropped_values,
+				buffer.failed_uploads);
+		buffer.dropped_unreported = 0;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "active check buffer statistics: sent:" ZBX_FS_UI64 " discarded:" ZBX_FS_UI64
+			" failed uploads:" ZBX_FS_UI64 " early uploads:" ZBX_FS_UI64, buffer.sent_values,
+			buffer.dropped_values, buffer.failed_uploads, buffer.early_flushes);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets protocol flags for active check data upload                  *
+ *                                                                            *
+ * Parameters: size - [IN] size of upload                                     *
+ *                                                                            *
+ * Comments: Uploads are compressed, like server-proxy communications, when   *
+ *           agent is built with zlib and upload size reaches                 *
+ *           BufferCompressSize. Small uploads gain little from compression.  *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	active_data_tcp_flags(size_t size)
+{
+#ifdef HAVE_ZLIB
+	if (0 != buffer.compress_size && (size_t)buffer.compress_size <= size)
+		return ZBX_TCP_COMPRESS;
+#else
+	ZBX_UNUSED(size);
+#endif
+	return 0;
 }
 
 static char	*connect_callback(void *data)
@@ -1200,7 +1383,8 @@ static int	send_buffer(zbx_vector_addr_ptr_t *addrs, zbx_vector_pre_persistent_t
 	level = 0 == buffer.first_error ? LOG_LEVEL_WARNING : LOG_LEVEL_DEBUG;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, MIN(buffer.count * config_timeout, 60),
-			config_timeout, 0, level, config_tls, json.buffer, connect_callback, &json, &data, NULL);
+			config_timeout, 0, level, config_tls, active_data_tcp_flags(json.buffer_size), json.buffer,
+			connect_callback, &json, &data, NULL);
 
 	if (SUCCEED == ret)
 	{
@@ -1227,52 +1411,44 @@ ret:
 	return ret;
 }
 
-/******************************************************************************************
- *                                                                                        *
- * Purpose: buffers new value or sends whole buffer to server                             *
- *                                                                                        *
- * Parameters:                                                                            *
- *   addrs              - [IN] In C agent - vector with a pair of Zabbix server IP or     *
- *                             Hostname and port number. In Agent2 it is not used (NULL). *
- *   agent2_result      - [IN] NULL in C agent. In Agent2 it is used for passing          *
- *                             address of buffer where to store matching log              *
- *                             records. It is here to have the same function              *
- *                             prototype as in Agent2.                                    *
- *   itemid             - [IN] item identifier
- *   host               - [IN] name of host in Zabbix database                            *
- *   key                - [IN] name of metric                                             *
- *   value              - [IN] key value or error message why item became NOTSUPPORTED    *
- *   state              - [IN] ITEM_STATE_NORMAL or ITEM_STATE_NOTSUPPORTED               *
- *   lastlogsize        - [IN] size of read logfile                                       *
- *   mtime              - [IN] time of last file modification                             *
- *   timestamp          - [IN] timestamp of read value                                    *
- *   source             - [IN] name of logged data source                                 *
- *   severity           - [IN] severity of logged data sources                            *
- *   logeventid         - [IN] application-specific identifier for the event; used        *
- *                             for monitoring of Windows event logs                       *
- *   flags              - [IN] metric flags                                               *
- *   config_tls         - [IN]                                                            *
- *   config_timeout     - [IN]                                                            *
- *   config_source_ip   - [IN]                                                            *
- *   config_buffer_send - [IN]                                                            *
- *   config_buffer_size - [IN]                                                            *
- *                                                                                        *
- * Return value: returns SUCCEED on successful parsing,                                   *
- *               FAIL on other cases                                                      *
- *                                                                                        *
- * Comments: ATTENTION! This function's address and pointers to arguments                 *
- *           are described in Zabbix defined type "zbx_process_value_func_t"              *
- *           and used when calling process_log(), process_logrt() and                     *
- *           zbx_read2(). If you ever change this process_value() arguments               *
- *           or return value do not forget to synchronize changes with the                *
- *           defined type "zbx_process_value_func_t" and implementations of               *
- *           process_log(), process_logrt(), zbx_read2() and their callers.               *
- *                                                                                        *
- ******************************************************************************************/
-static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result, zbx_uint64_t itemid,
-		const char *host, const char *key, const char *value, unsigned char state, zbx_uint64_t *lastlogsize,
-		const int *mtime, const unsigned long *timestamp, const char *source,
-		const unsigned short *severity, const unsigned long *logeventid, unsigned char flags,
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets throttling history of pushed down preprocessing steps, so  *
+ *          the next item value is sent to server                             *
+ *                                                                            *
+ * Comments: Called when a value sent to server was lost or replaced by error,*
+ *           so server throttling history differs from agent.                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	reset_pushdown(zbx_uint64_t itemid)
+{
+	for (int i = 0; i < active_metrics.values_num; i++)
+	{
+		zbx_active_metric_t	*metric = active_metrics.values[i];
+
+		if (metric->itemid != itemid)
+			continue;
+
+		if (NULL != metric->pushdown)
+			zbx_pp_pushdown_reset(metric->pushdown);
+
+		break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: buffers new value with the specified timestamp or sends whole     *
+ *          buffer to server                                                  *
+ *                                                                            *
+ * Comments: See process_value() for parameter description. If ts is NULL the *
+ *           current time is used.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_value_ext(zbx_vector_addr_ptr_t *addrs, zbx_uint64_t itemid, const char *host, const char *key,
+		const char *value, unsigned char state, zbx_uint64_t *lastlogsize, const int *mtime,
+		const unsigned long *timestamp, const char *source, const unsigned short *severity,
+		const unsigned long *logeventid, unsigned char flags, const zbx_timespec_t *ts,
 		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
 		int config_buffer_send, int config_buffer_size)
 {
@@ -1280,8 +1456,6 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 	int			i, ret = FAIL;
 	size_t			sz;
 
-	ZBX_UNUSED(agent2_result);
-
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		if (NULL != lastlogsize)
@@ -1350,6 +1524,11 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 
 			zbx_free(el->value);
 			zbx_free(el->source);
+
+			buffer.dropped_values++;
+			buffer.dropped_unreported++;
+
+			reset_pushdown(el->itemid);
 		}
 
 		sz = (size_t)(config_buffer_size - i - 1) * sizeof(active_buffer_element_t);
@@ -1379,7 +1558,13 @@ static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_
 	if (NULL != logeventid)
 		el->logeventid = (int)*logeventid;
 
-	zbx_timespec(&el->ts);
+	if (NULL != ts)
+		el->ts = *ts;
+	else
+		zbx_timespec(&el->ts);
+
+	if (ITEM_STATE_NOTSUPPORTED == state)
+		reset_pushdown(itemid);
 
 	el->flags = flags;
 	el->id = ++last_valueid;
@@ -1403,6 +1588,62 @@ out:
 	return ret;
 }
 
+/******************************************************************************************
+ *                                                                                        *
+ * Purpose: buffers new value or sends whole buffer to server                             *
+ *                                                                                        *
+ * Parameters:                                                                            *
+ *   addrs              - [IN] In C agent - vector with a pair of Zabbix server IP or     *
+ *                             Hostname and port number. In Agent2 it is not used (NULL). *
+ *   agent2_result      - [IN] NULL in C agent. In Agent2 it is used for passing          *
+ *                             address of buffer where to store matching log              *
+ *                             records. It is here to have the same function              *
+ *                             prototype as in Agent2.                                    *
+ *   itemid             - [IN] item identifier
+ *   host               - [IN] name of host in Zabbix database                            *
+ *   key                - [IN] name of metric                                             *
+ *   value              - [IN] key value or error message why item became NOTSUPPORTED    *
+ *   state              - [IN] ITEM_STATE_NORMAL or ITEM_STATE_NOTSUPPORTED               *
+ *   lastlogsize        - [IN] size of read logfile                                       *
+ *   mtime              - [IN] time of last file modification                             *
+ *   timestamp          - [IN] timestamp of read value                                    *
+ *   source             - [IN] name of logged data source                                 *
+ *   severity           - [IN] severity of logged data sources                            *
+ *   logeventid         - [IN] application-specific identifier for the event; used        *
+ *                             for monitoring of Windows event logs                       *
+ *   flags              - [IN] metric flags                                               *
+ *   config_tls         - [IN]                                                            *
+ *   config_timeout     - [IN]                                                            *
+ *   config_source_ip   - [IN]                                                            *
+ *   config_buffer_send - [IN]                                                            *
+ *   config_buffer_size - [IN]                                                            *
+ *                                                                                        *
+ * Return value: returns SUCCEED on successful parsing,                                   *
+ *               FAIL on other cases                                                      *
+ *                                                                                        *
+ * Comments: ATTENTION! This function's address and pointers to arguments                 *
+ *           are described in Zabbix defined type "zbx_process_value_func_t"              *
+ *           and used when calling process_log(), process_logrt() and                     *
+ *           zbx_read2(). If you ever change this process_value() arguments               *
+ *           or return value do not forget to synchronize changes with the                *
+ *           defined type "zbx_process_value_func_t" and implementations of               *
+ *           process_log(), process_logrt(), zbx_read2() and their callers.               *
+ *                                                                                        *
+ ******************************************************************************************/
+static int	process_value(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_result, zbx_uint64_t itemid,
+		const char *host, const char *key, const char *value, unsigned char state, zbx_uint64_t *lastlogsize,
+		const int *mtime, const unsigned long *timestamp, const char *source,
+		const unsigned short *severity, const unsigned long *logeventid, unsigned char flags,
+		const zbx_config_tls_t *config_tls, int config_timeout, const char *config_source_ip,
+		int config_buffer_send, int config_buffer_size)
+{
+	ZBX_UNUSED(agent2_result);
+
+	return process_value_ext(addrs, itemid, host, key, value, state, lastlogsize, mtime, timestamp, source,
+			severity, logeventid, flags, NULL, config_tls, config_timeout, config_source_ip,
+			config_buffer_send, config_buffer_size);
+}
+
 static void	process_remote_command_value(const char *value, zbx_uint64_t id, unsigned char state)
 {
 	zbx_command_result_t	*result;
@@ -1505,10 +1746,21 @@ static int	process_common_check(zbx_vector_addr_ptr_t *addrs, zbx_active_metric_
 
 	if (NULL != (pvalue = ZBX_GET_TEXT_RESULT(&result)))
 	{
+		zbx_timespec_t	ts;
+
 		zabbix_log(LOG_LEVEL_DEBUG, "for key [%s] received value [%s]", metric->key, *pvalue);
 
-		process_value(addrs, NULL, metric->itemid, config_hostname, metric->key, *pvalue, ITEM_STATE_NORMAL,
-				NULL, NULL, NULL, NULL, NULL, NULL, metric->flags, config_tls, config_timeout,
+		/* the same timestamp is used for throttling and sending, to match server throttling */
+		zbx_timespec(&ts);
+
+		if (NULL != metric->pushdown && FAIL == zbx_pp_pushdown_execute(metric->pushdown, *pvalue, &ts))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "value of key [%s] discarded by preprocessing", metric->key);
+			goto out;
+		}
+
+		process_value_ext(addrs, metric->itemid, config_hostname, metric->key, *pvalue, ITEM_STATE_NORMAL,
+				NULL, NULL, NULL, NULL, NULL, NULL, metric->flags, &ts, config_tls, config_timeout,
 				config_source_ip, config_buffer_send, config_buffer_size);
 	}
 out:
@@ -1824,7 +2076,7 @@ static void	send_heartbeat_msg(zbx_vector_addr_ptr_t *addrs, const zbx_config_tl
 	level = SUCCEED != last_ret ? LOG_LEVEL_DEBUG : LOG_LEVEL_WARNING;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, config_timeout, config_timeout, 0, level,
-			config_tls, json.buffer, NULL, NULL, NULL, &error);
+			config_tls, 0, json.buffer, NULL, NULL, NULL, &error);
 
 	if (SUCCEED == ret)
 	{
@@ -1875,7 +2127,7 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	zbx_tls_init_child(activechks_args_in->zbx_config_tls, activechks_args_in->zbx_get_program_type_cb_arg, NULL);
 #endif
-	init_active_metrics(activechks_args_in->config_buffer_size);
+	init_active_metrics(activechks_args_in->config_buffer_size, activechks_args_in->config_buffer_compress_size);
 
 #ifndef _WINDOWS
 	zbx_set_sigusr_handler(zbx_active_checks_sigusr_handler);
@@ -39,6 +39,7 @@ typedef struct
 	const char		*config_host_interface_item;
 	int			config_buffer_send;
 	int			config_buffer_size;
+	int			config_buffer_compress_size;
 	int			config_eventlog_max_lines_per_second;
 	int			config_max_lines_per_second;
 	int			config_refresh_active_checks;
@@ -29,6 +29,13 @@
 #	include "zbxnix.h"
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#	include <sys/epoll.h>
+#	ifdef EPOLLEXCLUSIVE
+#		define ZBX_LISTENER_EPOLL
+#	endif
+#endif
+
 #ifndef _WINDOWS
 static volatile sig_atomic_t	need_update_userparam;
 #endif
@@ -211,6 +218,79 @@ static void	process_listener(zbx_socket_t *s, int config_timeout)
 		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
 }
 
+#ifdef ZBX_LISTENER_EPOLL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates epoll instance for waiting on listening sockets shared    *
+ *          by all listener processes                                         *
+ *                                                                            *
+ * Parameters: s - [IN] listening socket                                      *
+ *                                                                            *
+ * Return value: epoll file descriptor or -1 on failure                       *
+ *                                                                            *
+ * Comments: Listening sockets are registered with EPOLLEXCLUSIVE flag, so an *
+ *           incoming connection wakes up one idle listener instead of all of *
+ *           them competing to accept it.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_epoll_create(const zbx_socket_t *s)
+{
+	int	epfd;
+
+	if (-1 == (epfd = epoll_create1(EPOLL_CLOEXEC)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot create epoll instance: %s", zbx_strerror(errno));
+		return -1;
+	}
+
+	for (int i = 0; i < s->num_socks; i++)
+	{
+		struct epoll_event	ev;
+
+		ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+		ev.data.fd = s->sockets[i];
+
+		if (-1 == epoll_ctl(epfd, EPOLL_CTL_ADD, s->sockets[i], &ev))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot add listening socket to epoll instance: %s",
+					zbx_strerror(errno));
+			close(epfd);
+			return -1;
+		}
+	}
+
+	return epfd;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for incoming connection on listening sockets                *
+ *                                                                            *
+ * Parameters: epfd    - [IN] epoll file descriptor                           *
+ *             timeout - [IN] timeout in seconds                              *
+ *                                                                            *
+ * Return value: SUCCEED       - connection is waiting to be accepted         *
+ *               TIMEOUT_ERROR - no connections for the timeout period        *
+ *               FAIL          - an error occurred                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_epoll_wait(int epfd, int timeout)
+{
+	struct epoll_event	ev;
+	int			n;
+
+	if (0 < (n = epoll_wait(epfd, &ev, 1, timeout * 1000)))
+		return SUCCEED;
+
+	if (0 == n || EINTR == errno)
+		return TIMEOUT_ERROR;
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot wait for incoming connections: %s", zbx_strerror(errno));
+
+	return FAIL;
+}
+#endif
+
 #ifndef _WINDOWS
 static void	zbx_listener_sigusr_handler(int flags)
 {
@@ -229,8 +309,12 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 	zbx_thread_listener_args	*init_child_args_in;
 	zbx_thread_info_t		*info = &((zbx_thread_args_t *)args)->info;
 	unsigned char			process_type = ((zbx_thread_args_t *)args)->info.process_type;
-	int				ret, server_num = ((zbx_thread_args_t *)args)->info.server_num,
+	int				ret, poll_timeout = POLL_TIMEOUT,
+					server_num = ((zbx_thread_args_t *)args)->info.server_num,
 					process_num = ((zbx_thread_args_t *)args)->info.process_num;
+#ifdef ZBX_LISTENER_EPOLL
+	int				epfd;
+#endif
 
 	init_child_args_in = (zbx_thread_listener_args *)((((zbx_thread_args_t *)args))->args);
 
@@ -249,6 +333,12 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 	zbx_set_sigusr_handler(zbx_listener_sigusr_handler);
 #endif
 
+#ifdef ZBX_LISTENER_EPOLL
+	/* connection is accepted without waiting once epoll reports it, fall back to poll if epoll is not usable */
+	if (-1 != (epfd = listener_epoll_create(&s)))
+		poll_timeout = 0;
+#endif
+
 	while (ZBX_IS_RUNNING())
 	{
 #ifndef _WINDOWS
@@ -262,7 +352,24 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 #endif
 
 		zbx_setproctitle("listener #%d [waiting for connection]", process_num);
-		ret = zbx_tcp_accept(&s, init_child_args_in->zbx_config_tls->accept_modes, POLL_TIMEOUT);
+
+#ifdef ZBX_LISTENER_EPOLL
+		if (-1 != epfd && SUCCEED != (ret = listener_epoll_wait(epfd, POLL_TIMEOUT)))
+		{
+			zbx_update_env(get_process_type_string(process_type), zbx_time());
+
+			if (FAIL == ret)
+			{
+				close(epfd);
+				epfd = -1;
+				poll_timeout = POLL_TIMEOUT;
+			}
+
+			continue;
+		}
+#endif
+		/* without waiting TIMEOUT_ERROR is returned if other listener has already accepted the connection */
+		ret = zbx_tcp_accept(&s, init_child_args_in->zbx_config_tls->accept_modes, poll_timeout);
 		zbx_update_env(get_process_type_string(process_type), zbx_time());
 
 		if (TIMEOUT_ERROR == ret)
@@ -316,6 +423,10 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 
 	zbx_thread_exit(EXIT_SUCCESS);
 #else
+#	ifdef ZBX_LISTENER_EPOLL
+	if (-1 != epfd)
+		close(epfd);
+#	endif
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	while (1)
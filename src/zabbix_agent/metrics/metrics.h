@@ -16,6 +16,7 @@
 #define ZABBIX_METRICS_H
 
 #include "zbxalgo.h"
+#include "zbxpreprocbase.h"
 
 /* define minimal and maximal values of lines to send by agent */
 /* per second for checks `log' and `eventlog', used to parse key parameters */
@@ -59,6 +60,7 @@ typedef struct
 	char			*persistent_file_name;	/* not used on Microsoft Windows */
 
 	int			timeout;
+	zbx_pp_pushdown_t	*pushdown;	/* preprocessing steps pushed down by server, can be NULL */
 }
 zbx_active_metric_t;
 
@@ -48,6 +48,7 @@ ZBX_GET_CONFIG_VAR2(char*, const char *, zbx_config_source_ip, NULL)
 static int	config_log_level = LOG_LEVEL_WARNING;
 static int	zbx_config_buffer_size = 100;
 static int	zbx_config_buffer_send = 5;
+static int	zbx_config_buffer_compress_size = ZBX_KIBIBYTE;
 static int	zbx_config_max_lines_per_second	= 20;
 static int	zbx_config_eventlog_max_lines_per_second = 20;
 static char	*config_load_module_path = NULL;
@@ -843,6 +844,7 @@ static int	add_serveractive_host_cb(const zbx_vector_addr_ptr_t *addrs, zbx_vect
 		config_active_args[forks].config_host_interface_item = zbx_config_host_interface_item;
 		config_active_args[forks].config_buffer_send = zbx_config_buffer_send;
 		config_active_args[forks].config_buffer_size = zbx_config_buffer_size;
+		config_active_args[forks].config_buffer_compress_size = zbx_config_buffer_compress_size;
 		config_active_args[forks].config_eventlog_max_lines_per_second =
 				zbx_config_eventlog_max_lines_per_second;
 		config_active_args[forks].config_max_lines_per_second = zbx_config_max_lines_per_second;
@@ -954,6 +956,8 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	2,			65535},
 		{"BufferSend",			&zbx_config_buffer_send,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
+		{"BufferCompressSize",		&zbx_config_buffer_compress_size,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_MEBIBYTE},
 #ifndef _WINDOWS
 		{"PidFile",			&config_pid_file,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
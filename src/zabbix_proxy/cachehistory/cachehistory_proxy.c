@@ -402,6 +402,8 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 			while (ZBX_DB_DOWN == (txn_rc = zbx_db_commit()));
 		}
 
+		zbx_hc_latency_mark(ZBX_HC_LATENCY_DBFLUSH);
+
 		zbx_dbcache_lock();
 
 		zbx_hc_push_items(&history_items);	/* return items to history cache */
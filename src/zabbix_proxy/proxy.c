@@ -110,7 +110,7 @@ static const char	*help_message[] = {
 	"                                   target is not specified",
 	"      " ZBX_SNMP_CACHE_RELOAD "          Reload SNMP cache",
 	"      " ZBX_DIAGINFO "=section           Log internal diagnostic information of the",
-	"                                 section (historycache, preprocessing, locks) or",
+	"                                 section (historycache, preprocessing, locks, profiler) or",
 	"                                 everything if section is not specified",
 	"      " ZBX_PROF_ENABLE "=target         Enable profiling, affects all processes if",
 	"                                   target is not specified",
@@ -139,7 +139,7 @@ static const char	*help_message[] = {
 	"        process-type,N           Process type and number (e.g., history syncer,1)",
 	"        pid                      Process identifier",
 	"        scope                    Profiling scope",
-	"                                 (rwlock, mutex, processing) can be used with process-type",
+	"                                 (rwlock, mutex, processing, sampling) can be used with process-type",
 	"                                 (e.g., history syncer,1,processing)",
 	"",
 	"  -T --test-config               Validate configuration file and exit",
@@ -321,6 +321,7 @@ static char	*config_stats_allowed_ip	= NULL;
 static int	config_tcp_max_backlog_size	= SOMAXCONN;
 static char	*config_file		= NULL;
 static int	config_allow_root	= 0;
+static int	config_enable_profiler_sampling	= 0;
 
 static zbx_config_log_t	log_file_cfg = {NULL, NULL, ZBX_LOG_TYPE_UNDEFINED, 1};
 
@@ -725,6 +726,8 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 			"OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == zbx_check_cfg_feature_str("TLSCipherAll13", zbx_config_tls->cipher_all13,
 			"OpenSSL 1.1.1 or newer"));
+	err |= (FAIL == zbx_check_cfg_feature_int("TLSKernelOffload", zbx_config_tls->kernel_offload,
+			"OpenSSL 3.0 or newer"));
 #endif
 
 #if !defined(HAVE_OPENIPMI)
@@ -994,6 +997,9 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"DBTLSCipher13",		&(zbx_config_dbhigh->config_db_tls_cipher_13),
 											ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"DBPreparedStatements",	&(zbx_config_dbhigh->config_db_prepared_statements),
+											ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"SSHKeyLocation",		&config_ssh_key_location,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&config_log_slow_queries,		ZBX_CFG_TYPE_INT,
@@ -1054,6 +1060,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"TLSCipherAll",		&(zbx_config_tls->cipher_all),		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"TLSKernelOffload",		&(zbx_config_tls->kernel_offload),	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"SocketDir",			&config_socket_path,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"EnableRemoteCommands",	&zbx_config_enable_remote_commands,	ZBX_CFG_TYPE_INT,
@@ -1093,6 +1101,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			1000},
 		{"WebDriverURL",		&config_webdriver_url,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"EnableProfilerSampling",	&config_enable_profiler_sampling,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{0}
 	};
 
@@ -1631,6 +1641,12 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		zabbix_log(LOG_LEVEL_CRIT, "cannot disable core dump, exiting...");
 		exit(EXIT_FAILURE);
 	}
+
+	/* generate session ticket keys before forking to share them between child processes */
+	zbx_tls_init_ticket_keys();
+
+	/* warn once rather than in every child process */
+	zbx_tls_check_kernel_offload(zbx_config_tls);
 #endif
 	if (FAIL == zbx_load_modules(config_load_module_path, config_load_module, zbx_config_timeout, 1))
 	{
@@ -1682,6 +1698,15 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	zbx_prof_init(zbx_selfmon_prof_flush);
+	zbx_tcp_init_compress_stats(zbx_selfmon_compress_update);
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_init_stats(zbx_selfmon_tls_update);
+#endif
+
+	if (1 == config_enable_profiler_sampling)
+		zbx_prof_enable(ZBX_PROF_SAMPLING);
+
 	if (0 != config_forks[ZBX_PROCESS_TYPE_VMWARE] && SUCCEED != zbx_vmware_init(&config_vmware_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize VMware cache: %s", error);
@@ -406,3 +406,38 @@ const char	*get_string(const char *p, char *buf, size_t bufsize)
 	return p;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates hash of host name and item key of input line           *
+ *                                                                            *
+ * Parameters: line         - [IN] input line                                 *
+ *             default_host - [IN] host name used for '-' (can be NULL)       *
+ *                                                                            *
+ * Return value: hash of host name and item key                               *
+ *                                                                            *
+ * Comments: Used to pass values of the same item to the same connection in   *
+ *           bulk mode. Invalid lines are hashed by the fields parsed so far, *
+ *           parsing error is reported when the line is added to buffer.      *
+ *                                                                            *
+ ******************************************************************************/
+zbx_hash_t	sb_line_hash(const char *line, const char *default_host)
+{
+	const char	*p;
+	char		hostname[MAX_STRING_LEN], key[MAX_STRING_LEN];
+	zbx_hash_t	hash;
+
+	*hostname = '\0';
+	*key = '\0';
+
+	if (NULL == (p = get_string(line, hostname, sizeof(hostname))))
+		*hostname = '\0';
+	else if (NULL == get_string(p, key, sizeof(key)))
+		*key = '\0';
+
+	if (NULL != default_host && 0 == strcmp(hostname, "-"))
+		zbx_strlcpy(hostname, default_host, sizeof(hostname));
+
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(hostname, strlen(hostname), ZBX_DEFAULT_HASH_SEED);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(key, strlen(key), hash);
+}
@@ -52,5 +52,6 @@ void	sb_destroy(zbx_send_buffer_t *buf);
 int	sb_parse_line(zbx_send_buffer_t *buf, const char *line, size_t line_alloc, int immediate, struct zbx_json **out,
 		char **error);
 struct zbx_json	*sb_pop(zbx_send_buffer_t *buf);
+zbx_hash_t	sb_line_hash(const char *line, const char *default_host);
 
 #endif
@@ -103,7 +103,7 @@ int	zabbix_sender_send_values(const char *address, unsigned short port, const ch
 	memset(&config_tls, 0, sizeof(config_tls));
 	config_tls.connect_mode = ZBX_TCP_SEC_UNENCRYPTED;
 
-	ret = zbx_comms_exchange_with_redirect(source, &zbx_addrs, GET_SENDER_TIMEOUT, 30, 0, 0, &config_tls,
+	ret = zbx_comms_exchange_with_redirect(source, &zbx_addrs, GET_SENDER_TIMEOUT, 30, 0, 0, &config_tls, 0,
 			json.buffer, NULL, NULL, result, NULL);
 
 	if (SUCCEED != ret && NULL != result)
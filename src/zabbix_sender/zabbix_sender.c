@@ -41,11 +41,11 @@ static const char	syslog_app_name[] = "zabbix_sender";
 static const char	*usage_message[] = {
 	"[-v]", "-z server", "[-p port]", "[-I IP-address]", "[-t timeout]", "-s host", "-k key", "-o value", NULL,
 	"[-v]", "-z server", "[-p port]", "[-I IP-address]", "[-t timeout]", "[-s host]", "[-T]", "[-N]", "[-r]",
-	"[-b]", "-i input-file", NULL,
+	"[-b]", "[--bulk connections]", "-i input-file", NULL,
 	"[-v]", "-c config-file", "[-z server]", "[-p port]", "[-I IP-address]", "[-t timeout]", "[-s host]", "-k key",
 	"-o value", NULL,
 	"[-v]", "-c config-file", "[-z server]", "[-p port]", "[-I IP-address]", "[-t timeout]", "[-s host]", "[-T]",
-	"[-N]", "[-r]", "-b]", "-i input-file", NULL,
+	"[-N]", "[-r]", "-b]", "[--bulk connections]", "-i input-file", NULL,
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	"[-v]", "-z server", "[-p port]", "[-I IP-address]", "[-t timeout]", "-s host", "--tls-connect cert",
 	"--tls-ca-file CA-file", "[--tls-crl-file CRL-file]", "[--tls-server-cert-issuer cert-issuer]",
@@ -66,7 +66,7 @@ static const char	*usage_message[] = {
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	"[--tls-cipher cipher-string]",
 #endif
-	"[-T]", "[-N]", "[-r]", "[-b]", "-i input-file", NULL,
+	"[-T]", "[-N]", "[-r]", "[-b]", "[--bulk connections]", "-i input-file", NULL,
 	"[-v]", "-c config-file [-z server]", "[-p port]", "[-I IP-address]", "[-t timeout]", "[-s host]",
 	"--tls-connect cert", "--tls-ca-file CA-file", "[--tls-crl-file CRL-file]",
 	"[--tls-server-cert-issuer cert-issuer]", "[--tls-server-cert-subject cert-subject]",
@@ -88,7 +88,7 @@ static const char	*usage_message[] = {
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	"[--tls-cipher cipher-string]",
 #endif
-	"[-T]", "[-N]", "[-r]", "[-b]", "-i input-file", NULL,
+	"[-T]", "[-N]", "[-r]", "[-b]", "[--bulk connections]", "-i input-file", NULL,
 	"[-v]", "-z server", "[-p port]", "[-I IP-address]", "[-t timeout]", "-s host", "--tls-connect psk",
 	"--tls-psk-identity PSK-identity", "--tls-psk-file PSK-file",
 #if defined(HAVE_OPENSSL)
@@ -106,7 +106,7 @@ static const char	*usage_message[] = {
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	"[--tls-cipher cipher-string]",
 #endif
-	"[-T]", "[-N]", "[-r]", "[-b]", "-i input-file", NULL,
+	"[-T]", "[-N]", "[-r]", "[-b]", "[--bulk connections]", "-i input-file", NULL,
 	"[-v]", "-c config-file", "[-z server]", "[-p port]", "[-I IP-address]", "[-t timeout]", "[-s host]",
 	"--tls-connect psk", "--tls-psk-identity PSK-identity", "--tls-psk-file PSK-file",
 #if defined(HAVE_OPENSSL)
@@ -124,7 +124,7 @@ static const char	*usage_message[] = {
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	"[--tls-cipher cipher-string]",
 #endif
-	"[-T]", "[-N]", "[-r]", "[-b]", "-i input-file", NULL,
+	"[-T]", "[-N]", "[-r]", "[-b]", "[--bulk connections]", "-i input-file", NULL,
 #endif
 	"-h", NULL,
 	"-V", NULL,
@@ -148,6 +148,11 @@ static int	CONFIG_SENDER_TIMEOUT = GET_SENDER_TIMEOUT;
 #define CONFIG_SENDER_TIMEOUT_MIN_STR	ZBX_STR(CONFIG_SENDER_TIMEOUT_MIN)
 #define CONFIG_SENDER_TIMEOUT_MAX_STR	ZBX_STR(CONFIG_SENDER_TIMEOUT_MAX)
 
+#define ZBX_BULK_CONNECTIONS_MIN	1
+#define ZBX_BULK_CONNECTIONS_MAX	64
+#define ZBX_BULK_CONNECTIONS_MIN_STR	ZBX_STR(ZBX_BULK_CONNECTIONS_MIN)
+#define ZBX_BULK_CONNECTIONS_MAX_STR	ZBX_STR(ZBX_BULK_CONNECTIONS_MAX)
+
 static const char	*help_message[] = {
 	"Utility for sending monitoring data to Zabbix server or proxy.",
 	"",
@@ -204,6 +209,17 @@ static const char	*help_message[] = {
 	"  -g --group                 Group values by hosts and send to each host in",
 	"                             a separate batch",
 	"",
+#if !defined(_WINDOWS)
+	"  --bulk connections         Send input file values over several parallel",
+	"                             connections, each keeping the next batch queued",
+	"                             while the current one is being sent, and print",
+	"                             throughput statistics. Values of the same item",
+	"                             are always sent over the same connection in",
+	"                             input order. This can be used with",
+	"                             --input-file option, but not with --real-time.",
+	"                             Valid range: " ZBX_BULK_CONNECTIONS_MIN_STR "-" ZBX_BULK_CONNECTIONS_MAX_STR,
+	"",
+#endif
 	"  -v --verbose               Verbose mode, -vv for more details",
 	"",
 	"  -h --help                  Display this help message",
@@ -300,6 +316,7 @@ static struct zbx_option	longopts[] =
 	{"with-ns",			0,	NULL,	'N'},
 	{"real-time",			0,	NULL,	'r'},
 	{"group",			0,	NULL,	'g'},
+	{"bulk",			1,	NULL,	'C'},
 	{"verbose",			0,	NULL,	'v'},
 	{"help",			0,	NULL,	'h'},
 	{"version",			0,	NULL,	'V'},
@@ -339,17 +356,48 @@ static char	*ZABBIX_KEY_VALUE = NULL;
 static char	*config_file = NULL;
 
 static int	config_group_mode = ZBX_SEND_GROUP_NONE;
+static int	config_bulk_connections = 0;
 
 typedef struct
 {
 	zbx_vector_addr_ptr_t	addrs;
 	ZBX_THREAD_HANDLE	*thread;
+	int			index;	/* position in the configured list, kept when destinations are removed */
 }
 zbx_send_destinations_t;
 
 static zbx_send_destinations_t	*destinations = NULL;		/* list of servers to send data to */
 static int			destinations_count = 0;
 
+#if !defined(_WINDOWS)
+/* chunk of input lines passed to connection worker, followed by line data and line numbers */
+typedef struct
+{
+	int	lines;
+	size_t	size;
+}
+zbx_bulk_chunk_t;
+
+typedef struct
+{
+	int			index;
+	int			fds[2];		/* pipe for chunks of input lines sent to worker */
+	ZBX_THREAD_HANDLE	thread;
+
+	/* used by main process only */
+	int			requests;	/* number of chunks requested by worker and not passed yet */
+	zbx_bulk_chunk_t	chunk;		/* input lines collected for worker */
+	char			*data;
+	size_t			data_alloc;
+	size_t			data_offset;
+	int			*line_nums;	/* input file line numbers of collected lines */
+}
+zbx_bulk_worker_t;
+
+static zbx_bulk_worker_t	*bulk_workers = NULL;		/* bulk mode connection workers */
+static int			bulk_workers_num = 0;
+#endif
+
 volatile sig_atomic_t	sig_exiting = 0;
 
 #if !defined(_WINDOWS)
@@ -387,11 +435,20 @@ static void	main_signal_handler(int sig)
 
 		for (i = 0; i < destinations_count; i++)
 		{
-			pid_t	child = *(destinations[i].thread);
+			pid_t	child;
+
+			if (NULL == destinations[i].thread)
+				continue;
 
-			if (ZBX_THREAD_HANDLE_NULL != child)
+			if (ZBX_THREAD_HANDLE_NULL != (child = *(destinations[i].thread)))
 				kill(child, sig);
 		}
+
+		for (i = 0; i < bulk_workers_num; i++)
+		{
+			if (0 < bulk_workers[i].thread)
+				kill(bulk_workers[i].thread, sig);
+		}
 	}
 }
 #endif
@@ -520,7 +577,13 @@ static int	sender_threads_wait(ZBX_THREAD_HANDLE *threads, zbx_thread_args_t *th
  *                                                                            *
  * Purpose: Check whether JSON response is SUCCEED                            *
  *                                                                            *
- * Parameters: JSON response from Zabbix trapper                              *
+ * Parameters: response  - [IN] JSON response from Zabbix trapper            *
+ *             server    - [IN] server address                                *
+ *             port      - [IN] server port                                   *
+ *             processed - [OUT] number of values processed by server,        *
+ *                               optional                                     *
+ *             failed    - [OUT] number of values failed to process,          *
+ *                               optional                                     *
  *                                                                            *
  * Return value:  SUCCEED - processed successfully                            *
  *                FAIL - an error occurred                                    *
@@ -528,9 +591,12 @@ static int	sender_threads_wait(ZBX_THREAD_HANDLE *threads, zbx_thread_args_t *th
  *                successfully, but processing of at least one value failed   *
  *                                                                            *
  * Comments: active agent has almost the same function!                       *
+ *           Server response info is printed only when processed and failed   *
+ *           value counters are not requested.                                *
  *                                                                            *
  ******************************************************************************/
-static int	check_response(char *response, const char *server, unsigned short port)
+static int	check_response(char *response, const char *server, unsigned short port, int *processed,
+		int *failed)
 {
 	struct zbx_json_parse	jp;
 	char			value[MAX_STRING_LEN], info[MAX_STRING_LEN], *rhost = NULL;
@@ -549,13 +615,25 @@ static int	check_response(char *response, const char *server, unsigned short por
 
 	if (SUCCEED == ret && SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_INFO, info, sizeof(info), NULL))
 	{
-		int	failed;
+		int	info_processed, info_failed;
 
-		printf("Response from \"%s:%hu\": \"%s\"\n", server, port, info);
-		fflush(stdout);
+		if (NULL == processed)
+		{
+			printf("Response from \"%s:%hu\": \"%s\"\n", server, port, info);
+			fflush(stdout);
+		}
 
-		if (1 == sscanf(info, "processed: %*d; failed: %d", &failed) && 0 < failed)
-			ret = SUCCEED_PARTIAL;
+		if (2 == sscanf(info, "processed: %d; failed: %d", &info_processed, &info_failed))
+		{
+			if (NULL != processed)
+			{
+				*processed += info_processed;
+				*failed += info_failed;
+			}
+
+			if (0 < info_failed)
+				ret = SUCCEED_PARTIAL;
+		}
 	}
 
 	if (FAIL == ret && SUCCEED == zbx_parse_redirect_response(&jp, &rhost, &redirect_port, &redirect_revision,
@@ -639,13 +717,13 @@ static	ZBX_THREAD_ENTRY(send_value, args)
 #endif
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, sendval_args->addrs, CONFIG_SENDER_TIMEOUT,
-			config_timeout, 0, LOG_LEVEL_DEBUG, sendval_args->zbx_config_tls, sendval_args->json->buffer,
-			connect_callback, sendval_args->json, &data, NULL);
+			config_timeout, 0, LOG_LEVEL_DEBUG, sendval_args->zbx_config_tls, 0,
+			sendval_args->json->buffer, connect_callback, sendval_args->json, &data, NULL);
 
 	if (SUCCEED == ret)
 	{
 		if (FAIL == check_response(data, sendval_args->addrs->values[0]->ip,
-				sendval_args->addrs->values[0]->port))
+				sendval_args->addrs->values[0]->port, NULL, NULL))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "incorrect answer from \"%s:%hu\": [%s]",
 					sendval_args->addrs->values[0]->ip, sendval_args->addrs->values[0]->port,
@@ -773,6 +851,8 @@ static int	sender_add_serveractive_host_cb(const zbx_vector_addr_ptr_t *addrs, z
 			sizeof(zbx_send_destinations_t) * destinations_count);
 
 	zbx_vector_addr_ptr_create(&destinations[destinations_count - 1].addrs);
+	destinations[destinations_count - 1].thread = NULL;
+	destinations[destinations_count - 1].index = destinations_count - 1;
 
 	zbx_addr_copy(&destinations[destinations_count - 1].addrs, addrs);
 
@@ -985,6 +1065,21 @@ static void	parse_commandline(int argc, char **argv)
 			case 'g':
 				config_group_mode = 1;
 				break;
+			case 'C':
+#if !defined(_WINDOWS)
+				if (FAIL == zbx_is_uint_n_range(zbx_optarg, ZBX_MAX_UINT64_LEN, &config_bulk_connections,
+						sizeof(config_bulk_connections), ZBX_BULK_CONNECTIONS_MIN,
+						ZBX_BULK_CONNECTIONS_MAX))
+				{
+					zbx_error("Invalid number of bulk connections, valid range %d:%d",
+							ZBX_BULK_CONNECTIONS_MIN, ZBX_BULK_CONNECTIONS_MAX);
+					exit(EXIT_FAILURE);
+				}
+#else
+				zbx_error("parameter \"--bulk\" is not supported on Windows");
+				exit(EXIT_FAILURE);
+#endif
+				break;
 			case 'v':
 				if (LOG_LEVEL_WARNING > CONFIG_LOG_LEVEL)
 					CONFIG_LOG_LEVEL = LOG_LEVEL_WARNING;
@@ -1339,7 +1434,8 @@ static void	parse_commandline(int argc, char **argv)
 					(0x5c0 <= opt_mask && opt_mask <= 0x5c3) ||
 					(0x6c0 <= opt_mask && opt_mask <= 0x6c3) ||
 					(0x7c0 <= opt_mask && opt_mask <= 0x7c3))) ||
-					(1 == opt_count['g'] && 0 == opt_count['i'])
+					(1 == opt_count['g'] && 0 == opt_count['i']) ||
+					(1 == opt_count['C'] && (0 == opt_count['i'] || 1 == opt_count['r']))
 					)
 	{
 		zbx_error("too few or mutually exclusive options used");
@@ -1422,6 +1518,519 @@ static int	send_data(zbx_thread_sendval_args *sendval_args, int ret, struct zbx_
 	return ret;
 }
 
+#if !defined(_WINDOWS)
+/* each connection worker sends one batch while the next one is queued in its pipe */
+#define ZBX_BULK_BATCHES_QUEUED		2
+#define ZBX_BULK_READ_BUFFER_SIZE	ZBX_MEBIBYTE
+
+#ifdef HAVE_ZLIB
+#	define ZBX_BULK_TCP_FLAGS	ZBX_TCP_COMPRESS
+#else
+#	define ZBX_BULK_TCP_FLAGS	0
+#endif
+
+/* Chunk processing result, written by connection worker after each chunk. Before exiting the worker also */
+/* writes a result for each destination with the number of values processed and failed by it.           */
+typedef struct
+{
+	int	worker;
+	int	destination;	/* destination index for destination results, -1 for chunk results */
+	int	status;
+	int	values;
+	int	batches;
+	int	processed;
+	int	failed;
+	int	parse_failed;
+}
+zbx_bulk_result_t;
+
+static int	bulk_results_fds[2];	/* results from all connection workers */
+
+static int	bulk_read_all(int fd, char *buf, size_t n)
+{
+	ssize_t	offset;
+
+	while (0 < n)
+	{
+		if (0 >= (offset = read(fd, buf, n)))
+		{
+			if (-1 == offset && EINTR == errno)
+				continue;
+
+			return FAIL;
+		}
+
+		buf += offset;
+		n -= (size_t)offset;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends batch to all destinations                                   *
+ *                                                                            *
+ * Parameters: json         - [IN] batch to send, freed by this function      *
+ *             result       - [IN/OUT] chunk processing result                *
+ *             dest_results - [IN/OUT] values processed by each destination,  *
+ *                                     indexed by destination index           *
+ *                                                                            *
+ * Comments: Destinations failing to accept data are removed from connection  *
+ *           worker destination list, like sender_threads_wait() does.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	bulk_send_batch(struct zbx_json *json, zbx_bulk_result_t *result, zbx_bulk_result_t *dest_results)
+{
+	int	i, sent_num = 0, dest_num = destinations_count, partial = 0;
+
+	zbx_json_close(json);
+
+	/* clone batch before sending, as connect callback adds clock to the sent batch */
+	for (i = destinations_count - 1; 0 <= i; i--)
+	{
+		struct zbx_json		*out = (0 == i ? json : zbx_json_clone(json));
+		zbx_vector_addr_ptr_t	*addrs = &destinations[i].addrs;
+		char			*data = NULL;
+
+		if (SUCCEED == zbx_comms_exchange_with_redirect(config_source_ip, addrs, CONFIG_SENDER_TIMEOUT,
+				config_timeout, 0, LOG_LEVEL_DEBUG, zbx_config_tls, ZBX_BULK_TCP_FLAGS, out->buffer,
+				connect_callback, out, &data, NULL))
+		{
+			zbx_bulk_result_t	*dest = &dest_results[destinations[i].index];
+
+			switch (check_response(data, addrs->values[0]->ip, addrs->values[0]->port, &dest->processed,
+					&dest->failed))
+			{
+				case FAIL:
+					zabbix_log(LOG_LEVEL_WARNING, "incorrect answer from \"%s:%hu\": [%s]",
+							addrs->values[0]->ip, addrs->values[0]->port, data);
+					break;
+				case SUCCEED_PARTIAL:
+					partial = 1;
+					break;
+			}
+
+			zbx_free(data);
+			sent_num++;
+		}
+		else
+		{
+			zbx_vector_addr_ptr_clear_ext(addrs, zbx_addr_free);
+			zbx_vector_addr_ptr_destroy(addrs);
+			destinations[i] = destinations[--destinations_count];
+		}
+
+		if (out != json)
+		{
+			zbx_json_free(out);
+			zbx_free(out);
+		}
+	}
+
+	zbx_json_free(json);
+	zbx_free(json);
+
+	if (0 == sent_num)
+	{
+		result->status = FAIL;
+		return;
+	}
+
+	result->batches++;
+
+	if (dest_num != sent_num || 1 == partial)
+		result->status = SUCCEED_PARTIAL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: connection worker, parses chunks of input lines received from     *
+ *          main process into batches and sends them to destinations          *
+ *                                                                            *
+ ******************************************************************************/
+static	ZBX_THREAD_ENTRY(bulk_worker, args)
+{
+	zbx_bulk_worker_t	*worker = (zbx_bulk_worker_t *)((zbx_thread_args_t *)args)->args;
+	zbx_bulk_chunk_t	chunk;
+	zbx_bulk_result_t	result, *dest_results;
+	zbx_send_buffer_t	send_buffer;
+	struct zbx_json		*out;
+	char			*data = NULL, *error = NULL;
+	size_t			data_alloc = 0;
+	int			i, dest_num = destinations_count, *line_nums;
+
+	zbx_set_sender_signal_handlers();
+
+	/* close pipes of workers started earlier, so that they get end of file when main process closes them */
+	for (i = 0; i < worker->index; i++)
+		close(bulk_workers[i].fds[1]);
+
+	close(worker->fds[1]);
+	close(bulk_results_fds[0]);
+
+	sb_init(&send_buffer, config_group_mode, ZABBIX_HOSTNAME, WITH_TIMESTAMPS, WITH_NS);
+
+	memset(&result, 0, sizeof(result));
+	result.worker = worker->index;
+	result.destination = -1;
+	result.status = SUCCEED;
+
+	dest_results = (zbx_bulk_result_t *)zbx_calloc(NULL, (size_t)dest_num, sizeof(zbx_bulk_result_t));
+
+	for (i = 0; i < dest_num; i++)
+	{
+		dest_results[i].worker = worker->index;
+		dest_results[i].destination = i;
+	}
+
+	line_nums = (int *)zbx_malloc(NULL, VALUES_MAX * sizeof(int));
+
+	/* request initial chunks */
+	for (i = 0; i < ZBX_BULK_BATCHES_QUEUED; i++)
+	{
+		if (FAIL == zbx_write_all(bulk_results_fds[1], (char *)&result, sizeof(result)))
+			goto out;
+	}
+
+	while (SUCCEED == bulk_read_all(worker->fds[0], (char *)&chunk, sizeof(chunk)))
+	{
+		char	*line, *next;
+
+		if (data_alloc < chunk.size + 1)
+		{
+			data_alloc = chunk.size + 1;
+			data = (char *)zbx_realloc(data, data_alloc);
+		}
+
+		if (FAIL == bulk_read_all(worker->fds[0], data, chunk.size) ||
+				FAIL == bulk_read_all(worker->fds[0], (char *)line_nums, (size_t)chunk.lines * sizeof(int)))
+		{
+			break;
+		}
+
+		/* after failure keep reading queued chunks until main process stops sending them */
+		if (FAIL == result.status || 1 == result.parse_failed)
+			continue;
+
+		data[chunk.size] = '\0';
+
+		result.status = SUCCEED;
+		result.values = 0;
+		result.batches = 0;
+
+		for (line = data, i = 0; i < chunk.lines; line = next + 1, i++)
+		{
+			if (NULL != (next = strchr(line, '\n')))
+				*next = '\0';
+
+			if (FAIL == sb_parse_line(&send_buffer, line, data_alloc, ZBX_SEND_BATCHED, &out, &error))
+			{
+				zabbix_log(LOG_LEVEL_CRIT, "[line %d] %s", line_nums[i], error);
+				zbx_free(error);
+				result.parse_failed = 1;
+				break;
+			}
+
+			result.values++;
+
+			if (NULL != out)
+				bulk_send_batch(out, &result, dest_results);
+
+			if (FAIL == result.status || NULL == next)
+				break;
+		}
+
+		while (FAIL != result.status && NULL != (out = sb_pop(&send_buffer)))
+			bulk_send_batch(out, &result, dest_results);
+
+		if (FAIL == zbx_write_all(bulk_results_fds[1], (char *)&result, sizeof(result)))
+			goto out;
+	}
+
+	for (i = 0; i < dest_num; i++)
+	{
+		if (FAIL == zbx_write_all(bulk_results_fds[1], (char *)&dest_results[i], sizeof(dest_results[i])))
+			break;
+	}
+out:
+	zbx_free(line_nums);
+	zbx_free(dest_results);
+	zbx_free(data);
+	sb_destroy(&send_buffer);
+
+	close(worker->fds[0]);
+	close(bulk_results_fds[1]);
+
+	zbx_thread_exit(result.status);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accounts chunk processing result received from connection worker *
+ *                                                                            *
+ * Parameters: result        - [IN] chunk or destination processing result    *
+ *             ret           - [IN/OUT] sending status                        *
+ *             succeed_count - [IN/OUT] number of values parsed               *
+ *             batches       - [IN/OUT] number of batches sent                *
+ *             dest_results  - [IN/OUT] values processed by each destination  *
+ *                                                                            *
+ * Return value: SUCCEED - sending can continue                               *
+ *               FAIL    - sending must be stopped                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	bulk_process_result(const zbx_bulk_result_t *result, int *ret, int *succeed_count, int *batches,
+		zbx_bulk_result_t *dest_results)
+{
+	if (0 <= result->destination)
+	{
+		dest_results[result->destination].processed += result->processed;
+		dest_results[result->destination].failed += result->failed;
+
+		return SUCCEED;
+	}
+
+	*succeed_count += result->values;
+	*batches += result->batches;
+
+	if (FAIL == result->status)
+		*ret = FAIL;
+	else if (SUCCEED_PARTIAL == result->status && FAIL != *ret)
+		*ret = SUCCEED_PARTIAL;
+
+	if (FAIL == *ret || 1 == result->parse_failed)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes input lines collected for connection worker to it as soon  *
+ *          as the worker requests next chunk                                 *
+ *                                                                            *
+ * Parameters: worker        - [IN/OUT] connection worker                     *
+ *             ret           - [IN/OUT] sending status                        *
+ *             succeed_count - [IN/OUT] number of values parsed               *
+ *             batches       - [IN/OUT] number of batches sent                *
+ *             dest_results  - [IN/OUT] values processed by each destination  *
+ *                                                                            *
+ * Return value: SUCCEED - chunk was passed to connection worker              *
+ *               FAIL    - worker has exited or sending must be stopped       *
+ *                                                                            *
+ * Comments: Results of other workers are accounted while waiting, their      *
+ *           requests are remembered for their next chunks.                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	bulk_dispatch_chunk(zbx_bulk_worker_t *worker, int *ret, int *succeed_count, int *batches,
+		zbx_bulk_result_t *dest_results)
+{
+	zbx_bulk_result_t	result;
+	int			fd = worker->fds[1];
+
+	while (0 == worker->requests)
+	{
+		if (FAIL == bulk_read_all(bulk_results_fds[0], (char *)&result, sizeof(result)))
+		{
+			*ret = FAIL;
+			return FAIL;
+		}
+
+		if (SUCCEED != bulk_process_result(&result, ret, succeed_count, batches, dest_results))
+			return FAIL;
+
+		/* destination results are written by exiting workers, which do not request chunks anymore */
+		if (0 > result.destination)
+			bulk_workers[result.worker].requests++;
+	}
+
+	worker->requests--;
+	worker->chunk.size = worker->data_offset;
+
+	if (FAIL == zbx_write_all(fd, (const char *)&worker->chunk, sizeof(worker->chunk)) ||
+			FAIL == zbx_write_all(fd, worker->data, worker->chunk.size) ||
+			FAIL == zbx_write_all(fd, (const char *)worker->line_nums,
+			(size_t)worker->chunk.lines * sizeof(int)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot write data to pipe: %s", zbx_strerror(errno));
+		*ret = FAIL;
+		return FAIL;
+	}
+
+	worker->chunk.lines = 0;
+	worker->data_offset = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends input file values over several connections                  *
+ *                                                                            *
+ * Parameters: in            - [IN] input file                                *
+ *             total_count   - [OUT] number of input lines read               *
+ *             succeed_count - [OUT] number of values parsed                  *
+ *                                                                            *
+ * Return value:  SUCCEED - success with all values at all destinations       *
+ *                FAIL - an error occurred                                    *
+ *                SUCCEED_PARTIAL - data sending was completed successfully   *
+ *                to at least one destination or processing of at least one   *
+ *                value at least at one destination failed                    *
+ *                                                                            *
+ * Comments: Main process only reads input lines and passes them in chunks    *
+ *           of VALUES_MAX lines to connection workers. Each line goes to the *
+ *           worker selected by hash of its host and key, so values of the    *
+ *           same item are always sent over the same connection in input      *
+ *           order. Workers parse the lines into batches in parallel and each *
+ *           of them keeps up to ZBX_BULK_BATCHES_QUEUED chunks in flight,    *
+ *           requesting the next chunk when a batch has been sent.            *
+ *                                                                            *
+ ******************************************************************************/
+static int	bulk_send(FILE *in, int *total_count, int *succeed_count)
+{
+	zbx_thread_args_t	*threads_args;
+	zbx_bulk_result_t	result, *dest_results;
+	char			*in_line = NULL;
+	size_t			in_line_alloc = MAX_BUFFER_LEN;
+	int			i, ret = SUCCEED, batches = 0, started = 0, dispatched = SUCCEED, *shards;
+	double			time_start, time_spent;
+
+	setvbuf(in, NULL, _IOFBF, ZBX_BULK_READ_BUFFER_SIZE);
+
+	if (-1 == pipe(bulk_results_fds))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot create data pipe: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	time_start = zbx_time();
+
+	bulk_workers = (zbx_bulk_worker_t *)zbx_calloc(NULL, (size_t)config_bulk_connections,
+			sizeof(zbx_bulk_worker_t));
+	threads_args = (zbx_thread_args_t *)zbx_calloc(NULL, (size_t)config_bulk_connections,
+			sizeof(zbx_thread_args_t));
+	dest_results = (zbx_bulk_result_t *)zbx_calloc(NULL, (size_t)destinations_count, sizeof(zbx_bulk_result_t));
+	shards = (int *)zbx_malloc(NULL, (size_t)config_bulk_connections * sizeof(int));
+
+	for (i = 0; i < config_bulk_connections; i++)
+	{
+		zbx_bulk_worker_t	*worker = &bulk_workers[i];
+
+		if (-1 == pipe(worker->fds))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot create data pipe: %s", zbx_strerror(errno));
+			break;
+		}
+
+		worker->index = i;
+		threads_args[i].args = worker;
+		bulk_workers_num++;
+
+		zbx_thread_start(bulk_worker, &threads_args[i], &worker->thread);
+		close(worker->fds[0]);
+
+		if (ZBX_THREAD_ERROR == worker->thread)
+		{
+			close(worker->fds[1]);
+			worker->thread = ZBX_THREAD_HANDLE_NULL;
+			continue;
+		}
+
+		worker->line_nums = (int *)zbx_malloc(NULL, VALUES_MAX * sizeof(int));
+		shards[started++] = i;
+	}
+
+	close(bulk_results_fds[1]);
+
+	if (0 == started)
+	{
+		ret = FAIL;
+		goto out;
+	}
+
+	in_line = (char *)zbx_malloc(NULL, in_line_alloc);
+
+	while (0 == sig_exiting && NULL != zbx_fgets_alloc(&in_line, &in_line_alloc, in))
+	{
+		zbx_bulk_worker_t	*worker;
+
+		(*total_count)++;
+
+		zbx_rtrim(in_line, "\r\n");
+
+		/* keep values of the same item on the same connection to preserve their order */
+		worker = &bulk_workers[shards[sb_line_hash(in_line, ZABBIX_HOSTNAME) % (zbx_hash_t)started]];
+
+		zbx_strcpy_alloc(&worker->data, &worker->data_alloc, &worker->data_offset, in_line);
+		zbx_chrcpy_alloc(&worker->data, &worker->data_alloc, &worker->data_offset, '\n');
+		worker->line_nums[worker->chunk.lines] = *total_count;
+
+		if (VALUES_MAX > ++worker->chunk.lines)
+			continue;
+
+		if (SUCCEED != (dispatched = bulk_dispatch_chunk(worker, &ret, succeed_count, &batches, dest_results)))
+			break;
+	}
+
+	for (i = 0; i < started && SUCCEED == dispatched && 0 == sig_exiting; i++)
+	{
+		zbx_bulk_worker_t	*worker = &bulk_workers[shards[i]];
+
+		if (0 != worker->chunk.lines)
+			dispatched = bulk_dispatch_chunk(worker, &ret, succeed_count, &batches, dest_results);
+	}
+out:
+	/* let workers finish queued chunks and collect their results */
+	for (i = 0; i < bulk_workers_num; i++)
+	{
+		if (ZBX_THREAD_HANDLE_NULL != bulk_workers[i].thread)
+			close(bulk_workers[i].fds[1]);
+	}
+
+	while (SUCCEED == bulk_read_all(bulk_results_fds[0], (char *)&result, sizeof(result)))
+		(void)bulk_process_result(&result, &ret, succeed_count, &batches, dest_results);
+
+	close(bulk_results_fds[0]);
+
+	for (i = 0; i < bulk_workers_num; i++)
+	{
+		if (ZBX_THREAD_HANDLE_NULL != bulk_workers[i].thread)
+		{
+			zbx_thread_wait(bulk_workers[i].thread);
+			bulk_workers[i].thread = ZBX_THREAD_HANDLE_NULL;
+		}
+	}
+
+	time_spent = zbx_time() - time_start;
+
+	for (i = 0; i < destinations_count; i++)
+	{
+		const zbx_addr_t	*addr = destinations[i].addrs.values[0];
+
+		printf("Response from \"%s:%hu\": \"processed: %d; failed: %d\"\n", addr->ip, addr->port,
+				dest_results[i].processed, dest_results[i].failed);
+	}
+
+	printf("batches: %d; connections: %d; seconds spent: %.6f; values per second: %.1f\n", batches, started,
+			time_spent, 0 < time_spent ? (double)*succeed_count / time_spent : 0);
+
+	for (i = 0; i < bulk_workers_num; i++)
+	{
+		zbx_free(bulk_workers[i].data);
+		zbx_free(bulk_workers[i].line_nums);
+	}
+
+	bulk_workers_num = 0;
+	zbx_free(bulk_workers);
+	zbx_free(threads_args);
+	zbx_free(dest_results);
+	zbx_free(shards);
+	zbx_free(in_line);
+
+	return ret;
+}
+#endif
+
 int	main(int argc, char **argv)
 {
 	char			*error = NULL;
@@ -1562,6 +2171,17 @@ int	main(int argc, char **argv)
 		}
 
 		sendval_args->sync_timestamp = WITH_TIMESTAMPS;
+#if !defined(_WINDOWS)
+		if (0 != config_bulk_connections)
+		{
+			ret = bulk_send(in, &total_count, &succeed_count);
+
+			if (in != stdin)
+				fclose(in);
+
+			goto free;
+		}
+#endif
 		in_line = (char *)zbx_malloc(NULL, in_line_alloc);
 
 		ret = SUCCEED;
@@ -2655,13 +2655,14 @@ clean:
  *                                                                            *
  * Parameters: event    - [IN]                                                *
  *             actionid - [IN] action to execute operations for               *
+ *             links    - [IN/OUT] templates pending to be linked to hosts    *
  *                                                                            *
  * Comments: For message, command operations see                              *
  *           escalation_execute_operations(),                                 *
  *           escalation_execute_recovery_operations().                        *
  *                                                                            *
  ******************************************************************************/
-static void	execute_operations(const zbx_db_event *event, zbx_uint64_t actionid)
+static void	execute_operations(const zbx_db_event *event, zbx_uint64_t actionid, zbx_hashset_t *links)
 {
 	zbx_db_result_t		result;
 	zbx_db_row_t		row;
@@ -2711,7 +2712,7 @@ static void	execute_operations(const zbx_db_event *event, zbx_uint64_t actionid)
 				op_host_add(event, &cfg);
 				break;
 			case ZBX_OPERATION_TYPE_HOST_REMOVE:
-				op_host_del(event);
+				op_host_del(event, links);
 				break;
 			case ZBX_OPERATION_TYPE_HOST_ENABLE:
 				op_host_enable(event, &cfg);
@@ -2796,14 +2797,14 @@ static void	execute_operations(const zbx_db_event *event, zbx_uint64_t actionid)
 	{
 		zbx_vector_uint64_sort(&del_templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 		zbx_vector_uint64_uniq(&del_templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-		op_template_del(event, &del_templateids);
+		op_template_del(event, &del_templateids, links);
 	}
 
 	if (0 != lnk_templateids.values_num)
 	{
 		zbx_vector_uint64_sort(&lnk_templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 		zbx_vector_uint64_uniq(&lnk_templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-		op_template_add(event, &cfg, &lnk_templateids);
+		op_template_add(event, &cfg, &lnk_templateids, links);
 	}
 
 	if (0 != new_groupids.values_num)
@@ -3097,7 +3098,7 @@ void	process_actions(zbx_vector_db_event_t *events, const zbx_vector_uint64_pair
 {
 	zbx_vector_action_eval_ptr_t	actions;
 	zbx_vector_uint64_pair_t	rec_escalations;
-	zbx_hashset_t			uniq_conditions[EVENT_SOURCE_COUNT];
+	zbx_hashset_t			uniq_conditions[EVENT_SOURCE_COUNT], links;
 	zbx_vector_db_event_t		esc_events[EVENT_SOURCE_COUNT];
 	zbx_hashset_iter_t		iter;
 	zbx_condition_t			*condition;
@@ -3143,6 +3144,8 @@ void	process_actions(zbx_vector_db_event_t *events, const zbx_vector_uint64_pair
 
 	zbx_dc_close_user_macros(um_handle);
 
+	op_template_links_create(&links);
+
 	/* 1. All event sources: match PROBLEM events to action conditions, add them to 'new_escalations' list.      */
 	/* 2. EVENT_SOURCE_DISCOVERY, EVENT_SOURCE_AUTOREGISTRATION: execute operations (except command and message  */
 	/*    operations) for events that match action conditions.                                                   */
@@ -3175,12 +3178,16 @@ void	process_actions(zbx_vector_db_event_t *events, const zbx_vector_uint64_pair
 				if (EVENT_SOURCE_DISCOVERY == event->source ||
 						EVENT_SOURCE_AUTOREGISTRATION == event->source)
 				{
-					execute_operations(event, action->actionid);
+					execute_operations(event, action->actionid, &links);
 				}
 			}
 		}
 	}
 
+	/* templates are linked to all discovered hosts at once */
+	op_template_links_flush(&links);
+	op_template_links_destroy(&links);
+
 	for (int i = 0; i < EVENT_SOURCE_COUNT; i++)
 	{
 		zbx_vector_db_event_destroy(&esc_events[i]);
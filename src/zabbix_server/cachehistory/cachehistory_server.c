@@ -1401,6 +1401,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 				do
 				{
 					zbx_db_begin();
+					zbx_db_pipeline_enable();
 
 					zbx_db_mass_update_items(&item_diff, &inventory_values);
 
@@ -1420,6 +1421,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 			}
 
 			zbx_dc_close_user_macros(um_handle);
+			zbx_hc_latency_mark(ZBX_HC_LATENCY_DBFLUSH);
 
 			if (NULL != events_cbs->clean_events_cb)
 				events_cbs->clean_events_cb();
@@ -1496,6 +1498,8 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 				if (ZBX_DB_OK == txn_error && NULL != events_cbs->events_update_itservices_cb)
 					events_cbs->events_update_itservices_cb();
+
+				zbx_hc_latency_mark(ZBX_HC_LATENCY_TRIGGERS);
 			}
 		}
 
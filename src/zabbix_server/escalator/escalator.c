@@ -116,6 +116,1057 @@ static void	zbx_tag_filter_free(zbx_tag_filter_t *tag_filter)
 	zbx_free(tag_filter);
 }
 
+/* alert insert variants, recovery alerts are flushed after problem alerts */
+#define ZBX_ESC_ALERT_INSERT_ERROR	0x01
+#define ZBX_ESC_ALERT_INSERT_RECOVERY	0x02
+#define ZBX_ESC_ALERT_INSERT_NUM	4
+
+/* loaded operation data */
+#define ZBX_ESC_OPERATION_MESSAGE	0x01
+#define ZBX_ESC_OPERATION_RECIPIENTS	0x02
+#define ZBX_ESC_OPERATION_CONDITIONS	0x04
+
+#define ZBX_ESC_STEP_NEXT_UNKNOWN	-1
+
+/* usrgrp.users_status value of disabled user group */
+#define ZBX_ESC_USRGRP_STATUS_DISABLED	1
+
+typedef struct
+{
+	zbx_uint64_t	mediatypeid;
+	char		*sendto;
+	char		*period;
+	int		severity;
+	unsigned char	active;
+	unsigned char	mediatype_status;
+	unsigned char	mediatype_type;
+}
+zbx_esc_media_t;
+
+ZBX_PTR_VECTOR_DECL(esc_media_ptr, zbx_esc_media_t *)
+ZBX_PTR_VECTOR_IMPL(esc_media_ptr, zbx_esc_media_t *)
+
+typedef struct
+{
+	zbx_uint64_t			userid;
+	zbx_uint64_t			roleid;
+
+	/* user type, -1 if user was not found */
+	int				type;
+
+	/* FAIL if user belongs to a disabled user group, SUCCEED otherwise */
+	int				perm2system;
+
+	char				*timezone;
+	zbx_vector_tag_filter_ptr_t	tag_filters;
+	zbx_vector_esc_media_ptr_t	media;
+}
+zbx_esc_user_t;
+
+typedef struct
+{
+	zbx_uint64_t		triggerid;
+	zbx_vector_uint64_t	hgsetids;
+	zbx_vector_uint64_t	hostgroupids;
+}
+zbx_esc_trigger_t;
+
+typedef struct
+{
+	/* user and trigger identifiers */
+	zbx_uint64_pair_t	ids;
+
+	/* SUCCEED if user has read access to all host group sets of trigger, FAIL otherwise */
+	int			ret;
+}
+zbx_esc_trigger_perm_t;
+
+typedef struct
+{
+	unsigned char	conditiontype;
+	unsigned char	op;
+	char		*value;
+}
+zbx_esc_opcondition_t;
+
+ZBX_VECTOR_DECL(esc_opcondition, zbx_esc_opcondition_t)
+ZBX_VECTOR_IMPL(esc_opcondition, zbx_esc_opcondition_t)
+
+typedef struct
+{
+	zbx_uint64_t			operationid;
+	unsigned char			flags;
+
+	/* opmessage row */
+	unsigned char			message_found;
+	unsigned char			default_msg;
+	zbx_uint64_t			mediatypeid;
+	char				*subject;
+	char				*message;
+
+	/* users from opmessage_usr and opmessage_grp */
+	zbx_vector_uint64_t		userids;
+
+	/* opconditions rows sorted by condition type */
+	zbx_vector_esc_opcondition_t	conditions;
+}
+zbx_esc_operation_t;
+
+typedef struct
+{
+	zbx_uint64_t	mediatype_messageid;
+	zbx_uint64_t	mediatypeid;
+	char		*subject;
+	char		*message;
+}
+zbx_esc_mediatype_msg_t;
+
+ZBX_VECTOR_DECL(esc_mediatype_msg, zbx_esc_mediatype_msg_t)
+ZBX_VECTOR_IMPL(esc_mediatype_msg, zbx_esc_mediatype_msg_t)
+
+typedef struct
+{
+	/* messages are selected either by media type or by media types of user */
+	zbx_uint64_t			mediatypeid;
+	zbx_uint64_t			userid;
+	unsigned char			eventsource;
+	unsigned char			recovery;
+
+	zbx_vector_esc_mediatype_msg_t	messages;
+}
+zbx_esc_mediatype_msgs_t;
+
+typedef struct
+{
+	zbx_uint64_t	operationid;
+	int		operationtype;
+	unsigned char	evaltype;
+	char		*esc_period;
+}
+zbx_esc_step_operation_t;
+
+ZBX_VECTOR_DECL(esc_step_operation, zbx_esc_step_operation_t)
+ZBX_VECTOR_IMPL(esc_step_operation, zbx_esc_step_operation_t)
+
+typedef struct
+{
+	/* action identifier and escalation step */
+	zbx_uint64_pair_t			ids;
+
+	/* normal message and command operations of the step */
+	zbx_vector_esc_step_operation_t	operations;
+
+	/* SUCCEED if action has normal operations after this step, FAIL otherwise */
+	int					has_next;
+}
+zbx_esc_step_t;
+
+/* data shared by escalations processed in the same batch */
+typedef struct
+{
+	zbx_hashset_t	users;
+	zbx_hashset_t	triggers;
+	zbx_hashset_t	trigger_perms;
+	zbx_hashset_t	operations;
+	zbx_hashset_t	mediatype_msgs;
+	zbx_hashset_t	steps;
+
+	zbx_db_insert_t	alerts[ZBX_ESC_ALERT_INSERT_NUM];
+	unsigned char	alerts_prepared[ZBX_ESC_ALERT_INSERT_NUM];
+}
+zbx_esc_cache_t;
+
+static zbx_esc_cache_t	esc_cache;
+
+static void	esc_media_free(zbx_esc_media_t *media)
+{
+	zbx_free(media->sendto);
+	zbx_free(media->period);
+	zbx_free(media);
+}
+
+static void	esc_user_clean(zbx_esc_user_t *user)
+{
+	zbx_free(user->timezone);
+	zbx_vector_tag_filter_ptr_clear_ext(&user->tag_filters, zbx_tag_filter_free);
+	zbx_vector_tag_filter_ptr_destroy(&user->tag_filters);
+	zbx_vector_esc_media_ptr_clear_ext(&user->media, esc_media_free);
+	zbx_vector_esc_media_ptr_destroy(&user->media);
+}
+
+static void	esc_trigger_clean(zbx_esc_trigger_t *trigger)
+{
+	zbx_vector_uint64_destroy(&trigger->hgsetids);
+	zbx_vector_uint64_destroy(&trigger->hostgroupids);
+}
+
+static void	esc_operation_clean(zbx_esc_operation_t *operation)
+{
+	zbx_free(operation->subject);
+	zbx_free(operation->message);
+	zbx_vector_uint64_destroy(&operation->userids);
+
+	for (int i = 0; i < operation->conditions.values_num; i++)
+		zbx_free(operation->conditions.values[i].value);
+
+	zbx_vector_esc_opcondition_destroy(&operation->conditions);
+}
+
+static void	esc_mediatype_msgs_clean(zbx_esc_mediatype_msgs_t *msgs)
+{
+	for (int i = 0; i < msgs->messages.values_num; i++)
+	{
+		zbx_free(msgs->messages.values[i].subject);
+		zbx_free(msgs->messages.values[i].message);
+	}
+
+	zbx_vector_esc_mediatype_msg_destroy(&msgs->messages);
+}
+
+static void	esc_step_clean(zbx_esc_step_t *step)
+{
+	for (int i = 0; i < step->operations.values_num; i++)
+		zbx_free(step->operations.values[i].esc_period);
+
+	zbx_vector_esc_step_operation_destroy(&step->operations);
+}
+
+static zbx_hash_t	esc_mediatype_msgs_hash_func(const void *data)
+{
+	const zbx_esc_mediatype_msgs_t	*msgs = (const zbx_esc_mediatype_msgs_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&msgs->mediatypeid);
+	hash = ZBX_DEFAULT_UINT64_HASH_ALGO(&msgs->userid, sizeof(msgs->userid), hash);
+	hash = ZBX_DEFAULT_HASH_ALGO(&msgs->eventsource, sizeof(msgs->eventsource), hash);
+
+	return ZBX_DEFAULT_HASH_ALGO(&msgs->recovery, sizeof(msgs->recovery), hash);
+}
+
+static int	esc_mediatype_msgs_compare_func(const void *d1, const void *d2)
+{
+	const zbx_esc_mediatype_msgs_t	*msgs1 = (const zbx_esc_mediatype_msgs_t *)d1;
+	const zbx_esc_mediatype_msgs_t	*msgs2 = (const zbx_esc_mediatype_msgs_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(msgs1->mediatypeid, msgs2->mediatypeid);
+	ZBX_RETURN_IF_NOT_EQUAL(msgs1->userid, msgs2->userid);
+	ZBX_RETURN_IF_NOT_EQUAL(msgs1->eventsource, msgs2->eventsource);
+	ZBX_RETURN_IF_NOT_EQUAL(msgs1->recovery, msgs2->recovery);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates cache of users, triggers and operations shared by         *
+ *          escalations processed in the same batch                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_init(void)
+{
+	zbx_hashset_create_ext(&esc_cache.users, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			(zbx_clean_func_t)esc_user_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&esc_cache.triggers, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)esc_trigger_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create(&esc_cache.trigger_perms, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+	zbx_hashset_create_ext(&esc_cache.operations, 100, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)esc_operation_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&esc_cache.mediatype_msgs, 100, esc_mediatype_msgs_hash_func,
+			esc_mediatype_msgs_compare_func, (zbx_clean_func_t)esc_mediatype_msgs_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&esc_cache.steps, 100, ZBX_DEFAULT_UINT64_PAIR_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC, (zbx_clean_func_t)esc_step_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	memset(esc_cache.alerts_prepared, 0, sizeof(esc_cache.alerts_prepared));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts alerts collected by escalations into database             *
+ *                                                                            *
+ * Comments: Must be called before reading alerts created in the current      *
+ *           batch from database.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_flush_alerts(void)
+{
+	for (int i = 0; i < ZBX_ESC_ALERT_INSERT_NUM; i++)
+	{
+		if (0 == esc_cache.alerts_prepared[i])
+			continue;
+
+		zbx_db_insert_autoincrement(&esc_cache.alerts[i], "alertid");
+		zbx_db_insert_execute(&esc_cache.alerts[i]);
+		zbx_db_insert_clean(&esc_cache.alerts[i]);
+
+		esc_cache.alerts_prepared[i] = 0;
+	}
+}
+
+static void	esc_cache_destroy(void)
+{
+	esc_cache_flush_alerts();
+
+	zbx_hashset_destroy(&esc_cache.steps);
+	zbx_hashset_destroy(&esc_cache.mediatype_msgs);
+	zbx_hashset_destroy(&esc_cache.operations);
+	zbx_hashset_destroy(&esc_cache.trigger_perms);
+	zbx_hashset_destroy(&esc_cache.triggers);
+	zbx_hashset_destroy(&esc_cache.users);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets batch alert insert for the specified alert type              *
+ *                                                                            *
+ * Parameters: error    - [IN] 1 for alerts without media, 0 otherwise        *
+ *             recovery - [IN] 1 for alerts with problem event reference,     *
+ *                             0 otherwise                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_insert_t	*esc_cache_get_alert_insert(int error, int recovery)
+{
+	int		index;
+	zbx_db_insert_t	*db_insert;
+
+	index = (0 != error ? ZBX_ESC_ALERT_INSERT_ERROR : 0) | (0 != recovery ? ZBX_ESC_ALERT_INSERT_RECOVERY : 0);
+	db_insert = &esc_cache.alerts[index];
+
+	if (0 != esc_cache.alerts_prepared[index])
+		return db_insert;
+
+	if (0 == error)
+	{
+		zbx_db_insert_prepare(db_insert, "alerts", "alertid", "actionid", "eventid", "userid", "clock",
+				"mediatypeid", "sendto", "subject", "message", "status", "error", "esc_step",
+				"alerttype", "acknowledgeid", "parameters", (0 != recovery ? "p_eventid" : NULL),
+				(char *)NULL);
+	}
+	else
+	{
+		zbx_db_insert_prepare(db_insert, "alerts", "alertid", "actionid", "eventid", "userid", "clock",
+				"subject", "message", "status", "retries", "error", "esc_step", "alerttype",
+				"acknowledgeid", (0 != recovery ? "p_eventid" : NULL), (char *)NULL);
+	}
+
+	esc_cache.alerts_prepared[index] = 1;
+
+	return db_insert;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads users, their permission to system, tag filters and media    *
+ *          into cache                                                        *
+ *                                                                            *
+ * Parameters: userids - [IN] users to load, already cached users are skipped *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_load_users(const zbx_vector_uint64_t *userids)
+{
+	zbx_vector_uint64_t	ids;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_esc_user_t		*user, user_local;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		userid;
+
+	zbx_vector_uint64_create(&ids);
+
+	for (int i = 0; i < userids->values_num; i++)
+	{
+		if (NULL != zbx_hashset_search(&esc_cache.users, &userids->values[i]))
+			continue;
+
+		user_local.userid = userids->values[i];
+		user_local.roleid = 0;
+		user_local.type = -1;
+		user_local.perm2system = SUCCEED;
+		user_local.timezone = NULL;
+
+		user = (zbx_esc_user_t *)zbx_hashset_insert(&esc_cache.users, &user_local, sizeof(user_local));
+		zbx_vector_tag_filter_ptr_create(&user->tag_filters);
+		zbx_vector_esc_media_ptr_create(&user->media);
+
+		zbx_vector_uint64_append(&ids, user->userid);
+	}
+
+	if (0 == ids.values_num)
+		goto out;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() users:%d", __func__, ids.values_num);
+
+	zbx_vector_uint64_sort(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select u.userid,r.type,u.roleid,u.timezone from users u,role r where u.roleid=r.roleid and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "u.userid", ids.values, ids.values_num);
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(userid, row[0]);
+
+		if (NULL == (user = (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid)) ||
+				SUCCEED == zbx_db_is_null(row[1]))
+		{
+			continue;
+		}
+
+		user->type = atoi(row[1]);
+		ZBX_STR2UINT64(user->roleid, row[2]);
+		user->timezone = zbx_strdup(NULL, row[3]);
+	}
+	zbx_db_free_result(result);
+
+	sql_offset = 0;
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select ug.userid from usrgrp g,users_groups ug"
+			" where g.usrgrpid=ug.usrgrpid"
+				" and g.users_status=%d"
+				" and",
+			ZBX_ESC_USRGRP_STATUS_DISABLED);
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "ug.userid", ids.values, ids.values_num);
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(userid, row[0]);
+
+		if (NULL != (user = (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid)))
+			user->perm2system = FAIL;
+	}
+	zbx_db_free_result(result);
+
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select ug.userid,tf.groupid,tf.tag,tf.value from tag_filter tf"
+			" join users_groups ug on ug.usrgrpid=tf.usrgrpid"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "ug.userid", ids.values, ids.values_num);
+	result = zbx_db_select("%s order by ug.userid,tf.groupid", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_tag_filter_t	*tag_filter;
+
+		ZBX_STR2UINT64(userid, row[0]);
+
+		if (NULL == (user = (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid)))
+			continue;
+
+		tag_filter = (zbx_tag_filter_t *)zbx_malloc(NULL, sizeof(zbx_tag_filter_t));
+		ZBX_STR2UINT64(tag_filter->hostgroupid, row[1]);
+		tag_filter->tag = zbx_strdup(NULL, row[2]);
+		tag_filter->value = zbx_strdup(NULL, row[3]);
+		zbx_vector_tag_filter_ptr_append(&user->tag_filters, tag_filter);
+	}
+	zbx_db_free_result(result);
+
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select m.userid,m.mediatypeid,m.sendto,m.severity,m.period,mt.status,m.active,mt.type"
+			" from media m,media_type mt"
+			" where m.mediatypeid=mt.mediatypeid"
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "m.userid", ids.values, ids.values_num);
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_esc_media_t	*media;
+
+		ZBX_STR2UINT64(userid, row[0]);
+
+		if (NULL == (user = (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid)))
+			continue;
+
+		media = (zbx_esc_media_t *)zbx_malloc(NULL, sizeof(zbx_esc_media_t));
+		ZBX_STR2UINT64(media->mediatypeid, row[1]);
+		media->sendto = zbx_strdup(NULL, row[2]);
+		media->severity = atoi(row[3]);
+		media->period = zbx_strdup(NULL, row[4]);
+		ZBX_STR2UCHAR(media->mediatype_status, row[5]);
+		ZBX_STR2UCHAR(media->active, row[6]);
+		ZBX_STR2UCHAR(media->mediatype_type, row[7]);
+		zbx_vector_esc_media_ptr_append(&user->media, media);
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+out:
+	zbx_vector_uint64_destroy(&ids);
+}
+
+static const zbx_esc_user_t	*esc_cache_get_user(zbx_uint64_t userid)
+{
+	zbx_esc_user_t		*user;
+	zbx_vector_uint64_t	userids;
+
+	if (NULL != (user = (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid)))
+		return user;
+
+	zbx_vector_uint64_create(&userids);
+	zbx_vector_uint64_append(&userids, userid);
+	esc_cache_load_users(&userids);
+	zbx_vector_uint64_destroy(&userids);
+
+	return (zbx_esc_user_t *)zbx_hashset_search(&esc_cache.users, &userid);
+}
+
+static int	esc_check_user_perm2system(zbx_uint64_t userid)
+{
+	return esc_cache_get_user(userid)->perm2system;
+}
+
+static char	*esc_get_user_timezone(zbx_uint64_t userid)
+{
+	const zbx_esc_user_t	*user = esc_cache_get_user(userid);
+
+	return NULL != user->timezone ? zbx_strdup(NULL, user->timezone) : NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads host group sets and host groups of triggers into cache      *
+ *                                                                            *
+ * Parameters: triggerids - [IN] triggers to load, already cached triggers    *
+ *                               are skipped                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_load_triggers(const zbx_vector_uint64_t *triggerids)
+{
+	zbx_vector_uint64_t	ids;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_esc_trigger_t	*trigger, trigger_local;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	zbx_uint64_t		triggerid, id;
+
+	zbx_vector_uint64_create(&ids);
+
+	for (int i = 0; i < triggerids->values_num; i++)
+	{
+		if (NULL != zbx_hashset_search(&esc_cache.triggers, &triggerids->values[i]))
+			continue;
+
+		trigger_local.triggerid = triggerids->values[i];
+		trigger = (zbx_esc_trigger_t *)zbx_hashset_insert(&esc_cache.triggers, &trigger_local,
+				sizeof(trigger_local));
+		zbx_vector_uint64_create(&trigger->hgsetids);
+		zbx_vector_uint64_create(&trigger->hostgroupids);
+
+		zbx_vector_uint64_append(&ids, trigger->triggerid);
+	}
+
+	if (0 == ids.values_num)
+		goto out;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() triggers:%d", __func__, ids.values_num);
+
+	zbx_vector_uint64_sort(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select distinct f.triggerid,hh.hgsetid from host_hgset hh"
+			" join items i on hh.hostid=i.hostid"
+			" join functions f on i.itemid=f.itemid"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid", ids.values, ids.values_num);
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(triggerid, row[0]);
+
+		if (NULL == (trigger = (zbx_esc_trigger_t *)zbx_hashset_search(&esc_cache.triggers, &triggerid)))
+			continue;
+
+		ZBX_STR2UINT64(id, row[1]);
+		zbx_vector_uint64_append(&trigger->hgsetids, id);
+	}
+	zbx_db_free_result(result);
+
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select distinct f.triggerid,hg.groupid from items i"
+			" join functions f on i.itemid=f.itemid"
+			" join hosts_groups hg on hg.hostid=i.hostid"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid", ids.values, ids.values_num);
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(triggerid, row[0]);
+
+		if (NULL == (trigger = (zbx_esc_trigger_t *)zbx_hashset_search(&esc_cache.triggers, &triggerid)))
+			continue;
+
+		ZBX_STR2UINT64(id, row[1]);
+		zbx_vector_uint64_append(&trigger->hostgroupids, id);
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+
+	for (int i = 0; i < ids.values_num; i++)
+	{
+		trigger = (zbx_esc_trigger_t *)zbx_hashset_search(&esc_cache.triggers, &ids.values[i]);
+
+		zbx_vector_uint64_sort(&trigger->hgsetids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_sort(&trigger->hostgroupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+out:
+	zbx_vector_uint64_destroy(&ids);
+}
+
+static const zbx_esc_trigger_t	*esc_cache_get_trigger(zbx_uint64_t triggerid)
+{
+	zbx_esc_trigger_t	*trigger;
+	zbx_vector_uint64_t	triggerids;
+
+	if (NULL != (trigger = (zbx_esc_trigger_t *)zbx_hashset_search(&esc_cache.triggers, &triggerid)))
+		return trigger;
+
+	zbx_vector_uint64_create(&triggerids);
+	zbx_vector_uint64_append(&triggerids, triggerid);
+	esc_cache_load_triggers(&triggerids);
+	zbx_vector_uint64_destroy(&triggerids);
+
+	return (zbx_esc_trigger_t *)zbx_hashset_search(&esc_cache.triggers, &triggerid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prefetches triggers of escalated trigger events                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_prefetch_triggers(const zbx_vector_db_event_t *events)
+{
+	zbx_vector_uint64_t	triggerids;
+
+	zbx_vector_uint64_create(&triggerids);
+
+	for (int i = 0; i < events->values_num; i++)
+	{
+		if (EVENT_OBJECT_TRIGGER == events->values[i]->object)
+			zbx_vector_uint64_append(&triggerids, events->values[i]->objectid);
+	}
+
+	zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	esc_cache_load_triggers(&triggerids);
+
+	zbx_vector_uint64_destroy(&triggerids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads access of users to host group sets of trigger with single   *
+ *          query                                                             *
+ *                                                                            *
+ * Parameters: userids - [IN] users to check, super admins and users already *
+ *                            checked for the trigger are skipped             *
+ *             trigger - [IN]                                                 *
+ *                                                                            *
+ * Comments: User has access to trigger when there are permission rows for    *
+ *           all its host group sets.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	esc_cache_load_trigger_perms(const zbx_vector_uint64_t *userids, const zbx_esc_trigger_t *trigger)
+{
+	zbx_esc_trigger_perm_t	perm_local;
+	zbx_vector_uint64_t	ids;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+
+	if (0 == trigger->hgsetids.values_num)
+		return;
+
+	zbx_vector_uint64_create(&ids);
+
+	perm_local.ids.second = trigger->triggerid;
+
+	for (int i = 0; i < userids->values_num; i++)
+	{
+		perm_local.ids.first = userids->values[i];
+
+		if (NULL != zbx_hashset_search(&esc_cache.trigger_perms, &perm_local))
+			continue;
+
+		if (USER_TYPE_SUPER_ADMIN != esc_cache_get_user(userids->values[i])->type)
+			zbx_vector_uint64_append(&ids, userids->values[i]);
+	}
+
+	if (0 == ids.values_num)
+		goto out;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() triggerid:" ZBX_FS_UI64 " users:%d", __func__, trigger->triggerid,
+			ids.values_num);
+
+	zbx_vector_uint64_sort(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	/* users without permission rows are denied */
+	perm_local.ret = FAIL;
+
+	for (int i = 0; i < ids.values_num; i++)
+	{
+		perm_local.ids.first = ids.values[i];
+		zbx_hashset_insert(&esc_cache.trigger_perms, &perm_local, sizeof(perm_local));
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select u.userid,count(*) from permission p"
+			" join user_ugset u on p.ugsetid=u.ugsetid"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "u.userid", ids.values, ids.values_num);
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "p.hgsetid", trigger->hgsetids.values,
+			trigger->hgsetids.values_num);
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " group by u.userid");
+	result = zbx_db_select("%s", sql);
+	zbx_free(sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_esc_trigger_perm_t	*perm;
+
+		ZBX_STR2UINT64(perm_local.ids.first, row[0]);
+
+		if (NULL == (perm = (zbx_esc_trigger_perm_t *)zbx_hashset_search(&esc_cache.trigger_perms,
+				&perm_local)))
+		{
+			continue;
+		}
+
+		if (atoi(row[1]) == trigger->hgsetids.values_num)
+			perm->ret = SUCCEED;
+	}
+	zbx_db_free_result(result);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+out:
+	zbx_vector_uint64_destroy(&ids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if user has read access to all host group sets of trigger  *
+ *                                                                            *
+ * Return value: SUCCEED - user has access                                    *
+ *               FAIL    - user does not have access                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	esc_cache_check_trigger_hgsets(zbx_uint64_t userid, const zbx_esc_trigger_t *trigger)
+{
+	zbx_esc_trigger_perm_t	*perm, perm_local;
+
+	perm_local.ids.first = userid;
+	perm_local.ids.second = trigger->triggerid;
+
+	if (NULL == (perm = (zbx_esc_trigger_perm_t *)zbx_hashset_search(&esc_cache.trigger_perms, &perm_local)))
+	{
+		zbx_vector_uint64_t	userids;
+
+		zbx_vector_uint64_create(&userids);
+		zbx_vector_uint64_append(&userids, userid);
+		esc_cache_load_trigger_perms(&userids, trigger);
+		zbx_vector_uint64_destroy(&userids);
+
+		if (NULL == (perm = (zbx_esc_trigger_perm_t *)zbx_hashset_search(&esc_cache.trigger_perms,
+				&perm_local)))
+		{
+			return FAIL;
+		}
+	}
+
+	return perm->ret;
+}
+
+static zbx_esc_operation_t	*esc_cache_get_operation(zbx_uint64_t operationid)
+{
+	zbx_esc_operation_t	*operation, operation_local;
+
+	if (NULL != (operation = (zbx_esc_operation_t *)zbx_hashset_search(&esc_cache.operations, &operationid)))
+		return operation;
+
+	memset(&operation_local, 0, sizeof(operation_local));
+	operation_local.operationid = operationid;
+
+	operation = (zbx_esc_operation_t *)zbx_hashset_insert(&esc_cache.operations, &operation_local,
+			sizeof(operation_local));
+	zbx_vector_uint64_create(&operation->userids);
+	zbx_vector_esc_opcondition_create(&operation->conditions);
+
+	return operation;
+}
+
+static const zbx_esc_operation_t	*esc_cache_get_operation_message(zbx_uint64_t operationid)
+{
+	zbx_esc_operation_t	*operation;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+
+	operation = esc_cache_get_operation(operationid);
+
+	if (0 != (operation->flags & ZBX_ESC_OPERATION_MESSAGE))
+		return operation;
+
+	result = zbx_db_select(
+			"select mediatypeid,default_msg,subject,message from opmessage where operationid=" ZBX_FS_UI64,
+			operationid);
+
+	if (NULL != (row = zbx_db_fetch(result)))
+	{
+		operation->message_found = 1;
+		ZBX_DBROW2UINT64(operation->mediatypeid, row[0]);
+		operation->default_msg = (1 == atoi(row[1]) ? 1 : 0);
+		operation->subject = zbx_strdup(NULL, row[2]);
+		operation->message = zbx_strdup(NULL, row[3]);
+	}
+	zbx_db_free_result(result);
+
+	operation->flags |= ZBX_ESC_OPERATION_MESSAGE;
+
+	return operation;
+}
+
+static const zbx_esc_operation_t	*esc_cache_get_operation_recipients(zbx_uint64_t operationid)
+{
+	zbx_esc_operation_t	*operation;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+
+	operation = esc_cache_get_operation(operationid);
+
+	if (0 != (operation->flags & ZBX_ESC_OPERATION_RECIPIENTS))
+		return operation;
+
+	result = zbx_db_select(
+			"select userid"
+			" from opmessage_usr"
+			" where operationid=" ZBX_FS_UI64
+			" union "
+			"select g.userid"
+			" from opmessage_grp m,users_groups g"
+			" where m.usrgrpid=g.usrgrpid"
+				" and m.operationid=" ZBX_FS_UI64,
+			operationid, operationid);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_uint64_t	userid;
+
+		ZBX_STR2UINT64(userid, row[0]);
+		zbx_vector_uint64_append(&operation->userids, userid);
+	}
+	zbx_db_free_result(result);
+
+	operation->flags |= ZBX_ESC_OPERATION_RECIPIENTS;
+
+	return operation;
+}
+
+static const zbx_esc_operation_t	*esc_cache_get_operation_conditions(zbx_uint64_t operationid)
+{
+	zbx_esc_operation_t	*operation;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+
+	operation = esc_cache_get_operation(operationid);
+
+	if (0 != (operation->flags & ZBX_ESC_OPERATION_CONDITIONS))
+		return operation;
+
+	result = zbx_db_select("select conditiontype,operator,value"
+				" from opconditions"
+				" where operationid=" ZBX_FS_UI64
+				" order by conditiontype",
+			operationid);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_esc_opcondition_t	condition;
+
+		ZBX_STR2UCHAR(condition.conditiontype, row[0]);
+		ZBX_STR2UCHAR(condition.op, row[1]);
+		condition.value = zbx_strdup(NULL, row[2]);
+		zbx_vector_esc_opcondition_append(&operation->conditions, condition);
+	}
+	zbx_db_free_result(result);
+
+	operation->flags |= ZBX_ESC_OPERATION_CONDITIONS;
+
+	return operation;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets media type messages for operation with default message       *
+ *                                                                            *
+ * Parameters: mediatypeid - [IN] operation media type, 0 for all media types *
+ *                                of user                                     *
+ *             userid      - [IN]                                             *
+ *             eventsource - [IN]                                             *
+ *             recovery    - [IN] operation mode                              *
+ *                                                                            *
+ * Comments: If media type is set, messages do not depend on user.            *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_esc_mediatype_msgs_t	*esc_cache_get_mediatype_msgs(zbx_uint64_t mediatypeid, zbx_uint64_t userid,
+		unsigned char eventsource, unsigned char recovery)
+{
+	zbx_esc_mediatype_msgs_t	*msgs, msgs_local;
+	zbx_db_result_t			result;
+	zbx_db_row_t			row;
+
+	msgs_local.mediatypeid = mediatypeid;
+	msgs_local.userid = (0 != mediatypeid ? 0 : userid);
+	msgs_local.eventsource = eventsource;
+	msgs_local.recovery = recovery;
+
+	if (NULL != (msgs = (zbx_esc_mediatype_msgs_t *)zbx_hashset_search(&esc_cache.mediatype_msgs, &msgs_local)))
+		return msgs;
+
+	msgs = (zbx_esc_mediatype_msgs_t *)zbx_hashset_insert(&esc_cache.mediatype_msgs, &msgs_local,
+			sizeof(msgs_local));
+	zbx_vector_esc_mediatype_msg_create(&msgs->messages);
+
+	if (0 != mediatypeid)
+	{
+		result = zbx_db_select("select mediatype_messageid,subject,message,mediatypeid from media_type_message"
+				" where eventsource=%d and recovery=%d and mediatypeid=" ZBX_FS_UI64,
+				eventsource, recovery, mediatypeid);
+	}
+	else
+	{
+		result = zbx_db_select(
+				"select mm.mediatype_messageid,mm.subject,mm.message,mt.mediatypeid from media_type mt"
+				" left join (select mediatypeid,subject,message,mediatype_messageid"
+				" from media_type_message where eventsource=%d and recovery=%d) mm"
+				" on mt.mediatypeid=mm.mediatypeid"
+				" join (select distinct mediatypeid from media where userid=" ZBX_FS_UI64 ") m"
+				" on mt.mediatypeid=m.mediatypeid",
+				eventsource, recovery, userid);
+	}
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_esc_mediatype_msg_t	msg;
+
+		ZBX_DBROW2UINT64(msg.mediatype_messageid, row[0]);
+		msg.subject = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(row[1]));
+		msg.message = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(row[2]));
+		ZBX_STR2UINT64(msg.mediatypeid, row[3]);
+		zbx_vector_esc_mediatype_msg_append(&msgs->messages, msg);
+	}
+	zbx_db_free_result(result);
+
+	return msgs;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets normal message and command operations of escalation step     *
+ *                                                                            *
+ * Parameters: actionid - [IN]                                                *
+ *             esc_step - [IN] escalation step                                *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_esc_step_t	*esc_cache_get_step(zbx_uint64_t actionid, int esc_step)
+{
+	zbx_esc_step_t	*step, step_local;
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+
+	step_local.ids.first = actionid;
+	step_local.ids.second = (zbx_uint64_t)esc_step;
+
+	if (NULL != (step = (zbx_esc_step_t *)zbx_hashset_search(&esc_cache.steps, &step_local)))
+		return step;
+
+	step_local.has_next = ZBX_ESC_STEP_NEXT_UNKNOWN;
+
+	step = (zbx_esc_step_t *)zbx_hashset_insert(&esc_cache.steps, &step_local, sizeof(step_local));
+	zbx_vector_esc_step_operation_create(&step->operations);
+
+	result = zbx_db_select(
+			"select o.operationid,o.operationtype,o.esc_period,o.evaltype"
+			" from operations o"
+			" where o.actionid=" ZBX_FS_UI64
+				" and o.operationtype in (%d,%d)"
+				" and o.esc_step_from<=%d"
+				" and (o.esc_step_to=0 or o.esc_step_to>=%d)"
+				" and o.recovery=%d",
+			actionid,
+			ZBX_OPERATION_TYPE_MESSAGE, ZBX_OPERATION_TYPE_COMMAND,
+			esc_step,
+			esc_step,
+			ZBX_OPERATION_MODE_NORMAL);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_esc_step_operation_t	operation;
+
+		ZBX_STR2UINT64(operation.operationid, row[0]);
+		operation.operationtype = atoi(row[1]);
+		operation.esc_period = zbx_strdup(NULL, row[2]);
+		ZBX_STR2UCHAR(operation.evaltype, row[3]);
+		zbx_vector_esc_step_operation_append(&step->operations, operation);
+	}
+	zbx_db_free_result(result);
+
+	return step;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if action has normal operations after escalation step      *
+ *                                                                            *
+ * Return value: SUCCEED - there are operations for next steps                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	esc_cache_step_has_next(zbx_esc_step_t *step)
+{
+	char		*sql;
+	zbx_db_result_t	result;
+
+	if (ZBX_ESC_STEP_NEXT_UNKNOWN != step->has_next)
+		return step->has_next;
+
+	sql = zbx_dsprintf(NULL,
+			"select null"
+			" from operations"
+			" where actionid=" ZBX_FS_UI64
+				" and (esc_step_to>%d or esc_step_to=0)"
+				" and recovery=%d",
+				step->ids.first, (int)step->ids.second, ZBX_OPERATION_MODE_NORMAL);
+	result = zbx_db_select_n(sql, 1);
+
+	step->has_next = (NULL != zbx_db_fetch(result) ? SUCCEED : FAIL);
+
+	zbx_db_free_result(result);
+	zbx_free(sql);
+
+	return step->has_next;
+}
+
 static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_event, zbx_uint64_t actionid,
 		int esc_step, zbx_uint64_t userid, zbx_uint64_t mediatypeid, const char *subject, const char *message,
 		const zbx_db_acknowledge *ack, const zbx_service_alarm_t *service_alarm, const zbx_db_service *service,
@@ -125,7 +1176,7 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
  *                                                                            *
  * Purpose: checks user access to event by tags                               *
  *                                                                            *
- * Parameters: userid       - [IN]                                            *
+ * Parameters: user         - [IN]                                            *
  *             hostgroupids - [IN] list of host groups in which trigger is to *
  *                                 be found                                   *
  *             event        - [IN] checked event for access                   *
@@ -134,47 +1185,23 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
  *               FAIL    - user does not have access                          *
  *                                                                            *
  ******************************************************************************/
-static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *hostgroupids,
+static int	check_tag_based_permission(const zbx_esc_user_t *user, const zbx_vector_uint64_t *hostgroupids,
 		zbx_db_event *event)
 {
-	char				*sql = NULL;
-	size_t				sql_alloc = 0, sql_offset = 0;
-	zbx_db_result_t			result;
-	zbx_db_row_t			row;
-	int				ret = FAIL;
-	zbx_vector_tag_filter_ptr_t	tag_filters;
-	zbx_tag_filter_t		*tag_filter;
-	zbx_condition_t			condition;
+	int			ret = FAIL;
+	const zbx_tag_filter_t	*tag_filter;
+	zbx_condition_t		condition;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_vector_tag_filter_ptr_create(&tag_filters);
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select tf.groupid,tf.tag,tf.value from tag_filter tf"
-			" join users_groups ug on ug.usrgrpid=tf.usrgrpid"
-				" where ug.userid=" ZBX_FS_UI64, userid);
-	result = zbx_db_select("%s order by tf.groupid", sql);
-
-	while (NULL != (row = zbx_db_fetch(result)))
-	{
-		tag_filter = (zbx_tag_filter_t *)zbx_malloc(NULL, sizeof(zbx_tag_filter_t));
-		ZBX_STR2UINT64(tag_filter->hostgroupid, row[0]);
-		tag_filter->tag = zbx_strdup(NULL, row[1]);
-		tag_filter->value = zbx_strdup(NULL, row[2]);
-		zbx_vector_tag_filter_ptr_append(&tag_filters, tag_filter);
-	}
-	zbx_free(sql);
-	zbx_db_free_result(result);
-
-	if (0 < tag_filters.values_num)
+	if (0 < user->tag_filters.values_num)
 		condition.op = ZBX_CONDITION_OPERATOR_EQUAL;
 	else
 		ret = SUCCEED;
 
-	for (int i = 0; i < tag_filters.values_num && SUCCEED != ret; i++)
+	for (int i = 0; i < user->tag_filters.values_num && SUCCEED != ret; i++)
 	{
-		tag_filter = (zbx_tag_filter_t *)tag_filters.values[i];
+		tag_filter = user->tag_filters.values[i];
 
 		if (FAIL == zbx_vector_uint64_search(hostgroupids, tag_filter->hostgroupid,
 				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
@@ -207,8 +1234,6 @@ static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *
 		else
 			ret = SUCCEED;
 	}
-	zbx_vector_tag_filter_ptr_clear_ext(&tag_filters, zbx_tag_filter_free);
-	zbx_vector_tag_filter_ptr_destroy(&tag_filters);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -226,78 +1251,27 @@ static int	check_tag_based_permission(zbx_uint64_t userid, zbx_vector_uint64_t *
 static int	check_trigger_permission(zbx_uint64_t userid, zbx_db_event *event, char **user_timezone)
 {
 	int			ret = FAIL;
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_uint64_t		roleid;
-	zbx_vector_uint64_t	hostgroupids, hgsetids;
-	zbx_db_result_t		result;
-	zbx_db_row_t		row;
+	const zbx_esc_user_t	*user;
+	const zbx_esc_trigger_t	*trigger;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_vector_uint64_create(&hgsetids);
+	user = esc_cache_get_user(userid);
+	*user_timezone = (NULL != user->timezone ? zbx_strdup(NULL, user->timezone) : NULL);
 
-	if (USER_TYPE_SUPER_ADMIN == zbx_get_user_info(userid, &roleid, user_timezone))
+	if (USER_TYPE_SUPER_ADMIN == user->type)
 	{
 		ret = SUCCEED;
 		goto out;
 	}
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select distinct hh.hgsetid from host_hgset hh"
-			" join items i on hh.hostid=i.hostid"
-			" join functions f on i.itemid=f.itemid"
-			" where f.triggerid=" ZBX_FS_UI64,
-			event->objectid);
-	zbx_db_select_uint64(sql, &hgsetids);
-
-	if (0 == hgsetids.values_num)
-		goto out;
-
-	zbx_vector_uint64_sort(&hgsetids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	sql_offset = 0;
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select count(*) from permission p"
-			" join user_ugset u on p.ugsetid=u.ugsetid"
-			" where u.userid=" ZBX_FS_UI64 " and", userid);
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "p.hgsetid", hgsetids.values, hgsetids.values_num);
-	result = zbx_db_select("%s", sql);
+	trigger = esc_cache_get_trigger(event->objectid);
 
-	if (NULL == (row = zbx_db_fetch(result)) || atoi(row[0]) != hgsetids.values_num)
-	{
-		zbx_db_free_result(result);
+	if (0 == trigger->hgsetids.values_num || SUCCEED != esc_cache_check_trigger_hgsets(userid, trigger))
 		goto out;
-	}
-
-	zbx_db_free_result(result);
-	zbx_vector_uint64_create(&hostgroupids);
-
-	result = zbx_db_select(
-			"select distinct hg.groupid from items i"
-			" join functions f on i.itemid=f.itemid"
-			" join hosts_groups hg on hg.hostid=i.hostid"
-				" and f.triggerid=" ZBX_FS_UI64,
-			event->objectid);
-
-	while (NULL != (row = zbx_db_fetch(result)))
-	{
-		zbx_uint64_t	hostgroupid;
-
-		ZBX_STR2UINT64(hostgroupid, row[0]);
-		zbx_vector_uint64_append(&hostgroupids, hostgroupid);
-	}
-	zbx_db_free_result(result);
-
-	zbx_vector_uint64_sort(&hostgroupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	ret = check_tag_based_permission(userid, &hostgroupids, event);
 
-	zbx_vector_uint64_destroy(&hostgroupids);
+	ret = check_tag_based_permission(user, &trigger->hostgroupids, event);
 out:
-	zbx_vector_uint64_destroy(&hgsetids);
-	zbx_free(sql);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -503,8 +1477,13 @@ static int	get_service_permission(zbx_uint64_t userid, char **user_timezone, con
 	zbx_ipc_message_t	response;
 	zbx_vector_uint64_t	parent_ids;
 	zbx_service_role_t	role_local, *role;
+	const zbx_esc_user_t	*esc_user;
 
-	user.type = zbx_get_user_info(userid, &user.roleid, user_timezone);
+	esc_user = esc_cache_get_user(userid);
+
+	user.type = esc_user->type;
+	user.roleid = esc_user->roleid;
+	*user_timezone = (NULL != esc_user->timezone ? zbx_strdup(NULL, esc_user->timezone) : NULL);
 
 	role_local.roleid = user.roleid;
 
@@ -647,10 +1626,10 @@ static void	add_user_msgs(zbx_uint64_t userid, zbx_uint64_t operationid, zbx_uin
 		const zbx_db_service *service, int macro_type, unsigned char evt_src, unsigned char op_mode,
 		const char *default_timezone, const char *user_timezone)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	zbx_uint64_t	mtid;
-	const char	*tz;
+	zbx_uint64_t				mtid;
+	const char				*tz;
+	const zbx_esc_operation_t		*operation;
+	const zbx_esc_mediatype_msgs_t		*msgs;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -659,61 +1638,36 @@ static void	add_user_msgs(zbx_uint64_t userid, zbx_uint64_t operationid, zbx_uin
 	else
 		tz = user_timezone;
 
-	result = zbx_db_select(
-			"select mediatypeid,default_msg,subject,message from opmessage where operationid=" ZBX_FS_UI64,
-			operationid);
-
-	if (NULL != (row = zbx_db_fetch(result)))
-	{
-		if (0 == mediatypeid)
-			ZBX_DBROW2UINT64(mediatypeid, row[0]);
-
-		if (1 != atoi(row[1]))
-		{
-			add_user_msg(userid, mediatypeid, user_msg, row[2], row[3], actionid, event, r_event, ack,
-					service_alarm, service, ZBX_MACRO_EXPAND_YES, macro_type,
-					ZBX_ALERT_MESSAGE_ERR_NONE, tz);
-			goto out;
-		}
+	operation = esc_cache_get_operation_message(operationid);
 
-		zbx_db_free_result(result);
-	}
-	else
+	if (0 == operation->message_found)
 		goto out;
 
-	mtid = mediatypeid;
-
-	if (0 != mediatypeid)
-	{
-		result = zbx_db_select("select mediatype_messageid,subject,message,mediatypeid from media_type_message"
-				" where eventsource=%d and recovery=%d and mediatypeid=" ZBX_FS_UI64,
-				evt_src, op_mode, mediatypeid);
+	if (0 == mediatypeid)
+		mediatypeid = operation->mediatypeid;
 
-		mediatypeid = 0;
-	}
-	else
+	if (1 != operation->default_msg)
 	{
-		result = zbx_db_select(
-				"select mm.mediatype_messageid,mm.subject,mm.message,mt.mediatypeid from media_type mt"
-				" left join (select mediatypeid,subject,message,mediatype_messageid"
-				" from media_type_message where eventsource=%d and recovery=%d) mm"
-				" on mt.mediatypeid=mm.mediatypeid"
-				" join (select distinct mediatypeid from media where userid=" ZBX_FS_UI64 ") m"
-				" on mt.mediatypeid=m.mediatypeid",
-				evt_src, op_mode, userid);
+		add_user_msg(userid, mediatypeid, user_msg, operation->subject, operation->message, actionid, event,
+				r_event, ack, service_alarm, service, ZBX_MACRO_EXPAND_YES, macro_type,
+				ZBX_ALERT_MESSAGE_ERR_NONE, tz);
+		goto out;
 	}
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	mtid = mediatypeid;
+	msgs = esc_cache_get_mediatype_msgs(mediatypeid, userid, evt_src, op_mode);
+	mediatypeid = 0;
+
+	for (int i = 0; i < msgs->messages.values_num; i++)
 	{
-		zbx_uint64_t	mtmid;
+		const zbx_esc_mediatype_msg_t	*msg = &msgs->messages.values[i];
 
-		ZBX_DBROW2UINT64(mtmid, row[0]);
-		ZBX_STR2UINT64(mediatypeid, row[3]);
+		mediatypeid = msg->mediatypeid;
 
-		if (0 != mtmid)
+		if (0 != msg->mediatype_messageid)
 		{
-			add_user_msg(userid, mediatypeid, user_msg, row[1], row[2], actionid, event, r_event, ack,
-					service_alarm, service, ZBX_MACRO_EXPAND_YES, macro_type,
+			add_user_msg(userid, mediatypeid, user_msg, msg->subject, msg->message, actionid, event,
+					r_event, ack, service_alarm, service, ZBX_MACRO_EXPAND_YES, macro_type,
 					ZBX_ALERT_MESSAGE_ERR_NONE, tz);
 		}
 		else
@@ -730,8 +1684,6 @@ static void	add_user_msgs(zbx_uint64_t userid, zbx_uint64_t operationid, zbx_uin
 				0 == mtid ? ZBX_ALERT_MESSAGE_ERR_USR : ZBX_ALERT_MESSAGE_ERR_MSG, tz);
 	}
 out:
-	zbx_db_free_result(result);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -740,34 +1692,28 @@ static void	add_object_msg(zbx_uint64_t actionid, zbx_uint64_t operationid, zbx_
 		const zbx_service_alarm_t *service_alarm, const zbx_db_service *service, int macro_type,
 		unsigned char evt_src, unsigned char op_mode, const char *default_timezone, zbx_hashset_t *roles)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
+	const zbx_esc_operation_t	*operation;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	result = zbx_db_select(
-			"select userid"
-			" from opmessage_usr"
-			" where operationid=" ZBX_FS_UI64
-			" union "
-			"select g.userid"
-			" from opmessage_grp m,users_groups g"
-			" where m.usrgrpid=g.usrgrpid"
-				" and m.operationid=" ZBX_FS_UI64,
-			operationid, operationid);
+	operation = esc_cache_get_operation_recipients(operationid);
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	/* prefetch all recipients of operation and their access to trigger with single set of queries */
+	esc_cache_load_users(&operation->userids);
+
+	if (EVENT_OBJECT_TRIGGER == event->object)
+		esc_cache_load_trigger_perms(&operation->userids, esc_cache_get_trigger(event->objectid));
+
+	for (int i = 0; i < operation->userids.values_num; i++)
 	{
-		zbx_uint64_t	userid;
+		zbx_uint64_t	userid = operation->userids.values[i];
 		char		*user_timezone = NULL;
 
-		ZBX_STR2UINT64(userid, row[0]);
-
 		/* exclude acknowledgment author from the recipient list */
 		if (NULL != ack && ack->userid == userid)
 			continue;
 
-		if (SUCCEED != zbx_db_check_user_perm2system(userid))
+		if (SUCCEED != esc_check_user_perm2system(userid))
 			continue;
 
 		switch (event->object)
@@ -786,7 +1732,7 @@ static void	add_object_msg(zbx_uint64_t actionid, zbx_uint64_t operationid, zbx_
 					goto clean;
 				break;
 			default:
-				user_timezone = zbx_db_get_user_timezone(userid);
+				user_timezone = esc_get_user_timezone(userid);
 		}
 
 		add_user_msgs(userid, operationid, 0, user_msg, actionid, event, r_event, ack, service_alarm, service,
@@ -794,7 +1740,6 @@ static void	add_object_msg(zbx_uint64_t actionid, zbx_uint64_t operationid, zbx_
 clean:
 		zbx_free(user_timezone);
 	}
-	zbx_db_free_result(result);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -832,6 +1777,8 @@ static void	add_sentusers_msg(zbx_user_msg_t **user_msg, zbx_uint64_t actionid,
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	esc_cache_flush_alerts();
+
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select distinct userid,mediatypeid"
 			" from alerts"
@@ -868,7 +1815,7 @@ static void	add_sentusers_msg(zbx_user_msg_t **user_msg, zbx_uint64_t actionid,
 		if (NULL != ack && ack->userid == userid)
 			continue;
 
-		if (SUCCEED != zbx_db_check_user_perm2system(userid))
+		if (SUCCEED != esc_check_user_perm2system(userid))
 			continue;
 
 		ZBX_STR2UINT64(mediatypeid, row[1]);
@@ -889,7 +1836,7 @@ static void	add_sentusers_msg(zbx_user_msg_t **user_msg, zbx_uint64_t actionid,
 					goto clean;
 				break;
 			default:
-				user_timezone = zbx_db_get_user_timezone(userid);
+				user_timezone = esc_get_user_timezone(userid);
 		}
 
 		add_user_msgs(userid, operationid, mediatypeid, user_msg, actionid, event, r_event, ack, service_alarm,
@@ -932,6 +1879,8 @@ static void	add_sentusers_msg_esc_cancel(zbx_user_msg_t **user_msg, zbx_uint64_t
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	esc_cache_flush_alerts();
+
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select userid,mediatypeid,subject,message,esc_step"
 			" from alerts"
@@ -966,7 +1915,7 @@ static void	add_sentusers_msg_esc_cancel(zbx_user_msg_t **user_msg, zbx_uint64_t
 		mediatypeid_prev = mediatypeid;
 		esc_step_prev = esc_step;
 
-		if (SUCCEED != zbx_db_check_user_perm2system(userid))
+		if (SUCCEED != esc_check_user_perm2system(userid))
 			continue;
 
 		switch (event->object)
@@ -985,7 +1934,7 @@ static void	add_sentusers_msg_esc_cancel(zbx_user_msg_t **user_msg, zbx_uint64_t
 					goto clean;
 				break;
 			default:
-				user_timezone = zbx_db_get_user_timezone(userid);
+				user_timezone = esc_get_user_timezone(userid);
 		}
 
 		message_dyn = zbx_dsprintf(NULL, "NOTE: Escalation canceled: %s\nLast message sent:\n%s", error,
@@ -1048,7 +1997,7 @@ static void	add_sentusers_ack_msg(zbx_user_msg_t **user_msg, zbx_uint64_t action
 		if (ack->userid == userid)
 			continue;
 
-		if (SUCCEED != zbx_db_check_user_perm2system(userid))
+		if (SUCCEED != esc_check_user_perm2system(userid))
 			continue;
 
 		if (SUCCEED != check_trigger_permission(userid, event, &user_timezone))
@@ -1618,13 +2567,12 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 		const zbx_db_acknowledge *ack, const zbx_service_alarm_t *service_alarm, const zbx_db_service *service,
 		int err_type, const char *tz)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	int		now, priority, have_alerts = 0;
-	zbx_db_insert_t	db_insert;
-	zbx_uint64_t	ackid;
-	char		*period = NULL;
-	const char	*error;
+	int			now, priority, media_found = 0;
+	zbx_db_insert_t		*db_insert;
+	zbx_uint64_t		ackid;
+	char			*period = NULL;
+	const char		*error;
+	const zbx_esc_user_t	*user;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1634,27 +2582,7 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 	if (ZBX_ALERT_MESSAGE_ERR_USR == err_type)
 		goto err_alert;
 
-	if (0 == mediatypeid)
-	{
-		result = zbx_db_select(
-				"select m.mediatypeid,m.sendto,m.severity,m.period,mt.status,m.active,mt.type"
-				" from media m,media_type mt"
-				" where m.mediatypeid=mt.mediatypeid"
-					" and m.userid=" ZBX_FS_UI64,
-				userid);
-	}
-	else
-	{
-		result = zbx_db_select(
-				"select m.mediatypeid,m.sendto,m.severity,m.period,mt.status,m.active,mt.type"
-				" from media m,media_type mt"
-				" where m.mediatypeid=mt.mediatypeid"
-					" and m.userid=" ZBX_FS_UI64
-					" and m.mediatypeid=" ZBX_FS_UI64,
-				userid, mediatypeid);
-	}
-
-	mediatypeid = 0;
+	user = esc_cache_get_user(userid);
 
 	if (EVENT_SOURCE_TRIGGERS == event->source)
 		priority = event->trigger.priority;
@@ -1663,30 +2591,33 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 	else
 		priority = TRIGGER_SEVERITY_NOT_CLASSIFIED;
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	for (int i = 0; i < user->media.values_num; i++)
 	{
-		int		severity, status, type, res;
-		const char	*perror;
-		char		*params;
+		int			status, res;
+		const char		*perror;
+		char			*params;
+		const zbx_esc_media_t	*media = user->media.values[i];
 
-		ZBX_STR2UINT64(mediatypeid, row[0]);
-		severity = atoi(row[2]);
-		period = zbx_strdup(period, row[3]);
-		type = atoi(row[6]);
+		if (0 != mediatypeid && media->mediatypeid != mediatypeid)
+			continue;
+
+		media_found = 1;
+
+		period = zbx_strdup(period, media->period);
 
 		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 				&period, ZBX_MACRO_TYPE_COMMON, NULL, 0);
 
 		zabbix_log(LOG_LEVEL_DEBUG, "severity:%d, media severity:%d, period:'%s', userid:" ZBX_FS_UI64,
-				priority, severity, period, userid);
+				priority, media->severity, period, userid);
 
-		if (MEDIA_STATUS_DISABLED == atoi(row[5]))
+		if (MEDIA_STATUS_DISABLED == media->active)
 		{
 			zabbix_log(LOG_LEVEL_DEBUG, "will not send message (user media disabled)");
 			continue;
 		}
 
-		if (0 == ((1 << priority) & severity))
+		if (0 == ((1 << priority) & media->severity))
 		{
 			zabbix_log(LOG_LEVEL_DEBUG, "will not send message (severity)");
 			continue;
@@ -1702,7 +2633,7 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 			zabbix_log(LOG_LEVEL_DEBUG, "will not send message (period)");
 			continue;
 		}
-		else if (MEDIA_TYPE_STATUS_DISABLED == atoi(row[4]))
+		else if (MEDIA_TYPE_STATUS_DISABLED == media->mediatype_status)
 		{
 			status = ALERT_STATUS_FAILED;
 			perror = "Media type disabled.";
@@ -1718,37 +2649,30 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 			perror = "";
 		}
 
-		if (0 == have_alerts)
-		{
-			have_alerts = 1;
-			zbx_db_insert_prepare(&db_insert, "alerts", "alertid", "actionid", "eventid", "userid",
-					"clock", "mediatypeid", "sendto", "subject", "message", "status", "error",
-					"esc_step", "alerttype", "acknowledgeid", "parameters",
-					(NULL != r_event ? "p_eventid" : NULL), (char *)NULL);
-		}
-
-		if (MEDIA_TYPE_EXEC == type)
+		if (MEDIA_TYPE_EXEC == media->mediatype_type)
 		{
-			get_mediatype_params_array(event, r_event, actionid, userid, mediatypeid, row[1], subject,
-					message, ack, service_alarm, service, &params, tz);
+			get_mediatype_params_array(event, r_event, actionid, userid, media->mediatypeid, media->sendto,
+					subject, message, ack, service_alarm, service, &params, tz);
 		}
 		else
 		{
-			get_mediatype_params_object(event, r_event, actionid, userid, mediatypeid, row[1], subject,
-					message, ack, service_alarm, service, &params, tz);
+			get_mediatype_params_object(event, r_event, actionid, userid, media->mediatypeid,
+					media->sendto, subject, message, ack, service_alarm, service, &params, tz);
 		}
 
+		db_insert = esc_cache_get_alert_insert(0, NULL != r_event);
+
 		if (NULL != r_event)
 		{
-			zbx_db_insert_add_values(&db_insert, __UINT64_C(0), actionid, r_event->eventid, userid,
-					now, mediatypeid, row[1], subject, message, status, perror, esc_step,
-					(int)ALERT_TYPE_MESSAGE, ackid, params, event->eventid);
+			zbx_db_insert_add_values(db_insert, __UINT64_C(0), actionid, r_event->eventid, userid,
+					now, media->mediatypeid, media->sendto, subject, message, status, perror,
+					esc_step, (int)ALERT_TYPE_MESSAGE, ackid, params, event->eventid);
 		}
 		else
 		{
-			zbx_db_insert_add_values(&db_insert, __UINT64_C(0), actionid, event->eventid, userid,
-					now, mediatypeid, row[1], subject, message, status, perror, esc_step,
-					(int)ALERT_TYPE_MESSAGE, ackid, params);
+			zbx_db_insert_add_values(db_insert, __UINT64_C(0), actionid, event->eventid, userid,
+					now, media->mediatypeid, media->sendto, subject, message, status, perror,
+					esc_step, (int)ALERT_TYPE_MESSAGE, ackid, params);
 		}
 
 		zbx_free(params);
@@ -1756,41 +2680,29 @@ static void	add_message_alert(const zbx_db_event *event, const zbx_db_event *r_e
 
 	zbx_free(period);
 
-	zbx_db_free_result(result);
-
-	if (0 == mediatypeid)
+	if (0 == media_found)
 	{
 err_alert:
-		have_alerts = 1;
 		error = "No media defined for user.";
 
-		zbx_db_insert_prepare(&db_insert, "alerts", "alertid", "actionid", "eventid", "userid", "clock",
-				"subject", "message", "status", "retries", "error", "esc_step", "alerttype",
-				"acknowledgeid", (NULL != r_event ? "p_eventid" : NULL), (char *)NULL);
+		db_insert = esc_cache_get_alert_insert(1, NULL != r_event);
 
 		if (NULL != r_event)
 		{
 /* max number of retries for alerts */
 #define ALERT_MAX_RETRIES	3
-			zbx_db_insert_add_values(&db_insert, __UINT64_C(0), actionid, r_event->eventid, userid,
+			zbx_db_insert_add_values(db_insert, __UINT64_C(0), actionid, r_event->eventid, userid,
 					now, subject, message, (int)ALERT_STATUS_FAILED, (int)ALERT_MAX_RETRIES, error,
 					esc_step, (int)ALERT_TYPE_MESSAGE, ackid, event->eventid);
 		}
 		else
 		{
-			zbx_db_insert_add_values(&db_insert, __UINT64_C(0), actionid, event->eventid, userid,
+			zbx_db_insert_add_values(db_insert, __UINT64_C(0), actionid, event->eventid, userid,
 					now, subject, message, (int)ALERT_STATUS_FAILED, (int)ALERT_MAX_RETRIES, error,
 					esc_step, (int)ALERT_TYPE_MESSAGE, ackid);
 		}
 	}
 
-	if (0 != have_alerts)
-	{
-		zbx_db_insert_autoincrement(&db_insert, "alertid");
-		zbx_db_insert_execute(&db_insert);
-		zbx_db_insert_clean(&db_insert);
-	}
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -1807,10 +2719,9 @@ err_alert:
  ******************************************************************************/
 static int	check_operation_conditions(zbx_db_event *event, zbx_uint64_t operationid, unsigned char evaltype)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	int		exit = 0, ret = SUCCEED;	/* SUCCEED required for ZBX_CONDITION_EVAL_TYPE_AND_OR */
-	unsigned char	old_type = 0xff;
+	int				exit = 0, ret = SUCCEED;	/* SUCCEED required for ZBX_CONDITION_EVAL_TYPE_AND_OR */
+	unsigned char			old_type = 0xff;
+	const zbx_esc_operation_t	*operation;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() operationid:" ZBX_FS_UI64, __func__, operationid);
 
@@ -1818,21 +2729,17 @@ static int	check_operation_conditions(zbx_db_event *event, zbx_uint64_t operatio
 	if (EVENT_SOURCE_SERVICE == event->source)
 		goto succeed;
 
-	result = zbx_db_select("select conditiontype,operator,value"
-				" from opconditions"
-				" where operationid=" ZBX_FS_UI64
-				" order by conditiontype",
-			operationid);
+	operation = esc_cache_get_operation_conditions(operationid);
 
-	while (NULL != (row = zbx_db_fetch(result)) && 0 == exit)
+	for (int i = 0; i < operation->conditions.values_num && 0 == exit; i++)
 	{
 		int		cond;
 		zbx_condition_t	condition;
 
 		memset(&condition, 0, sizeof(condition));
-		condition.conditiontype	= (unsigned char)atoi(row[0]);
-		condition.op = (unsigned char)atoi(row[1]);
-		condition.value = row[2];
+		condition.conditiontype	= operation->conditions.values[i].conditiontype;
+		condition.op = operation->conditions.values[i].op;
+		condition.value = operation->conditions.values[i].value;
 		zbx_vector_uint64_create(&condition.eventids);
 
 		switch (evaltype)
@@ -1883,7 +2790,6 @@ static int	check_operation_conditions(zbx_db_event *event, zbx_uint64_t operatio
 
 		zbx_vector_uint64_destroy(&condition.eventids);
 	}
-	zbx_db_free_result(result);
 succeed:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1896,38 +2802,23 @@ static void	escalation_execute_operations(zbx_db_escalation *escalation, zbx_db_
 		const char *config_ssh_key_location, zbx_get_config_forks_f get_config_forks,
 		int config_enable_global_scripts, unsigned char program_type)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
 	int		next_esc_period = 0, esc_period, default_esc_period;
 	zbx_user_msg_t	*user_msg = NULL;
+	zbx_esc_step_t	*step;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	default_esc_period = 0 == action->esc_period ? SEC_PER_HOUR : action->esc_period;
 	escalation->esc_step++;
 
-	result = zbx_db_select(
-			"select o.operationid,o.operationtype,o.esc_period,o.evaltype"
-			" from operations o"
-			" where o.actionid=" ZBX_FS_UI64
-				" and o.operationtype in (%d,%d)"
-				" and o.esc_step_from<=%d"
-				" and (o.esc_step_to=0 or o.esc_step_to>=%d)"
-				" and o.recovery=%d",
-			action->actionid,
-			ZBX_OPERATION_TYPE_MESSAGE, ZBX_OPERATION_TYPE_COMMAND,
-			escalation->esc_step,
-			escalation->esc_step,
-			ZBX_OPERATION_MODE_NORMAL);
+	step = esc_cache_get_step(action->actionid, escalation->esc_step);
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	for (int i = 0; i < step->operations.values_num; i++)
 	{
 		char		*tmp;
-		zbx_uint64_t	operationid;
-
-		ZBX_STR2UINT64(operationid, row[0]);
+		zbx_uint64_t	operationid = step->operations.values[i].operationid;
 
-		tmp = zbx_strdup(NULL, row[2]);
+		tmp = zbx_strdup(NULL, step->operations.values[i].esc_period);
 		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 				&tmp, ZBX_MACRO_TYPE_COMMON, NULL, 0);
 
@@ -1945,11 +2836,11 @@ static void	escalation_execute_operations(zbx_db_escalation *escalation, zbx_db_
 		if (0 == next_esc_period || next_esc_period > esc_period)
 			next_esc_period = esc_period;
 
-		if (SUCCEED == check_operation_conditions(event, operationid, (unsigned char)atoi(row[3])))
+		if (SUCCEED == check_operation_conditions(event, operationid, step->operations.values[i].evaltype))
 		{
 			zabbix_log(LOG_LEVEL_DEBUG, "Conditions match our event. Execute operation.");
 
-			switch (atoi(row[1]))
+			switch (step->operations.values[i].operationtype)
 			{
 				case ZBX_OPERATION_TYPE_MESSAGE:
 					add_object_msg(action->actionid, operationid, &user_msg, event, NULL, NULL,
@@ -1969,25 +2860,13 @@ static void	escalation_execute_operations(zbx_db_escalation *escalation, zbx_db_
 		else
 			zabbix_log(LOG_LEVEL_DEBUG, "Conditions do not match our event. Do not execute operation.");
 	}
-	zbx_db_free_result(result);
 
 	flush_user_msg(&user_msg, escalation->esc_step, event, NULL, action->actionid, NULL, NULL, service);
 
 	if (EVENT_SOURCE_TRIGGERS == action->eventsource || EVENT_SOURCE_INTERNAL == action->eventsource ||
 			EVENT_SOURCE_SERVICE == action->eventsource)
 	{
-		char	*sql;
-
-		sql = zbx_dsprintf(NULL,
-				"select null"
-				" from operations"
-				" where actionid=" ZBX_FS_UI64
-					" and (esc_step_to>%d or esc_step_to=0)"
-					" and recovery=%d",
-					action->actionid, escalation->esc_step, ZBX_OPERATION_MODE_NORMAL);
-		result = zbx_db_select_n(sql, 1);
-
-		if (NULL != zbx_db_fetch(result))
+		if (SUCCEED == esc_cache_step_has_next(step))
 		{
 			next_esc_period = (0 != next_esc_period ? next_esc_period : default_esc_period);
 			escalation->nextcheck = time(NULL) + next_esc_period;
@@ -1999,9 +2878,6 @@ static void	escalation_execute_operations(zbx_db_escalation *escalation, zbx_db_
 		}
 		else
 			escalation->status = ESCALATION_STATUS_COMPLETED;
-
-		zbx_db_free_result(result);
-		zbx_free(sql);
 	}
 	else
 		escalation->status = ESCALATION_STATUS_COMPLETED;
@@ -2325,6 +3201,8 @@ static int	check_unfinished_alerts(const zbx_db_escalation *escalation)
 	if (0 == escalation->r_eventid)
 		return SUCCEED;
 
+	esc_cache_flush_alerts();
+
 	sql = zbx_dsprintf(NULL,
 			"select eventid"
 			" from alerts"
@@ -3077,9 +3955,11 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalat
 	add_ack_escalation_r_eventids(escalations, eventids, &event_pairs);
 
 	um_handle = zbx_dc_open_user_macros();
+	esc_cache_init();
 
 	get_db_actions_info(actionids, &actions);
 	zbx_db_get_events_by_eventids(eventids, &events);
+	esc_cache_prefetch_triggers(&events);
 
 	zbx_db_select_symptom_eventids(problem_eventids, &symptom_eventids);
 	zbx_vector_uint64_sort(&symptom_eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
@@ -3308,6 +4188,8 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalat
 #		undef ZBX_ESCALATION_UNSET
 	}
 
+	esc_cache_flush_alerts();
+
 	if (0 == diffs.values_num && 0 == escalationids.values_num)
 		goto out;
 
@@ -3389,6 +4271,7 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalat
 
 	zbx_db_commit();
 out:
+	esc_cache_destroy();
 	zbx_dc_close_user_macros(um_handle);
 
 	zbx_vector_escalation_diff_ptr_clear_ext(&diffs, (void (*)(zbx_escalation_diff_t *))zbx_ptr_free);
@@ -33,6 +33,7 @@
 #include "zbxconnector.h"
 #include "zbxtagfilter.h"
 #include "zbxescalations.h"
+#include "zbxevent.h"
 
 /* event recovery data */
 typedef struct
@@ -47,16 +48,6 @@ typedef struct
 }
 zbx_event_recovery_t;
 
-/* problem event, used to cache open problems for recovery attempts */
-typedef struct
-{
-	zbx_uint64_t		eventid;
-	zbx_uint64_t		triggerid;
-
-	zbx_vector_tags_ptr_t	tags;
-}
-zbx_event_problem_t;
-
 typedef enum
 {
 	CORRELATION_MATCH = 0,
@@ -70,6 +61,9 @@ static zbx_hashset_t		event_recovery;
 static zbx_hashset_t		correlation_cache;
 static zbx_correlation_rules_t	correlation_rules;
 
+/* triggers with problems updated in problem cache by the current transaction */
+static zbx_vector_uint64_t	problem_cache_triggerids;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Check that tag name is not empty and that tag is not duplicate.   *
@@ -620,6 +614,54 @@ static void	save_event_recovery(void)
 	zbx_free(sql);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates problem cache with new and recovered trigger problems     *
+ *                                                                            *
+ * Comments: The problem cache is updated before transaction is committed     *
+ *           while triggers are still locked. If the transaction fails, the   *
+ *           affected triggers are removed from problem cache by              *
+ *           zbx_clean_events().                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	update_problem_cache(void)
+{
+	zbx_vector_db_event_t	problem_events;
+	zbx_vector_uint64_t	r_eventids;
+	zbx_event_recovery_t	*recovery;
+	zbx_hashset_iter_t	iter;
+
+	zbx_vector_db_event_create(&problem_events);
+	zbx_vector_uint64_create(&r_eventids);
+
+	for (int i = 0; i < events.values_num; i++)
+	{
+		zbx_db_event	*event = events.values[i];
+
+		if (0 == (event->flags & ZBX_FLAGS_DB_EVENT_CREATE) || EVENT_SOURCE_TRIGGERS != event->source ||
+				EVENT_OBJECT_TRIGGER != event->object || TRIGGER_VALUE_PROBLEM != event->value)
+		{
+			continue;
+		}
+
+		zbx_vector_db_event_append(&problem_events, event);
+		zbx_vector_uint64_append(&problem_cache_triggerids, event->objectid);
+	}
+
+	zbx_hashset_iter_reset(&event_recovery, &iter);
+	while (NULL != (recovery = (zbx_event_recovery_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_uint64_append(&r_eventids, recovery->eventid);
+		zbx_vector_uint64_append(&problem_cache_triggerids, recovery->objectid);
+	}
+
+	if (0 != problem_events.values_num || 0 != r_eventids.values_num)
+		zbx_problem_cache_update(&problem_events, &r_eventids);
+
+	zbx_vector_uint64_destroy(&r_eventids);
+	zbx_vector_db_event_destroy(&problem_events);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: find event index by its source object                             *
@@ -1684,6 +1726,7 @@ void	zbx_initialize_events(void)
 	zbx_vector_db_event_create(&events);
 	zbx_hashset_create(&event_recovery, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	zbx_hashset_create(&correlation_cache, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_create(&problem_cache_triggerids);
 
 	zbx_dc_correlation_rules_init(&correlation_rules);
 }
@@ -1698,6 +1741,7 @@ void	zbx_uninitialize_events(void)
 	zbx_vector_db_event_destroy(&events);
 	zbx_hashset_destroy(&event_recovery);
 	zbx_hashset_destroy(&correlation_cache);
+	zbx_vector_uint64_destroy(&problem_cache_triggerids);
 
 	zbx_dc_correlation_rules_free(&correlation_rules);
 }
@@ -1743,6 +1787,19 @@ static void	zbx_clean_event(zbx_db_event *event)
  ******************************************************************************/
 void	zbx_clean_events(void)
 {
+	if (0 != problem_cache_triggerids.values_num)
+	{
+		/* drop problems cached by failed transaction */
+		if (ZBX_DB_OK != zbx_db_txn_end_error())
+		{
+			zbx_vector_uint64_sort(&problem_cache_triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+			zbx_vector_uint64_uniq(&problem_cache_triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+			zbx_problem_cache_invalidate_triggers(&problem_cache_triggerids);
+		}
+
+		zbx_vector_uint64_clear(&problem_cache_triggerids);
+	}
+
 	zbx_vector_db_event_clear_ext(&events, zbx_clean_event);
 
 	zbx_reset_event_recovery();
@@ -2181,6 +2238,7 @@ static int	flush_events(zbx_vector_escalation_new_ptr_t *escalations)
 	save_problems();
 	save_event_recovery();
 	update_event_suppress_data();
+	update_problem_cache();
 
 	zbx_vector_uint64_pair_create(&closed_events);
 
@@ -2384,6 +2442,9 @@ static void	process_internal_events_without_actions(zbx_vector_ptr_t *internal_p
  * Parameters: triggerids - [IN] trigger identifiers (sorted)                 *
  *             problems   - [OUT]                                             *
  *                                                                            *
+ * Comments: Problems are taken from problem cache, problems of triggers not  *
+ *           found in cache are loaded from database and cached.              *
+ *                                                                            *
  ******************************************************************************/
 static void	get_open_problems(const zbx_vector_uint64_t *triggerids, zbx_vector_ptr_t *problems)
 {
@@ -2393,16 +2454,26 @@ static void	get_open_problems(const zbx_vector_uint64_t *triggerids, zbx_vector_
 	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_event_problem_t	*problem;
 	zbx_tag_t		*tag;
-	zbx_uint64_t		eventid;
+	zbx_uint64_t		eventid, revision;
 	int			index;
-	zbx_vector_uint64_t	eventids;
+	zbx_vector_uint64_t	eventids, triggerids_miss;
 
 	zbx_vector_uint64_create(&eventids);
+	zbx_vector_uint64_create(&triggerids_miss);
+
+	revision = zbx_problem_cache_get(triggerids, problems, &triggerids_miss);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() triggers:%d cached:%d", __func__, triggerids->values_num,
+			triggerids->values_num - triggerids_miss.values_num);
+
+	if (0 == triggerids_miss.values_num)
+		goto out;
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select eventid,objectid from problem where source=%d and object=%d and",
 			EVENT_SOURCE_TRIGGERS, EVENT_OBJECT_TRIGGER);
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "objectid", triggerids->values, triggerids->values_num);
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "objectid", triggerids_miss.values,
+			triggerids_miss.values_num);
 	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and r_eventid is null");
 
 	result = zbx_db_select("%s", sql);
@@ -2420,7 +2491,7 @@ static void	get_open_problems(const zbx_vector_uint64_t *triggerids, zbx_vector_
 	}
 	zbx_db_free_result(result);
 
-	if (0 != problems->values_num)
+	if (0 != eventids.values_num)
 	{
 		zbx_vector_ptr_sort(problems, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 		zbx_vector_uint64_sort(&eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
@@ -2451,8 +2522,13 @@ static void	get_open_problems(const zbx_vector_uint64_t *triggerids, zbx_vector_
 		zbx_db_free_result(result);
 	}
 
+	/* incomplete problems must not be cached if database query failed */
+	if (ZBX_DB_OK == zbx_db_txn_error())
+		zbx_problem_cache_set(&triggerids_miss, problems, revision);
+out:
 	zbx_free(sql);
 
+	zbx_vector_uint64_destroy(&triggerids_miss);
 	zbx_vector_uint64_destroy(&eventids);
 }
 
@@ -2611,6 +2687,7 @@ static void	process_trigger_events(const zbx_vector_ptr_t *trigger_events,
 	if (0 != triggerids.values_num)
 	{
 		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 		get_open_problems(&triggerids, &problems);
 	}
 
@@ -0,0 +1,413 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "history_partition.h"
+
+#include "zbxdbhigh.h"
+#include "zbxdb.h"
+#include "zbxstr.h"
+#include "zbxalgo.h"
+
+/* the number of partitions created ahead of the current one */
+#define HK_PARTITIONS_AHEAD	7
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses partition upper bound                                      *
+ *                                                                            *
+ * Parameters: bound - [IN] clock value or MAXVALUE, optionally followed by   *
+ *                          closing parenthesis                               *
+ *                                                                            *
+ * Return value: partition upper bound or HK_PARTITION_MAXVALUE if the        *
+ *               partition range has no upper bound                           *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_parse_bound(const char *bound)
+{
+	return 0 != isdigit((unsigned char)*bound) ? atoi(bound) : HK_PARTITION_MAXVALUE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if partition contains only expired data                    *
+ *                                                                            *
+ * Parameters: to        - [IN] partition upper bound (exclusive)             *
+ *             keep_from - [IN] the oldest clock value to keep                *
+ *                                                                            *
+ * Return value: SUCCEED - partition can be dropped                           *
+ *               FAIL    - partition can contain values to keep               *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_is_expired(int to, int keep_from)
+{
+	return HK_PARTITION_MAXVALUE != to && to <= keep_from ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets clock ranges of partitions to be created                     *
+ *                                                                            *
+ * Parameters: last_to - [IN] upper bound of the last existing partition,     *
+ *                            0 if there are no partitions                    *
+ *             period  - [IN] partition length in seconds                     *
+ *             now     - [IN] current timestamp                               *
+ *             ranges  - [OUT] clock ranges (first - inclusive start,         *
+ *                             second - exclusive end)                        *
+ *                                                                            *
+ * Comments: Partitions are aligned to period boundaries (UTC) and cover the  *
+ *           current and HK_PARTITIONS_AHEAD next periods. Gap since the last *
+ *           partition is covered by the current partition. Nothing is        *
+ *           created after partition without upper bound.                     *
+ *                                                                            *
+ ******************************************************************************/
+void	hk_partition_get_ranges(int last_to, int period, int now, zbx_vector_uint64_pair_t *ranges)
+{
+	int	start, end, current = now - now % period, until = current + (HK_PARTITIONS_AHEAD + 1) * period;
+
+	if (HK_PARTITION_MAXVALUE == last_to)
+		return;
+
+	for (start = (0 == last_to ? current : last_to); start < until; start = end)
+	{
+		zbx_uint64_pair_t	range;
+
+		end = MAX(start - start % period + period, current + period);
+
+		range.first = (zbx_uint64_t)start;
+		range.second = (zbx_uint64_t)end;
+		zbx_vector_uint64_pair_append(ranges, range);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: formats name of partition starting at the specified clock         *
+ *                                                                            *
+ * Parameters: prefix   - [IN]                                                *
+ *             start    - [IN] partition start clock                          *
+ *             name     - [OUT]                                               *
+ *             name_len - [IN] size of name buffer                            *
+ *                                                                            *
+ ******************************************************************************/
+void	hk_partition_get_name(const char *prefix, int start, char *name, size_t name_len)
+{
+	time_t		start_time = start;
+	struct tm	tm;
+
+	gmtime_r(&start_time, &tm);
+
+	zbx_snprintf(name, name_len, "%sp%04d%02d%02d", prefix, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+}
+
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+
+typedef struct
+{
+	char	*name;
+
+	/* values below this clock are stored in the partition */
+	int	to;
+}
+zbx_hk_partition_t;
+
+ZBX_PTR_VECTOR_DECL(hk_partition_ptr, zbx_hk_partition_t *)
+ZBX_PTR_VECTOR_IMPL(hk_partition_ptr, zbx_hk_partition_t *)
+
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds partition to the list                                        *
+ *                                                                            *
+ * Parameters: partitions - [OUT]                                             *
+ *             name       - [IN] partition name                               *
+ *             bound      - [IN] partition upper bound, either clock value or *
+ *                               MAXVALUE                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partition_add(zbx_vector_hk_partition_ptr_t *partitions, const char *name, const char *bound)
+{
+	zbx_hk_partition_t	*partition;
+
+	partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+	partition->name = zbx_strdup(NULL, name);
+	partition->to = hk_partition_parse_bound(bound);
+
+	zbx_vector_hk_partition_ptr_append(partitions, partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets partitions of table partitioned by clock ranges              *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             partitions - [OUT]                                             *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by clock ranges           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_get_partitions(const char *table_name, zbx_vector_hk_partition_ptr_t *partitions)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	int		ret = FAIL;
+#if defined(HAVE_POSTGRESQL)
+	const char	*bound;
+
+	result = zbx_db_select("select pg_get_partkeydef(p.oid) from pg_class p"
+			" join pg_namespace n on n.oid=p.relnamespace"
+			" where n.nspname='%s' and p.relname='%s' and p.relkind='p'",
+			zbx_db_get_schema_esc(), table_name);
+
+	if (NULL != (row = zbx_db_fetch(result)) && 0 == strcmp(row[0], "RANGE (clock)"))
+		ret = SUCCEED;
+
+	zbx_db_free_result(result);
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	result = zbx_db_select("select c.oid::regclass,pg_get_expr(c.relpartbound,c.oid) from pg_inherits i"
+			" join pg_class c on c.oid=i.inhrelid"
+			" join pg_class p on p.oid=i.inhparent"
+			" join pg_namespace n on n.oid=p.relnamespace"
+			" where n.nspname='%s' and p.relname='%s'",
+			zbx_db_get_schema_esc(), table_name);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		/* default partition is never created or dropped */
+		if (NULL == (bound = strstr(row[1], " TO (")))
+			continue;
+
+		hk_partition_add(partitions, row[0], bound + ZBX_CONST_STRLEN(" TO ("));
+	}
+#else
+	result = zbx_db_select("select partition_name,partition_description,partition_method,partition_expression"
+			" from information_schema.partitions"
+			" where table_schema=database() and table_name='%s' and partition_name is not null",
+			table_name);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		if (0 != strncmp(row[2], "RANGE", ZBX_CONST_STRLEN("RANGE")) ||
+				(0 != strcmp(row[3], "clock") && 0 != strcmp(row[3], "`clock`")))
+		{
+			zbx_vector_hk_partition_ptr_clear_ext(partitions, hk_partition_free);
+			ret = FAIL;
+			break;
+		}
+
+		hk_partition_add(partitions, row[0], row[1]);
+		ret = SUCCEED;
+	}
+#endif
+	zbx_db_free_result(result);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates partitions for the current and next periods               *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             period     - [IN] partition length in seconds                  *
+ *             now        - [IN] current timestamp                            *
+ *             partitions - [IN] existing table partitions                    *
+ *                                                                            *
+ * Comments: New partitions are added after the last existing one. If the     *
+ *           last partition range has no upper bound, nothing is created.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_create_partitions(const char *table_name, int period, int now,
+		const zbx_vector_hk_partition_ptr_t *partitions)
+{
+	int				last_to = 0;
+	zbx_vector_uint64_pair_t	ranges;
+#if defined(HAVE_POSTGRESQL)
+	char				prefix[ZBX_TABLENAME_LEN_MAX];
+
+	zbx_snprintf(prefix, sizeof(prefix), "%s_", table_name);
+#else
+	const char			*prefix = "";
+#endif
+	for (int i = 0; i < partitions->values_num; i++)
+	{
+		if (partitions->values[i]->to > last_to)
+			last_to = partitions->values[i]->to;
+	}
+
+	zbx_vector_uint64_pair_create(&ranges);
+	hk_partition_get_ranges(last_to, period, now, &ranges);
+
+	for (int i = 0; i < ranges.values_num; i++)
+	{
+		char	name[ZBX_TABLENAME_LEN_MAX];
+		int	rc, start = (int)ranges.values[i].first, end = (int)ranges.values[i].second;
+
+		hk_partition_get_name(prefix, start, name, sizeof(name));
+#if defined(HAVE_POSTGRESQL)
+		rc = zbx_db_execute("create table %s partition of %s for values from (%d) to (%d)", name, table_name,
+				start, end);
+#else
+		rc = zbx_db_execute("alter table %s add partition (partition `%s` values less than (%d))", table_name,
+				name, end);
+#endif
+		if (ZBX_DB_OK > rc)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot create partition \"%s\" of table \"%s\"", name, table_name);
+			break;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "created partition \"%s\" of table \"%s\" for clock range %d-%d", name,
+				table_name, start, end);
+	}
+
+	zbx_vector_uint64_pair_destroy(&ranges);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drops partitions containing only expired data                     *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             keep_from  - [IN] the oldest clock value to keep               *
+ *             partitions - [IN] existing table partitions                    *
+ *                                                                            *
+ * Return value: number of dropped partitions                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_drop_partitions(const char *table_name, int keep_from,
+		const zbx_vector_hk_partition_ptr_t *partitions)
+{
+	int	dropped = 0;
+#if defined(HAVE_POSTGRESQL)
+	for (int i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = partitions->values[i];
+
+		if (SUCCEED != hk_partition_is_expired(partition->to, keep_from))
+			continue;
+
+		if (ZBX_DB_OK > zbx_db_execute("drop table %s", partition->name))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot drop partition \"%s\" of table \"%s\"", partition->name,
+					table_name);
+			continue;
+		}
+
+		dropped++;
+	}
+#else
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+	int	num = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "alter table %s drop partition ", table_name);
+
+	for (int i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = partitions->values[i];
+
+		if (SUCCEED != hk_partition_is_expired(partition->to, keep_from))
+			continue;
+
+		if (0 != num++)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "`%s`", partition->name);
+	}
+
+	if (0 != num)
+	{
+		if (ZBX_DB_OK > zbx_db_execute("%s", sql))
+			zabbix_log(LOG_LEVEL_ERR, "cannot drop expired partitions of table \"%s\"", table_name);
+		else
+			dropped = num;
+	}
+
+	zbx_free(sql);
+#endif
+	return dropped;
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maintains partitions of history/trends table partitioned by clock *
+ *          ranges with native database partitioning                          *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             period     - [IN] length of created partitions in seconds      *
+ *             keep_from  - [IN] the oldest clock value to keep, partitions   *
+ *                               with older data are dropped, 0 to keep all   *
+ *             now        - [IN] current timestamp                            *
+ *             dropped    - [OUT] number of dropped partitions                *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned and its partitions were   *
+ *                         maintained                                         *
+ *               FAIL    - the table is not partitioned by clock ranges       *
+ *                                                                            *
+ * Comments: Partitioning must be set up by administrator (PostgreSQL         *
+ *           declarative partitioning or MySQL range partitioning by clock    *
+ *           column), afterwards partitions for upcoming periods are created  *
+ *           ahead of time by housekeeper. Pass keep_from 0 to only create    *
+ *           partitions.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_history_partitions_update(const char *table_name, int period, int keep_from, int now, int *dropped)
+{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+	zbx_vector_hk_partition_ptr_t	partitions;
+	int				ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s period:%d keep_from:%d", __func__, table_name, period,
+			keep_from);
+
+	*dropped = 0;
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+
+	if (SUCCEED == (ret = hk_get_partitions(table_name, &partitions)))
+	{
+		hk_create_partitions(table_name, period, now, &partitions);
+
+		if (0 < keep_from)
+			*dropped = hk_drop_partitions(table_name, keep_from, &partitions);
+	}
+
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s dropped:%d", __func__, zbx_result_string(ret), *dropped);
+
+	return ret;
+#else
+	ZBX_UNUSED(table_name);
+	ZBX_UNUSED(period);
+	ZBX_UNUSED(keep_from);
+	ZBX_UNUSED(now);
+
+	*dropped = 0;
+
+	return FAIL;
+#endif
+}
@@ -0,0 +1,30 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_HISTORY_PARTITION_H
+#define ZABBIX_HISTORY_PARTITION_H
+
+#include "zbxalgo.h"
+
+/* upper bound of partition accepting all values above the previous partition */
+#define HK_PARTITION_MAXVALUE	INT_MAX
+
+int	hk_partition_parse_bound(const char *bound);
+int	hk_partition_is_expired(int to, int keep_from);
+void	hk_partition_get_ranges(int last_to, int period, int now, zbx_vector_uint64_pair_t *ranges);
+void	hk_partition_get_name(const char *prefix, int start, char *name, size_t name_len);
+
+int	hk_history_partitions_update(const char *table_name, int period, int keep_from, int now, int *dropped);
+
+#endif
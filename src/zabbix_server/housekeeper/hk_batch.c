@@ -0,0 +1,74 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "hk_batch.h"
+
+#include "zbxcommon.h"
+
+/* the minimum size of events and problems deletion batch */
+#define HK_BATCH_SIZE_MIN	100
+
+/* target duration of selecting and deleting a single batch, seconds */
+#define HK_BATCH_TARGET_SEC	0.5
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the number of records to delete with a single statement      *
+ *                                                                            *
+ * Parameters: batch_size           - [IN/OUT] adaptive batch size, 0 - not   *
+ *                                             initialized yet                *
+ *             config_max_hk_delete - [IN] the maximum batch size, 0 - no     *
+ *                                         limit                              *
+ *                                                                            *
+ * Return value: batch size or 0 if all records must be deleted at once       *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_batch_get_size(int *batch_size, int config_max_hk_delete)
+{
+	if (0 == config_max_hk_delete)
+		return 0;
+
+	if (0 == *batch_size || config_max_hk_delete < *batch_size)
+		*batch_size = config_max_hk_delete;
+
+	return *batch_size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adjusts batch size according to the duration of the last batch    *
+ *                                                                            *
+ * Parameters: batch_size           - [IN/OUT] adaptive batch size            *
+ *             config_max_hk_delete - [IN] the maximum batch size, 0 - no     *
+ *                                         limit                              *
+ *             deleted              - [IN] number of deleted records          *
+ *             sec                  - [IN] time spent selecting and deleting  *
+ *                                         the records                        *
+ *                                                                            *
+ * Comments: Batch is halved when it takes longer than the target duration    *
+ *           and doubled when a full batch takes less than quarter of it, so  *
+ *           statements stay short enough to not hold locks for long on busy  *
+ *           database while being large enough to keep up on idle one.       *
+ *                                                                            *
+ ******************************************************************************/
+void	hk_batch_update(int *batch_size, int config_max_hk_delete, int deleted, double sec)
+{
+	if (0 == config_max_hk_delete)
+		return;
+
+	if (HK_BATCH_TARGET_SEC < sec)
+		*batch_size = MAX(MIN(HK_BATCH_SIZE_MIN, config_max_hk_delete), *batch_size / 2);
+	else if (HK_BATCH_TARGET_SEC / 4 > sec && deleted >= *batch_size)
+		*batch_size = MIN(config_max_hk_delete, *batch_size * 2);
+}
@@ -0,0 +1,21 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_HK_BATCH_H
+#define ZABBIX_HK_BATCH_H
+
+int	hk_batch_get_size(int *batch_size, int config_max_hk_delete);
+void	hk_batch_update(int *batch_size, int config_max_hk_delete, int deleted, double sec);
+
+#endif
@@ -15,6 +15,8 @@
 #include "housekeeper_server.h"
 
 #include "history_compress.h"
+#include "history_partition.h"
+#include "hk_batch.h"
 
 #include "zbxtimekeeper.h"
 #include "zbxlog.h"
@@ -40,6 +42,9 @@
 /* the maximum number of housekeeping periods to be removed per single housekeeping cycle */
 #define HK_MAX_DELETE_PERIODS		4
 
+/* how often partitions of natively partitioned history tables are created ahead */
+#define HK_PARTITIONS_CHECK_PERIOD	SEC_PER_HOUR
+
 #define HK_MIN_CLOCK_UNDEFINED		0
 #define HK_MIN_CLOCK_ALWAYS_RECHECK	-1
 
@@ -136,6 +141,9 @@ typedef struct
 	/* type for checking which values are sent to the history storage */
 	unsigned char				type;
 
+	/* length of partitions created for natively partitioned table */
+	int					partition_period;
+
 	/* the oldest item record timestamp cache for target table */
 	zbx_hashset_t				item_cache;
 
@@ -152,6 +160,9 @@ static int	tsdb_version = 0;
 
 static int	hk_period;
 
+/* adaptive events and problems deletion batch size, kept between housekeeping cycles */
+static int	hk_batch_size;
+
 static unsigned char poption_mode_regular	= ZBX_HK_MODE_REGULAR;
 static unsigned char poption_global_disabled	= ZBX_HK_OPTION_DISABLED;
 
@@ -180,28 +191,28 @@ static zbx_hk_cleanup_table_t	hk_cleanup_tables[] = {
 static zbx_hk_history_rule_t	hk_history_rules[] = {
 	{.table = "history",		.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_FLOAT},
+			.type = ITEM_VALUE_TYPE_FLOAT,	.partition_period = SEC_PER_DAY},
 	{.table = "history_str",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_STR},
+			.type = ITEM_VALUE_TYPE_STR,	.partition_period = SEC_PER_DAY},
 	{.table = "history_log",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_LOG},
+			.type = ITEM_VALUE_TYPE_LOG,	.partition_period = SEC_PER_DAY},
 	{.table = "history_uint",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_UINT64},
+			.type = ITEM_VALUE_TYPE_UINT64,	.partition_period = SEC_PER_DAY},
 	{.table = "history_text",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_TEXT},
+			.type = ITEM_VALUE_TYPE_TEXT,	.partition_period = SEC_PER_DAY},
 	{.table = "history_bin",	.history = "history",	.poption_mode = &cfg.hk.history_mode,
 			.poption_global = &cfg.hk.history_global,	.poption = &cfg.hk.history,
-			.type = ITEM_VALUE_TYPE_BIN},
+			.type = ITEM_VALUE_TYPE_BIN,	.partition_period = SEC_PER_DAY},
 	{.table = "trends",		.history = "trends",	.poption_mode = &cfg.hk.trends_mode,
 			.poption_global = &cfg.hk.trends_global,	.poption = &cfg.hk.trends,
-			.type = ITEM_VALUE_TYPE_FLOAT},
+			.type = ITEM_VALUE_TYPE_FLOAT,	.partition_period = SEC_PER_WEEK},
 	{.table = "trends_uint",	.history = "trends",	.poption_mode = &cfg.hk.trends_mode,
 			.poption_global = &cfg.hk.trends_global,	.poption = &cfg.hk.trends,
-			.type = ITEM_VALUE_TYPE_UINT64},
+			.type = ITEM_VALUE_TYPE_UINT64,	.partition_period = SEC_PER_WEEK},
 	{0}
 };
 
@@ -647,6 +658,71 @@ static void 	hk_update_dbversion_status(void)
 }
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maintains natively partitioned history or trends table            *
+ *                                                                            *
+ * Parameters: rule - [IN] history housekeeping rule                          *
+ *             now  - [IN] current timestamp                                  *
+ *                                                                            *
+ * Return value: SUCCEED - expired data was removed by dropping partitions    *
+ *               FAIL    - expired data must be removed per item              *
+ *                                                                            *
+ * Comments: Partitions can be dropped only when global history (trends)      *
+ *           storage period overrides item settings, otherwise only new       *
+ *           partitions are created.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_history_native_partitions_update(const zbx_hk_history_rule_t *rule, int now)
+{
+	int	keep_from = 0, dropped;
+
+#if defined(HAVE_POSTGRESQL)
+	/* TimescaleDB hypertables are maintained by dropping chunks */
+	if (0 < tsdb_version)
+		return FAIL;
+#endif
+	if (ZBX_HK_MODE_REGULAR == *rule->poption_mode && ZBX_HK_OPTION_ENABLED == *rule->poption_global)
+		keep_from = now - *rule->poption;
+
+	if (SUCCEED != hk_history_partitions_update(rule->table, rule->partition_period, keep_from, now, &dropped))
+		return FAIL;
+
+	if (0 != dropped)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "dropped %d expired partitions of table \"%s\"", dropped,
+				rule->table);
+	}
+
+	return 0 != keep_from ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates upcoming partitions of natively partitioned history and   *
+ *          trends tables                                                     *
+ *                                                                            *
+ * Parameters: now - [IN] current timestamp                                   *
+ *                                                                            *
+ * Comments: Runs at startup and then every HK_PARTITIONS_CHECK_PERIOD        *
+ *           independently of HousekeepingFrequency, so partitions exist      *
+ *           before data arrives even with long or disabled housekeeping.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	housekeeping_history_partitions(int now)
+{
+	zbx_hk_history_rule_t	*rule;
+	int			dropped;
+
+#if defined(HAVE_POSTGRESQL)
+	/* TimescaleDB hypertables are maintained by dropping chunks */
+	if (0 < tsdb_version)
+		return;
+#endif
+	for (rule = hk_history_rules; NULL != rule->table; rule++)
+		hk_history_partitions_update(rule->table, rule->partition_period, 0, now, &dropped);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: performs housekeeping for history and trends tables               *
@@ -676,6 +752,10 @@ static int	housekeeping_history_and_trends(int now)
 	/* we need to clear records from */
 	for (rule = hk_history_rules; NULL != rule->table; rule++)
 	{
+		/* partitions are created ahead of time even when housekeeping is disabled */
+		if (SUCCEED == hk_history_native_partitions_update(rule, now))
+			goto skip;
+
 		if (ZBX_HK_MODE_DISABLED == *rule->poption_mode)
 			goto skip;
 
@@ -749,6 +829,25 @@ skip:
 	return deleted;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adjusts batch size after deleting a batch of events or problems   *
+ *          and publishes deletion progress                                   *
+ *                                                                            *
+ * Parameters: config_max_hk_delete - [IN] the maximum batch size, 0 - no     *
+ *                                         limit                              *
+ *             deleted              - [IN] number of deleted records or       *
+ *                                         database error                     *
+ *             sec                  - [IN] time spent selecting and deleting  *
+ *                                         the records                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_batch_done(int config_max_hk_delete, int deleted, double sec)
+{
+	hk_batch_update(&hk_batch_size, config_max_hk_delete, deleted, sec);
+	zbx_dc_update_hk_stats(MAX(deleted, 0), sec, hk_batch_get_size(&hk_batch_size, config_max_hk_delete));
+}
+
 /*******************************************************************************************
  *                                                                                         *
  * Purpose: removes old records from table according to specified rule                     *
@@ -801,7 +900,7 @@ static int	housekeeping_process_rule(int now, int config_max_hk_delete, zbx_hk_r
 	keep_from = now - *rule->phistory;
 	if (keep_from > min_clock)
 	{
-		char			buffer[MAX_STRING_LEN], *sql = NULL;
+		char			buffer[MAX_STRING_LEN], *sql = NULL, *last_id = NULL;
 		size_t			sql_alloc = 0, sql_offset;
 		zbx_vector_uint64_t	ids_uint64;
 		zbx_vector_str_t	ids_str;
@@ -817,19 +916,33 @@ static int	housekeeping_process_rule(int now, int config_max_hk_delete, zbx_hk_r
 		zbx_snprintf(buffer, sizeof(buffer),
 			"select %s"
 			" from %s"
-			" where clock<%d%s%s"
-			" order by %s",
-			rule->field_name, rule->table, min_clock, '\0' != *rule->filter ? " and " : "", rule->filter,
-			rule->field_name);
+			" where clock<%d%s%s",
+			rule->field_name, rule->table, min_clock, '\0' != *rule->filter ? " and " : "", rule->filter);
 
-		while (1)
+		while (ZBX_IS_RUNNING())
 		{
+			int	batch_size = hk_batch_get_size(&hk_batch_size, config_max_hk_delete);
+			double	sec = zbx_time();
+
+			/* Continue after the last selected ID instead of scanning again over the records */
+			/* that were just deleted or did not match the filter.                              */
+			sql_offset = 0;
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, buffer);
+
+			if (NULL != last_id)
+			{
+				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and %s>%s", rule->field_name,
+						last_id);
+			}
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " order by %s", rule->field_name);
+
 			/* Select IDs of records that must be deleted, this allows to avoid locking for every   */
 			/* record the search encounters when using delete statement, thus eliminates deadlocks. */
-			if (0 == config_max_hk_delete)
-				result = zbx_db_select("%s", buffer);
+			if (0 == batch_size)
+				result = zbx_db_select("%s", sql);
 			else
-				result = zbx_db_select_n(buffer, config_max_hk_delete);
+				result = zbx_db_select_n(sql, batch_size);
 
 			while (NULL != (row = zbx_db_fetch(result)))
 			{
@@ -850,11 +963,19 @@ static int	housekeeping_process_rule(int now, int config_max_hk_delete, zbx_hk_r
 			{
 				if (0 == ids_uint64.values_num)
 					break;
+
+				last_id = zbx_dsprintf(last_id, ZBX_FS_UI64,
+						ids_uint64.values[ids_uint64.values_num - 1]);
 			}
 			else
 			{
 				if (0 == ids_str.values_num)
 					break;
+
+				char	*id_esc = zbx_db_dyn_escape_string(ids_str.values[ids_str.values_num - 1]);
+
+				last_id = zbx_dsprintf(last_id, "'%s'", id_esc);
+				zbx_free(id_esc);
 			}
 
 			sql_offset = 0;
@@ -878,12 +999,15 @@ static int	housekeeping_process_rule(int now, int config_max_hk_delete, zbx_hk_r
 			else
 				zbx_vector_str_clear_ext(&ids_str, zbx_str_free);
 
+			hk_batch_done(config_max_hk_delete, ret, zbx_time() - sec);
+
 			if (ZBX_DB_OK > ret)
 				break;
 
 			deleted += ret;
 		}
 
+		zbx_free(last_id);
 		zbx_free(sql);
 
 		if (0 == id_field_str_type)
@@ -1307,31 +1431,36 @@ static int	housekeeping_events(int now, int config_max_hk_delete)
 static int	housekeeping_problems(int now, int config_max_hk_delete)
 {
 	int			deleted = 0;
+	zbx_uint64_t		last_eventid = 0;
 	zbx_vector_uint64_t	ids_uint64;
 	size_t			sql_alloc = 0, sql_offset;
-	char			buffer[MAX_STRING_LEN], *sql = NULL;;
+	char			*sql = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
 
 	zbx_vector_uint64_create(&ids_uint64);
 
-	zbx_snprintf(buffer, sizeof(buffer),
-		"select p1.eventid from problem p1"
-		" where p1.r_clock<>0 and p1.r_clock<%d and not exists ("
-			"select NULL"
-			" from problem p2"
-			" where p1.eventid=p2.cause_eventid"
-		")", now - SEC_PER_DAY);
-
-	while (1)
+	while (ZBX_IS_RUNNING())
 	{
 		zbx_db_result_t	result;
 		zbx_db_row_t	row;
+		int		batch_size = hk_batch_get_size(&hk_batch_size, config_max_hk_delete);
+		double		sec = zbx_time();
+
+		sql_offset = 0;
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select p1.eventid from problem p1"
+			" where p1.r_clock<>0 and p1.r_clock<%d and p1.eventid>" ZBX_FS_UI64 " and not exists ("
+				"select NULL"
+				" from problem p2"
+				" where p1.eventid=p2.cause_eventid"
+			")"
+			" order by p1.eventid", now - SEC_PER_DAY, last_eventid);
 
-		if (0 == config_max_hk_delete)
-			result = zbx_db_select("%s", buffer);
+		if (0 == batch_size)
+			result = zbx_db_select("%s", sql);
 		else
-			result = zbx_db_select_n(buffer, config_max_hk_delete);
+			result = zbx_db_select_n(sql, batch_size);
 
 		while (NULL != (row = zbx_db_fetch(result)))
 		{
@@ -1346,6 +1475,8 @@ static int	housekeeping_problems(int now, int config_max_hk_delete)
 		if (0 == ids_uint64.values_num)
 			break;
 
+		last_eventid = ids_uint64.values[ids_uint64.values_num - 1];
+
 		sql_offset = 0;
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "delete from problem where");
 		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "eventid", ids_uint64.values,
@@ -1355,6 +1486,8 @@ static int	housekeeping_problems(int now, int config_max_hk_delete)
 
 		zbx_vector_uint64_clear(&ids_uint64);
 
+		hk_batch_done(config_max_hk_delete, rc, zbx_time() - sec);
+
 		if (ZBX_DB_OK > rc)
 			break;
 
@@ -1400,11 +1533,12 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 {
 	zbx_thread_housekeeper_args	*housekeeper_args_in = (zbx_thread_housekeeper_args *)
 							(((zbx_thread_args_t *)args)->args);
-	double				sec, time_slept, time_now;
+	double				sec, time_slept, time_now, time_idle;
 	char				sleeptext[25];
 	zbx_ipc_async_socket_t		rtc;
 	const zbx_thread_info_t		*info = &((zbx_thread_args_t *)args)->info;
-	int				sleeptime, server_num = ((zbx_thread_args_t *)args)->info.server_num,
+	int				sleeptime, hk_nextcheck, partitions_nextcheck = 0,
+					server_num = ((zbx_thread_args_t *)args)->info.server_num,
 					process_num = ((zbx_thread_args_t *)args)->info.process_num;
 	unsigned char			process_type = ((zbx_thread_args_t *)args)->info.process_type;
 	zbx_uint32_t			rtc_msgs[] = {ZBX_RTC_HOUSEKEEPER_EXECUTE, ZBX_RTC_TRIGGER_HOUSEKEEPER_EXECUTE};
@@ -1418,13 +1552,13 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	if (0 == housekeeper_args_in->config_housekeeping_frequency)
 	{
-		sleeptime = ZBX_IPC_WAIT_FOREVER;
+		hk_nextcheck = INT_MAX;
 		zbx_setproctitle("%s [waiting for user command]", get_process_type_string(process_type));
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "waiting for user command");
 	}
 	else
 	{
-		sleeptime = HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
+		hk_nextcheck = (int)time(NULL) + HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
 		zbx_setproctitle("%s [startup idle for %d minutes]", get_process_type_string(process_type),
 				HOUSEKEEPER_STARTUP_DELAY);
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "idle for %d hour(s)",
@@ -1448,13 +1582,24 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 	}
 #endif
 
+	time_idle = zbx_time();
+
 	while (ZBX_IS_RUNNING())
 	{
 		zbx_uint32_t	rtc_cmd;
 		unsigned char	*rtc_data;
 		int		now, hk_execute = 0;
 
-		sec = zbx_time();
+		if (partitions_nextcheck <= (now = (int)time(NULL)))
+		{
+			zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+			housekeeping_history_partitions(now);
+			zbx_db_close();
+
+			partitions_nextcheck = now - now % HK_PARTITIONS_CHECK_PERIOD + HK_PARTITIONS_CHECK_PERIOD;
+		}
+
+		sleeptime = MAX(MIN(hk_nextcheck, partitions_nextcheck) - (int)time(NULL), 0);
 
 		while (SUCCEED == zbx_rtc_wait(&rtc, info, &rtc_cmd, &rtc_data, sleeptime) && 0 != rtc_cmd)
 		{
@@ -1482,13 +1627,12 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		if (!ZBX_IS_RUNNING())
 			break;
 
-		if (0 == housekeeper_args_in->config_housekeeping_frequency)
-			sleeptime = ZBX_IPC_WAIT_FOREVER;
-		else
-			sleeptime = housekeeper_args_in->config_housekeeping_frequency * SEC_PER_HOUR;
+		/* woken up only to maintain partitions */
+		if (0 == hk_execute && hk_nextcheck > (int)time(NULL))
+			continue;
 
 		time_now = zbx_time();
-		time_slept = time_now - sec;
+		time_slept = time_now - time_idle;
 		zbx_update_env(get_process_type_string(process_type), time_now);
 
 		hk_period = get_housekeeping_period(time_slept);
@@ -1515,19 +1659,19 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		int	d_history_and_trends = housekeeping_history_and_trends(now);
 
 		zbx_setproctitle("%s [removing old problems]", get_process_type_string(process_type));
-		int	d_problems = housekeeping_problems(now, housekeeper_args_in->config_housekeeping_frequency);
+		int	d_problems = housekeeping_problems(now, housekeeper_args_in->config_max_housekeeper_delete);
 
 		zbx_setproctitle("%s [removing old events]", get_process_type_string(process_type));
-		int	d_events = housekeeping_events(now, housekeeper_args_in->config_housekeeping_frequency);
+		int	d_events = housekeeping_events(now, housekeeper_args_in->config_max_housekeeper_delete);
 
 		zbx_setproctitle("%s [removing old sessions]", get_process_type_string(process_type));
-		int	d_sessions = housekeeping_sessions(now, housekeeper_args_in->config_housekeeping_frequency);
+		int	d_sessions = housekeeping_sessions(now, housekeeper_args_in->config_max_housekeeper_delete);
 
 		zbx_setproctitle("%s [removing old service alarms]", get_process_type_string(process_type));
-		int	d_services = housekeeping_services(now, housekeeper_args_in->config_housekeeping_frequency);
+		int	d_services = housekeeping_services(now, housekeeper_args_in->config_max_housekeeper_delete);
 
 		zbx_setproctitle("%s [removing old audit log items]", get_process_type_string(process_type));
-		int	d_audit = housekeeping_audit(now, housekeeper_args_in->config_housekeeping_frequency);
+		int	d_audit = housekeeping_audit(now, housekeeper_args_in->config_max_housekeeper_delete);
 
 		zbx_setproctitle("%s [removing old autoreg_hosts]", get_process_type_string(process_type));
 		int	d_autoreg_host = housekeeping_autoreg_host(housekeeper_args_in->config_max_housekeeper_delete);
@@ -1536,7 +1680,7 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		int	records = housekeeping_proxy_dhistory(now);
 
 		zbx_setproctitle("%s [removing deleted items data]", get_process_type_string(process_type));
-		int	d_cleanup = housekeeping_cleanup(housekeeper_args_in->config_housekeeping_frequency);
+		int	d_cleanup = housekeeping_cleanup(housekeeper_args_in->config_max_housekeeper_delete);
 		sec = zbx_time() - sec;
 
 		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d items/triggers, %d events, %d problems,"
@@ -1551,6 +1695,14 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 		zbx_dc_cleanup_sessions();
 
+		time_idle = zbx_time();
+
+		if (0 != housekeeper_args_in->config_housekeeping_frequency)
+		{
+			hk_nextcheck = (int)time_idle + housekeeper_args_in->config_housekeeping_frequency *
+					SEC_PER_HOUR;
+		}
+
 		zbx_setproctitle("%s [deleted %d hist/trends, %d items/triggers, %d events, %d sessions, %d alarms,"
 				" %d audit items, %d autoreg_host, %d records in " ZBX_FS_DBL " sec, %s]",
 				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
@@ -4534,14 +4534,20 @@ out:
 
 static void	lld_templates_link(const zbx_vector_lld_host_ptr_t *hosts, char **error)
 {
-	zbx_lld_host_t	*host;
-	char		*err = NULL;
+	zbx_lld_host_t		*host;
+	char			*err = NULL;
+	zbx_vector_ptr_t	groups;
+	zbx_vector_str_t	errors;
+	int			i, j;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	zbx_vector_ptr_create(&groups);
+	zbx_vector_str_create(&errors);
+
 	zbx_db_begin();
 
-	for (int i = 0; i < hosts->values_num; i++)
+	for (i = 0; i < hosts->values_num; i++)
 	{
 		host = hosts->values[i];
 
@@ -4558,19 +4564,64 @@ static void	lld_templates_link(const zbx_vector_lld_host_ptr_t *hosts, char **er
 			}
 		}
 
-		if (0 != host->lnk_templateids.values_num)
+		if (0 == host->lnk_templateids.values_num)
+			continue;
+
+		/* group hosts by the set of templates to link, so each set is linked to its hosts in one pass */
+		for (j = 0; j < groups.values_num; j++)
 		{
-			if (SUCCEED != zbx_db_copy_template_elements(host->hostid, &host->lnk_templateids,
-					ZBX_TEMPLATE_LINK_LLD, ZBX_AUDIT_LLD_CONTEXT, &err))
+			const zbx_lld_host_t	*first = ((zbx_vector_ptr_t *)groups.values[j])->values[0];
+
+			if (first->lnk_templateids.values_num == host->lnk_templateids.values_num &&
+					0 == memcmp(first->lnk_templateids.values, host->lnk_templateids.values,
+					sizeof(zbx_uint64_t) * (size_t)host->lnk_templateids.values_num))
 			{
-				*error = zbx_strdcatf(*error, "Cannot link template(s) %s.\n", err);
-				zbx_free(err);
+				break;
 			}
 		}
+
+		if (j == groups.values_num)
+		{
+			zbx_vector_ptr_t	*group = (zbx_vector_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_ptr_t));
+
+			zbx_vector_ptr_create(group);
+			zbx_vector_ptr_append(&groups, group);
+		}
+
+		zbx_vector_ptr_append((zbx_vector_ptr_t *)groups.values[j], host);
+	}
+
+	for (i = 0; i < groups.values_num; i++)
+	{
+		zbx_vector_ptr_t	*group = (zbx_vector_ptr_t *)groups.values[i];
+		zbx_vector_uint64_t	hostids;
+
+		zbx_vector_uint64_create(&hostids);
+
+		for (j = 0; j < group->values_num; j++)
+			zbx_vector_uint64_append(&hostids, ((zbx_lld_host_t *)group->values[j])->hostid);
+
+		host = (zbx_lld_host_t *)group->values[0];
+
+		if (SUCCEED != zbx_db_copy_template_elements_hosts(&hostids, &host->lnk_templateids,
+				ZBX_TEMPLATE_LINK_LLD, ZBX_AUDIT_LLD_CONTEXT, &errors))
+		{
+			for (j = 0; j < errors.values_num; j++)
+				*error = zbx_strdcatf(*error, "Cannot link template(s) %s.\n", errors.values[j]);
+
+			zbx_vector_str_clear_ext(&errors, zbx_str_free);
+		}
+
+		zbx_vector_uint64_destroy(&hostids);
+		zbx_vector_ptr_destroy(group);
+		zbx_free(group);
 	}
 
 	zbx_db_commit();
 
+	zbx_vector_str_destroy(&errors);
+	zbx_vector_ptr_destroy(&groups);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -44,6 +44,15 @@ typedef enum
 }
 zbx_host_tag_op_t;
 
+/* templates to be linked to discovered host when actions of all events are processed */
+typedef struct
+{
+	zbx_uint64_t		hostid;
+	int			audit_context_mode;
+	zbx_vector_uint64_t	templateids;
+}
+zbx_host_template_link_t;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: selects hostid of discovered host                                 *
@@ -982,9 +991,10 @@ out:
  * Purpose: deletes host                                                      *
  *                                                                            *
  * Parameters: event - [IN] source event data                                 *
+ *             links - [IN/OUT] templates pending to be linked to hosts       *
  *                                                                            *
  ******************************************************************************/
-void	op_host_del(const zbx_db_event *event)
+void	op_host_del(const zbx_db_event *event, zbx_hashset_t *links)
 {
 	zbx_vector_uint64_t	hostids;
 	zbx_vector_str_t	hostnames;
@@ -999,6 +1009,8 @@ void	op_host_del(const zbx_db_event *event)
 	if (0 == (hostid = select_discovered_host(event, &hostname)))
 		goto out;
 
+	zbx_hashset_remove(links, &hostid);
+
 	zbx_vector_uint64_create(&hostids);
 	zbx_vector_uint64_append(&hostids, hostid);
 	zbx_vector_str_create(&hostnames);
@@ -1265,18 +1277,26 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: links host with template                                          *
+ * Purpose: queues templates to be linked to discovered host                  *
  *                                                                            *
  * Parameters: event           - [IN] source event data                       *
  *             cfg             - [IN] global configuration data               *
- *             lnk_templateids - [IN] array of template IDs                   *
+ *             lnk_templateids - [IN] array of template IDs, sorted           *
+ *             links           - [IN/OUT] templates pending to be linked to   *
+ *                                        hosts                               *
+ *                                                                            *
+ * Comments: The host is added immediately, templates are linked by           *
+ *           op_template_links_flush() after actions of all events are        *
+ *           processed, so that hosts linked to the same templates share      *
+ *           single pass.                                                     *
  *                                                                            *
  ******************************************************************************/
-void	op_template_add(const zbx_db_event *event, zbx_config_t *cfg, zbx_vector_uint64_t *lnk_templateids)
+void	op_template_add(const zbx_db_event *event, zbx_config_t *cfg, zbx_vector_uint64_t *lnk_templateids,
+		zbx_hashset_t *links)
 {
-	zbx_uint64_t	hostid;
-	char		*error = NULL;
-	int		status;
+	zbx_uint64_t			hostid;
+	int				status;
+	zbx_host_template_link_t	*link;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1286,12 +1306,20 @@ void	op_template_add(const zbx_db_event *event, zbx_config_t *cfg, zbx_vector_ui
 	if (0 == (hostid = add_discovered_host(event, &status, cfg)))
 		goto out;
 
-	if (SUCCEED != zbx_db_copy_template_elements(hostid, lnk_templateids, ZBX_TEMPLATE_LINK_MANUAL,
-			zbx_map_db_event_to_audit_context(event), &error))
+	if (NULL == (link = (zbx_host_template_link_t *)zbx_hashset_search(links, &hostid)))
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot link template(s) %s", error);
-		zbx_free(error);
+		zbx_host_template_link_t	link_local;
+
+		link_local.hostid = hostid;
+		link_local.audit_context_mode = zbx_map_db_event_to_audit_context(event);
+
+		link = (zbx_host_template_link_t *)zbx_hashset_insert(links, &link_local, sizeof(link_local));
+		zbx_vector_uint64_create(&link->templateids);
 	}
+
+	zbx_vector_uint64_append_array(&link->templateids, lnk_templateids->values, lnk_templateids->values_num);
+	zbx_vector_uint64_sort(&link->templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&link->templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -1302,12 +1330,15 @@ out:
  *                                                                            *
  * Parameters: event           - [IN] source event data                       *
  *             del_templateids - [IN] array of template IDs                   *
+ *             links           - [IN/OUT] templates pending to be linked to   *
+ *                                        hosts                               *
  *                                                                            *
  ******************************************************************************/
-void	op_template_del(const zbx_db_event *event, zbx_vector_uint64_t *del_templateids)
+void	op_template_del(const zbx_db_event *event, zbx_vector_uint64_t *del_templateids, zbx_hashset_t *links)
 {
-	zbx_uint64_t	hostid;
-	char		*error, *hostname = NULL;
+	zbx_uint64_t			hostid;
+	char				*error, *hostname = NULL;
+	zbx_host_template_link_t	*link;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1317,6 +1348,24 @@ void	op_template_del(const zbx_db_event *event, zbx_vector_uint64_t *del_templat
 	if (0 == (hostid = select_discovered_host(event, &hostname)))
 		goto out;
 
+	/* templates queued by previous events are not linked yet */
+	if (NULL != (link = (zbx_host_template_link_t *)zbx_hashset_search(links, &hostid)))
+	{
+		for (int i = 0; i < del_templateids->values_num; i++)
+		{
+			int	index;
+
+			if (FAIL != (index = zbx_vector_uint64_bsearch(&link->templateids, del_templateids->values[i],
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+			{
+				zbx_vector_uint64_remove(&link->templateids, index);
+			}
+		}
+
+		if (0 == link->templateids.values_num)
+			zbx_hashset_remove_direct(links, link);
+	}
+
 	if (SUCCEED != zbx_db_delete_template_elements(hostid, hostname, del_templateids,
 			zbx_map_db_event_to_audit_context(event), &error))
 	{
@@ -1328,6 +1377,153 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+static void	host_template_link_clean(void *data)
+{
+	zbx_host_template_link_t	*link = (zbx_host_template_link_t *)data;
+
+	zbx_vector_uint64_destroy(&link->templateids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates storage of templates pending to be linked to hosts        *
+ *                                                                            *
+ * Parameters: links - [OUT]                                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	op_template_links_create(zbx_hashset_t *links)
+{
+	zbx_hashset_create_ext(links, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			host_template_link_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+void	op_template_links_destroy(zbx_hashset_t *links)
+{
+	zbx_hashset_destroy(links);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: links queued templates to hosts                                   *
+ *                                                                            *
+ * Parameters: links - [IN/OUT] templates pending to be linked to hosts,      *
+ *                              cleared on return                             *
+ *                                                                            *
+ * Comments: Hosts are grouped by audit context and the set of templates to   *
+ *           link, each group is linked in one pass.                          *
+ *                                                                            *
+ ******************************************************************************/
+void	op_template_links_flush(zbx_hashset_t *links)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_host_template_link_t	*link;
+	zbx_vector_ptr_t		groups;
+	zbx_vector_str_t		errors;
+	zbx_config_t			cfg;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __func__, links->num_data);
+
+	if (0 == links->num_data)
+		goto out;
+
+	zbx_vector_ptr_create(&groups);
+	zbx_vector_str_create(&errors);
+
+	zbx_hashset_iter_reset(links, &iter);
+
+	while (NULL != (link = (zbx_host_template_link_t *)zbx_hashset_iter_next(&iter)))
+	{
+		int	i;
+
+		for (i = 0; i < groups.values_num; i++)
+		{
+			const zbx_host_template_link_t	*first = ((zbx_vector_ptr_t *)groups.values[i])->values[0];
+
+			if (first->audit_context_mode == link->audit_context_mode &&
+					first->templateids.values_num == link->templateids.values_num &&
+					0 == memcmp(first->templateids.values, link->templateids.values,
+					sizeof(zbx_uint64_t) * (size_t)link->templateids.values_num))
+			{
+				break;
+			}
+		}
+
+		if (i == groups.values_num)
+		{
+			zbx_vector_ptr_t	*group = (zbx_vector_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_ptr_t));
+
+			zbx_vector_ptr_create(group);
+			zbx_vector_ptr_append(&groups, group);
+		}
+
+		zbx_vector_ptr_append((zbx_vector_ptr_t *)groups.values[i], link);
+	}
+
+	zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_AUDITLOG_ENABLED | ZBX_CONFIG_FLAGS_AUDITLOG_MODE);
+
+	for (int i = 0; i < groups.values_num; i++)
+	{
+		zbx_vector_ptr_t	*group = (zbx_vector_ptr_t *)groups.values[i];
+		zbx_vector_uint64_t	hostids;
+		zbx_db_result_t		result;
+		zbx_db_row_t		row;
+		char			*sql = NULL;
+		size_t			sql_alloc = 0, sql_offset = 0;
+
+		link = (zbx_host_template_link_t *)group->values[0];
+
+		zbx_vector_uint64_create(&hostids);
+
+		for (int j = 0; j < group->values_num; j++)
+			zbx_vector_uint64_append(&hostids, ((zbx_host_template_link_t *)group->values[j])->hostid);
+
+		zbx_vector_uint64_sort(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_audit_init(cfg.auditlog_enabled, cfg.auditlog_mode, link->audit_context_mode);
+
+		/* audit entries of host additions are flushed with their events */
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select hostid,host from hosts where");
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hostid", hostids.values,
+				hostids.values_num);
+
+		result = zbx_db_select("%s", sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_uint64_t	hostid;
+
+			ZBX_STR2UINT64(hostid, row[0]);
+			zbx_audit_host_create_entry(link->audit_context_mode, ZBX_AUDIT_ACTION_UPDATE, hostid, row[1]);
+		}
+		zbx_db_free_result(result);
+
+		zbx_free(sql);
+
+		if (SUCCEED != zbx_db_copy_template_elements_hosts(&hostids, &link->templateids,
+				ZBX_TEMPLATE_LINK_MANUAL, link->audit_context_mode, &errors))
+		{
+			for (int j = 0; j < errors.values_num; j++)
+				zabbix_log(LOG_LEVEL_WARNING, "cannot link template(s) %s", errors.values[j]);
+
+			zbx_vector_str_clear_ext(&errors, zbx_str_free);
+		}
+
+		zbx_audit_flush(link->audit_context_mode);
+
+		zbx_vector_uint64_destroy(&hostids);
+		zbx_vector_ptr_destroy(group);
+		zbx_free(group);
+	}
+
+	zbx_vector_str_destroy(&errors);
+	zbx_vector_ptr_destroy(&groups);
+
+	zbx_hashset_clear(links);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds and deletes tags from discovered host if they are not        *
@@ -19,12 +19,16 @@
 #include "zbxdbhigh.h"
 #include "zbxcacheconfig.h"
 
-void	op_template_add(const zbx_db_event *event, zbx_config_t *cfg, zbx_vector_uint64_t *lnk_templateids);
-void	op_template_del(const zbx_db_event *event, zbx_vector_uint64_t *del_templateids);
+void	op_template_add(const zbx_db_event *event, zbx_config_t *cfg, zbx_vector_uint64_t *lnk_templateids,
+		zbx_hashset_t *links);
+void	op_template_del(const zbx_db_event *event, zbx_vector_uint64_t *del_templateids, zbx_hashset_t *links);
+void	op_template_links_create(zbx_hashset_t *links);
+void	op_template_links_flush(zbx_hashset_t *links);
+void	op_template_links_destroy(zbx_hashset_t *links);
 void	op_groups_add(const zbx_db_event *event,  zbx_config_t *cfg, zbx_vector_uint64_t *groupids);
 void	op_groups_del(const zbx_db_event *event, zbx_vector_uint64_t *groupids);
 void	op_host_add(const zbx_db_event *event, zbx_config_t *cfg);
-void	op_host_del(const zbx_db_event *event);
+void	op_host_del(const zbx_db_event *event, zbx_hashset_t *links);
 void	op_host_enable(const zbx_db_event *event, zbx_config_t *cfg);
 void	op_host_disable(const zbx_db_event *event, zbx_config_t *cfg);
 void	op_host_inventory_mode(const zbx_db_event *event, zbx_config_t *cfg, int inventory_mode);
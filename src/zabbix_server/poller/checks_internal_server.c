@@ -384,6 +384,38 @@ int	zbx_get_value_internal_ext_server(const zbx_dc_item_t *item, const char *par
 			goto out;
 		}
 	}
+	else if (0 == strcmp(param1, "housekeeper"))		/* zabbix["housekeeper",<param>] */
+	{
+		zbx_hk_stats_t	stats;
+
+		if (2 != nparams)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		zbx_dc_get_hk_stats(&stats);
+
+		param2 = get_rparam(request, 1);
+
+		if (0 == strcmp(param2, "deleted"))
+		{
+			SET_UI64_RESULT(result, stats.deleted);
+		}
+		else if (0 == strcmp(param2, "rps"))
+		{
+			SET_DBL_RESULT(result, stats.rps);
+		}
+		else if (0 == strcmp(param2, "batch"))
+		{
+			SET_UI64_RESULT(result, (zbx_uint64_t)stats.batch_size);
+		}
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+	}
 	else if (0 == strcmp(param1, "proxy group"))		/* zabbix["proxy",<hostname>,"lastaccess" OR "delay"] */
 	{							/* zabbix["proxy","discovery"]                        */
 		char		*error = NULL;
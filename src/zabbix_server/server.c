@@ -99,6 +99,7 @@
 #include "zbxhttppoller.h"
 #include "zbx_ha_constants.h"
 #include "zbxescalations.h"
+#include "zbxevent.h"
 #include "zbxbincommon.h"
 
 #ifdef HAVE_LIBCURL
@@ -139,8 +140,8 @@ static const char	*help_message[] = {
 	"      " ZBX_SECRETS_RELOAD "                  Reload secrets from Vault",
 	"      " ZBX_DIAGINFO "=section                Log internal diagnostic information of the",
 	"                                        section (historycache, preprocessing, alerting,",
-	"                                        lld, valuecache, locks, connector) or everything if section is",
-	"                                        not specified",
+	"                                        lld, valuecache, locks, connector, profiler) or",
+	"                                        everything if section is not specified",
 	"      " ZBX_PROF_ENABLE "=target              Enable profiling, affects all processes if",
 	"                                        target is not specified",
 	"      " ZBX_PROF_DISABLE "=target             Disable profiling, affects all processes if",
@@ -179,7 +180,7 @@ static const char	*help_message[] = {
 	"        process-type,N            Process type and number (e.g., history syncer,1)",
 	"        pid                       Process identifier",
 	"        scope                     Profiling scope",
-	"                                  (rwlock, mutex, processing) can be used with process-type",
+	"                                  (rwlock, mutex, processing, sampling) can be used with process-type",
 	"                                  (e.g., history syncer,1,processing)",
 	"",
 	"  -T --test-config                Validate configuration file and exit",
@@ -322,6 +323,7 @@ static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static zbx_uint64_t	config_problem_cache_size	= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
@@ -381,6 +383,7 @@ static char	*config_file				= NULL;
 static int	config_allow_root			= 0;
 static int	config_enable_global_scripts		= 1;
 static int	config_allow_software_update_check	= 1;
+static int	config_enable_profiler_sampling		= 0;
 static char	*config_sms_devices			= NULL;
 static zbx_config_log_t	log_file_cfg			= {NULL, NULL, ZBX_LOG_TYPE_UNDEFINED, 1};
 
@@ -739,6 +742,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (0 != config_problem_cache_size && 128 * ZBX_KIBIBYTE > config_problem_cache_size)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"ProblemCacheSize\" configuration parameter must be either 0"
+				" or greater than 128KB");
+		err = 1;
+	}
+
 	if (NULL != zbx_config_source_ip && SUCCEED != zbx_is_supported_ip(zbx_config_source_ip))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "invalid \"SourceIP\" configuration parameter: '%s'", zbx_config_source_ip);
@@ -833,6 +843,8 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 			"OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == zbx_check_cfg_feature_str("TLSCipherAll13", zbx_config_tls->cipher_all13,
 			"OpenSSL 1.1.1 or newer"));
+	err |= (FAIL == zbx_check_cfg_feature_int("TLSKernelOffload", zbx_config_tls->kernel_offload,
+			"OpenSSL 3.0 or newer"));
 #endif
 
 #if !defined(HAVE_OPENIPMI)
@@ -918,6 +930,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ProblemCacheSize",		&config_problem_cache_size,		ZBX_CFG_TYPE_UINT64,
+				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
@@ -1009,6 +1023,9 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"DBTLSCipher13",		&(zbx_config_dbhigh->config_db_tls_cipher_13),
 											ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"DBPreparedStatements",	&(zbx_config_dbhigh->config_db_prepared_statements),
+											ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"SSHKeyLocation",		&config_ssh_key_location,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&config_log_slow_queries,		ZBX_CFG_TYPE_INT,
@@ -1064,6 +1081,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"TLSCipherAll",		&(zbx_config_tls->cipher_all),		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"TLSKernelOffload",		&(zbx_config_tls->kernel_offload),	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"SocketDir",			&CONFIG_SOCKET_PATH,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"StartAlerters",		&config_forks[ZBX_PROCESS_TYPE_ALERTER],
@@ -1136,6 +1155,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			1},
 		{"AllowSoftwareUpdateCheck",	&config_allow_software_update_check,	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
+		{"EnableProfilerSampling",	&config_enable_profiler_sampling,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"StartBrowserPollers",		&config_forks[ZBX_PROCESS_TYPE_BROWSERPOLLER], ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
 		{"WebDriverURL",		&config_webdriver_url,			ZBX_CFG_TYPE_STRING,
@@ -1211,6 +1232,8 @@ static void	zbx_on_exit(int ret, void *on_exit_args)
 		/* free history value cache */
 		zbx_vc_destroy();
 
+		zbx_problem_cache_destroy();
+
 		zbx_deinit_remote_commands_cache();
 
 		/* free vmware support */
@@ -1643,6 +1666,15 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
+	zbx_prof_init(zbx_selfmon_prof_flush);
+	zbx_tcp_init_compress_stats(zbx_selfmon_compress_update);
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_init_stats(zbx_selfmon_tls_update);
+#endif
+
+	if (1 == config_enable_profiler_sampling)
+		zbx_prof_enable(ZBX_PROF_SAMPLING);
+
 	if (0 != config_forks[ZBX_PROCESS_TYPE_VMWARE] && SUCCEED != zbx_vmware_init(&config_vmware_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize VMware cache: %s", error);
@@ -1664,6 +1696,13 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
+	if (SUCCEED != zbx_problem_cache_init(config_problem_cache_size, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize problem cache: %s", error);
+		zbx_free(error);
+		return FAIL;
+	}
+
 	if (0 != config_forks[ZBX_PROCESS_TYPE_CONNECTORMANAGER])
 		zbx_connector_init();
 
@@ -2030,6 +2069,7 @@ static void	server_teardown(zbx_rtc_t *rtc, zbx_socket_t *listen_sock)
 		zbx_tcp_unlisten(listen_sock);
 
 	/* destroy shared caches */
+	zbx_problem_cache_destroy();
 	zbx_tfc_destroy();
 	zbx_vc_destroy();
 	zbx_vmware_destroy();
@@ -2225,6 +2265,12 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		zabbix_log(LOG_LEVEL_CRIT, "cannot disable core dump, exiting...");
 		exit(EXIT_FAILURE);
 	}
+
+	/* generate session ticket keys before forking to share them between child processes */
+	zbx_tls_init_ticket_keys();
+
+	/* warn once rather than in every child process */
+	zbx_tls_check_kernel_offload(zbx_config_tls);
 #endif
 	zbx_initialize_events();
 
@@ -0,0 +1,222 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+
+#include <time.h>
+
+#define BENCH_SAMPLES_MAX	(1024 * 1024)
+
+static zbx_uint64_t	bench_seed = 1;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns monotonic clock value in nanoseconds                      *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_bench_clock_ns(void)
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (zbx_uint64_t)ts.tv_sec * 1000000000 + (zbx_uint64_t)ts.tv_nsec;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sleeps until the specified monotonic clock value                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_sleep_until(zbx_uint64_t deadline_ns)
+{
+	struct timespec	ts;
+
+	ts.tv_sec = (time_t)(deadline_ns / 1000000000);
+	ts.tv_nsec = (long)(deadline_ns % 1000000000);
+
+	while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL))
+		;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: seeds benchmark random number generator                           *
+ *                                                                            *
+ * Comments: Benchmark data is generated with a fixed seed linear congruential *
+ *           generator so that runs are repeatable across hosts and libc      *
+ *           versions.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_srand(zbx_uint64_t seed)
+{
+	bench_seed = seed;
+}
+
+zbx_uint64_t	zbx_bench_rand(void)
+{
+	bench_seed = bench_seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return bench_seed >> 16;
+}
+
+void	zbx_bench_samples_reset(zbx_vector_uint64_t *samples)
+{
+	zbx_vector_uint64_clear(samples);
+}
+
+static double	bench_percentile(const zbx_vector_uint64_t *samples, int percent)
+{
+	int	index;
+
+	if (0 == samples->values_num)
+		return 0;
+
+	index = (int)((zbx_uint64_t)samples->values_num * (zbx_uint64_t)percent / 100);
+
+	if (index >= samples->values_num)
+		index = samples->values_num - 1;
+
+	return (double)samples->values[index];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates benchmark result from collected latency samples        *
+ *                                                                            *
+ * Parameters: samples    - [IN/OUT] latency samples in nanoseconds, sorted   *
+ *                                   on return                                *
+ *             ops        - [IN] number of executed operations                *
+ *             elapsed_ns - [IN] total run time in nanoseconds                *
+ *             result     - [OUT] benchmark result                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_bench_samples_calc(zbx_vector_uint64_t *samples, zbx_uint64_t ops, zbx_uint64_t elapsed_ns,
+		zbx_bench_result_t *result)
+{
+	zbx_vector_uint64_sort(samples, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	result->ops = ops;
+	result->elapsed = (double)elapsed_ns / 1e9;
+	result->ops_sec = (0 != elapsed_ns ? (double)ops * 1e9 / (double)elapsed_ns : 0);
+	result->p50 = bench_percentile(samples, 50);
+	result->p90 = bench_percentile(samples, 90);
+	result->p99 = bench_percentile(samples, 99);
+	result->max = (0 != samples->values_num ? (double)samples->values[samples->values_num - 1] : 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes benchmark for the configured duration or operation count *
+ *                                                                            *
+ * Parameters: bench  - [IN] benchmark definition                             *
+ *             opts   - [IN] run options                                      *
+ *             result - [OUT] benchmark result                                *
+ *                                                                            *
+ * Return value: SUCCEED - benchmark was executed                             *
+ *               FAIL    - benchmark setup failed                             *
+ *                                                                            *
+ * Comments: Operations are timed in batches of bench->batch operations to    *
+ *           keep clock overhead out of fast operations, each batch provides  *
+ *           one per operation latency sample.                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_bench_run(const zbx_bench_t *bench, const zbx_bench_opts_t *opts, zbx_bench_result_t *result)
+{
+	void			*data = NULL;
+	zbx_uint64_t		offset = 0, start, end, now, batch_start;
+	zbx_vector_uint64_t	samples;
+
+	zbx_bench_srand(1);
+
+	if (NULL != bench->setup && NULL == (data = bench->setup()))
+		return FAIL;
+
+	zbx_vector_uint64_create(&samples);
+	zbx_vector_uint64_reserve(&samples, 4096);
+
+	result->name = bench->name;
+
+	/* warmup */
+	end = zbx_bench_clock_ns() + (zbx_uint64_t)(opts->warmup * 1e9);
+
+	do
+	{
+		bench->run(data, offset, bench->batch);
+		offset += (zbx_uint64_t)bench->batch;
+	}
+	while (zbx_bench_clock_ns() < end);
+
+	offset = 0;
+	start = now = zbx_bench_clock_ns();
+	end = start + (zbx_uint64_t)(opts->duration * 1e9);
+
+	while (1)
+	{
+		batch_start = now;
+		bench->run(data, offset, bench->batch);
+		now = zbx_bench_clock_ns();
+
+		offset += (zbx_uint64_t)bench->batch;
+
+		if (BENCH_SAMPLES_MAX > samples.values_num)
+			zbx_vector_uint64_append(&samples, (now - batch_start) / (zbx_uint64_t)bench->batch);
+
+		if (0 != opts->ops_max)
+		{
+			if (offset >= opts->ops_max)
+				break;
+		}
+		else if (now >= end)
+			break;
+	}
+
+	zbx_bench_samples_calc(&samples, offset, now - start, result);
+
+	zbx_vector_uint64_destroy(&samples);
+
+	if (NULL != bench->teardown)
+		bench->teardown(data);
+
+	return SUCCEED;
+}
+
+void	zbx_bench_print_header(void)
+{
+	printf("%-40s %14s %12s %12s %12s %12s\n", "benchmark", "ops/sec", "p50 ns", "p90 ns", "p99 ns",
+			"max ns");
+}
+
+void	zbx_bench_print_result(const zbx_bench_result_t *result)
+{
+	printf("%-40s %14.0f %12.0f %12.0f %12.0f %12.0f\n", result->name, result->ops_sec, result->p50, result->p90,
+			result->p99, result->max);
+	fflush(stdout);
+}
+
+void	zbx_bench_json_result(struct zbx_json *json, const zbx_bench_result_t *result)
+{
+	zbx_json_addobject(json, NULL);
+	zbx_json_addstring(json, "name", result->name, ZBX_JSON_TYPE_STRING);
+	zbx_json_adduint64(json, "ops", result->ops);
+	zbx_json_addfloat(json, "elapsed", result->elapsed);
+	zbx_json_addfloat(json, "ops_sec", result->ops_sec);
+	zbx_json_addfloat(json, "p50", result->p50);
+	zbx_json_addfloat(json, "p90", result->p90);
+	zbx_json_addfloat(json, "p99", result->p99);
+	zbx_json_addfloat(json, "max", result->max);
+	zbx_json_close(json);
+}
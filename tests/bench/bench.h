@@ -0,0 +1,89 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_BENCH_H
+#define ZABBIX_BENCH_H
+
+#include "zbxalgo.h"
+#include "zbxjson.h"
+
+/* benchmark definition                                                           */
+/*   setup    - prepares benchmark data, called once before warmup                */
+/*   run      - executes num operations starting with operation index offset      */
+/*   teardown - frees benchmark data                                               */
+/*   batch    - number of operations timed together as one latency sample, use 1  */
+/*              for operations taking more than a few microseconds                */
+typedef struct
+{
+	const char	*name;
+	int		batch;
+	void		*(*setup)(void);
+	void		(*run)(void *data, zbx_uint64_t offset, int num);
+	void		(*teardown)(void *data);
+}
+zbx_bench_t;
+
+typedef struct
+{
+	const char	*name;
+	zbx_uint64_t	ops;
+	double		elapsed;
+	double		ops_sec;
+
+	/* operation latency percentiles in nanoseconds */
+	double		p50;
+	double		p90;
+	double		p99;
+	double		max;
+}
+zbx_bench_result_t;
+
+typedef struct
+{
+	double		duration;	/* measured run duration in seconds */
+	double		warmup;		/* warmup duration in seconds */
+	zbx_uint64_t	ops_max;	/* if set - run exactly ops_max operations instead of duration */
+}
+zbx_bench_opts_t;
+
+zbx_uint64_t	zbx_bench_clock_ns(void);
+void		zbx_bench_sleep_until(zbx_uint64_t deadline_ns);
+
+void		zbx_bench_srand(zbx_uint64_t seed);
+zbx_uint64_t	zbx_bench_rand(void);
+
+void	zbx_bench_samples_reset(zbx_vector_uint64_t *samples);
+void	zbx_bench_samples_calc(zbx_vector_uint64_t *samples, zbx_uint64_t ops, zbx_uint64_t elapsed_ns,
+		zbx_bench_result_t *result);
+
+int	zbx_bench_run(const zbx_bench_t *bench, const zbx_bench_opts_t *opts, zbx_bench_result_t *result);
+
+/* benchmark tables are terminated by entry with NULL name */
+typedef const zbx_bench_t	*(*zbx_bench_table_func_t)(void);
+
+const zbx_bench_t	*zbx_bench_algo(void);
+const zbx_bench_t	*zbx_bench_shmem(void);
+const zbx_bench_t	*zbx_bench_eval(void);
+const zbx_bench_t	*zbx_bench_jsonpath(void);
+const zbx_bench_t	*zbx_bench_prometheus(void);
+const zbx_bench_t	*zbx_bench_valuecache(void);
+const zbx_bench_t	*zbx_bench_sysinfo(void);
+
+void	zbx_bench_print_header(void);
+void	zbx_bench_print_result(const zbx_bench_result_t *result);
+void	zbx_bench_json_result(struct zbx_json *json, const zbx_bench_result_t *result);
+
+int	zbx_bench_main(int argc, char **argv, const zbx_bench_table_func_t *tables);
+
+#endif
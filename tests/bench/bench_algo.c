@@ -0,0 +1,183 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxalgo.h"
+
+#define BENCH_HASHSET_KEYS_NUM		100000
+#define BENCH_HASHSET_KEYS_NUM_LARGE	1000000
+
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	data[3];
+}
+bench_hashset_entry_t;
+
+typedef struct
+{
+	zbx_hashset_t	hs;
+	zbx_uint64_t	*keys;
+	zbx_uint64_t	*misses;
+	int		keys_num;
+}
+bench_hashset_t;
+
+static bench_hashset_t	*bench_hashset_create(int keys_num, int fill_num)
+{
+	bench_hashset_t	*bh;
+	int		i;
+
+	bh = (bench_hashset_t *)zbx_malloc(NULL, sizeof(bench_hashset_t));
+	bh->keys_num = keys_num;
+	bh->keys = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)bh->keys_num);
+	bh->misses = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)bh->keys_num);
+
+	/* even keys are stored, odd keys are used for lookup misses */
+	for (i = 0; i < bh->keys_num; i++)
+	{
+		bh->keys[i] = zbx_bench_rand() << 1;
+		bh->misses[i] = (zbx_bench_rand() << 1) | 1;
+	}
+
+	zbx_hashset_create(&bh->hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < fill_num; i++)
+	{
+		bench_hashset_entry_t	entry = {.id = bh->keys[i]};
+
+		zbx_hashset_insert(&bh->hs, &entry, sizeof(entry));
+	}
+
+	return bh;
+}
+
+static void	bench_hashset_teardown(void *data)
+{
+	bench_hashset_t	*bh = (bench_hashset_t *)data;
+
+	zbx_hashset_destroy(&bh->hs);
+	zbx_free(bh->keys);
+	zbx_free(bh->misses);
+	zbx_free(bh);
+}
+
+static void	*bench_hashset_full(void)
+{
+	return bench_hashset_create(BENCH_HASHSET_KEYS_NUM, BENCH_HASHSET_KEYS_NUM);
+}
+
+static void	*bench_hashset_half(void)
+{
+	return bench_hashset_create(BENCH_HASHSET_KEYS_NUM, BENCH_HASHSET_KEYS_NUM / 2);
+}
+
+/* large hashsets do not fit into CPU caches, like item tables of big installations */
+static void	*bench_hashset_large(void)
+{
+	return bench_hashset_create(BENCH_HASHSET_KEYS_NUM_LARGE, BENCH_HASHSET_KEYS_NUM_LARGE);
+}
+
+static void	bench_hashset_search_hit(void *data, zbx_uint64_t offset, int num)
+{
+	bench_hashset_t	*bh = (bench_hashset_t *)data;
+	int		i;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL == zbx_hashset_search(&bh->hs,
+				&bh->keys[(offset + (zbx_uint64_t)i) % (zbx_uint64_t)bh->keys_num]))
+		{
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static void	bench_hashset_search_miss(void *data, zbx_uint64_t offset, int num)
+{
+	bench_hashset_t	*bh = (bench_hashset_t *)data;
+	int		i;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL != zbx_hashset_search(&bh->hs,
+				&bh->misses[(offset + (zbx_uint64_t)i) % (zbx_uint64_t)bh->keys_num]))
+		{
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts one key and removes another keeping hashset at half of    *
+ *          the key pool                                                      *
+ *                                                                            *
+ * Comments: Before operation i the hashset contains keys [i, i + N/2) of the *
+ *           key pool (modulo N).                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_hashset_churn(void *data, zbx_uint64_t offset, int num)
+{
+	bench_hashset_t	*bh = (bench_hashset_t *)data;
+	zbx_uint64_t	n = (zbx_uint64_t)bh->keys_num, op;
+	int		i;
+
+	for (i = 0; i < num; i++)
+	{
+		bench_hashset_entry_t	entry;
+
+		op = offset + (zbx_uint64_t)i;
+		entry.id = bh->keys[(op + n / 2) % n];
+
+		zbx_hashset_insert(&bh->hs, &entry, sizeof(entry));
+		zbx_hashset_remove(&bh->hs, &bh->keys[op % n]);
+	}
+}
+
+static void	bench_hashset_iterate(void *data, zbx_uint64_t offset, int num)
+{
+	bench_hashset_t			*bh = (bench_hashset_t *)data;
+	zbx_hashset_iter_t		iter;
+	bench_hashset_entry_t		*entry;
+	int				i;
+	static volatile zbx_uint64_t	sum;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_hashset_iter_reset(&bh->hs, &iter);
+
+		while (NULL != (entry = (bench_hashset_entry_t *)zbx_hashset_iter_next(&iter)))
+			sum += entry->id;
+	}
+}
+
+static const zbx_bench_t	bench_algo[] = {
+	{"hashset_search_hit", 1000, bench_hashset_full, bench_hashset_search_hit, bench_hashset_teardown},
+	{"hashset_search_miss", 1000, bench_hashset_full, bench_hashset_search_miss, bench_hashset_teardown},
+	{"hashset_search_hit_1m", 1000, bench_hashset_large, bench_hashset_search_hit, bench_hashset_teardown},
+	{"hashset_search_miss_1m", 1000, bench_hashset_large, bench_hashset_search_miss, bench_hashset_teardown},
+	{"hashset_churn", 1000, bench_hashset_half, bench_hashset_churn, bench_hashset_teardown},
+	{"hashset_iterate_100k", 1, bench_hashset_full, bench_hashset_iterate, bench_hashset_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_algo(void)
+{
+	return bench_algo;
+}
@@ -0,0 +1,118 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxeval.h"
+#include "zbxvariant.h"
+
+#define BENCH_EVAL_RULES	ZBX_EVAL_PARSE_CALC_EXPRESSION
+
+static const char	*bench_eval_math = "(1.5 + 2 * 3 - 4 / 5) * 10 > 64 or 7 - 3 = 4 and not 0";
+static const char	*bench_eval_func = "round(sqrt(1024) + abs(-3) * log(10), 2) + length(left(\"abcdef\", 3))"
+		" + (mid(\"some text\", 6, 4) = \"text\")";
+
+typedef struct
+{
+	const char		*expression;
+	zbx_eval_context_t	ctx;
+}
+bench_eval_t;
+
+static bench_eval_t	*bench_eval_create(const char *expression)
+{
+	bench_eval_t	*be;
+	char		*error = NULL;
+
+	be = (bench_eval_t *)zbx_malloc(NULL, sizeof(bench_eval_t));
+	be->expression = expression;
+
+	if (SUCCEED != zbx_eval_parse_expression(&be->ctx, expression, BENCH_EVAL_RULES, &error))
+	{
+		printf("cannot parse expression \"%s\": %s\n", expression, error);
+		zbx_free(error);
+		zbx_free(be);
+		return NULL;
+	}
+
+	return be;
+}
+
+static void	*bench_eval_setup_math(void)
+{
+	return bench_eval_create(bench_eval_math);
+}
+
+static void	*bench_eval_setup_func(void)
+{
+	return bench_eval_create(bench_eval_func);
+}
+
+static void	bench_eval_teardown(void *data)
+{
+	bench_eval_t	*be = (bench_eval_t *)data;
+
+	zbx_eval_clear(&be->ctx);
+	zbx_free(be);
+}
+
+static void	bench_eval_parse(void *data, zbx_uint64_t offset, int num)
+{
+	bench_eval_t		*be = (bench_eval_t *)data;
+	zbx_eval_context_t	ctx;
+	char			*error = NULL;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_eval_parse_expression(&ctx, be->expression, BENCH_EVAL_RULES, &error))
+			exit(EXIT_FAILURE);
+
+		zbx_eval_clear(&ctx);
+	}
+}
+
+static void	bench_eval_execute(void *data, zbx_uint64_t offset, int num)
+{
+	bench_eval_t	*be = (bench_eval_t *)data;
+	zbx_variant_t	value;
+	char		*error = NULL;
+	int		i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_eval_execute(&be->ctx, NULL, &value, &error))
+			exit(EXIT_FAILURE);
+
+		zbx_variant_clear(&value);
+	}
+}
+
+static const zbx_bench_t	bench_eval[] = {
+	{"eval_parse_math", 100, bench_eval_setup_math, bench_eval_parse, bench_eval_teardown},
+	{"eval_parse_func", 100, bench_eval_setup_func, bench_eval_parse, bench_eval_teardown},
+	{"eval_execute_math", 100, bench_eval_setup_math, bench_eval_execute, bench_eval_teardown},
+	{"eval_execute_func", 100, bench_eval_setup_func, bench_eval_execute, bench_eval_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_eval(void)
+{
+	return bench_eval;
+}
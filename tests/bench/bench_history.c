@@ -0,0 +1,136 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+/* in-process history storage replacing database backends for benchmarks, linked with -Wl,--wrap */
+
+#include "bench_history.h"
+
+#include "zbxcommon.h"
+#include "zbxhistory.h"
+#include "../../src/libs/zbxhistory/history.h"
+
+static zbx_uint64_t	history_added;
+static zbx_uint64_t	history_read;
+
+int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
+		zbx_vector_history_record_t *values);
+int	__wrap_zbx_history_add_values(const zbx_vector_dc_history_ptr_t *history, int *ret_flush,
+		int config_history_storage_pipelines);
+void	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type);
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+void	__wrap_zbx_elastic_version_extract(struct zbx_json *json, int *result,
+		int config_allow_unsupported_db_versions, const char *config_history_storage_url);
+zbx_uint32_t	__wrap_zbx_elastic_version_get(void);
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns synthetic numeric history with one value per              *
+ *          BENCH_HISTORY_PERIOD seconds for the last BENCH_HISTORY_DEPTH     *
+ *          seconds up to the current time                                    *
+ *                                                                            *
+ * Comments: Values are returned in descending timestamp order from the       *
+ *           (start, end] range, limited by count if it is not zero - the     *
+ *           same contract as database backends have.                         *
+ *                                                                            *
+ ******************************************************************************/
+int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	int	clock, now;
+
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		return SUCCEED;
+
+	if (0 == count)
+		count = -1;
+
+	now = (int)time(NULL);
+
+	if (start < now - BENCH_HISTORY_DEPTH)
+		start = now - BENCH_HISTORY_DEPTH;
+
+	if (end > now)
+		end = now;
+
+	for (clock = end - end % BENCH_HISTORY_PERIOD; clock > start; clock -= BENCH_HISTORY_PERIOD)
+	{
+		zbx_history_record_t	record;
+
+		if (0 == count--)
+			break;
+
+		record.timestamp.sec = clock;
+		record.timestamp.ns = 0;
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			record.value.dbl = (double)(itemid + (zbx_uint64_t)clock % 1000) / 10;
+		else
+			record.value.ui64 = itemid + (zbx_uint64_t)clock % 1000;
+
+		zbx_vector_history_record_append_ptr(values, &record);
+		history_read++;
+	}
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_history_add_values(const zbx_vector_dc_history_ptr_t *history, int *ret_flush,
+		int config_history_storage_pipelines)
+{
+	ZBX_UNUSED(config_history_storage_pipelines);
+
+	history_added += (zbx_uint64_t)history->values_num;
+	*ret_flush = FLUSH_SUCCEED;
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+}
+
+int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_elastic_version_extract(struct zbx_json *json, int *result,
+		int config_allow_unsupported_db_versions, const char *config_history_storage_url)
+{
+	ZBX_UNUSED(json);
+	ZBX_UNUSED(result);
+	ZBX_UNUSED(config_allow_unsupported_db_versions);
+	ZBX_UNUSED(config_history_storage_url);
+}
+
+zbx_uint32_t	__wrap_zbx_elastic_version_get(void)
+{
+	return 0;
+}
+
+zbx_uint64_t	zbx_bench_history_added(void)
+{
+	return history_added;
+}
+
+zbx_uint64_t	zbx_bench_history_read(void)
+{
+	return history_read;
+}
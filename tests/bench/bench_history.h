@@ -0,0 +1,27 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_BENCH_HISTORY_H
+#define ZABBIX_BENCH_HISTORY_H
+
+#include "zbxtypes.h"
+
+/* synthetic history value period and stored history depth in seconds */
+#define BENCH_HISTORY_PERIOD	60
+#define BENCH_HISTORY_DEPTH	SEC_PER_DAY
+
+zbx_uint64_t	zbx_bench_history_added(void);
+zbx_uint64_t	zbx_bench_history_read(void);
+
+#endif
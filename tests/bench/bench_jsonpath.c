@@ -0,0 +1,190 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+#include "zbxstr.h"
+
+#define BENCH_JSONPATH_ROWS_NUM	1000
+
+typedef struct
+{
+	const char	*path;
+	char		*data;
+	zbx_jsonobj_t	obj;
+}
+bench_jsonpath_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates JSON document resembling HTTP agent master item value   *
+ *                                                                            *
+ ******************************************************************************/
+static char	*bench_jsonpath_document(void)
+{
+	struct zbx_json	j;
+	int		i;
+	char		name[64], *data;
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addarray(&j, "items");
+
+	for (i = 0; i < BENCH_JSONPATH_ROWS_NUM; i++)
+	{
+		zbx_json_addobject(&j, NULL);
+		zbx_json_adduint64(&j, "id", (zbx_uint64_t)i);
+		zbx_snprintf(name, sizeof(name), "item%d", i);
+		zbx_json_addstring(&j, "name", name, ZBX_JSON_TYPE_STRING);
+		zbx_json_addfloat(&j, "value", (double)(zbx_bench_rand() % 100000) / 100);
+		zbx_json_addobject(&j, "tags");
+		zbx_json_addstring(&j, "env", 0 == i % 3 ? "prod" : "test", ZBX_JSON_TYPE_STRING);
+		zbx_json_close(&j);
+		zbx_json_close(&j);
+	}
+
+	data = zbx_strdup(NULL, j.buffer);
+	zbx_json_free(&j);
+
+	return data;
+}
+
+static bench_jsonpath_t	*bench_jsonpath_create(const char *path)
+{
+	bench_jsonpath_t	*bj;
+
+	bj = (bench_jsonpath_t *)zbx_malloc(NULL, sizeof(bench_jsonpath_t));
+	bj->path = path;
+	bj->data = bench_jsonpath_document();
+
+	if (SUCCEED != zbx_jsonobj_open(bj->data, &bj->obj))
+	{
+		printf("cannot parse benchmark JSON document: %s\n", zbx_json_strerror());
+		zbx_free(bj->data);
+		zbx_free(bj);
+		return NULL;
+	}
+
+	return bj;
+}
+
+static void	*bench_jsonpath_setup_index(void)
+{
+	return bench_jsonpath_create("$.items[500].value");
+}
+
+static void	*bench_jsonpath_setup_filter(void)
+{
+	return bench_jsonpath_create("$.items[?(@.name == \"item700\")].value.first()");
+}
+
+static void	*bench_jsonpath_setup_aggregate(void)
+{
+	return bench_jsonpath_create("$.items[?(@.tags.env == \"prod\")].value.sum()");
+}
+
+static void	bench_jsonpath_teardown(void *data)
+{
+	bench_jsonpath_t	*bj = (bench_jsonpath_t *)data;
+
+	zbx_jsonobj_clear(&bj->obj);
+	zbx_free(bj->data);
+	zbx_free(bj);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queries raw JSON text, matching preprocessing without cached      *
+ *          master item value                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_jsonpath_query(void *data, zbx_uint64_t offset, int num)
+{
+	bench_jsonpath_t	*bj = (bench_jsonpath_t *)data;
+	struct zbx_json_parse	jp;
+	char			*output = NULL;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_json_open(bj->data, &jp) || SUCCEED != zbx_jsonpath_query(&jp, bj->path, &output) ||
+				NULL == output)
+		{
+			exit(EXIT_FAILURE);
+		}
+
+		zbx_free(output);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queries parsed JSON object, matching preprocessing with cached    *
+ *          master item value                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_jsonpath_query_obj(void *data, zbx_uint64_t offset, int num)
+{
+	bench_jsonpath_t	*bj = (bench_jsonpath_t *)data;
+	char			*output = NULL;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_jsonobj_query(&bj->obj, bj->path, &output) || NULL == output)
+			exit(EXIT_FAILURE);
+
+		zbx_free(output);
+	}
+}
+
+static void	bench_jsonpath_open(void *data, zbx_uint64_t offset, int num)
+{
+	bench_jsonpath_t	*bj = (bench_jsonpath_t *)data;
+	zbx_jsonobj_t		obj;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_jsonobj_open(bj->data, &obj))
+			exit(EXIT_FAILURE);
+
+		zbx_jsonobj_clear(&obj);
+	}
+}
+
+static const zbx_bench_t	bench_jsonpath[] = {
+	{"jsonobj_open_1k_rows", 1, bench_jsonpath_setup_index, bench_jsonpath_open, bench_jsonpath_teardown},
+	{"jsonpath_query_index", 1, bench_jsonpath_setup_index, bench_jsonpath_query, bench_jsonpath_teardown},
+	{"jsonpath_query_filter", 1, bench_jsonpath_setup_filter, bench_jsonpath_query, bench_jsonpath_teardown},
+	{"jsonpath_query_aggregate", 1, bench_jsonpath_setup_aggregate, bench_jsonpath_query,
+			bench_jsonpath_teardown},
+	{"jsonobj_query_index", 100, bench_jsonpath_setup_index, bench_jsonpath_query_obj, bench_jsonpath_teardown},
+	{"jsonobj_query_filter", 1, bench_jsonpath_setup_filter, bench_jsonpath_query_obj, bench_jsonpath_teardown},
+	{"jsonobj_query_aggregate", 1, bench_jsonpath_setup_aggregate, bench_jsonpath_query_obj,
+			bench_jsonpath_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_jsonpath(void)
+{
+	return bench_jsonpath;
+}
@@ -0,0 +1,176 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxgetopt.h"
+#include "zbxmutexs.h"
+#include "zbxnix.h"
+#include "zbxjson.h"
+#include "zbxlog.h"
+#include "zbxnum.h"
+
+ZBX_GET_CONFIG_VAR2(const char *, const char *, zbx_progname, NULL)
+
+static const char	*usage_message = "[-t seconds] [-w seconds] [-n operations] [-f filter] [-j] [-l]";
+
+static struct zbx_option	longopts[] =
+{
+	{"time",	1,	NULL,	't'},
+	{"warmup",	1,	NULL,	'w'},
+	{"ops",		1,	NULL,	'n'},
+	{"filter",	1,	NULL,	'f'},
+	{"json",	0,	NULL,	'j'},
+	{"list",	0,	NULL,	'l'},
+	{"help",	0,	NULL,	'h'},
+	{0}
+};
+
+static char	shortopts[] = "t:w:n:f:jlh";
+
+static void	bench_usage(void)
+{
+	printf("usage: %s %s\n", zbx_progname, usage_message);
+	printf("  -t, --time seconds      measured run time of each benchmark (default: 1)\n");
+	printf("  -w, --warmup seconds    warmup time of each benchmark (default: 0.2)\n");
+	printf("  -n, --ops operations    run fixed number of operations instead of fixed time\n");
+	printf("  -f, --filter filter     run only benchmarks containing filter in their name\n");
+	printf("  -j, --json              print results in JSON format\n");
+	printf("  -l, --list              list available benchmarks\n");
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses command line and runs benchmarks from the specified tables *
+ *                                                                            *
+ * Parameters: argc   - [IN]                                                  *
+ *             argv   - [IN]                                                  *
+ *             tables - [IN] benchmark table functions, terminated by NULL    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_bench_main(int argc, char **argv, const zbx_bench_table_func_t *tables)
+{
+	zbx_bench_opts_t	opts = {.duration = 1, .warmup = 0.2, .ops_max = 0};
+	const char		*filter = NULL;
+	char			ch, *zbx_optarg = NULL, *error = NULL;
+	int			zbx_optind = 0, json_output = 0, list = 0, i, ret = EXIT_SUCCESS;
+	struct zbx_json		json;
+	const zbx_bench_t	*bench;
+
+	zbx_progname = get_program_name(argv[0]);
+
+	zbx_set_log_level(LOG_LEVEL_WARNING);
+	zbx_init_library_common(zbx_log_impl, get_zbx_progname, zbx_backtrace);
+	zbx_init_library_nix(get_zbx_progname, NULL);
+
+	while ((char)EOF != (ch = (char)zbx_getopt_long(argc, argv, shortopts, longopts, NULL, &zbx_optarg,
+			&zbx_optind)))
+	{
+		switch (ch)
+		{
+			case 't':
+				if (SUCCEED != zbx_is_double(zbx_optarg, &opts.duration) || 0 >= opts.duration)
+				{
+					printf("invalid run time \"%s\"\n", zbx_optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'w':
+				if (SUCCEED != zbx_is_double(zbx_optarg, &opts.warmup) || 0 > opts.warmup)
+				{
+					printf("invalid warmup time \"%s\"\n", zbx_optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'n':
+				if (SUCCEED != zbx_is_uint64(zbx_optarg, &opts.ops_max) || 0 == opts.ops_max)
+				{
+					printf("invalid number of operations \"%s\"\n", zbx_optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'f':
+				filter = zbx_optarg;
+				break;
+			case 'j':
+				json_output = 1;
+				break;
+			case 'l':
+				list = 1;
+				break;
+			case 'h':
+				bench_usage();
+				exit(EXIT_SUCCESS);
+			default:
+				bench_usage();
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (SUCCEED != zbx_locks_create(&error))
+	{
+		printf("cannot create locks: %s\n", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
+	if (0 != json_output)
+	{
+		zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
+		zbx_json_addarray(&json, "benchmarks");
+	}
+	else if (0 == list)
+		zbx_bench_print_header();
+
+	for (i = 0; NULL != tables[i]; i++)
+	{
+		for (bench = tables[i](); NULL != bench->name; bench++)
+		{
+			zbx_bench_result_t	result;
+
+			if (NULL != filter && NULL == strstr(bench->name, filter))
+				continue;
+
+			if (0 != list)
+			{
+				printf("%s\n", bench->name);
+				continue;
+			}
+
+			if (SUCCEED != zbx_bench_run(bench, &opts, &result))
+			{
+				printf("cannot run benchmark \"%s\"\n", bench->name);
+				ret = EXIT_FAILURE;
+				continue;
+			}
+
+			if (0 != json_output)
+				zbx_bench_json_result(&json, &result);
+			else
+				zbx_bench_print_result(&result);
+		}
+	}
+
+	if (0 != json_output)
+	{
+		zbx_json_close(&json);
+		printf("%s\n", json.buffer);
+		zbx_json_free(&json);
+	}
+
+	zbx_locks_destroy();
+
+	return ret;
+}
@@ -0,0 +1,169 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxprometheus.h"
+#include "zbxstr.h"
+
+#define BENCH_PROMETHEUS_METRICS_NUM	50
+#define BENCH_PROMETHEUS_SERIES_NUM	20
+
+typedef struct
+{
+	const char		*filter;
+	const char		*request;
+	const char		*output;
+	char			*data;
+	zbx_prometheus_t	prom;
+}
+bench_prometheus_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates exposition format text resembling node/application      *
+ *          exporter output (1000 series)                                     *
+ *                                                                            *
+ ******************************************************************************/
+static char	*bench_prometheus_document(void)
+{
+	char	*data = NULL;
+	size_t	data_alloc = 0, data_offset = 0;
+	int	i, j;
+
+	for (i = 0; i < BENCH_PROMETHEUS_METRICS_NUM; i++)
+	{
+		zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "# HELP metric_%d_total Benchmark metric %d.\n"
+				"# TYPE metric_%d_total counter\n", i, i, i);
+
+		for (j = 0; j < BENCH_PROMETHEUS_SERIES_NUM; j++)
+		{
+			zbx_snprintf_alloc(&data, &data_alloc, &data_offset,
+					"metric_%d_total{instance=\"node%d\",code=\"%d\",handler=\"/api/v1/h%d\"} %d\n",
+					i, j % 4, 200 + (j % 5) * 100, j,
+					(int)(zbx_bench_rand() % 1000000));
+		}
+	}
+
+	return data;
+}
+
+static bench_prometheus_t	*bench_prometheus_create(const char *filter, const char *request, const char *output)
+{
+	bench_prometheus_t	*bp;
+	char			*error = NULL;
+
+	bp = (bench_prometheus_t *)zbx_malloc(NULL, sizeof(bench_prometheus_t));
+	bp->filter = filter;
+	bp->request = request;
+	bp->output = output;
+	bp->data = bench_prometheus_document();
+
+	if (SUCCEED != zbx_prometheus_init(&bp->prom, bp->data, &error))
+	{
+		printf("cannot parse benchmark prometheus data: %s\n", error);
+		zbx_free(error);
+		zbx_free(bp->data);
+		zbx_free(bp);
+		return NULL;
+	}
+
+	return bp;
+}
+
+static void	*bench_prometheus_setup_value(void)
+{
+	return bench_prometheus_create("metric_42_total{instance=\"node1\",handler=\"/api/v1/h13\"}", "value", "");
+}
+
+static void	*bench_prometheus_setup_sum(void)
+{
+	return bench_prometheus_create("metric_42_total{code=~\"5..\"}", "function", "sum");
+}
+
+static void	bench_prometheus_teardown(void *data)
+{
+	bench_prometheus_t	*bp = (bench_prometheus_t *)data;
+
+	zbx_prometheus_clear(&bp->prom);
+	zbx_free(bp->data);
+	zbx_free(bp);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses and queries raw text, matching preprocessing without       *
+ *          cached master item value                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_prometheus_pattern(void *data, zbx_uint64_t offset, int num)
+{
+	bench_prometheus_t	*bp = (bench_prometheus_t *)data;
+	char			*value = NULL, *error = NULL;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_prometheus_pattern(bp->data, bp->filter, bp->request, bp->output, &value, &error))
+			exit(EXIT_FAILURE);
+
+		zbx_free(value);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queries parsed data, matching preprocessing with cached master    *
+ *          item value                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_prometheus_pattern_ex(void *data, zbx_uint64_t offset, int num)
+{
+	bench_prometheus_t	*bp = (bench_prometheus_t *)data;
+	char			*value = NULL, *error = NULL;
+	int			i;
+
+	ZBX_UNUSED(offset);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != zbx_prometheus_pattern_ex(&bp->prom, bp->filter, bp->request, bp->output, &value,
+				&error))
+		{
+			exit(EXIT_FAILURE);
+		}
+
+		zbx_free(value);
+	}
+}
+
+static const zbx_bench_t	bench_prometheus[] = {
+	{"prometheus_pattern_value", 1, bench_prometheus_setup_value, bench_prometheus_pattern,
+			bench_prometheus_teardown},
+	{"prometheus_pattern_sum", 1, bench_prometheus_setup_sum, bench_prometheus_pattern,
+			bench_prometheus_teardown},
+	{"prometheus_pattern_ex_value", 10, bench_prometheus_setup_value, bench_prometheus_pattern_ex,
+			bench_prometheus_teardown},
+	{"prometheus_pattern_ex_sum", 10, bench_prometheus_setup_sum, bench_prometheus_pattern_ex,
+			bench_prometheus_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_prometheus(void)
+{
+	return bench_prometheus;
+}
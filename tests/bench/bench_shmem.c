@@ -0,0 +1,133 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxshmem.h"
+
+#define BENCH_SHMEM_SIZE	(64 * ZBX_MEBIBYTE)
+#define BENCH_SHMEM_LIVE_NUM	16384
+#define BENCH_SHMEM_SIZES_NUM	4096
+
+typedef struct
+{
+	zbx_shmem_info_t	*mem;
+	void			*live[BENCH_SHMEM_LIVE_NUM];
+	size_t			sizes[BENCH_SHMEM_SIZES_NUM];
+}
+bench_shmem_t;
+
+static bench_shmem_t	*bench_shmem_create(size_t size_min, size_t size_max)
+{
+	bench_shmem_t	*bs;
+	char		*error = NULL;
+	int		i;
+
+	bs = (bench_shmem_t *)zbx_malloc(NULL, sizeof(bench_shmem_t));
+	memset(bs->live, 0, sizeof(bs->live));
+
+	if (SUCCEED != zbx_shmem_create(&bs->mem, BENCH_SHMEM_SIZE, "benchmark", "benchmark", 0, &error))
+	{
+		printf("cannot create shared memory: %s\n", error);
+		zbx_free(error);
+		zbx_free(bs);
+		return NULL;
+	}
+
+	/* small allocations dominate configuration and value cache usage, so sizes are skewed to the low end */
+	for (i = 0; i < BENCH_SHMEM_SIZES_NUM; i++)
+	{
+		zbx_uint64_t	r = zbx_bench_rand() % (size_max - size_min + 1);
+
+		bs->sizes[i] = size_min + (size_t)(r * r / (size_max - size_min + 1));
+	}
+
+	/* half fill the live set so that both allocation and free paths are exercised from the start */
+	for (i = 0; i < BENCH_SHMEM_LIVE_NUM; i += 2)
+		bs->live[i] = zbx_shmem_malloc(bs->mem, NULL, bs->sizes[i % BENCH_SHMEM_SIZES_NUM]);
+
+	return bs;
+}
+
+static void	*bench_shmem_setup_small(void)
+{
+	return bench_shmem_create(16, 128);
+}
+
+static void	*bench_shmem_setup_mixed(void)
+{
+	return bench_shmem_create(16, 4096);
+}
+
+static void	bench_shmem_teardown(void *data)
+{
+	bench_shmem_t	*bs = (bench_shmem_t *)data;
+
+	zbx_shmem_destroy(bs->mem);
+	zbx_free(bs);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees a pseudo random live allocation and allocates a new one in  *
+ *          its place                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_shmem_churn(void *data, zbx_uint64_t offset, int num)
+{
+	bench_shmem_t	*bs = (bench_shmem_t *)data;
+	int		i, slot;
+
+	for (i = 0; i < num; i++)
+	{
+		slot = (int)(zbx_bench_rand() % BENCH_SHMEM_LIVE_NUM);
+
+		if (NULL != bs->live[slot])
+		{
+			zbx_shmem_free(bs->mem, bs->live[slot]);
+		}
+		else
+		{
+			bs->live[slot] = zbx_shmem_malloc(bs->mem, NULL,
+					bs->sizes[(offset + (zbx_uint64_t)i) % BENCH_SHMEM_SIZES_NUM]);
+		}
+	}
+}
+
+static void	bench_shmem_realloc(void *data, zbx_uint64_t offset, int num)
+{
+	bench_shmem_t	*bs = (bench_shmem_t *)data;
+	int		i, slot;
+
+	for (i = 0; i < num; i++)
+	{
+		slot = (int)(zbx_bench_rand() % BENCH_SHMEM_LIVE_NUM);
+
+		bs->live[slot] = zbx_shmem_realloc(bs->mem, bs->live[slot],
+				bs->sizes[(offset + (zbx_uint64_t)i) % BENCH_SHMEM_SIZES_NUM]);
+	}
+}
+
+static const zbx_bench_t	bench_shmem[] = {
+	{"shmem_alloc_free_16_128", 1000, bench_shmem_setup_small, bench_shmem_churn, bench_shmem_teardown},
+	{"shmem_alloc_free_16_4096", 1000, bench_shmem_setup_mixed, bench_shmem_churn, bench_shmem_teardown},
+	{"shmem_realloc_16_4096", 1000, bench_shmem_setup_mixed, bench_shmem_realloc, bench_shmem_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_shmem(void)
+{
+	return bench_shmem;
+}
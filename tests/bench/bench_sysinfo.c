@@ -0,0 +1,177 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+
+#include "zbxcommon.h"
+#include "zbxsysinfo.h"
+#include "../../src/libs/zbxsysinfo/sysinfo.h"
+#include "../../src/libs/zbxsysinfo/linux/proc.h"
+
+typedef struct
+{
+	const char	*key;
+	AGENT_REQUEST	request;
+}
+bench_sysinfo_item_t;
+
+/* reads kernel statistics file the way item handlers did before contents were shared */
+static void	bench_proc_file_fopen(const char *path, int num)
+{
+	char	line[MAX_STRING_LEN];
+
+	for (int i = 0; i < num; i++)
+	{
+		FILE	*f;
+
+		if (NULL == (f = fopen(path, "r")))
+			exit(EXIT_FAILURE);
+
+		while (NULL != fgets(line, sizeof(line), f))
+			;
+
+		zbx_fclose(f);
+	}
+}
+
+static void	bench_proc_file_shared(const char *path, int num)
+{
+	char	line[MAX_STRING_LEN];
+
+	for (int i = 0; i < num; i++)
+	{
+		FILE	*f;
+
+		if (NULL == (f = proc_file_open(path)))
+			exit(EXIT_FAILURE);
+
+		while (NULL != fgets(line, sizeof(line), f))
+			;
+
+		zbx_fclose(f);
+	}
+}
+
+static void	bench_stat_fopen(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(offset);
+
+	bench_proc_file_fopen("/proc/stat", num);
+}
+
+static void	bench_stat_shared(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(offset);
+
+	bench_proc_file_shared("/proc/stat", num);
+}
+
+static void	bench_meminfo_fopen(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(offset);
+
+	bench_proc_file_fopen("/proc/meminfo", num);
+}
+
+static void	bench_meminfo_shared(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(offset);
+
+	bench_proc_file_shared("/proc/meminfo", num);
+}
+
+static void	*bench_item_setup(const char *key)
+{
+	bench_sysinfo_item_t	*item;
+
+	item = (bench_sysinfo_item_t *)zbx_malloc(NULL, sizeof(bench_sysinfo_item_t));
+	item->key = key;
+	zbx_init_agent_request(&item->request);
+
+	if (SUCCEED != zbx_parse_item_key(key, &item->request))
+	{
+		printf("cannot parse item key \"%s\"\n", key);
+		zbx_free(item);
+		return NULL;
+	}
+
+	return item;
+}
+
+static void	*bench_cpu_switches_setup(void)
+{
+	return bench_item_setup("system.cpu.switches");
+}
+
+static void	*bench_memory_size_setup(void)
+{
+	return bench_item_setup("vm.memory.size[available]");
+}
+
+static void	bench_item_teardown(void *data)
+{
+	bench_sysinfo_item_t	*item = (bench_sysinfo_item_t *)data;
+
+	zbx_free_agent_request(&item->request);
+	zbx_free(item);
+}
+
+static void	bench_item_run(bench_sysinfo_item_t *item, int (*func)(AGENT_REQUEST *, AGENT_RESULT *), int num)
+{
+	for (int i = 0; i < num; i++)
+	{
+		AGENT_RESULT	result;
+
+		zbx_init_agent_result(&result);
+
+		if (SYSINFO_RET_OK != func(&item->request, &result))
+			exit(EXIT_FAILURE);
+
+		zbx_free_agent_result(&result);
+	}
+}
+
+static void	bench_cpu_switches(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(offset);
+
+	bench_item_run((bench_sysinfo_item_t *)data, system_cpu_switches, num);
+}
+
+static void	bench_memory_size(void *data, zbx_uint64_t offset, int num)
+{
+	ZBX_UNUSED(offset);
+
+	bench_item_run((bench_sysinfo_item_t *)data, vm_memory_size, num);
+}
+
+/* fopen benchmarks show the cost of per-item reads that proc_file_open() replaces */
+static const zbx_bench_t	bench_sysinfo[] = {
+	{"sysinfo_proc_stat_fopen", 10, NULL, bench_stat_fopen, NULL},
+	{"sysinfo_proc_stat_shared", 10, NULL, bench_stat_shared, NULL},
+	{"sysinfo_proc_meminfo_fopen", 10, NULL, bench_meminfo_fopen, NULL},
+	{"sysinfo_proc_meminfo_shared", 10, NULL, bench_meminfo_shared, NULL},
+	{"sysinfo_cpu_switches", 10, bench_cpu_switches_setup, bench_cpu_switches, bench_item_teardown},
+	{"sysinfo_memory_size_available", 10, bench_memory_size_setup, bench_memory_size, bench_item_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_sysinfo(void)
+{
+	return bench_sysinfo;
+}
@@ -0,0 +1,133 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "bench.h"
+#include "bench_history.h"
+
+#include "zbxcommon.h"
+#include "zbxcachevalue.h"
+#include "zbxhistory.h"
+#include "zbxtime.h"
+
+#define BENCH_VC_SIZE		(256 * ZBX_MEBIBYTE)
+#define BENCH_VC_ITEMS_NUM	10000
+#define BENCH_VC_ITEMID_BASE	100000
+
+typedef struct
+{
+	zbx_timespec_t	ts;
+	int		seconds;
+	int		count;
+}
+bench_vc_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value cache and warms up items with one hour of       *
+ *          synthetic history                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static bench_vc_t	*bench_vc_create(int seconds, int count)
+{
+	bench_vc_t			*bv;
+	char				*error = NULL;
+	int				i;
+	zbx_vector_history_record_t	values;
+
+	if (SUCCEED != zbx_vc_init(BENCH_VC_SIZE, &error))
+	{
+		printf("cannot initialize value cache: %s\n", error);
+		zbx_free(error);
+		return NULL;
+	}
+
+	zbx_vc_enable();
+
+	bv = (bench_vc_t *)zbx_malloc(NULL, sizeof(bench_vc_t));
+	bv->seconds = seconds;
+	bv->count = count;
+	zbx_timespec(&bv->ts);
+
+	zbx_history_record_vector_create(&values);
+
+	for (i = 0; i < BENCH_VC_ITEMS_NUM; i++)
+	{
+		zbx_vc_get_values(BENCH_VC_ITEMID_BASE + (zbx_uint64_t)i, ITEM_VALUE_TYPE_FLOAT, &values, SEC_PER_HOUR,
+				0, &bv->ts);
+		zbx_history_record_vector_clean(&values, ITEM_VALUE_TYPE_FLOAT);
+	}
+
+	zbx_history_record_vector_destroy(&values, ITEM_VALUE_TYPE_FLOAT);
+
+	return bv;
+}
+
+static void	*bench_vc_setup_last(void)
+{
+	return bench_vc_create(0, 1);
+}
+
+static void	*bench_vc_setup_hour(void)
+{
+	return bench_vc_create(SEC_PER_HOUR, 0);
+}
+
+static void	*bench_vc_setup_count(void)
+{
+	return bench_vc_create(0, 10);
+}
+
+static void	bench_vc_teardown(void *data)
+{
+	zbx_vc_destroy();
+	zbx_free(data);
+}
+
+static void	bench_vc_get_values(void *data, zbx_uint64_t offset, int num)
+{
+	bench_vc_t			*bv = (bench_vc_t *)data;
+	zbx_vector_history_record_t	values;
+	int				i;
+
+	ZBX_UNUSED(offset);
+
+	zbx_history_record_vector_create(&values);
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_uint64_t	itemid = BENCH_VC_ITEMID_BASE + zbx_bench_rand() % BENCH_VC_ITEMS_NUM;
+
+		if (SUCCEED != zbx_vc_get_values(itemid, ITEM_VALUE_TYPE_FLOAT, &values, bv->seconds, bv->count,
+				&bv->ts) || 0 == values.values_num)
+		{
+			exit(EXIT_FAILURE);
+		}
+
+		zbx_history_record_vector_clean(&values, ITEM_VALUE_TYPE_FLOAT);
+	}
+
+	zbx_history_record_vector_destroy(&values, ITEM_VALUE_TYPE_FLOAT);
+}
+
+static const zbx_bench_t	bench_valuecache[] = {
+	{"vc_get_values_last", 100, bench_vc_setup_last, bench_vc_get_values, bench_vc_teardown},
+	{"vc_get_values_count_10", 100, bench_vc_setup_count, bench_vc_get_values, bench_vc_teardown},
+	{"vc_get_values_1h", 10, bench_vc_setup_hour, bench_vc_get_values, bench_vc_teardown},
+	{0}
+};
+
+const zbx_bench_t	*zbx_bench_valuecache(void)
+{
+	return bench_valuecache;
+}
@@ -0,0 +1,700 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+/* synthetic NVPS load generator for trapper (sender data) ingestion                                   */
+/*                                                                                                     */
+/* Each request is processed by zbx_process_sender_history_data() - the same function trapper uses     */
+/* for sender data - and then synced from history cache to value cache by a history syncer step. The  */
+/* database is stubbed out:                                                                            */
+/*   * configuration cache is populated directly with hosts and trapper items instead of database sync */
+/*   * values are passed to history cache the same way preprocessing manager does for items without    */
+/*     preprocessing steps, without the preprocessing IPC                                             */
+/*   * history syncer step covers history cache, value cache and trend cache updates, the history     */
+/*     storage is replaced with in-process storage (see bench_history.c), trigger processing and      */
+/*     database updates of items and trends are not performed                                          */
+/*                                                                                                     */
+/* With target rate set the requests are issued on a fixed schedule (open loop) and latency is         */
+/* measured from the scheduled request time, so that stalls are not hidden by delaying the following   */
+/* requests.                                                                                           */
+
+#include "bench.h"
+#include "bench_history.h"
+
+#include "dbconfig.h"
+
+#include "zbxcommon.h"
+#include "zbxalgo.h"
+#include "zbxcacheconfig.h"
+#include "zbxcachehistory.h"
+#include "zbxcachevalue.h"
+#include "zbxcomms.h"
+#include "zbx_item_constants.h"
+#include "zbxdbwrap.h"
+#include "zbxgetopt.h"
+#include "zbxhistory.h"
+#include "zbxjson.h"
+#include "zbxlog.h"
+#include "zbxmutexs.h"
+#include "zbxnix.h"
+#include "zbxnum.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+#include "zbxvariant.h"
+
+#define BENCH_NVPS_VC_SIZE		(256 * ZBX_MEBIBYTE)
+#define BENCH_NVPS_HC_SIZE		(256 * ZBX_MEBIBYTE)
+#define BENCH_NVPS_HC_INDEX_SIZE	(64 * ZBX_MEBIBYTE)
+#define BENCH_NVPS_TREND_CACHE_SIZE	(64 * ZBX_MEBIBYTE)
+#define BENCH_NVPS_REQUESTS_NUM		64
+#define BENCH_NVPS_HOST_LEN		256
+#define BENCH_NVPS_HOSTID_BASE		10000
+#define BENCH_NVPS_ITEMID_BASE		100000
+
+ZBX_GET_CONFIG_VAR2(const char *, const char *, zbx_progname, NULL)
+
+static const char	*usage_message = "[-r values/sec] [-b values] [-H hosts] [-k keys] [-t seconds] [-j]";
+
+static struct zbx_option	longopts[] =
+{
+	{"rate",	1,	NULL,	'r'},
+	{"batch",	1,	NULL,	'b'},
+	{"hosts",	1,	NULL,	'H'},
+	{"keys",	1,	NULL,	'k'},
+	{"time",	1,	NULL,	't'},
+	{"json",	0,	NULL,	'j'},
+	{"help",	0,	NULL,	'h'},
+	{0}
+};
+
+static char	shortopts[] = "r:b:H:k:t:jh";
+
+typedef struct
+{
+	zbx_dc_config_t		config;
+	zbx_dc_config_table_t	config_table;
+	ZBX_DC_NUMITEM		numitem;
+	char			*requests[BENCH_NVPS_REQUESTS_NUM];
+	zbx_socket_t		sock;
+	zbx_uint64_t		failed;
+}
+bench_nvps_t;
+
+static unsigned char	bench_nvps_get_program_type(void)
+{
+	return ZBX_PROGRAM_TYPE_SERVER;
+}
+
+static zbx_hash_t	bench_nvps_host_h_hash(const void *data)
+{
+	const ZBX_DC_HOST_H	*host_h = (const ZBX_DC_HOST_H *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(host_h->host, strlen(host_h->host), ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	bench_nvps_host_h_compare(const void *d1, const void *d2)
+{
+	const ZBX_DC_HOST_H	*host_h_1 = (const ZBX_DC_HOST_H *)d1;
+	const ZBX_DC_HOST_H	*host_h_2 = (const ZBX_DC_HOST_H *)d2;
+
+	return strcmp(host_h_1->host, host_h_2->host);
+}
+
+static zbx_hash_t	bench_nvps_item_hk_hash(const void *data)
+{
+	const ZBX_DC_ITEM_HK	*item_hk = (const ZBX_DC_ITEM_HK *)data;
+	zbx_hash_t		hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_FUNC(&item_hk->hostid);
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(item_hk->key, strlen(item_hk->key), hash);
+}
+
+static int	bench_nvps_item_hk_compare(const void *d1, const void *d2)
+{
+	const ZBX_DC_ITEM_HK	*item_hk_1 = (const ZBX_DC_ITEM_HK *)d1;
+	const ZBX_DC_ITEM_HK	*item_hk_2 = (const ZBX_DC_ITEM_HK *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(item_hk_1->hostid, item_hk_2->hostid);
+
+	return strcmp(item_hk_1->key, item_hk_2->key);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes received value to history cache                            *
+ *                                                                            *
+ * Comments: Replaces zbx_preprocess_item_value(). Preprocessing manager      *
+ *           flushes values of items without preprocessing steps directly to  *
+ *           history cache, so the preprocessing IPC is skipped.              *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_nvps_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error)
+{
+	ZBX_UNUSED(hostid);
+
+	zbx_dc_add_history(itemid, item_value_type, item_flags, result, ts, state, error);
+}
+
+static void	bench_nvps_preprocessor_flush(void)
+{
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares history value for storing, see DCmass_prepare_history()  *
+ *          and normalize_item_value() in server history syncer               *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_nvps_prepare_history(zbx_dc_history_t *h, const zbx_history_sync_item_t *item, int errcode)
+{
+	zbx_variant_t	value;
+	char		*errmsg = NULL;
+
+	if (SUCCEED != errcode || ITEM_STATUS_ACTIVE != item->status || HOST_STATUS_MONITORED != item->host.status)
+	{
+		h->flags |= ZBX_DC_FLAG_UNDEF;
+		return;
+	}
+
+	if (0 == item->history)
+		h->flags |= ZBX_DC_FLAG_NOHISTORY;
+
+	if (0 == item->trends)
+		h->flags |= ZBX_DC_FLAG_NOTRENDS;
+
+	if (0 != item->has_trigger)
+		h->flags |= ZBX_DC_FLAG_HASTRIGGER;
+
+	if (0 != (h->flags & ZBX_DC_FLAG_NOVALUE) || ITEM_STATE_NOTSUPPORTED == h->state)
+		return;
+
+	h->ttl = item->history_sec;
+
+	if (item->value_type == h->value_type || (ITEM_VALUE_TYPE_STR != h->value_type &&
+			ITEM_VALUE_TYPE_TEXT != h->value_type))
+	{
+		return;
+	}
+
+	zbx_variant_set_str(&value, h->value.str);
+	h->value.str = NULL;
+
+	if (SUCCEED != zbx_variant_to_value_type(&value, item->value_type, &errmsg))
+	{
+		h->value.err = errmsg;
+		h->state = ITEM_STATE_NOTSUPPORTED;
+		h->flags |= ZBX_DC_FLAG_UNDEF;
+		zbx_variant_clear(&value);
+		return;
+	}
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			h->value.dbl = value.data.dbl;
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			h->value.ui64 = value.data.ui64;
+			break;
+		default:
+			h->value.str = value.data.str;
+			zbx_variant_set_none(&value);
+	}
+
+	h->value_type = item->value_type;
+	zbx_variant_clear(&value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: history syncer step without database                              *
+ *                                                                            *
+ * Comments: Follows zbx_sync_server_history() - values are taken from        *
+ *           history cache, prepared using item configuration from            *
+ *           configuration cache, added to history storage and value cache    *
+ *           and trend cache is updated. The trends closed by update are not  *
+ *           flushed to database.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_nvps_sync_history(int *values_num, int *triggers_num, const zbx_events_funcs_t *events_cbs,
+		zbx_ipc_async_socket_t *rtc, int config_history_storage_pipelines, int *more)
+{
+	static zbx_dc_history_t		history[ZBX_HC_SYNC_MAX];
+	static zbx_history_sync_item_t	items[ZBX_HC_SYNC_MAX];
+	static int			errcodes[ZBX_HC_SYNC_MAX];
+	zbx_uint64_t			itemids[ZBX_HC_SYNC_MAX];
+	zbx_vector_hc_item_ptr_t	history_items;
+	zbx_vector_dc_history_ptr_t	history_values;
+	int				i, history_num, ret_flush, trends_num;
+	ZBX_DC_TREND			*trends;
+
+	ZBX_UNUSED(triggers_num);
+	ZBX_UNUSED(events_cbs);
+	ZBX_UNUSED(rtc);
+
+	zbx_vector_hc_item_ptr_create(&history_items);
+	zbx_vector_hc_item_ptr_reserve(&history_items, ZBX_HC_SYNC_MAX);
+	zbx_vector_dc_history_ptr_create(&history_values);
+	zbx_vector_dc_history_ptr_reserve(&history_values, ZBX_HC_SYNC_MAX);
+
+	do
+	{
+		*more = ZBX_SYNC_DONE;
+
+		zbx_dbcache_lock();
+		zbx_hc_pop_items(&history_items);
+		zbx_dbcache_unlock();
+
+		if (0 == (history_num = history_items.values_num))
+			break;
+
+		zbx_vector_hc_item_ptr_sort(&history_items, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+		zbx_hc_get_item_values(history, &history_items);
+
+		for (i = 0; i < history_num; i++)
+			itemids[i] = history[i].itemid;
+
+		zbx_dc_config_history_sync_get_items_by_itemids(items, itemids, errcodes, (size_t)history_num,
+				ZBX_ITEM_GET_SYNC);
+
+		for (i = 0; i < history_num; i++)
+		{
+			bench_nvps_prepare_history(&history[i], &items[i], errcodes[i]);
+
+			if (0 == (ZBX_DC_FLAGS_NOT_FOR_HISTORY & history[i].flags))
+				zbx_vector_dc_history_ptr_append(&history_values, &history[i]);
+		}
+
+		if (0 != history_values.values_num)
+			zbx_vc_add_values(&history_values, &ret_flush, config_history_storage_pipelines);
+
+		trends = NULL;
+		trends_num = 0;
+		zbx_dc_mass_update_trends(history, history_num, &trends, &trends_num, 0);
+		zbx_free(trends);
+
+		zbx_dc_config_clean_history_sync_items(items, errcodes, (size_t)history_num);
+
+		zbx_dbcache_lock();
+		zbx_hc_push_items(&history_items);
+		zbx_dbcache_set_history_num(zbx_dbcache_get_history_num() - history_num);
+
+		if (0 != zbx_hc_queue_get_size())
+			*more = ZBX_SYNC_MORE;
+
+		zbx_dbcache_unlock();
+
+		*values_num += history_num;
+
+		zbx_hc_free_item_values(history, history_num);
+		zbx_vector_hc_item_ptr_clear(&history_items);
+		zbx_vector_dc_history_ptr_clear(&history_values);
+	}
+	while (ZBX_SYNC_MORE == *more);
+
+	zbx_vector_dc_history_ptr_destroy(&history_values);
+	zbx_vector_hc_item_ptr_destroy(&history_items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: populates configuration cache with monitored hosts and float      *
+ *          trapper items                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_nvps_config_init(bench_nvps_t *bn, int hosts_num, int keys_num)
+{
+	int	i, j;
+	char	buf[BENCH_NVPS_HOST_LEN];
+
+	bn->config.config = &bn->config_table;
+	bn->numitem.units = "";
+	bn->numitem.trends_period = "365d";
+
+	zbx_hashset_create(&bn->config.hosts, (size_t)hosts_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&bn->config.hosts_h, (size_t)hosts_num, bench_nvps_host_h_hash,
+			bench_nvps_host_h_compare);
+	zbx_hashset_create(&bn->config.items, (size_t)(hosts_num * keys_num), ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&bn->config.items_hk, (size_t)(hosts_num * keys_num), bench_nvps_item_hk_hash,
+			bench_nvps_item_hk_compare);
+
+	set_dc_config(&bn->config);
+
+	for (i = 0; i < hosts_num; i++)
+	{
+		ZBX_DC_HOST	host_local = {0}, *host;
+		ZBX_DC_HOST_H	host_h;
+
+		zbx_snprintf(buf, sizeof(buf), "host%d", i);
+
+		host_local.hostid = BENCH_NVPS_HOSTID_BASE + (zbx_uint64_t)i;
+		host_local.host = zbx_strdup(NULL, buf);
+		host_local.name = host_local.host;
+		host_local.status = HOST_STATUS_MONITORED;
+		host_local.monitored_by = HOST_MONITORED_BY_SERVER;
+		host_local.tls_accept = ZBX_TCP_SEC_UNENCRYPTED;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+		host_local.tls_issuer = "";
+		host_local.tls_subject = "";
+#endif
+		host = (ZBX_DC_HOST *)zbx_hashset_insert(&bn->config.hosts, &host_local, sizeof(host_local));
+
+		host_h.host = host->host;
+		host_h.host_ptr = host;
+		zbx_hashset_insert(&bn->config.hosts_h, &host_h, sizeof(host_h));
+
+		for (j = 0; j < keys_num; j++)
+		{
+			ZBX_DC_ITEM	item_local = {0}, *item;
+			ZBX_DC_ITEM_HK	item_hk;
+
+			zbx_snprintf(buf, sizeof(buf), "app.metric[%d,avg]", j);
+
+			item_local.itemid = BENCH_NVPS_ITEMID_BASE + (zbx_uint64_t)(i * keys_num + j);
+			item_local.hostid = host->hostid;
+			item_local.key = zbx_strdup(NULL, buf);
+			item_local.error = "";
+			item_local.history_period = "1w";
+			item_local.itemvaluetype.numitem = &bn->numitem;
+			item_local.type = ITEM_TYPE_TRAPPER;
+			item_local.value_type = ITEM_VALUE_TYPE_FLOAT;
+			item_local.status = ITEM_STATUS_ACTIVE;
+			item_local.state = ITEM_STATE_NORMAL;
+			item = (ZBX_DC_ITEM *)zbx_hashset_insert(&bn->config.items, &item_local, sizeof(item_local));
+
+			item_hk.hostid = item->hostid;
+			item_hk.key = item->key;
+			item_hk.item_ptr = item;
+			zbx_hashset_insert(&bn->config.items_hk, &item_hk, sizeof(item_hk));
+		}
+	}
+}
+
+static void	bench_nvps_free_str(const char *str)
+{
+	char	*ptr = (char *)str;
+
+	zbx_free(ptr);
+}
+
+static void	bench_nvps_config_clear(bench_nvps_t *bn)
+{
+	zbx_hashset_iter_t	iter;
+	ZBX_DC_HOST		*host;
+	ZBX_DC_ITEM		*item;
+
+	set_dc_config(NULL);
+
+	zbx_hashset_iter_reset(&bn->config.items, &iter);
+	while (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
+		bench_nvps_free_str(item->key);
+
+	zbx_hashset_iter_reset(&bn->config.hosts, &iter);
+	while (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_iter_next(&iter)))
+		bench_nvps_free_str(host->host);
+
+	zbx_hashset_destroy(&bn->config.items_hk);
+	zbx_hashset_destroy(&bn->config.items);
+	zbx_hashset_destroy(&bn->config.hosts_h);
+	zbx_hashset_destroy(&bn->config.hosts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates configuration cache and pregenerated sender data requests *
+ *                                                                            *
+ * Comments: Requests carry no clock, so the values are timestamped on        *
+ *           arrival like sender data without -T option and requests can be   *
+ *           replayed indefinitely.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	bench_nvps_init(bench_nvps_t *bn, int hosts_num, int keys_num, int batch)
+{
+	int				i, j, items_num = hosts_num * keys_num;
+	char				host[BENCH_NVPS_HOST_LEN], key[BENCH_NVPS_HOST_LEN], value[MAX_ID_LEN];
+	zbx_timespec_t			ts;
+	zbx_vector_history_record_t	values;
+
+	memset(bn, 0, sizeof(bench_nvps_t));
+
+	bench_nvps_config_init(bn, hosts_num, keys_num);
+
+	bn->sock.connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+	zbx_strscpy(bn->sock.peer, "127.0.0.1");
+
+	zbx_timespec(&ts);
+	zbx_history_record_vector_create(&values);
+
+	/* items used in triggers are cached by the first trigger evaluation */
+	for (i = 0; i < items_num; i++)
+	{
+		zbx_vc_get_values(BENCH_NVPS_ITEMID_BASE + (zbx_uint64_t)i, ITEM_VALUE_TYPE_FLOAT, &values,
+				SEC_PER_HOUR, 0, &ts);
+		zbx_history_record_vector_clean(&values, ITEM_VALUE_TYPE_FLOAT);
+	}
+
+	zbx_history_record_vector_destroy(&values, ITEM_VALUE_TYPE_FLOAT);
+
+	for (i = 0; i < BENCH_NVPS_REQUESTS_NUM; i++)
+	{
+		struct zbx_json	j_req;
+
+		zbx_json_init(&j_req, ZBX_JSON_STAT_BUF_LEN);
+		zbx_json_addstring(&j_req, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_SENDER_DATA, ZBX_JSON_TYPE_STRING);
+		zbx_json_addarray(&j_req, ZBX_PROTO_TAG_DATA);
+
+		for (j = 0; j < batch; j++)
+		{
+			int	index = (int)(((zbx_uint64_t)i * (zbx_uint64_t)batch + (zbx_uint64_t)j) %
+					(zbx_uint64_t)items_num);
+
+			zbx_snprintf(host, sizeof(host), "host%d", index / keys_num);
+			zbx_snprintf(key, sizeof(key), "app.metric[%d,avg]", index % keys_num);
+			zbx_snprintf(value, sizeof(value), "%d.%02d", (int)(zbx_bench_rand() % 10000),
+					(int)(zbx_bench_rand() % 100));
+
+			zbx_json_addobject(&j_req, NULL);
+			zbx_json_addstring(&j_req, ZBX_PROTO_TAG_HOST, host, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&j_req, ZBX_PROTO_TAG_KEY, key, ZBX_JSON_TYPE_STRING);
+			zbx_json_addstring(&j_req, ZBX_PROTO_TAG_VALUE, value, ZBX_JSON_TYPE_STRING);
+			zbx_json_close(&j_req);
+		}
+
+		bn->requests[i] = zbx_strdup(NULL, j_req.buffer);
+		zbx_json_free(&j_req);
+	}
+}
+
+static void	bench_nvps_clear(bench_nvps_t *bn)
+{
+	int	i;
+
+	for (i = 0; i < BENCH_NVPS_REQUESTS_NUM; i++)
+		zbx_free(bn->requests[i]);
+
+	bench_nvps_config_clear(bn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes one sender data request and syncs received values       *
+ *                                                                            *
+ * Return value: number of values processed by trapper                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	bench_nvps_process(bench_nvps_t *bn, const char *request)
+{
+	struct zbx_json_parse	jp;
+	zbx_timespec_t		ts;
+	char			*info = NULL;
+	int			processed = 0, failed = 0, values_num, triggers_num, more;
+	zbx_events_funcs_t	events_cbs = {0};
+
+	zbx_timespec(&ts);
+
+	if (SUCCEED != zbx_json_open(request, &jp) ||
+			SUCCEED != zbx_process_sender_history_data(&bn->sock, &jp, &ts, &info) ||
+			2 != sscanf(info, "processed: %d; failed: %d", &processed, &failed))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process sender data: %s", ZBX_NULL2EMPTY_STR(info));
+		bn->failed++;
+		zbx_free(info);
+
+		return 0;
+	}
+
+	zbx_free(info);
+
+	bn->failed += (zbx_uint64_t)failed;
+
+	zbx_sync_history_cache(&events_cbs, NULL, 1, &values_num, &triggers_num, &more);
+
+	return processed;
+}
+
+static void	bench_nvps_usage(void)
+{
+	printf("usage: %s %s\n", zbx_progname, usage_message);
+	printf("  -r, --rate values/sec   target ingestion rate, 0 - unthrottled (default: 0)\n");
+	printf("  -b, --batch values      values per sender request (default: 250)\n");
+	printf("  -H, --hosts hosts       number of hosts (default: 100)\n");
+	printf("  -k, --keys keys         number of items per host (default: 100)\n");
+	printf("  -t, --time seconds      run time (default: 10)\n");
+	printf("  -j, --json              print result in JSON format\n");
+}
+
+static int	bench_nvps_parse_int(const char *str, int min, int max, int *value)
+{
+	if (SUCCEED != zbx_is_uint31(str, value) || *value < min || *value > max)
+	{
+		printf("invalid value \"%s\"\n", str);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+int	main(int argc, char **argv)
+{
+	char			ch, *zbx_optarg = NULL, *error = NULL;
+	int			zbx_optind = 0, json_output = 0, batch = 250, hosts_num = 100, keys_num = 100,
+				request = 0;
+	double			rate = 0, duration = 10;
+	zbx_uint64_t		start, end, now, scheduled, interval_ns = 0, values_num = 0,
+				trend_cache_size = BENCH_NVPS_TREND_CACHE_SIZE;
+	zbx_vector_uint64_t	samples;
+	zbx_bench_result_t	result;
+	bench_nvps_t		bn;
+
+	zbx_progname = get_program_name(argv[0]);
+
+	zbx_set_log_level(LOG_LEVEL_WARNING);
+	zbx_init_library_common(zbx_log_impl, get_zbx_progname, zbx_backtrace);
+	zbx_init_library_nix(get_zbx_progname, NULL);
+
+	while ((char)EOF != (ch = (char)zbx_getopt_long(argc, argv, shortopts, longopts, NULL, &zbx_optarg,
+			&zbx_optind)))
+	{
+		switch (ch)
+		{
+			case 'r':
+				if (SUCCEED != zbx_is_double(zbx_optarg, &rate) || 0 > rate)
+				{
+					printf("invalid rate \"%s\"\n", zbx_optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'b':
+				if (SUCCEED != bench_nvps_parse_int(zbx_optarg, 1, 100000, &batch))
+					exit(EXIT_FAILURE);
+				break;
+			case 'H':
+				if (SUCCEED != bench_nvps_parse_int(zbx_optarg, 1, 100000, &hosts_num))
+					exit(EXIT_FAILURE);
+				break;
+			case 'k':
+				if (SUCCEED != bench_nvps_parse_int(zbx_optarg, 1, 100000, &keys_num))
+					exit(EXIT_FAILURE);
+				break;
+			case 't':
+				if (SUCCEED != zbx_is_double(zbx_optarg, &duration) || 0 >= duration)
+				{
+					printf("invalid run time \"%s\"\n", zbx_optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'j':
+				json_output = 1;
+				break;
+			case 'h':
+				bench_nvps_usage();
+				exit(EXIT_SUCCESS);
+			default:
+				bench_nvps_usage();
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (SUCCEED != zbx_locks_create(&error) || SUCCEED != zbx_vc_init(BENCH_NVPS_VC_SIZE, &error) ||
+			SUCCEED != zbx_init_database_cache(bench_nvps_get_program_type, bench_nvps_sync_history,
+			BENCH_NVPS_HC_SIZE, BENCH_NVPS_HC_INDEX_SIZE, &trend_cache_size, &error))
+	{
+		printf("cannot initialize benchmark: %s\n", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_vc_enable();
+	zbx_init_library_dbwrap(NULL, bench_nvps_preprocess_item_value, bench_nvps_preprocessor_flush);
+
+	zbx_bench_srand(1);
+	bench_nvps_init(&bn, hosts_num, keys_num, batch);
+
+	if (0 != rate)
+		interval_ns = (zbx_uint64_t)((double)batch * 1e9 / rate);
+
+	zbx_vector_uint64_create(&samples);
+
+	start = now = zbx_bench_clock_ns();
+	end = start + (zbx_uint64_t)(duration * 1e9);
+
+	do
+	{
+		if (0 != interval_ns)
+		{
+			scheduled = start + (zbx_uint64_t)request * interval_ns;
+
+			if (scheduled >= end)
+				break;
+
+			zbx_bench_sleep_until(scheduled);
+		}
+		else
+			scheduled = zbx_bench_clock_ns();
+
+		values_num += (zbx_uint64_t)bench_nvps_process(&bn, bn.requests[request % BENCH_NVPS_REQUESTS_NUM]);
+		request++;
+
+		now = zbx_bench_clock_ns();
+		zbx_vector_uint64_append(&samples, now - scheduled);
+	}
+	while (now < end);
+
+	result.name = "nvps_sender_data";
+	zbx_bench_samples_calc(&samples, values_num, now - start, &result);
+
+	if (0 != json_output)
+	{
+		struct zbx_json	json;
+
+		zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
+		zbx_json_addfloat(&json, "rate", rate);
+		zbx_json_adduint64(&json, "batch", (zbx_uint64_t)batch);
+		zbx_json_adduint64(&json, "items", (zbx_uint64_t)(hosts_num * keys_num));
+		zbx_json_adduint64(&json, "requests", (zbx_uint64_t)request);
+		zbx_json_adduint64(&json, "failed", bn.failed);
+		zbx_json_adduint64(&json, "stored", zbx_bench_history_added());
+		zbx_json_addarray(&json, "benchmarks");
+		zbx_bench_json_result(&json, &result);
+		zbx_json_close(&json);
+		printf("%s\n", json.buffer);
+		zbx_json_free(&json);
+	}
+	else
+	{
+		if (0 != rate)
+			printf("target rate:     %.0f values/sec\n", rate);
+		else
+			printf("target rate:     unthrottled\n");
+
+		printf("items:           %d\n", hosts_num * keys_num);
+		printf("requests:        %d (%d values each)\n", request, batch);
+		printf("values:          " ZBX_FS_UI64 " (stored " ZBX_FS_UI64 ", failed " ZBX_FS_UI64 ")\n",
+				values_num, zbx_bench_history_added(), bn.failed);
+		printf("throughput:      %.0f values/sec\n", result.ops_sec);
+		printf("request latency: p50 %.0f us, p90 %.0f us, p99 %.0f us, max %.0f us\n", result.p50 / 1000,
+				result.p90 / 1000, result.p99 / 1000, result.max / 1000);
+	}
+
+	zbx_vector_uint64_destroy(&samples);
+	bench_nvps_clear(&bn);
+	zbx_free_database_cache(ZBX_SYNC_NONE, NULL, 1);
+	zbx_vc_destroy();
+	zbx_locks_destroy();
+
+	return EXIT_SUCCESS;
+}
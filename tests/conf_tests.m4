@@ -55,10 +55,13 @@ AC_DEFUN([CONF_TESTS],
 			tests/test_zbxcommon/Makefile
 			tests/libs/zbxcomms/Makefile
 			tests/libs/zbxcommshigh/Makefile
+			tests/libs/zbxcompress/Makefile
 			tests/libs/zbxcfg/Makefile
 			tests/libs/zbxcachevalue/Makefile
+			tests/libs/zbxevent/Makefile
 			tests/libs/zbxcacheconfig/Makefile
 			tests/libs/zbxdbhigh/Makefile
+			tests/libs/zbxdbwrap/Makefile
 			tests/libs/zbxeval/Makefile
 			tests/libs/zbxexpr/Makefile
 			tests/libs/zbxfile/Makefile
@@ -83,10 +86,13 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxvariant/Makefile
 			tests/libs/zbxxml/Makefile
 			tests/zabbix_server/Makefile
+			tests/zabbix_server/housekeeper/Makefile
 			tests/zabbix_server/pinger/Makefile
 			tests/zabbix_server/service/Makefile
 			tests/zabbix_server/trapper/Makefile
 			tests/zabbix_server/lld/Makefile
+			tests/zabbix_server/escalator/Makefile
+			tests/zabbix_sender/Makefile
 			tests/mocks/Makefile
 			tests/mocks/configcache/Makefile
 			tests/mocks/valuecache/Makefile
@@ -0,0 +1,157 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	value;
+}
+zbx_mock_hs_entry_t;
+
+/* simple linear congruential generator to have reproducible results across platforms */
+static zbx_uint64_t	mock_rand(zbx_uint64_t *seed)
+{
+	*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+	return *seed >> 33;
+}
+
+static void	mock_hashset_check(zbx_hashset_t *hs, const unsigned char *present, int keys_num)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_mock_hs_entry_t	*entry;
+	int			i, num = 0;
+
+	for (i = 0; i < keys_num; i++)
+	{
+		zbx_uint64_t	id = (zbx_uint64_t)i;
+
+		entry = (zbx_mock_hs_entry_t *)zbx_hashset_search(hs, &id);
+
+		if (0 == present[i])
+		{
+			zbx_mock_assert_ptr_eq("removed entry", NULL, entry);
+			continue;
+		}
+
+		if (NULL == entry)
+			fail_msg("cannot find entry " ZBX_FS_UI64, id);
+
+		zbx_mock_assert_uint64_eq("entry value", id * 3, entry->value);
+		num++;
+	}
+
+	zbx_mock_assert_int_eq("number of entries", num, hs->num_data);
+
+	num = 0;
+	zbx_hashset_iter_reset(hs, &iter);
+	while (NULL != (entry = (zbx_mock_hs_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 == present[entry->id])
+			fail_msg("unexpected entry " ZBX_FS_UI64 " returned by iterator", entry->id);
+		num++;
+	}
+
+	zbx_mock_assert_int_eq("number of iterated entries", num, hs->num_data);
+}
+
+static void	test_hashset_functional(void)
+{
+	zbx_hashset_t		hs, copy;
+	zbx_hashset_iter_t	iter;
+	zbx_mock_hs_entry_t	*entry, local;
+	unsigned char		*present;
+	int			i, keys_num, ops_num;
+	zbx_uint64_t		seed = 1;
+
+	keys_num = (int)zbx_mock_get_parameter_uint64("in.keys");
+	ops_num = (int)zbx_mock_get_parameter_uint64("in.operations");
+
+	present = (unsigned char *)zbx_calloc(NULL, (size_t)keys_num, sizeof(unsigned char));
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < ops_num; i++)
+	{
+		local.id = mock_rand(&seed) % (zbx_uint64_t)keys_num;
+
+		switch (mock_rand(&seed) % 4)
+		{
+			case 0:
+			case 1:
+				local.value = local.id * 3;
+				entry = (zbx_mock_hs_entry_t *)zbx_hashset_insert(&hs, &local, sizeof(local));
+				zbx_mock_assert_uint64_eq("inserted entry", local.id, entry->id);
+				present[local.id] = 1;
+				break;
+			case 2:
+				zbx_hashset_remove(&hs, &local.id);
+				present[local.id] = 0;
+				break;
+			case 3:
+				if (NULL != (entry = (zbx_mock_hs_entry_t *)zbx_hashset_search(&hs, &local.id)))
+				{
+					zbx_hashset_remove_direct(&hs, entry);
+					present[local.id] = 0;
+				}
+				else
+					zbx_mock_assert_int_eq("missing entry", 0, present[local.id]);
+				break;
+		}
+
+		if (0 == i % 1000)
+			mock_hashset_check(&hs, present, keys_num);
+	}
+
+	mock_hashset_check(&hs, present, keys_num);
+
+	/* copy must contain the same entries */
+	zbx_hashset_create(&copy, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_copy(&copy, &hs, sizeof(zbx_mock_hs_entry_t));
+	mock_hashset_check(&copy, present, keys_num);
+	zbx_hashset_destroy(&copy);
+
+	/* remove odd entries during iteration */
+	zbx_hashset_iter_reset(&hs, &iter);
+	while (NULL != (entry = (zbx_mock_hs_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != entry->id % 2)
+		{
+			present[entry->id] = 0;
+			zbx_hashset_iter_remove(&iter);
+		}
+	}
+
+	mock_hashset_check(&hs, present, keys_num);
+
+	zbx_hashset_clear(&hs);
+	memset(present, 0, (size_t)keys_num);
+	mock_hashset_check(&hs, present, keys_num);
+
+	zbx_hashset_destroy(&hs);
+	zbx_free(present);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	test_hashset_functional();
+}
@@ -0,0 +1,67 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	static zbx_hdr_histogram_t	hist, part;
+	zbx_mock_error_t		err;
+	zbx_mock_handle_t		hvalues, hvalue, hpercentiles, hpercentile;
+	int				i = 0;
+
+	ZBX_UNUSED(state);
+
+	zbx_hdr_histogram_clear(&hist);
+	zbx_hdr_histogram_clear(&part);
+
+	/* add every other value directly and the rest through merge */
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		zbx_uint64_t	value;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hvalue, &value)))
+			fail_msg("Cannot read value: %s", zbx_mock_error_string(err));
+
+		zbx_hdr_histogram_add(0 == i++ % 2 ? &hist : &part, value, 1);
+	}
+
+	zbx_hdr_histogram_merge(&hist, &part);
+
+	zbx_mock_assert_uint64_eq("count", zbx_mock_get_parameter_uint64("out.count"), hist.count);
+	zbx_mock_assert_uint64_eq("max", zbx_mock_get_parameter_uint64("out.max"), hist.max);
+	zbx_mock_assert_double_eq("avg", zbx_mock_get_parameter_float("out.avg"), zbx_hdr_histogram_avg(&hist));
+
+	hpercentiles = zbx_mock_get_parameter_handle("out.percentiles");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hpercentiles, &hpercentile))))
+	{
+		double	percentile;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read percentile: %s", zbx_mock_error_string(err));
+
+		percentile = zbx_mock_get_object_member_float(hpercentile, "percentile");
+
+		zbx_mock_assert_uint64_eq("percentile", zbx_mock_get_object_member_uint64(hpercentile, "value"),
+				zbx_hdr_histogram_percentile(&hist, percentile));
+	}
+}
@@ -0,0 +1,99 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxcompress.h"
+#include "zbxstr.h"
+
+static zbx_uint64_t	get_optional_uint64(const char *path, zbx_uint64_t default_value)
+{
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists(path))
+		return default_value;
+
+	return zbx_mock_get_parameter_uint64(path);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*str;
+	char			*data = NULL, *compressed, *out;
+	size_t			data_alloc = 0, data_offset = 0, compressed_size, out_size, reserved, chunk_size,
+				truncate, offset;
+	zbx_uint64_t		repeat;
+	int			ret;
+	zbx_uncompress_stream_t	*stream;
+
+	ZBX_UNUSED(state);
+
+	str = zbx_mock_get_parameter_string("in.data");
+	repeat = get_optional_uint64("in.repeat", 1);
+
+	for (zbx_uint64_t i = 0; i < repeat; i++)
+		zbx_strcpy_alloc(&data, &data_alloc, &data_offset, str);
+
+	if (SUCCEED != zbx_compress(data, data_offset, &compressed, &compressed_size))
+		fail_msg("cannot compress data: %s", zbx_compress_strerror());
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.trailing"))
+	{
+		str = zbx_mock_get_parameter_string("in.trailing");
+		compressed = (char *)zbx_realloc(compressed, compressed_size + strlen(str));
+		memcpy(compressed + compressed_size, str, strlen(str));
+		compressed_size += strlen(str);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.corrupt"))
+		compressed[0] = (char)~compressed[0];
+
+	truncate = (size_t)get_optional_uint64("in.truncate", 0);
+	compressed_size -= MIN(truncate, compressed_size);
+
+	reserved = (size_t)get_optional_uint64("in.reserved", data_offset);
+	chunk_size = (size_t)get_optional_uint64("in.chunk_size", compressed_size);
+
+	out = (char *)zbx_malloc(NULL, reserved + 1);
+
+	if (NULL == (stream = zbx_uncompress_stream_create(out, reserved)))
+		fail_msg("cannot create uncompress stream: %s", zbx_compress_strerror());
+
+	for (offset = 0, ret = SUCCEED; SUCCEED == ret && offset < compressed_size; offset += chunk_size)
+	{
+		ret = zbx_uncompress_stream_update(stream, compressed + offset,
+				MIN(chunk_size, compressed_size - offset));
+	}
+
+	if (SUCCEED == ret)
+		ret = zbx_uncompress_stream_finish(stream, &out_size);
+
+	zbx_uncompress_stream_free(stream);
+
+	zbx_mock_assert_result_eq("return value", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.return")), ret);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_uint64_eq("uncompressed size", get_optional_uint64("out.size", data_offset), out_size);
+
+		if (0 != memcmp(data, out, out_size))
+			fail_msg("uncompressed data does not match the original data");
+	}
+
+	zbx_free(out);
+	zbx_free(compressed);
+	zbx_free(data);
+}
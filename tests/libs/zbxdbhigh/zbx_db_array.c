@@ -0,0 +1,78 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxcommon.h"
+#include "zbxdbhigh.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(HAVE_POSTGRESQL)
+	zbx_mock_handle_t	helements, helement;
+	char			*array = NULL;
+	size_t			array_alloc = 0, array_offset = 0;
+
+	ZBX_UNUSED(state);
+
+	helements = zbx_mock_get_parameter_handle("in.elements");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(helements, &helement))
+	{
+		const char	*type;
+
+		type = zbx_mock_get_object_member_string(helement, "type");
+
+		if (0 == strcmp(type, "str"))
+		{
+			zbx_db_array_add_str(&array, &array_alloc, &array_offset,
+					zbx_mock_get_object_member_string(helement, "value"));
+		}
+		else if (0 == strcmp(type, "uint64"))
+		{
+			zbx_db_array_add_uint64(&array, &array_alloc, &array_offset,
+					zbx_mock_get_object_member_uint64(helement, "value"));
+		}
+		else if (0 == strcmp(type, "int"))
+		{
+			zbx_db_array_add_int(&array, &array_alloc, &array_offset,
+					zbx_mock_get_object_member_int(helement, "value"));
+		}
+		else if (0 == strcmp(type, "dbl"))
+		{
+			zbx_db_array_add_dbl(&array, &array_alloc, &array_offset,
+					zbx_mock_get_object_member_float(helement, "value"));
+		}
+		else if (0 == strcmp(type, "null"))
+		{
+			zbx_db_array_add_null(&array, &array_alloc, &array_offset);
+		}
+		else
+			fail_msg("unknown element type \"%s\"", type);
+	}
+
+	zbx_db_array_close(&array, &array_alloc, &array_offset);
+
+	zbx_mock_assert_str_eq("array literal", zbx_mock_get_parameter_string("out.array"), array);
+
+	zbx_free(array);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
@@ -0,0 +1,278 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+#include "zbxmockdb.h"
+#include "zbxcommon.h"
+
+#include "zbxalgo.h"
+
+#include "../../../src/libs/zbxdbwrap/template_item.c"
+
+int		__wrap_zbx_db_execute(const char *fmt, ...);
+int		__wrap_zbx_db_insert_execute(zbx_db_insert_t *self);
+zbx_uint64_t	__wrap_zbx_db_get_maxid_num(const char *tablename, int num);
+int		__wrap_zbx_db_is_null(const char *field);
+
+/* executed bulk insert - target table, inserted fields and row values formatted as strings */
+typedef struct
+{
+	const char		*table;
+	zbx_vector_ptr_t	fields;
+	zbx_vector_str_t	values;
+}
+mock_insert_t;
+
+static zbx_vector_ptr_t	inserts;
+static zbx_uint64_t	nextid;
+
+int	__wrap_zbx_db_execute(const char *fmt, ...)
+{
+	ZBX_UNUSED(fmt);
+
+	return ZBX_DB_OK;
+}
+
+int	__wrap_zbx_db_insert_execute(zbx_db_insert_t *self)
+{
+	mock_insert_t	*insert;
+	int		i, j;
+
+	if (0 == self->rows.values_num)
+		return SUCCEED;
+
+	insert = (mock_insert_t *)zbx_malloc(NULL, sizeof(mock_insert_t));
+	insert->table = self->table->table;
+	zbx_vector_ptr_create(&insert->fields);
+	zbx_vector_str_create(&insert->values);
+
+	for (i = 0; i < self->fields.values_num; i++)
+		zbx_vector_ptr_append(&insert->fields, self->fields.values[i]);
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*row = self->rows.values[i];
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &row[j];
+			char			*str;
+
+			switch (self->fields.values[j]->type)
+			{
+				case ZBX_TYPE_ID:
+				case ZBX_TYPE_UINT:
+					str = zbx_dsprintf(NULL, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_INT:
+					str = zbx_dsprintf(NULL, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					str = zbx_dsprintf(NULL, ZBX_FS_DBL, value->dbl);
+					break;
+				default:
+					str = zbx_strdup(NULL, value->str);
+			}
+
+			zbx_vector_str_append(&insert->values, str);
+		}
+	}
+
+	zbx_vector_ptr_append(&inserts, insert);
+
+	return SUCCEED;
+}
+
+/* identifiers are reserved from single sequence shared by all tables */
+zbx_uint64_t	__wrap_zbx_db_get_maxid_num(const char *tablename, int num)
+{
+	zbx_uint64_t	id = nextid;
+
+	ZBX_UNUSED(tablename);
+
+	nextid += (zbx_uint64_t)num;
+
+	return id;
+}
+
+/* mock database rows cannot contain NULL values, so "null" string is used instead */
+int	__wrap_zbx_db_is_null(const char *field)
+{
+	if (NULL == field || 0 == strcmp(field, "null"))
+		return SUCCEED;
+
+	return FAIL;
+}
+
+static void	mock_insert_free(mock_insert_t *insert)
+{
+	zbx_vector_ptr_destroy(&insert->fields);
+	zbx_vector_str_clear_ext(&insert->values, zbx_str_free);
+	zbx_vector_str_destroy(&insert->values);
+	zbx_free(insert);
+}
+
+static void	mock_read_uint64_vector(const char *path, zbx_vector_uint64_t *ids)
+{
+	zbx_mock_handle_t	hids, hid;
+	zbx_mock_error_t	err;
+
+	hids = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hids, &hid))))
+	{
+		zbx_uint64_t	id;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hid, &id)))
+			fail_msg("Cannot read \"%s\" element: %s", path, zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(ids, id);
+	}
+}
+
+static int	mock_insert_field_index(const mock_insert_t *insert, const char *name)
+{
+	int	i;
+
+	for (i = 0; i < insert->fields.values_num; i++)
+	{
+		if (0 == strcmp(((const zbx_db_field_t *)insert->fields.values[i])->name, name))
+			return i;
+	}
+
+	fail_msg("table \"%s\" insert does not have field \"%s\"", insert->table, name);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares executed inserts with expected ones, only the listed     *
+ *          fields of each insert are checked                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	check_inserts(void)
+{
+	zbx_mock_handle_t	hinserts, hinsert, hfields, hfield, hrows, hrow, hvalue;
+	zbx_mock_error_t	err;
+	int			i = 0;
+
+	hinserts = zbx_mock_get_parameter_handle("out.inserts");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hinserts, &hinsert))))
+	{
+		mock_insert_t		*insert;
+		zbx_vector_int32_t	indexes;
+		int			row = 0, values_num;
+		char			msg[MAX_STRING_LEN];
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read insert #%d: %s", i, zbx_mock_error_string(err));
+
+		if (i >= inserts.values_num)
+			fail_msg("insert #%d was not executed", i);
+
+		insert = (mock_insert_t *)inserts.values[i];
+
+		zbx_snprintf(msg, sizeof(msg), "insert #%d table", i);
+		zbx_mock_assert_str_eq(msg, zbx_mock_get_object_member_string(hinsert, "table"), insert->table);
+
+		zbx_vector_int32_create(&indexes);
+		hfields = zbx_mock_get_object_member_handle(hinsert, "fields");
+
+		while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hfields, &hfield))))
+		{
+			const char	*name;
+
+			if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hfield, &name)))
+				fail_msg("Cannot read insert #%d field: %s", i, zbx_mock_error_string(err));
+
+			zbx_vector_int32_append(&indexes, mock_insert_field_index(insert, name));
+		}
+
+		hrows = zbx_mock_get_object_member_handle(hinsert, "rows");
+
+		while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrows, &hrow))))
+		{
+			int	j = 0;
+
+			if (ZBX_MOCK_SUCCESS != err)
+				fail_msg("Cannot read insert #%d row #%d: %s", i, row, zbx_mock_error_string(err));
+
+			if ((row + 1) * insert->fields.values_num > insert->values.values_num)
+				fail_msg("insert #%d row #%d was not executed", i, row);
+
+			while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrow, &hvalue))))
+			{
+				const char	*value;
+
+				if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hvalue,
+						&value)))
+				{
+					fail_msg("Cannot read insert #%d row #%d value: %s", i, row,
+							zbx_mock_error_string(err));
+				}
+
+				if (j >= indexes.values_num)
+					fail_msg("insert #%d row #%d has too many values", i, row);
+
+				zbx_snprintf(msg, sizeof(msg), "insert #%d (%s) row #%d field %s", i, insert->table,
+						row, ((const zbx_db_field_t *)insert->fields.values[indexes.values[j]])->name);
+				zbx_mock_assert_str_eq(msg, value,
+						insert->values.values[row * insert->fields.values_num + indexes.values[j]]);
+				j++;
+			}
+
+			row++;
+		}
+
+		values_num = insert->values.values_num / insert->fields.values_num;
+		zbx_snprintf(msg, sizeof(msg), "insert #%d (%s) rows", i, insert->table);
+		zbx_mock_assert_int_eq(msg, row, values_num);
+
+		zbx_vector_int32_destroy(&indexes);
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("executed inserts", i, inserts.values_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_uint64_t	hostids, templateids;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+	zbx_vector_ptr_create(&inserts);
+	zbx_vector_uint64_create(&hostids);
+	zbx_vector_uint64_create(&templateids);
+
+	nextid = zbx_mock_get_parameter_uint64("in.nextid");
+	mock_read_uint64_vector("in.hostids", &hostids);
+	mock_read_uint64_vector("in.templateids", &templateids);
+
+	DBcopy_template_items_hosts(&hostids, &templateids, ZBX_AUDIT_ALL_CONTEXT);
+
+	check_inserts();
+
+	zbx_vector_uint64_destroy(&templateids);
+	zbx_vector_uint64_destroy(&hostids);
+	zbx_vector_ptr_clear_ext(&inserts, (zbx_clean_func_t)mock_insert_free);
+	zbx_vector_ptr_destroy(&inserts);
+	zbx_mockdb_destroy();
+}
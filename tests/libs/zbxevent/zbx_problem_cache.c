@@ -0,0 +1,276 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxevent.h"
+#include "zbxdbhigh.h"
+#include "zbxmutexs.h"
+#include "zbx_trigger_constants.h"
+
+static void	mock_read_ids(zbx_mock_handle_t hstep, const char *name, zbx_vector_uint64_t *ids)
+{
+	zbx_mock_handle_t	hids, hid;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, name, &hids))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hids, &hid))))
+	{
+		zbx_uint64_t	id;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hid, &id)))
+			fail_msg("Cannot read \"%s\" identifier: %s", name, zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(ids, id);
+	}
+
+	zbx_vector_uint64_sort(ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+static void	mock_read_tags(zbx_mock_handle_t hproblem, zbx_vector_tags_ptr_t *tags)
+{
+	zbx_mock_handle_t	htags, htag;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hproblem, "tags", &htags))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htags, &htag))))
+	{
+		zbx_tag_t	*tag;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read problem tag: %s", zbx_mock_error_string(err));
+
+		tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+		tag->tag = zbx_strdup(NULL, zbx_mock_get_object_member_string(htag, "tag"));
+		tag->value = zbx_strdup(NULL, zbx_mock_get_object_member_string(htag, "value"));
+		zbx_vector_tags_ptr_append(tags, tag);
+	}
+}
+
+static void	mock_read_problems(zbx_mock_handle_t hstep, zbx_vector_ptr_t *problems)
+{
+	zbx_mock_handle_t	hproblems, hproblem;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hstep, "problems", &hproblems))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hproblems, &hproblem))))
+	{
+		zbx_event_problem_t	*problem;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read problem: %s", zbx_mock_error_string(err));
+
+		problem = (zbx_event_problem_t *)zbx_malloc(NULL, sizeof(zbx_event_problem_t));
+		problem->eventid = zbx_mock_get_object_member_uint64(hproblem, "eventid");
+		problem->triggerid = zbx_mock_get_object_member_uint64(hproblem, "triggerid");
+		zbx_vector_tags_ptr_create(&problem->tags);
+		mock_read_tags(hproblem, &problem->tags);
+
+		zbx_vector_ptr_append(problems, problem);
+	}
+}
+
+static void	problem_free(void *data)
+{
+	zbx_event_problem_t	*problem = (zbx_event_problem_t *)data;
+
+	zbx_vector_tags_ptr_clear_ext(&problem->tags, zbx_free_tag);
+	zbx_vector_tags_ptr_destroy(&problem->tags);
+	zbx_free(problem);
+}
+
+static int	problem_compare(const void *d1, const void *d2)
+{
+	const zbx_event_problem_t	*p1 = *(const zbx_event_problem_t * const *)d1;
+	const zbx_event_problem_t	*p2 = *(const zbx_event_problem_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->eventid, p2->eventid);
+
+	return 0;
+}
+
+static void	check_problems(int step, const zbx_vector_ptr_t *expected, zbx_vector_ptr_t *returned)
+{
+	char	msg[64];
+
+	zbx_vector_ptr_sort(returned, problem_compare);
+
+	zbx_snprintf(msg, sizeof(msg), "step #%d problems", step);
+	zbx_mock_assert_int_eq(msg, expected->values_num, returned->values_num);
+
+	for (int i = 0; i < expected->values_num; i++)
+	{
+		const zbx_event_problem_t	*p1 = (const zbx_event_problem_t *)expected->values[i];
+		const zbx_event_problem_t	*p2 = (const zbx_event_problem_t *)returned->values[i];
+
+		zbx_snprintf(msg, sizeof(msg), "step #%d problem #%d", step, i);
+		zbx_mock_assert_uint64_eq(msg, p1->eventid, p2->eventid);
+		zbx_mock_assert_uint64_eq(msg, p1->triggerid, p2->triggerid);
+		zbx_mock_assert_int_eq(msg, p1->tags.values_num, p2->tags.values_num);
+
+		/* cached tags are returned in the original order */
+		for (int j = 0; j < p1->tags.values_num; j++)
+		{
+			zbx_mock_assert_str_eq(msg, p1->tags.values[j]->tag, p2->tags.values[j]->tag);
+			zbx_mock_assert_str_eq(msg, p1->tags.values[j]->value, p2->tags.values[j]->value);
+		}
+	}
+}
+
+static void	check_ids(int step, const char *name, const zbx_vector_uint64_t *expected,
+		zbx_vector_uint64_t *returned)
+{
+	char	msg[64];
+
+	zbx_vector_uint64_sort(returned, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_snprintf(msg, sizeof(msg), "step #%d %s", step, name);
+	zbx_mock_assert_int_eq(msg, expected->values_num, returned->values_num);
+
+	for (int i = 0; i < expected->values_num; i++)
+		zbx_mock_assert_uint64_eq(msg, expected->values[i], returned->values[i]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts problems to new problem events for cache update          *
+ *                                                                            *
+ ******************************************************************************/
+static void	problems_to_events(const zbx_vector_ptr_t *problems, zbx_vector_db_event_t *events)
+{
+	for (int i = 0; i < problems->values_num; i++)
+	{
+		const zbx_event_problem_t	*problem = (const zbx_event_problem_t *)problems->values[i];
+		zbx_db_event			*event;
+
+		event = (zbx_db_event *)zbx_malloc(NULL, sizeof(zbx_db_event));
+		memset(event, 0, sizeof(zbx_db_event));
+
+		event->eventid = problem->eventid;
+		event->objectid = problem->triggerid;
+		event->source = EVENT_SOURCE_TRIGGERS;
+		event->object = EVENT_OBJECT_TRIGGER;
+		event->value = TRIGGER_VALUE_PROBLEM;
+		event->tags = problem->tags;
+
+		zbx_vector_db_event_append(events, event);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	zbx_uint64_t		revision = 0;
+	char			*error = NULL;
+	int			step = 0;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_locks_create(&error))
+		fail_msg("cannot create locks: %s", error);
+
+	if (SUCCEED != zbx_problem_cache_init(zbx_mock_get_parameter_uint64("in.cache_size"), &error))
+		fail_msg("cannot initialize problem cache: %s", error);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		const char		*op;
+		zbx_vector_uint64_t	ids, ids_ret;
+		zbx_vector_ptr_t	problems, problems_ret;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step #%d: %s", step, zbx_mock_error_string(err));
+
+		zbx_vector_uint64_create(&ids);
+		zbx_vector_uint64_create(&ids_ret);
+		zbx_vector_ptr_create(&problems);
+		zbx_vector_ptr_create(&problems_ret);
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+		mock_read_problems(hstep, &problems);
+
+		if (0 == strcmp(op, "get"))
+		{
+			zbx_vector_uint64_t	miss;
+
+			mock_read_ids(hstep, "triggerids", &ids);
+			revision = zbx_problem_cache_get(&ids, &problems_ret, &ids_ret);
+
+			zbx_vector_uint64_create(&miss);
+			mock_read_ids(hstep, "miss", &miss);
+
+			check_problems(step, &problems, &problems_ret);
+			check_ids(step, "miss", &miss, &ids_ret);
+
+			zbx_vector_uint64_destroy(&miss);
+		}
+		else if (0 == strcmp(op, "set"))
+		{
+			mock_read_ids(hstep, "triggerids", &ids);
+			zbx_problem_cache_set(&ids, &problems, revision);
+		}
+		else if (0 == strcmp(op, "update"))
+		{
+			zbx_vector_db_event_t	events;
+
+			zbx_vector_db_event_create(&events);
+			problems_to_events(&problems, &events);
+
+			mock_read_ids(hstep, "recovered", &ids);
+			zbx_problem_cache_update(&events, &ids);
+
+			/* event tags are owned by the problems */
+			for (int i = 0; i < events.values_num; i++)
+				zbx_free(events.values[i]);
+
+			zbx_vector_db_event_destroy(&events);
+		}
+		else if (0 == strcmp(op, "invalidate triggers"))
+		{
+			mock_read_ids(hstep, "triggerids", &ids);
+			zbx_problem_cache_invalidate_triggers(&ids);
+		}
+		else if (0 == strcmp(op, "invalidate events"))
+		{
+			mock_read_ids(hstep, "eventids", &ids);
+			zbx_problem_cache_invalidate_events(&ids);
+		}
+		else
+			fail_msg("unknown step #%d operation \"%s\"", step, op);
+
+		zbx_vector_ptr_clear_ext(&problems_ret, problem_free);
+		zbx_vector_ptr_destroy(&problems_ret);
+		zbx_vector_ptr_clear_ext(&problems, problem_free);
+		zbx_vector_ptr_destroy(&problems);
+		zbx_vector_uint64_destroy(&ids_ret);
+		zbx_vector_uint64_destroy(&ids);
+
+		step++;
+	}
+
+	zbx_problem_cache_destroy();
+	zbx_locks_destroy();
+}
@@ -26,6 +26,7 @@ int	__wrap_expr_db_get_trigger_value(const zbx_db_trigger *trigger, char **repla
 zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void);
 
 void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
+zbx_uint64_t	__wrap_zbx_dc_get_config_revision(void);
 int	__wrap_zbx_db_trigger_get_all_hostids(const zbx_db_trigger *trigger, const zbx_vector_uint64_t **hostids);
 
 void	__wrap_zbx_dc_get_user_macro(const zbx_dc_um_handle_t *um_handle, const char *macro,
@@ -53,6 +54,11 @@ void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle)
 	ZBX_UNUSED(um_handle);
 }
 
+zbx_uint64_t	__wrap_zbx_dc_get_config_revision(void)
+{
+	return 0;
+}
+
 int	__wrap_zbx_db_trigger_get_all_hostids(const zbx_db_trigger *trigger, const zbx_vector_uint64_t **hostids)
 {
 	ZBX_UNUSED(trigger);
@@ -0,0 +1,125 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxexpression.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+static int	lookups_num;
+
+int	__wrap_expr_db_get_trigger_value(const zbx_db_trigger *trigger, char **replace_to, int N_functionid,
+		int request);
+int	__wrap_expr_db_item_value(const zbx_db_trigger *trigger, char **value, int N_functionid, int clock, int ns,
+		int raw);
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void);
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
+zbx_uint64_t	__wrap_zbx_dc_get_config_revision(void);
+
+/* returns value configured for Nth trigger function or FAIL if there is none */
+static int	mock_get_function_value(int N_functionid, char **value)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+
+	lookups_num++;
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		if (N_functionid == zbx_mock_get_object_member_int(hvalue, "N"))
+		{
+			*value = zbx_strdup(*value, zbx_mock_get_object_member_string(hvalue, "value"));
+			return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+int	__wrap_expr_db_get_trigger_value(const zbx_db_trigger *trigger, char **replace_to, int N_functionid,
+		int request)
+{
+	ZBX_UNUSED(trigger);
+	ZBX_UNUSED(request);
+
+	return mock_get_function_value(N_functionid, replace_to);
+}
+
+int	__wrap_expr_db_item_value(const zbx_db_trigger *trigger, char **value, int N_functionid, int clock, int ns,
+		int raw)
+{
+	ZBX_UNUSED(trigger);
+	ZBX_UNUSED(clock);
+	ZBX_UNUSED(ns);
+	ZBX_UNUSED(raw);
+
+	return mock_get_function_value(N_functionid, value);
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void)
+{
+	return NULL;
+}
+
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle)
+{
+	ZBX_UNUSED(um_handle);
+}
+
+zbx_uint64_t	__wrap_zbx_dc_get_config_revision(void)
+{
+	return 1;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int		expected_ret;
+	const char	*expected_expression;
+	zbx_db_event	event;
+
+	ZBX_UNUSED(state);
+
+	memset(&event, 0, sizeof(event));
+	event.source = EVENT_SOURCE_TRIGGERS;
+	event.object = EVENT_OBJECT_TRIGGER;
+
+	expected_expression = zbx_mock_get_parameter_string("out.expression");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+
+	/* the first substitution tokenizes message template, the second one uses cached template */
+	for (int i = 0; i < 2; i++)
+	{
+		int	returned_ret;
+		char	*expression, error[MAX_STRING_LEN], msg[64];
+
+		lookups_num = 0;
+		expression = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.expression"));
+
+		returned_ret = zbx_substitute_simple_macros(NULL, &event, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+				NULL, NULL, "", &expression, ZBX_MACRO_TYPE_MESSAGE_NORMAL, error, sizeof(error));
+
+		zbx_snprintf(msg, sizeof(msg), "substitution #%d return value", i + 1);
+		zbx_mock_assert_result_eq(msg, expected_ret, returned_ret);
+		zbx_snprintf(msg, sizeof(msg), "substitution #%d resulting expression", i + 1);
+		zbx_mock_assert_str_eq(msg, expected_expression, expression);
+		zbx_snprintf(msg, sizeof(msg), "substitution #%d number of macro value lookups", i + 1);
+		zbx_mock_assert_int_eq(msg, (int)zbx_mock_get_parameter_uint64("out.lookups"), lookups_num);
+
+		zbx_free(expression);
+	}
+}
@@ -0,0 +1,139 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxpreprocbase.h"
+
+static int	str_to_preproc_type(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_PREPROC_MULTIPLIER"))
+		return ZBX_PREPROC_MULTIPLIER;
+	if (0 == strcmp(str, "ZBX_PREPROC_RTRIM"))
+		return ZBX_PREPROC_RTRIM;
+	if (0 == strcmp(str, "ZBX_PREPROC_REGSUB"))
+		return ZBX_PREPROC_REGSUB;
+	if (0 == strcmp(str, "ZBX_PREPROC_DELTA_SPEED"))
+		return ZBX_PREPROC_DELTA_SPEED;
+	if (0 == strcmp(str, "ZBX_PREPROC_JSONPATH"))
+		return ZBX_PREPROC_JSONPATH;
+	if (0 == strcmp(str, "ZBX_PREPROC_VALIDATE_RANGE"))
+		return ZBX_PREPROC_VALIDATE_RANGE;
+	if (0 == strcmp(str, "ZBX_PREPROC_THROTTLE_VALUE"))
+		return ZBX_PREPROC_THROTTLE_VALUE;
+	if (0 == strcmp(str, "ZBX_PREPROC_THROTTLE_TIMED_VALUE"))
+		return ZBX_PREPROC_THROTTLE_TIMED_VALUE;
+
+	fail_msg("unknown preprocessing step type: %s", str);
+	return FAIL;
+}
+
+static void	read_steps(const char *path, zbx_vector_pp_step_ptr_t *steps)
+{
+	zbx_mock_handle_t	hsteps, hstep;
+
+	hsteps = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		zbx_pp_step_t	*step;
+
+		step = (zbx_pp_step_t *)zbx_malloc(NULL, sizeof(zbx_pp_step_t));
+		step->type = str_to_preproc_type(zbx_mock_get_object_member_string(hstep, "type"));
+		step->params = zbx_strdup(NULL, zbx_mock_get_object_member_string(hstep, "params"));
+		step->error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+		step->error_handler_params = zbx_strdup(NULL, "");
+
+		zbx_vector_pp_step_ptr_append(steps, step);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_pp_step_ptr_t	steps;
+	zbx_mock_handle_t		hsteps, hstep, hvalues, hvalue, hresults, hresult;
+	zbx_pp_pushdown_t		*pushdown;
+	unsigned char			value_type;
+	int				i = 0;
+	char				buffer[32];
+
+	ZBX_UNUSED(state);
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in.value_type"));
+
+	zbx_vector_pp_step_ptr_create(&steps);
+	read_steps("in.steps", &steps);
+
+	zbx_pp_pushdown_select(&steps);
+
+	hsteps = zbx_mock_get_parameter_handle("out.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		const char	*type;
+
+		if (i >= steps.values_num)
+			fail_msg("expected more than %d pushed down steps", steps.values_num);
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hstep, &type))
+			fail_msg("cannot read expected step type");
+
+		zbx_snprintf(buffer, sizeof(buffer), "step #%d type", i + 1);
+		zbx_mock_assert_int_eq(buffer, str_to_preproc_type(type), steps.values[i++]->type);
+	}
+
+	zbx_mock_assert_int_eq("number of pushed down steps", i, steps.values_num);
+
+	if (0 == steps.values_num)
+	{
+		zbx_vector_pp_step_ptr_destroy(&steps);
+		return;
+	}
+
+	pushdown = zbx_pp_pushdown_create(value_type, &steps);
+	zbx_mock_assert_int_eq("steps left after create", 0, steps.values_num);
+	zbx_vector_pp_step_ptr_destroy(&steps);
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+	hresults = zbx_mock_get_parameter_handle("out.results");
+
+	for (i = 1; ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue); i++)
+	{
+		zbx_timespec_t	ts;
+		const char	*result;
+
+		if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hvalue, "time"),
+				&ts))
+		{
+			fail_msg("Invalid 'time' format");
+		}
+
+		if (ZBX_MOCK_END_OF_VECTOR == zbx_mock_vector_element(hresults, &hresult) ||
+				ZBX_MOCK_SUCCESS != zbx_mock_string(hresult, &result))
+		{
+			fail_msg("missing expected result for value #%d", i);
+		}
+
+		zbx_snprintf(buffer, sizeof(buffer), "value #%d result", i);
+		zbx_mock_assert_int_eq(buffer, zbx_mock_str_to_return_code(result),
+				zbx_pp_pushdown_execute(pushdown, zbx_mock_get_object_member_string(hvalue, "data"),
+				&ts));
+	}
+
+	zbx_pp_pushdown_free(pushdown);
+}
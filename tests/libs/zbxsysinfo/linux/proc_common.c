@@ -0,0 +1,59 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "proc_common.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+
+#include "zbxstr.h"
+
+DIR	*__real_opendir(const char *name);
+
+static zbx_mock_handle_t	pids;
+static struct dirent		pid_entry;
+
+DIR	*__wrap_opendir(const char *name)
+{
+	if (0 != strcmp(name, "/proc"))
+	{
+		errno = ENOENT;
+		return NULL;
+	}
+
+	pids = zbx_mock_get_parameter_handle("in.pids");
+
+	/* returned directory is only closed, entries are read from the test case */
+	return __real_opendir("/");
+}
+
+struct dirent	*__wrap_readdir(DIR *dirp)
+{
+	zbx_mock_handle_t	pid;
+	zbx_mock_error_t	error;
+	const char		*value;
+
+	ZBX_UNUSED(dirp);
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(pids, &pid))
+		return NULL;
+
+	if (ZBX_MOCK_SUCCESS != (error = zbx_mock_string(pid, &value)))
+		fail_msg("Cannot read pid: %s", zbx_mock_error_string(error));
+
+	zbx_strlcpy(pid_entry.d_name, value, sizeof(pid_entry.d_name));
+
+	return &pid_entry;
+}
@@ -0,0 +1,127 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+#include "zbxmockhelper.h"
+
+#include "zbxsysinfo.h"
+#include "zbxstr.h"
+#include "../../../../src/libs/zbxsysinfo/linux/proc.h"
+
+#include <pthread.h>
+
+#define PROC_FILE_OPEN_THREADS_MAX	16
+
+static const char	*file_path, *file_contents;
+static int		fopen_calls;
+static pthread_mutex_t	fopen_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static FILE	*proc_fopen_mock(const char *path, const char *mode)
+{
+	ZBX_UNUSED(mode);
+
+	if (0 != strcmp(path, file_path))
+	{
+		errno = ENOENT;
+		return NULL;
+	}
+
+	pthread_mutex_lock(&fopen_lock);
+	fopen_calls++;
+	pthread_mutex_unlock(&fopen_lock);
+
+	return fmemopen((void *)file_contents, strlen(file_contents), "r");
+}
+
+typedef struct
+{
+	int	opens;
+	int	mismatches;
+}
+proc_file_reader_t;
+
+static void	*proc_file_read(void *data)
+{
+	proc_file_reader_t	*reader = (proc_file_reader_t *)data;
+
+	for (int i = 0; i < reader->opens; i++)
+	{
+		FILE	*f;
+		char	*contents = NULL, line[MAX_STRING_LEN];
+		size_t	contents_alloc = 0, contents_offset = 0;
+
+		if (NULL == (f = proc_file_open(file_path)))
+		{
+			reader->mismatches++;
+			continue;
+		}
+
+		while (NULL != fgets(line, sizeof(line), f))
+			zbx_strcpy_alloc(&contents, &contents_alloc, &contents_offset, line);
+
+		zbx_fclose(f);
+
+		if (NULL == contents || 0 != strcmp(contents, file_contents))
+			reader->mismatches++;
+
+		zbx_free(contents);
+	}
+
+	return NULL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	proc_file_reader_t	readers[PROC_FILE_OPEN_THREADS_MAX];
+	pthread_t		threads[PROC_FILE_OPEN_THREADS_MAX];
+	int			threads_num, opens;
+
+	ZBX_UNUSED(state);
+
+	file_path = zbx_mock_get_parameter_string("in.path");
+	file_contents = zbx_mock_get_parameter_string("in.contents");
+	threads_num = (int)zbx_mock_get_parameter_uint64("in.threads");
+	opens = (int)zbx_mock_get_parameter_uint64("in.opens");
+
+	if (PROC_FILE_OPEN_THREADS_MAX < threads_num)
+		fail_msg("too many threads: %d", threads_num);
+
+	zbx_set_fopen_mock_callback(proc_fopen_mock);
+
+	/* the calling thread reads the file too, while other threads are running */
+	for (int i = 0; i < threads_num; i++)
+	{
+		readers[i].opens = opens;
+		readers[i].mismatches = 0;
+
+		if (0 != i && 0 != pthread_create(&threads[i], NULL, proc_file_read, &readers[i]))
+			fail_msg("cannot create thread: %s", zbx_strerror(errno));
+	}
+
+	proc_file_read(&readers[0]);
+
+	for (int i = 1; i < threads_num; i++)
+		pthread_join(threads[i], NULL);
+
+	for (int i = 0; i < threads_num; i++)
+		zbx_mock_assert_int_eq("contents mismatches", 0, readers[i].mismatches);
+
+	zbx_mock_assert_int_eq("number of file reads", (int)zbx_mock_get_parameter_uint64("out.fopen_calls"),
+			fopen_calls);
+
+	zbx_set_fopen_mock_callback(NULL);
+}
@@ -0,0 +1,68 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "proc_common.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxsysinfo.h"
+#include "../../../../src/libs/zbxsysinfo/sysinfo.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	AGENT_REQUEST	request;
+	AGENT_RESULT	result;
+	const char	*key;
+	int		expected_ret, actual_ret;
+
+	ZBX_UNUSED(state);
+
+	zbx_init_agent_request(&request);
+	zbx_init_agent_result(&result);
+
+	key = zbx_mock_get_parameter_string("in.key");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+
+	if (SUCCEED != zbx_parse_item_key(key, &request))
+		fail_msg("Cannot parse item key: %s", key);
+
+	if (expected_ret != (actual_ret = proc_num(&request, &result)))
+	{
+		fail_msg("Unexpected return code from proc_num(): expected %s, got %s",
+				zbx_sysinfo_ret_string(expected_ret), zbx_sysinfo_ret_string(actual_ret));
+	}
+
+	if (SYSINFO_RET_OK == expected_ret)
+	{
+		if (NULL == ZBX_GET_UI64_RESULT(&result))
+			fail_msg("proc_num() did not return numeric value");
+
+		zbx_mock_assert_uint64_eq("number of processes", zbx_mock_get_parameter_uint64("out.value"),
+				*ZBX_GET_UI64_RESULT(&result));
+	}
+	else
+	{
+		if (NULL == ZBX_GET_MSG_RESULT(&result))
+			fail_msg("proc_num() did not return error message");
+
+		zbx_mock_assert_str_eq("error message", zbx_mock_get_parameter_string("out.error"),
+				*ZBX_GET_MSG_RESULT(&result));
+	}
+
+	zbx_free_agent_request(&request);
+	zbx_free_agent_result(&result);
+}
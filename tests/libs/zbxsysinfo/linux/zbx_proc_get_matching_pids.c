@@ -0,0 +1,93 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "proc_common.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "zbxsysinfo.h"
+#include "../../../../src/libs/zbxsysinfo/common/procstat.h"
+
+static const char	*get_optional_string(const char *path)
+{
+	const char	*value;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists(path))
+		return NULL;
+
+	value = zbx_mock_get_parameter_string(path);
+
+	return '\0' == *value ? NULL : value;
+}
+
+static void	read_pids(const char *path, zbx_vector_uint64_t *pids)
+{
+	zbx_mock_handle_t	handle, element;
+	zbx_mock_error_t	error;
+	zbx_uint64_t		pid;
+
+	handle = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (error = zbx_mock_vector_element(handle, &element)))
+	{
+		if (ZBX_MOCK_SUCCESS != error || ZBX_MOCK_SUCCESS != (error = zbx_mock_uint64(element, &pid)))
+			fail_msg("Cannot read pid from \"%s\": %s", path, zbx_mock_error_string(error));
+
+		zbx_vector_uint64_append(pids, pid);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_ptr_t	processes;
+	zbx_vector_uint64_t	pids, expected_pids;
+	const char		*procname, *username, *cmdline;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_ptr_create(&processes);
+	zbx_vector_uint64_create(&pids);
+	zbx_vector_uint64_create(&expected_pids);
+
+	procname = get_optional_string("in.procname");
+	username = get_optional_string("in.username");
+	cmdline = get_optional_string("in.cmdline");
+
+	if (SUCCEED != zbx_proc_get_processes(&processes, 0))
+		fail_msg("Cannot get processes");
+
+	/* matching must be performed only on the processes passed by caller */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.processes") &&
+			0 == strcmp(zbx_mock_get_parameter_string("in.processes"), "none"))
+	{
+		zbx_proc_free_processes(&processes);
+	}
+
+	zbx_proc_get_matching_pids(&processes, procname, username, cmdline, 0, &pids);
+
+	read_pids("out.pids", &expected_pids);
+
+	zbx_vector_uint64_sort(&pids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_sort(&expected_pids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_mock_assert_vector_uint64_eq("matching pids", &expected_pids, &pids);
+
+	zbx_proc_free_processes(&processes);
+	zbx_vector_ptr_destroy(&processes);
+	zbx_vector_uint64_destroy(&pids);
+	zbx_vector_uint64_destroy(&expected_pids);
+}
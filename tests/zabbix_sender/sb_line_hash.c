@@ -0,0 +1,40 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "send_buffer.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*default_host = NULL;
+	zbx_hash_t		hash1, hash2;
+	zbx_mock_handle_t	handle;
+
+	ZBX_UNUSED(state);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.default_host", &handle))
+		default_host = zbx_mock_get_parameter_string("in.default_host");
+
+	hash1 = sb_line_hash(zbx_mock_get_parameter_string("in.line1"), default_host);
+	hash2 = sb_line_hash(zbx_mock_get_parameter_string("in.line2"), default_host);
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("out.equal"), "yes"))
+		zbx_mock_assert_uint64_eq("line hash", hash1, hash2);
+	else
+		zbx_mock_assert_uint64_ne("line hash", hash1, hash2);
+}
@@ -0,0 +1,245 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+#include "zbxmockdb.h"
+#include "zbxcommon.h"
+
+#include "zbxalgo.h"
+
+#include "../../../src/zabbix_server/escalator/escalator.c"
+
+int	__wrap_zbx_db_insert_execute(zbx_db_insert_t *self);
+void	__wrap_zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
+
+/* executed alert inserts - insert index and number of rows */
+static zbx_vector_uint64_pair_t	executed;
+
+int	__wrap_zbx_db_insert_execute(zbx_db_insert_t *self)
+{
+	zbx_uint64_pair_t	pair = {.first = (zbx_uint64_t)(self - esc_cache.alerts),
+					.second = (zbx_uint64_t)self->rows.values_num};
+
+	zbx_vector_uint64_pair_append(&executed, pair);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name)
+{
+	ZBX_UNUSED(self);
+	ZBX_UNUSED(field_name);
+}
+
+static void	mock_read_uint64_vector(zbx_mock_handle_t handle, const char *name, zbx_vector_uint64_t *ids)
+{
+	zbx_mock_handle_t	hids, hid;
+	zbx_mock_error_t	err;
+
+	hids = zbx_mock_get_object_member_handle(handle, name);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hids, &hid))))
+	{
+		zbx_uint64_t	id;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hid, &id)))
+			fail_msg("Cannot read \"%s\" element: %s", name, zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(ids, id);
+	}
+}
+
+static void	mock_add_users(void)
+{
+	zbx_mock_handle_t	husers, huser;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter("in.users", &husers))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(husers, &huser))))
+	{
+		zbx_esc_user_t	user_local = {.perm2system = SUCCEED}, *user;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read user: %s", zbx_mock_error_string(err));
+
+		user_local.userid = zbx_mock_get_object_member_uint64(huser, "userid");
+		user_local.type = (0 == strcmp(zbx_mock_get_object_member_string(huser, "type"), "super admin") ?
+				USER_TYPE_SUPER_ADMIN : USER_TYPE_ZABBIX_USER);
+
+		user = (zbx_esc_user_t *)zbx_hashset_insert(&esc_cache.users, &user_local, sizeof(user_local));
+		zbx_vector_tag_filter_ptr_create(&user->tag_filters);
+		zbx_vector_esc_media_ptr_create(&user->media);
+	}
+}
+
+static zbx_esc_trigger_t	*mock_add_trigger(void)
+{
+	zbx_mock_handle_t	htrigger;
+	zbx_esc_trigger_t	trigger_local, *trigger;
+
+	htrigger = zbx_mock_get_parameter_handle("in.trigger");
+
+	trigger_local.triggerid = zbx_mock_get_object_member_uint64(htrigger, "triggerid");
+	trigger = (zbx_esc_trigger_t *)zbx_hashset_insert(&esc_cache.triggers, &trigger_local,
+			sizeof(trigger_local));
+	zbx_vector_uint64_create(&trigger->hgsetids);
+	zbx_vector_uint64_create(&trigger->hostgroupids);
+	mock_read_uint64_vector(htrigger, "hgsetids", &trigger->hgsetids);
+
+	return trigger;
+}
+
+static void	test_trigger_permissions(void)
+{
+	zbx_mock_handle_t	hchecks, hcheck;
+	zbx_mock_error_t	err;
+	zbx_vector_uint64_t	userids;
+	zbx_esc_trigger_t	*trigger;
+
+	mock_add_users();
+	trigger = mock_add_trigger();
+
+	zbx_vector_uint64_create(&userids);
+	mock_read_uint64_vector(zbx_mock_get_parameter_handle("in"), "recipients", &userids);
+	esc_cache_load_trigger_perms(&userids, trigger);
+	zbx_vector_uint64_destroy(&userids);
+
+	hchecks = zbx_mock_get_parameter_handle("out.permissions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hchecks, &hcheck))))
+	{
+		zbx_uint64_t	userid;
+		char		msg[64];
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read permission: %s", zbx_mock_error_string(err));
+
+		userid = zbx_mock_get_object_member_uint64(hcheck, "userid");
+		zbx_snprintf(msg, sizeof(msg), "user " ZBX_FS_UI64 " permission", userid);
+
+		zbx_mock_assert_result_eq(msg, zbx_mock_str_to_return_code(
+				zbx_mock_get_object_member_string(hcheck, "return")),
+				esc_cache_check_trigger_hgsets(userid, trigger));
+	}
+}
+
+static void	test_alerts(void)
+{
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	int			step = 0;
+
+	zbx_vector_uint64_pair_create(&executed);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		const char	*op;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step #%d: %s", step, zbx_mock_error_string(err));
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+
+		if (0 == strcmp(op, "add"))
+		{
+			zbx_db_event	event = {.source = EVENT_SOURCE_TRIGGERS}, r_event = {0};
+			zbx_uint64_t	r_eventid;
+
+			event.eventid = zbx_mock_get_object_member_uint64(hstep, "eventid");
+			r_event.eventid = r_eventid = zbx_mock_get_object_member_uint64(hstep, "r_eventid");
+
+			/* recipient errors are stored without user lookup */
+			add_message_alert(&event, 0 != r_eventid ? &r_event : NULL, 1, 1,
+					zbx_mock_get_object_member_uint64(hstep, "userid"), 0, "subject", "message",
+					NULL, NULL, NULL, ZBX_ALERT_MESSAGE_ERR_USR, NULL);
+		}
+		else if (0 == strcmp(op, "flush"))
+		{
+			zbx_mock_handle_t	hinserts, hinsert;
+			int			i = 0;
+			char			msg[64];
+
+			zbx_vector_uint64_pair_clear(&executed);
+			esc_cache_flush_alerts();
+
+			hinserts = zbx_mock_get_object_member_handle(hstep, "inserts");
+
+			while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hinserts, &hinsert))))
+			{
+				zbx_uint64_t	index;
+
+				if (ZBX_MOCK_SUCCESS != err)
+					fail_msg("Cannot read insert: %s", zbx_mock_error_string(err));
+
+				zbx_snprintf(msg, sizeof(msg), "step #%d insert #%d", step, i);
+
+				if (i >= executed.values_num)
+					fail_msg("%s was not executed", msg);
+
+				index = (0 == strcmp(zbx_mock_get_object_member_string(hinsert, "type"), "recovery") ?
+						ZBX_ESC_ALERT_INSERT_RECOVERY : 0) | ZBX_ESC_ALERT_INSERT_ERROR;
+
+				zbx_mock_assert_uint64_eq(msg, index, executed.values[i].first);
+				zbx_mock_assert_uint64_eq(msg, zbx_mock_get_object_member_uint64(hinsert, "rows"),
+						executed.values[i].second);
+				i++;
+			}
+
+			zbx_snprintf(msg, sizeof(msg), "step #%d inserts", step);
+			zbx_mock_assert_int_eq(msg, i, executed.values_num);
+		}
+		else
+			fail_msg("unknown step #%d operation \"%s\"", step, op);
+
+		step++;
+	}
+
+	zbx_vector_uint64_pair_clear(&executed);
+	esc_cache_destroy();
+	zbx_mock_assert_int_eq("inserts executed on destroy",
+			(int)zbx_mock_get_parameter_uint64("out.destroy_inserts"), executed.values_num);
+
+	zbx_vector_uint64_pair_destroy(&executed);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*test;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+	esc_cache_init();
+
+	test = zbx_mock_get_parameter_string("in.test");
+
+	if (0 == strcmp(test, "trigger permissions"))
+	{
+		test_trigger_permissions();
+		esc_cache_destroy();
+	}
+	else if (0 == strcmp(test, "alerts"))
+		test_alerts();
+	else
+		fail_msg("unknown test \"%s\"", test);
+
+	zbx_mockdb_destroy();
+}
@@ -0,0 +1,52 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "../../../src/zabbix_server/housekeeper/hk_batch.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hbatches, hbatch;
+	zbx_mock_error_t	err;
+	int			batch_size = 0, i = 0;
+
+	ZBX_UNUSED(state);
+
+	hbatches = zbx_mock_get_parameter_handle("in.batches");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hbatches, &hbatch))))
+	{
+		int	config_max_hk_delete, deleted;
+		double	sec;
+		char	msg[64];
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read batch #%d: %s", i, zbx_mock_error_string(err));
+
+		config_max_hk_delete = zbx_mock_get_object_member_int(hbatch, "max");
+		deleted = zbx_mock_get_object_member_int(hbatch, "deleted");
+		sec = zbx_mock_get_object_member_float(hbatch, "sec");
+
+		zbx_snprintf(msg, sizeof(msg), "batch #%d size", i);
+		zbx_mock_assert_int_eq(msg, zbx_mock_get_object_member_int(hbatch, "size"),
+				hk_batch_get_size(&batch_size, config_max_hk_delete));
+
+		hk_batch_update(&batch_size, config_max_hk_delete, deleted, sec);
+		i++;
+	}
+}
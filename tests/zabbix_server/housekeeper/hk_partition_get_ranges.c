@@ -0,0 +1,73 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "zbxalgo.h"
+#include "zbxdbschema.h"
+#include "../../../src/zabbix_server/housekeeper/history_partition.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t		hpartitions, hpartition;
+	zbx_vector_uint64_pair_t	ranges;
+	int				last_to = 0, period, now, i = 0;
+
+	ZBX_UNUSED(state);
+
+	hpartitions = zbx_mock_get_parameter_handle("in.partitions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hpartitions, &hpartition))
+	{
+		const char	*bound;
+		int		to;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hpartition, &bound))
+			fail_msg("cannot read partition bound");
+
+		if ((to = hk_partition_parse_bound(bound)) > last_to)
+			last_to = to;
+	}
+
+	period = (int)zbx_mock_get_parameter_uint64("in.period");
+	now = (int)zbx_mock_get_parameter_uint64("in.now");
+
+	zbx_vector_uint64_pair_create(&ranges);
+	hk_partition_get_ranges(last_to, period, now, &ranges);
+
+	hpartitions = zbx_mock_get_parameter_handle("out.partitions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hpartitions, &hpartition))
+	{
+		char	name[ZBX_TABLENAME_LEN_MAX];
+
+		if (i >= ranges.values_num)
+			fail_msg("expected more than %d partitions to be created", ranges.values_num);
+
+		hk_partition_get_name("history_", (int)ranges.values[i].first, name, sizeof(name));
+
+		zbx_mock_assert_str_eq("partition name", zbx_mock_get_object_member_string(hpartition, "name"), name);
+		zbx_mock_assert_uint64_eq("partition start", zbx_mock_get_object_member_uint64(hpartition, "from"),
+				ranges.values[i].first);
+		zbx_mock_assert_uint64_eq("partition end", zbx_mock_get_object_member_uint64(hpartition, "to"),
+				ranges.values[i].second);
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of created partitions", i, ranges.values_num);
+
+	zbx_vector_uint64_pair_destroy(&ranges);
+}
@@ -0,0 +1,34 @@
+/*
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#include "../../../src/zabbix_server/housekeeper/history_partition.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	int	to, keep_from;
+
+	ZBX_UNUSED(state);
+
+	to = hk_partition_parse_bound(zbx_mock_get_parameter_string("in.bound"));
+	zbx_mock_assert_int_eq("partition upper bound", (int)zbx_mock_get_parameter_uint64("out.to"), to);
+
+	keep_from = (int)zbx_mock_get_parameter_uint64("in.keep_from");
+
+	zbx_mock_assert_result_eq("return value", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.return")), hk_partition_is_expired(to, keep_from));
+}
@@ -211,6 +211,9 @@ static const char	*frag_data = NULL;
 static const char	*frag_pos = NULL;
 static size_t		frag_sz = 0;
 
+/* set when the opened descriptor reads contents of a file from "files" parameter instead of fragments */
+static int		frag_file = 0;
+
 static int	next_fragment(void)
 {
 	zbx_mock_handle_t	fragment;
@@ -228,6 +231,8 @@ static int	next_fragment(void)
 
 int	__wrap_open(const char *path, int oflag, ...)
 {
+	zbx_mock_handle_t	file_contents;
+
 	if (SUCCEED == is_profiler_path(path))
 	{
 		va_list	args;
@@ -239,6 +244,25 @@ int	__wrap_open(const char *path, int oflag, ...)
 		return fd;
 	}
 
+	if (ZBX_MOCK_SUCCESS == zbx_mock_file(path, &file_contents))
+	{
+		zbx_mock_error_t	error;
+
+		if (ZBX_MOCK_SUCCESS != (error = zbx_mock_binary(file_contents, &frag_data, &frag_sz)))
+			fail_msg("Cannot read contents of file \"%s\": %s", path, zbx_mock_error_string(error));
+
+		frag_pos = frag_data;
+		frag_file = 1;
+
+		return INT_MAX;
+	}
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists("in.fragments"))
+	{
+		errno = ENOENT;
+		return -1;
+	}
+
 	fragments = zbx_mock_get_parameter_handle("in.fragments");
 	next_fragment();
 
@@ -262,7 +286,7 @@ ssize_t	__wrap_read(int fildes, void *buf, size_t nbyte)
 
 	if (frag_pos >= frag_data + frag_sz)
 	{
-		if (1 != next_fragment())
+		if (0 != frag_file || 1 != next_fragment())
 			return 0;
 	}
 
@@ -320,6 +344,7 @@ int	__wrap_close(int fd)
 
 	frag_data = frag_pos = NULL;
 	frag_sz = 0;
+	frag_file = 0;
 
 	return 0;
 }